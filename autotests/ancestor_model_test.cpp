@@ -12,6 +12,7 @@
 #include "database/database.h"
 
 #include <QAbstractItemModelTester>
+#include <QSignalSpy>
 #include <QSqlDatabase>
 #include <QSqlDriver>
 #include <QSqlQuery>
@@ -147,6 +148,52 @@ private Q_SLOTS:
         QVERIFY(model.index(0, AncestorModel::FATHER_ID).data().isNull());
         QVERIFY(model.index(0, AncestorModel::MOTHER_ID).data().isNull());
     }
+
+    void testGenerationsAreLimited() {
+        AncestorModel model{1, 2};
+
+        QCOMPARE(model.rowCount(), 3);
+        QCOMPARE(model.index(0, AncestorModel::CHILD_ID).data(), 1);
+        QCOMPARE(model.index(0, AncestorModel::UNLOADED_PARENTS).data(), false);
+        QCOMPARE(model.index(1, AncestorModel::CHILD_ID).data(), 3);
+        QCOMPARE(model.index(1, AncestorModel::UNLOADED_PARENTS).data(), true);
+        QCOMPARE(model.index(2, AncestorModel::CHILD_ID).data(), 4);
+        QCOMPARE(model.index(2, AncestorModel::UNLOADED_PARENTS).data(), true);
+    }
+
+    void testLoadMoreGenerationsInsertsRows() {
+        AncestorModel model{1, 2};
+        QAbstractItemModelTester tester(&model);
+        QSignalSpy reset(&model, &QAbstractItemModel::modelReset);
+        QSignalSpy inserted(&model, &QAbstractItemModel::rowsInserted);
+
+        model.loadMoreGenerations(3);
+
+        QCOMPARE(reset.count(), 0);
+        QCOMPARE(inserted.count(), 1);
+        QCOMPARE(model.rowCount(), 6);
+        QCOMPARE(model.index(1, AncestorModel::UNLOADED_PARENTS).data(), false);
+        QCOMPARE(model.index(3, AncestorModel::CHILD_ID).data(), 5);
+        QCOMPARE(model.index(4, AncestorModel::CHILD_ID).data(), 6);
+        QCOMPARE(model.index(5, AncestorModel::CHILD_ID).data(), 9);
+        QCOMPARE(model.index(5, AncestorModel::LEVEL).data(), 4);
+
+        // Person 9 is shared, so is not loaded again.
+        model.loadMoreGenerations(4);
+        QCOMPARE(model.rowCount(), 8);
+        QCOMPARE(model.index(6, AncestorModel::CHILD_ID).data(), 7);
+        QCOMPARE(model.index(7, AncestorModel::CHILD_ID).data(), 8);
+        QCOMPARE(model.index(6, AncestorModel::UNLOADED_PARENTS).data(), false);
+    }
+
+    void testReloadKeepsLoadedGenerations() {
+        AncestorModel model{1, 2};
+        model.loadMoreGenerations(3);
+
+        model.reload();
+
+        QCOMPARE(model.rowCount(), 6);
+    }
 };
 
 QTEST_MAIN(TestAncestorModel)
@@ -0,0 +1,171 @@
+/*
+ * SPDX-FileCopyrightText: Niko Strijbol <niko@strijbol.be>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+// ReSharper disable CppMemberFunctionMayBeStatic
+// ReSharper disable CppMemberFunctionMayBeConst
+#include "./test_utils.h"
+#include "database/database.h"
+#include "domain/family/family_list_model.h"
+#include "domain/person/person_display_model.h"
+#include "domain/person/person_repository.h"
+#include "model/object_table_model.h"
+#include "utils/async.h"
+
+#include <qcoro/qcorotask.h>
+#include <qcoro/qcorotimer.h>
+
+#include <QSignalSpy>
+#include <QSqlDatabase>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QThread>
+
+using namespace Qt::Literals::StringLiterals;
+
+namespace {
+class IntModel : public ObjectTableModel<int> {
+public:
+    IntModel() {
+        this->addColumn(u"Value"_s, [](const int& value) { return QVariant(value); });
+    }
+};
+
+QCoro::Task<QList<int>> delayed(QList<int> values, std::chrono::milliseconds delay) {
+    co_await QCoro::sleepFor(delay);
+    co_return values;
+}
+
+class ThreadRecordingRepository : public BaseRepository {
+public:
+    struct ThreadEntity {
+        Qt::HANDLE thread;
+
+        static ThreadEntity fromSql(const QSqlQuery&) {
+            return {QThread::currentThreadId()};
+        }
+    };
+
+    [[nodiscard]] QCoro::Task<QList<ThreadEntity>> fetch() const {
+        return fetchAllAsync<ThreadEntity>(u"SELECT id FROM people"_s);
+    }
+
+    [[nodiscard]] QCoro::Task<std::optional<PersonEntity>> fetchPerson(IntegerPrimaryKey id) const {
+        return fetchOneAsync<PersonEntity>(u"SELECT id, root, sex FROM people WHERE id = :id"_s, {{u":id"_s, id}});
+    }
+};
+}
+
+class TestAsyncRepository : public QObject {
+    Q_OBJECT
+
+    QTemporaryDir directory;
+
+private Q_SLOTS:
+    void init() {
+        QVERIFY(QSqlDatabase::isDriverAvailable(u"QSQLITE"_s));
+        QVERIFY(directory.isValid());
+        openDatabase(directory.filePath(u"async.db"_s), false);
+    }
+
+    void cleanup() {
+        closeDatabase();
+        QFile::remove(directory.filePath(u"async.db"_s));
+    }
+
+    void testFetchAllAsyncRunsOnWorkerThread() {
+        PersonRepository().insertPerson(u"Male"_s);
+
+        auto future = spawn(ThreadRecordingRepository().fetch());
+        QTRY_VERIFY(future.isFinished());
+
+        const auto rows = future.result();
+        QCOMPARE(rows.size(), 1);
+        QVERIFY(rows.first().thread != QThread::currentThreadId());
+    }
+
+    void testFetchOneAsyncReturnsResult() {
+        const auto id = PersonRepository().insertPerson(u"Female"_s);
+        QVERIFY(id.has_value());
+
+        auto future = spawn(ThreadRecordingRepository().fetchPerson(*id));
+        QTRY_VERIFY(future.isFinished());
+
+        const auto person = future.result();
+        QVERIFY(person.has_value());
+        QCOMPARE(person->sex, u"Female"_s);
+    }
+
+    void testInMemoryDatabaseFetchesSynchronously() {
+        closeDatabase();
+        openDatabase(u":memory:"_s, false);
+        PersonRepository().insertPerson(u"Male"_s);
+
+        auto future = spawn(PersonRepository().findPeopleWithPrimaryNameAsync());
+        QVERIFY(future.isFinished());
+        QCOMPARE(future.result().size(), 1);
+    }
+
+    void testStaleRowsAreShownUntilReloadFinishes() {
+        IntModel model;
+        model.setItems({1, 2});
+
+        model.setItemsAsync(delayed({3, 4, 5}, std::chrono::milliseconds(20)));
+        QVERIFY(model.hasPendingReload());
+        QCOMPARE(model.rowCount(), 2);
+
+        QTRY_VERIFY(!model.hasPendingReload());
+        QCOMPARE(model.getItems(), QList<int>({3, 4, 5}));
+    }
+
+    void testOutdatedReloadIsDropped() {
+        IntModel model;
+        QSignalSpy resets(&model, &QAbstractItemModel::modelReset);
+
+        // The first reload finishes last, but was overtaken by the second one.
+        model.setItemsAsync(delayed({1}, std::chrono::milliseconds(50)));
+        model.setItemsAsync(delayed({2}, std::chrono::milliseconds(10)));
+
+        QTRY_VERIFY(!model.hasPendingReload());
+        QCOMPARE(model.getItems(), QList<int>({2}));
+
+        // Give the first reload time to finish; it must not overwrite the newer rows.
+        QTest::qWait(100);
+        QCOMPARE(model.getItems(), QList<int>({2}));
+        QCOMPARE(resets.count(), 1);
+    }
+
+    void testSetItemsOvertakesPendingReload() {
+        IntModel model;
+        model.setItemsAsync(delayed({1}, std::chrono::milliseconds(10)));
+        model.setItems({2});
+
+        QVERIFY(!model.hasPendingReload());
+        QTest::qWait(50);
+        QCOMPARE(model.getItems(), QList<int>({2}));
+    }
+
+    void testPersonDisplayModelReloadsInBackground() {
+        PersonRepository repository;
+        repository.insertPerson(u"Male"_s);
+
+        PersonDisplayModel model;
+        QTRY_COMPARE(model.rowCount(), 1);
+
+        repository.insertPerson(u"Female"_s);
+        QTRY_COMPARE(model.rowCount(), 2);
+    }
+
+    void testFamilyListModelReloadsInBackground() {
+        FamilyListModel model;
+        QSignalSpy resets(&model, &QAbstractItemModel::modelReset);
+
+        model.reload();
+        QTRY_VERIFY(!resets.isEmpty());
+        QCOMPARE(model.rowCount(), 0);
+    }
+};
+
+QTEST_MAIN(TestAsyncRepository)
+#include "async_repository_test.moc"
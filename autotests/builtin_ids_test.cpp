@@ -0,0 +1,113 @@
+/*
+ * SPDX-FileCopyrightText: Niko Strijbol <niko@strijbol.be>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+// ReSharper disable CppMemberFunctionMayBeStatic
+// ReSharper disable CppMemberFunctionMayBeConst
+#include "core/data_event_broker.h"
+#include "database/database.h"
+#include "domain/event/builtin_ids.h"
+#include "domain/event/event_repository.h"
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTest>
+
+using namespace Qt::Literals::StringLiterals;
+
+class TestBuiltinIds : public QObject {
+    Q_OBJECT
+
+private Q_SLOTS:
+    void init() {
+        QVERIFY(QSqlDatabase::isDriverAvailable(u"QSQLITE"_s));
+        openDatabase(u":memory:"_s, false);
+    }
+
+    void cleanup() {
+        closeDatabase();
+    }
+
+    // First, so the receiver subscribes before the ids are ever used, like a model that subscribes
+    // before its first reload.
+    void testReceiverSubscribedBeforeFirstUseGetsNewIds() {
+        QObject receiver;
+        std::optional<IntegerPrimaryKey> received;
+        connectToTable<Schema::EventTypes>(&receiver, [&] {
+            received = BuiltinIds::instance().typeId(EventTypes::Values::Birth);
+        });
+
+        const auto birth = BuiltinIds::instance().typeId(EventTypes::Values::Birth);
+        QSqlQuery query;
+        QVERIFY(query.exec(u"UPDATE event_types SET id = 100 WHERE id = %1"_s.arg(birth)));
+        DataEventBroker::instance().notifyChanged<Schema::EventTypes>(std::nullopt);
+
+        QCOMPARE(received, std::optional<IntegerPrimaryKey>(100));
+    }
+
+    void testIdsMatchTheNames() {
+        EventRepository repo;
+        auto& ids = BuiltinIds::instance();
+
+        QCOMPARE(ids.typeId(EventTypes::Values::Birth), *repo.findEventTypeIdByName(u"Birth"_s));
+        QCOMPARE(ids.typeId(EventTypes::Values::Funeral), *repo.findEventTypeIdByName(u"Funeral"_s));
+        QCOMPARE(ids.roleId(EventRoles::Values::Primary), *repo.findEventRoleIdByName(u"Primary"_s));
+        QCOMPARE(ids.roleId(EventRoles::Values::Father), *repo.findEventRoleIdByName(u"Father"_s));
+    }
+
+    void testChangedTableIsReadAgain() {
+        auto& ids = BuiltinIds::instance();
+        const auto birth = ids.typeId(EventTypes::Values::Birth);
+
+        // The built-in type moves to another id, and the broker tells about it.
+        QSqlQuery query;
+        QVERIFY(query.exec(u"UPDATE event_types SET id = 100 WHERE id = %1"_s.arg(birth)));
+        QCOMPARE(ids.typeId(EventTypes::Values::Birth), birth);
+        DataEventBroker::instance().notifyChanged<Schema::EventTypes>(std::nullopt);
+
+        QCOMPARE(ids.typeId(EventTypes::Values::Birth), IntegerPrimaryKey{100});
+    }
+
+    void testReceiverOfCommittedChangeCanUseIds() {
+        auto& ids = BuiltinIds::instance();
+        const auto birth = ids.typeId(EventTypes::Values::Birth);
+
+        // A receiver reloading its rows, which binds the ids.
+        QObject receiver;
+        std::optional<IntegerPrimaryKey> received;
+        connectToTable<Schema::EventTypes>(&receiver, [&] { received = ids.typeId(EventTypes::Values::Birth); });
+
+        // Committed, but not delivered until the event loop runs.
+        QSqlQuery query;
+        QVERIFY(query.exec(u"UPDATE event_types SET id = 100 WHERE id = %1"_s.arg(birth)));
+        QCOMPARE(ids.typeId(EventTypes::Values::Birth), birth);
+        QVERIFY(!received.has_value());
+
+        QTRY_COMPARE(received, std::optional<IntegerPrimaryKey>(100));
+        QCOMPARE(ids.typeId(EventTypes::Values::Birth), IntegerPrimaryKey{100});
+    }
+
+    void testOtherDatabaseIsReadAgain() {
+        auto& ids = BuiltinIds::instance();
+        QVERIFY(ids.roleId(EventRoles::Values::Mother) > 0);
+
+        closeDatabase();
+        openDatabase(u":memory:"_s, false, false);
+
+        // The new database has no built-in rows.
+        QCOMPARE(ids.roleId(EventRoles::Values::Mother), IntegerPrimaryKey{-1});
+    }
+
+    void testBuiltinRowWinsFromUserRow() {
+        EventRepository repo;
+        const auto builtin = *repo.findEventRoleIdByName(u"Witness"_s);
+        QVERIFY(repo.insertEventRole(u"Witness"_s).has_value());
+        BuiltinIds::instance().invalidate();
+
+        QCOMPARE(BuiltinIds::instance().roleId(EventRoles::Values::Witness), builtin);
+    }
+};
+
+QTEST_MAIN(TestBuiltinIds)
+#include "builtin_ids_test.moc"
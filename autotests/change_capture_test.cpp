@@ -0,0 +1,205 @@
+/*
+ * SPDX-FileCopyrightText: Niko Strijbol <niko@strijbol.be>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+// ReSharper disable CppMemberFunctionMayBeStatic
+// ReSharper disable CppMemberFunctionMayBeConst
+#include "./test_utils.h"
+#include "core/data_event_broker.h"
+#include "core/query_helper.h"
+#include "database/change_capture.h"
+#include "database/database.h"
+#include "domain/event/event_repository.h"
+#include "domain/person/person_repository.h"
+
+#include <QSignalSpy>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QThread>
+#include <QtConcurrent>
+
+using namespace Qt::Literals::StringLiterals;
+
+static_assert(!Schema::Tables::rowidIsId[Schema::table_id<Schema::EventCitations>]);
+static_assert(Schema::Tables::rowidIsId[Schema::table_id<Schema::Events>]);
+
+namespace {
+using Notification = std::pair<QString, std::optional<IntegerPrimaryKey>>;
+
+QList<Notification> notifications(const QSignalSpy& spy) {
+    QList<Notification> result;
+    for (const auto& arguments: spy) {
+        result.append({arguments.at(0).toString(), arguments.at(1).value<std::optional<IntegerPrimaryKey>>()});
+    }
+    return result;
+}
+}
+
+class TestChangeCapture : public QObject {
+    Q_OBJECT
+
+    QTemporaryDir directory;
+
+private Q_SLOTS:
+    void init() {
+        QVERIFY(QSqlDatabase::isDriverAvailable(u"QSQLITE"_s));
+        QVERIFY(directory.isValid());
+        openDatabase(directory.filePath(u"capture.db"_s), false);
+        // Creating the database also inserted rows.
+        ChangeCapture::deliverCommitted();
+        DataEventBroker::instance().setCoalesceThreshold(DataEventBroker::DEFAULT_COALESCE_THRESHOLD);
+    }
+
+    void cleanup() {
+        closeDatabase();
+        QFile::remove(directory.filePath(u"capture.db"_s));
+    }
+
+    void testTableNamesMapToIds() {
+        QCOMPARE(Schema::tableId(Schema::Names::table), std::optional(Schema::table_id<Schema::Names>));
+        QVERIFY(!Schema::tableId("person_external_ids"_L1).has_value());
+    }
+
+    void testRepositoryWriteIsNotifiedBeforeItReturns() {
+        QSignalSpy spy(&DataEventBroker::instance(), &DataEventBroker::entityChanged);
+
+        const auto id = PersonRepository().insertPerson(u"Male"_s);
+        QVERIFY(id.has_value());
+
+        QCOMPARE(notifications(spy), QList<Notification>({{Schema::People::table, *id}}));
+    }
+
+    void testRawQueryIsNotifiedFromEventLoop() {
+        QSignalSpy spy(&DataEventBroker::instance(), &DataEventBroker::entityChanged);
+
+        const auto id = insertQuery(u"INSERT INTO people (root, sex) VALUES (false, 'Female')"_s);
+        QCOMPARE(spy.count(), 0);
+
+        QTRY_COMPARE(spy.count(), 1);
+        QCOMPARE(notifications(spy), QList<Notification>({{Schema::People::table, id}}));
+    }
+
+    void testReadDoesNotDeliver() {
+        QSignalSpy spy(&DataEventBroker::instance(), &DataEventBroker::entityChanged);
+
+        insertQuery(u"INSERT INTO people (root, sex) VALUES (false, 'Female')"_s);
+        auto [query, ok] = QueryHelper::executeWithResult(u"SELECT COUNT(*) FROM people"_s);
+        QVERIFY(ok);
+
+        // Receivers do not run in the middle of a read, only from the event loop or after a write.
+        QCOMPARE(spy.count(), 0);
+        QTRY_COMPARE(spy.count(), 1);
+    }
+
+    void testCascadeDeleteIsNotified() {
+        const auto personId = PersonRepository().insertPerson(u"Male"_s);
+        QVERIFY(personId.has_value());
+        const auto nameId =
+            insertQuery(u"INSERT INTO names (person_id, sort, given_names) VALUES (%1, 1, 'Jan')"_s.arg(*personId));
+        ChangeCapture::deliverCommitted();
+
+        QSignalSpy spy(&DataEventBroker::instance(), &DataEventBroker::entityChanged);
+        QVERIFY(PersonRepository().deletePerson(*personId));
+
+        const auto received = notifications(spy);
+        QVERIFY(received.contains(Notification{Schema::People::table, *personId}));
+        QVERIFY(received.contains(Notification{Schema::Names::table, nameId}));
+    }
+
+    void testRollbackIsNotNotified() {
+        QSignalSpy spy(&DataEventBroker::instance(), &DataEventBroker::entityChanged);
+
+        auto result = executeInTransaction([]() -> std::optional<bool> {
+            PersonRepository().insertPerson(u"Male"_s);
+            return std::nullopt;
+        });
+        QVERIFY(!result.has_value());
+
+        QTest::qWait(20);
+        QCOMPARE(spy.count(), 0);
+    }
+
+    void testTransactionIsNotifiedOnceAfterCommit() {
+        QSignalSpy spy(&DataEventBroker::instance(), &DataEventBroker::entityChanged);
+
+        auto result = executeInTransaction([&spy]() -> std::optional<IntegerPrimaryKey> {
+            PersonRepository repository;
+            const auto id = repository.insertPerson(u"Male"_s);
+            VERIFY_OR_THROW(id.has_value());
+            VERIFY_OR_THROW(repository.updatePerson(*id, u"Female"_s, true));
+            VERIFY_OR_THROW(spy.count() == 0);
+            return id;
+        });
+        QVERIFY(result.has_value());
+
+        QCOMPARE(notifications(spy), QList<Notification>({{Schema::People::table, *result}}));
+    }
+
+    void testLargeTransactionIsNotifiedForWholeTable() {
+        DataEventBroker::instance().setCoalesceThreshold(10);
+        QSignalSpy spy(&DataEventBroker::instance(), &DataEventBroker::entityChanged);
+
+        QVERIFY(QueryHelper::execute(
+            u"WITH RECURSIVE counter(x) AS (SELECT 1 UNION ALL SELECT x + 1 FROM counter WHERE x < 100) "
+            u"INSERT INTO people (root, sex) SELECT false, 'Male' FROM counter"_s
+        ));
+
+        QCOMPARE(notifications(spy), QList<Notification>({{Schema::People::table, std::nullopt}}));
+    }
+
+    void testJunctionTablesAreNotCaptured() {
+        const auto typeId = insertQuery(u"INSERT INTO event_types (type, builtin) VALUES ('Birth', false)"_s);
+        const auto eventId = insertQuery(u"INSERT INTO events (type_id) VALUES (%1)"_s.arg(typeId));
+        const auto sourceId = insertQuery(u"INSERT INTO sources (title) VALUES ('Register')"_s);
+        ChangeCapture::deliverCommitted();
+
+        QSignalSpy spy(&DataEventBroker::instance(), &DataEventBroker::entityChanged);
+        QVERIFY(EventRepository().addEventCitation(eventId, sourceId));
+        QTest::qWait(20);
+
+        // Only the notification of the repository, with the id of the event.
+        QCOMPARE(notifications(spy), QList<Notification>({{Schema::EventCitations::table, eventId}}));
+    }
+
+    void testCommitOnOtherConnectionIsDeliveredOnBrokerThread() {
+        QObject receiver;
+        Qt::HANDLE callbackThread = nullptr;
+        std::optional<IntegerPrimaryKey> received;
+        connectToTable<Schema::People>(&receiver, [&](std::optional<IntegerPrimaryKey> id) {
+            callbackThread = QThread::currentThreadId();
+            received = id;
+        });
+
+        const auto inserted = QtConcurrent::run([] {
+            const auto connectionName = u"capture_test_writer"_s;
+            IntegerPrimaryKey id = 0;
+            {
+                const auto defaultConnection = QString::fromLatin1(QSqlDatabase::defaultConnection);
+                auto database = QSqlDatabase::cloneDatabase(defaultConnection, connectionName);
+                if (!database.open() || !configureConnection(database)) {
+                    return id;
+                }
+                QSqlQuery query(database);
+                if (query.exec(u"INSERT INTO people (root, sex) VALUES (false, 'Male')"_s)) {
+                    id = query.lastInsertId().toLongLong();
+                }
+                query.finish();
+                database.close();
+            }
+            QSqlDatabase::removeDatabase(connectionName);
+            ChangeCapture::uninstall(connectionName);
+            return id;
+        }).result();
+        QVERIFY(inserted > 0);
+
+        QTRY_VERIFY(received.has_value());
+        QCOMPARE(*received, inserted);
+        QCOMPARE(callbackThread, QThread::currentThreadId());
+    }
+};
+
+QTEST_MAIN(TestChangeCapture)
+#include "change_capture_test.moc"
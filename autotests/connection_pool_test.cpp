@@ -0,0 +1,141 @@
+/*
+ * SPDX-FileCopyrightText: Niko Strijbol <niko@strijbol.be>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+// ReSharper disable CppMemberFunctionMayBeStatic
+// ReSharper disable CppMemberFunctionMayBeConst
+#include "./test_utils.h"
+#include "core/query_helper.h"
+#include "database/connection_pool.h"
+#include "database/database.h"
+#include "domain/person/person_repository.h"
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QThreadPool>
+#include <QtConcurrent>
+
+using namespace Qt::Literals::StringLiterals;
+
+class TestConnectionPool : public QObject {
+    Q_OBJECT
+
+    QTemporaryDir directory;
+
+    static qsizetype countPeopleInBackground() {
+        return QtConcurrent::run([] { return PersonRepository().findPeople().size(); }).result();
+    }
+
+private Q_SLOTS:
+    void init() {
+        QVERIFY(QSqlDatabase::isDriverAvailable(u"QSQLITE"_s));
+        QVERIFY(directory.isValid());
+        openDatabase(directory.filePath(u"pool.db"_s), false);
+    }
+
+    void cleanup() {
+        closeDatabase();
+        QFile::remove(directory.filePath(u"pool.db"_s));
+    }
+
+    void testFileDatabaseUsesWal() {
+        QSqlQuery query;
+        QVERIFY(query.exec(u"PRAGMA journal_mode"_s));
+        QVERIFY(query.next());
+        QCOMPARE(query.value(0).toString(), u"wal"_s);
+        QVERIFY(ConnectionPool::instance().hasReaders());
+    }
+
+    void testWriterThreadUsesDefaultConnection() {
+        auto connection = ConnectionPool::instance().connectionForCurrentThread();
+        QCOMPARE(connection.connectionName(), QSqlDatabase::database().connectionName());
+    }
+
+    void testRepositoryReadsWorkOnOtherThreads() {
+        PersonRepository repository;
+        repository.insertPerson(u"Male"_s);
+        repository.insertPerson(u"Female"_s);
+
+        QCOMPARE(countPeopleInBackground(), 2);
+    }
+
+    void testReadersAreConfiguredAndReadOnly() {
+        auto check = [] {
+            auto connection = ConnectionPool::instance().connectionForCurrentThread();
+            QSqlQuery pragma(connection);
+            pragma.exec(u"PRAGMA foreign_keys"_s);
+            pragma.next();
+            const auto foreignKeys = pragma.value(0).toBool();
+            const auto inserted = QueryHelper::execute(u"INSERT INTO people (root, sex) VALUES (false, 'Male')"_s);
+            return std::pair{foreignKeys, inserted};
+        };
+        const auto [foreignKeys, inserted] = QtConcurrent::run(check).result();
+
+        QVERIFY(foreignKeys);
+        QVERIFY(!inserted);
+    }
+
+    void testReadersAreNotBlockedByWriteTransaction() {
+        PersonRepository repository;
+        repository.insertPerson(u"Male"_s);
+
+        auto database = QSqlDatabase::database();
+        QVERIFY(database.transaction());
+        repository.insertPerson(u"Female"_s);
+
+        // The uncommitted row is invisible, and the reader does not wait for the writer.
+        QCOMPARE(countPeopleInBackground(), 1);
+
+        QVERIFY(database.commit());
+        QCOMPARE(countPeopleInBackground(), 2);
+    }
+
+    void testReopeningDropsReaders() {
+        QCOMPARE(countPeopleInBackground(), 0);
+
+        closeDatabase();
+        QCOMPARE(ConnectionPool::instance().readerCount(), 0);
+        openDatabase(directory.filePath(u"pool.db"_s), false);
+
+        // The worker thread may be reused, but must get a connection to the reopened database.
+        PersonRepository().insertPerson(u"Male"_s);
+        QCOMPARE(countPeopleInBackground(), 1);
+    }
+
+    void testIdleReaderIsDroppedByItsOwnThread() {
+        QThreadPool pool;
+        pool.setMaxThreadCount(1);
+        pool.setExpiryTimeout(-1);
+        const auto readerOfPoolThread = [&pool] {
+            return QtConcurrent::run(&pool, [] {
+                       PersonRepository().findPeople();
+                       return ConnectionPool::instance().connectionForCurrentThread().connectionName();
+                   })
+                .result();
+        };
+
+        const auto first = readerOfPoolThread();
+        closeDatabase();
+        // The reader and its cached statements belong to the idle thread, so it is still there.
+        QVERIFY(QSqlDatabase::connectionNames().contains(first));
+
+        openDatabase(directory.filePath(u"pool.db"_s), false);
+        const auto second = readerOfPoolThread();
+        QVERIFY(second != first);
+        QVERIFY(!QSqlDatabase::connectionNames().contains(first));
+    }
+
+    void testInMemoryDatabaseHasNoReaders() {
+        closeDatabase();
+        openDatabase(u":memory:"_s, false);
+
+        QVERIFY(!ConnectionPool::instance().hasReaders());
+        QCOMPARE(ConnectionPool::instance().readerCount(), 0);
+    }
+};
+
+QTEST_MAIN(TestConnectionPool)
+#include "connection_pool_test.moc"
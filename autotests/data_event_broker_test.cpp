@@ -0,0 +1,156 @@
+/*
+ * SPDX-FileCopyrightText: Niko Strijbol <niko@strijbol.be>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+// ReSharper disable CppMemberFunctionMayBeStatic
+// ReSharper disable CppMemberFunctionMayBeConst
+#include "core/data_event_broker.h"
+#include "database/schema.h"
+
+#include <QSignalSpy>
+#include <QTest>
+#include <QThread>
+#include <QtConcurrent>
+
+using namespace Qt::Literals::StringLiterals;
+
+static_assert(Schema::table_id<Schema::People> == 0);
+static_assert(Schema::table_id<Schema::Names> == 1);
+
+class TestDataEventBroker : public QObject {
+    Q_OBJECT
+
+private Q_SLOTS:
+    void init() {
+        DataEventBroker::instance().resetStats();
+    }
+
+    void testOnlySubscribersOfTableAreWoken() {
+        QObject people;
+        QObject names;
+        int peopleCalls = 0;
+        int namesCalls = 0;
+        connectToTable<Schema::People>(&people, [&peopleCalls] { ++peopleCalls; });
+        connectToTable<Schema::Names>(&names, [&namesCalls] { ++namesCalls; });
+
+        DataEventBroker::instance().notifyChanged<Schema::Names>(1);
+
+        QCOMPARE(peopleCalls, 0);
+        QCOMPARE(namesCalls, 1);
+    }
+
+    void testIdSubscriberIsWokenForItsRowAndTableWideChanges() {
+        QObject receiver;
+        QList<std::optional<IntegerPrimaryKey>> received;
+        DataEventBroker::instance().subscribe<Schema::People>(
+            &receiver,
+            5,
+            [&received](std::optional<IntegerPrimaryKey> id) { received << id; }
+        );
+
+        auto& broker = DataEventBroker::instance();
+        broker.notifyChanged<Schema::People>(4);
+        broker.notifyChanged<Schema::People>(5);
+        broker.notifyChanged<Schema::People>(std::nullopt);
+
+        QCOMPARE(received, QList<std::optional<IntegerPrimaryKey>>({5, std::nullopt}));
+    }
+
+    void testDestroyedReceiverIsUnsubscribed() {
+        auto& broker = DataEventBroker::instance();
+        const auto before = broker.subscriberCount<Schema::Events>();
+
+        int calls = 0;
+        {
+            QObject receiver;
+            connectToTable<Schema::Events>(&receiver, [&calls] { ++calls; });
+            connectToTable<Schema::Events>(&receiver, 3, [&calls] { ++calls; });
+            QCOMPARE(broker.subscriberCount<Schema::Events>(), before + 2);
+        }
+
+        QCOMPARE(broker.subscriberCount<Schema::Events>(), before);
+        broker.notifyChanged<Schema::Events>(3);
+        QCOMPARE(calls, 0);
+    }
+
+    void testReceiverDestroyedByEarlierCallbackIsSkipped() {
+        auto* second = new QObject;
+        QObject first;
+        int secondCalls = 0;
+        connectToTable<Schema::Sources>(&first, [&second] {
+            delete second;
+            second = nullptr;
+        });
+        connectToTable<Schema::Sources>(second, [&secondCalls] { ++secondCalls; });
+
+        DataEventBroker::instance().notifyChanged<Schema::Sources>(1);
+
+        QCOMPARE(secondCalls, 0);
+        QVERIFY(second == nullptr);
+    }
+
+    void testCallbackRunsOnReceiverThread() {
+        QObject receiver;
+        Qt::HANDLE callbackThread = nullptr;
+        connectToTable<Schema::Media>(&receiver, [&callbackThread] { callbackThread = QThread::currentThreadId(); });
+
+        QtConcurrent::run([] { DataEventBroker::instance().notifyChanged<Schema::Media>(1); }).waitForFinished();
+
+        QTRY_VERIFY(callbackThread != nullptr);
+        QCOMPARE(callbackThread, QThread::currentThreadId());
+    }
+
+    void testTableIdsMapToNames() {
+        QCOMPARE(Schema::tableName(Schema::table_id<Schema::Events>), Schema::Events::table);
+        QCOMPARE(Schema::tableName(Schema::table_id<Schema::LocationMedia>), Schema::LocationMedia::table);
+    }
+
+    void testSignalIsStillEmittedForEveryNotification() {
+        QSignalSpy spy(&DataEventBroker::instance(), &DataEventBroker::entityChanged);
+        DataEventBroker::instance().notifyChanged<Schema::Locations>(2);
+
+        QCOMPARE(spy.count(), 1);
+        QCOMPARE(spy.at(0).at(0).toString(), Schema::Locations::table);
+    }
+
+    void testStatsCountNotificationsAndWokenReceivers() {
+        QObject a;
+        QObject b;
+        QObject other;
+        connectToTable<Schema::Families>(&a, [] {});
+        connectToTable<Schema::Families>(&b, 7, [] {});
+        connectToTable<Schema::Families>(&other, 8, [] {});
+
+        auto& broker = DataEventBroker::instance();
+        broker.notifyChanged<Schema::Families>(7);
+        broker.notifyChanged<Schema::Families>(9);
+
+        const auto stats = broker.stats<Schema::Families>();
+        QCOMPARE(stats.notifications, quint64{2});
+        // Row 7 wakes a and b, row 9 only a.
+        QCOMPARE(stats.receiversWoken, quint64{3});
+
+        const auto all = broker.allStats();
+        QVERIFY(all.contains(Schema::Families::table));
+        QVERIFY(!all.contains(Schema::People::table));
+    }
+
+    void testBatchedNotificationsAreDispatched() {
+        QObject receiver;
+        QList<std::optional<IntegerPrimaryKey>> received;
+        connectToTable<Schema::Names>(&receiver, [&received](std::optional<IntegerPrimaryKey> id) { received << id; });
+
+        {
+            auto guard = DataEventBroker::instance().batchNotifications();
+            DataEventBroker::instance().notifyChanged<Schema::Names>(1);
+            DataEventBroker::instance().notifyChanged<Schema::Names>(1);
+            QVERIFY(received.isEmpty());
+        }
+
+        QCOMPARE(received, QList<std::optional<IntegerPrimaryKey>>({1}));
+    }
+};
+
+QTEST_MAIN(TestDataEventBroker)
+#include "data_event_broker_test.moc"
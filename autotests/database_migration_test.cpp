@@ -5,14 +5,22 @@
  */
 // ReSharper disable CppMemberFunctionMayBeStatic
 // ReSharper disable CppMemberFunctionMayBeConst
+#include "core/query_utils.h"
 #include "database/database.h"
+#include "dates/date_columns.h"
+#include "random_dates.h"
 
+#include <QDate>
+#include <QRandomGenerator>
 #include <QSqlDatabase>
 #include <QSqlQuery>
 #include <QTest>
+#include <limits>
 
 using namespace Qt::Literals::StringLiterals;
 
+static constexpr int LATEST_VERSION = 14;
+
 // The old pre-migration schema for event_relations (composite PK, no surrogate id).
 static const QString OLD_EVENT_RELATIONS_DDL = QStringLiteral(
     "CREATE TABLE event_relations ("
@@ -54,6 +62,46 @@ static bool columnExists(QSqlDatabase& db, const QString& table, const QString&
     return false;
 }
 
+static bool indexExists(QSqlDatabase& db, const QString& index) {
+    QSqlQuery q(db);
+    q.prepare(u"SELECT 1 FROM sqlite_master WHERE type = 'index' AND name = :name"_s);
+    q.bindValue(u":name"_s, index);
+    return q.exec() && q.next();
+}
+
+// The rows of parent_links as "child parent role event", sorted.
+static QStringList parentLinks(QSqlDatabase& db) {
+    QSqlQuery q(db);
+    q.exec(u"SELECT child_id, parent_id, role_id, event_id FROM parent_links ORDER BY 1, 2, 3, 4"_s);
+    QStringList rows;
+    while (q.next()) {
+        rows.append(
+            u"%1 %2 %3 %4"_s
+                .arg(q.value(0).toString(), q.value(1).toString(), q.value(2).toString(), q.value(3).toString())
+        );
+    }
+    return rows;
+}
+
+// The date in the columns of DateColumns, starting at the first column of the query.
+static std::optional<GenealogicalDate::Stored> storedDate(const QSqlQuery& q, int first) {
+    if (q.value(first).isNull()) {
+        return std::nullopt;
+    }
+    return GenealogicalDate::Stored{
+        .type = static_cast<GenealogicalDate::DateType>(q.value(first).toInt()),
+        .modifier = static_cast<GenealogicalDate::Modifier>(q.value(first + 1).toInt()),
+        .quality = static_cast<GenealogicalDate::Quality>(q.value(first + 2).toInt()),
+        .precision = q.value(first + 3).toInt(),
+        .sortDay = validOrOptional<qint64>(q.value(first + 4)),
+        .firstDay = validOrOptional<qint64>(q.value(first + 5)),
+        .lastDay = validOrOptional<qint64>(q.value(first + 6)),
+        .startTime = validOrOptional<int>(q.value(first + 7)),
+        .endTime = validOrOptional<int>(q.value(first + 8)),
+        .text = q.value(first + 9).toString(),
+    };
+}
+
 // Opens a raw :memory: connection (no schema, no tracing) and returns it as the default connection.
 static QSqlDatabase openRawDatabase() {
     auto db = QSqlDatabase::addDatabase(u"QSQLITE"_s);
@@ -71,6 +119,10 @@ static void createSupportingTables(QSqlDatabase& db) {
         u"CREATE TABLE event_roles (id INTEGER NOT NULL PRIMARY KEY AUTOINCREMENT, role TEXT, builtin BOOLEAN NOT NULL DEFAULT FALSE)"_s,
         u"CREATE TABLE events (id INTEGER NOT NULL PRIMARY KEY AUTOINCREMENT, type_id INTEGER NOT NULL REFERENCES event_types (id) ON DELETE RESTRICT, date TEXT, name TEXT, note TEXT)"_s,
         u"CREATE TABLE sources (id INTEGER NOT NULL PRIMARY KEY AUTOINCREMENT, title TEXT, type TEXT, author TEXT, publication TEXT, confidence TEXT NOT NULL, note TEXT, parent_id INTEGER REFERENCES sources (id) ON DELETE SET NULL)"_s,
+        u"CREATE TABLE names (id INTEGER NOT NULL PRIMARY KEY AUTOINCREMENT, person_id INTEGER NOT NULL, sort INTEGER NOT NULL, titles TEXT, given_names TEXT, prefix TEXT, surname TEXT, note TEXT, origin_id INTEGER NULL DEFAULT NULL)"_s,
+        u"CREATE TABLE event_citations (event_id INTEGER NOT NULL, source_id INTEGER NOT NULL, PRIMARY KEY (event_id, source_id))"_s,
+        u"CREATE TABLE name_citations (name_id INTEGER NOT NULL, source_id INTEGER NOT NULL, PRIMARY KEY (name_id, source_id))"_s,
+        u"CREATE TABLE person_citations (person_id INTEGER NOT NULL, source_id INTEGER NOT NULL, PRIMARY KEY (person_id, source_id))"_s,
     };
     for (const auto& stmt: ddl) {
         QSqlQuery q(db);
@@ -107,17 +159,17 @@ private Q_SLOTS:
     void testFreshDatabaseIsStampedWithLatestVersion() {
         openDatabase(u":memory:"_s, false, false);
         auto db = QSqlDatabase::database();
-        QCOMPARE(userVersion(db), 9);
+        QCOMPARE(userVersion(db), LATEST_VERSION);
     }
 
     void testRunMigrationsIsNoopOnCurrentDatabase() {
         openDatabase(u":memory:"_s, false, false);
         auto db = QSqlDatabase::database();
-        QCOMPARE(userVersion(db), 9);
+        QCOMPARE(userVersion(db), LATEST_VERSION);
 
         runMigrations(db);
 
-        QCOMPARE(userVersion(db), 9);
+        QCOMPARE(userVersion(db), LATEST_VERSION);
     }
 
     void testRunMigrationsSkipsAlreadyAppliedMigration() {
@@ -134,7 +186,7 @@ private Q_SLOTS:
         // Migration 1 schema should be untouched — it was skipped.
         QVERIFY(!columnExists(db, u"event_relations"_s, u"id"_s));
         // Migrations 2 through 5 ran, bumping to version 5.
-        QCOMPARE(userVersion(db), 9);
+        QCOMPARE(userVersion(db), LATEST_VERSION);
     }
 
     // ==================== Migration 1 ====================
@@ -146,7 +198,7 @@ private Q_SLOTS:
         runMigrations(db);
 
         QVERIFY(columnExists(db, u"event_relations"_s, u"id"_s));
-        QCOMPARE(userVersion(db), 9);
+        QCOMPARE(userVersion(db), LATEST_VERSION);
     }
 
     void testMigration1ReplacesCompositeKeyWithUniqueConstraint() {
@@ -297,7 +349,7 @@ private Q_SLOTS:
         runMigrations(db);
 
         QVERIFY(columnExists(db, u"location_types"_s, u"id"_s));
-        QCOMPARE(userVersion(db), 9);
+        QCOMPARE(userVersion(db), LATEST_VERSION);
     }
 
     // ==================== Migration 3 ====================
@@ -325,7 +377,7 @@ private Q_SLOTS:
         QVERIFY(columnExists(db, u"event_type_translations"_s, u"type_id"_s));
         QVERIFY(columnExists(db, u"event_type_translations"_s, u"locale"_s));
         QVERIFY(columnExists(db, u"event_type_translations"_s, u"name"_s));
-        QCOMPARE(userVersion(db), 9);
+        QCOMPARE(userVersion(db), LATEST_VERSION);
     }
 
     void testMigration3AddsLocationTypeTranslationsTable() {
@@ -373,6 +425,247 @@ private Q_SLOTS:
         QCOMPARE(q.value(0).toInt(), 1);
         QCOMPARE(q.value(1).toString(), u"Test"_s);
     }
+
+    // ==================== Migration 11 ====================
+
+    void testMigration11AddsSecondaryIndexes() {
+        auto db = setupVersion1Database();
+        QVERIFY(!indexExists(db, u"idx_names_person_sort"_s));
+
+        runMigrations(db);
+
+        QVERIFY(indexExists(db, u"idx_names_person_sort"_s));
+        QVERIFY(indexExists(db, u"idx_event_relations_person_role"_s));
+        QVERIFY(indexExists(db, u"idx_events_family"_s));
+        QVERIFY(indexExists(db, u"idx_locations_parent_name"_s));
+        QVERIFY(indexExists(db, u"idx_person_media_media"_s));
+        QVERIFY(indexExists(db, u"idx_person_citations_source"_s));
+        QCOMPARE(userVersion(db), LATEST_VERSION);
+    }
+
+    void testFreshDatabaseHasSecondaryIndexes() {
+        openDatabase(u":memory:"_s, false, false);
+        auto db = QSqlDatabase::database();
+
+        QVERIFY(indexExists(db, u"idx_names_person_sort"_s));
+        QVERIFY(indexExists(db, u"idx_sources_type"_s));
+        QVERIFY(indexExists(db, u"idx_location_media_media"_s));
+    }
+
+    // ==================== Migration 12 ====================
+
+    static QSqlDatabase setupVersion1DatabaseWithBirth() {
+        auto db = setupVersion1Database();
+        QSqlQuery(db).exec(u"INSERT INTO event_types VALUES (1, 'Birth', true), (2, 'Death', true)"_s);
+        QSqlQuery(db).exec(
+            u"INSERT INTO event_roles VALUES (1, 'Primary', true), (2, 'Mother', true), (3, 'Father', true)"_s
+        );
+        QSqlQuery(db).exec(u"INSERT INTO events VALUES (1, 1, NULL, NULL, NULL), (2, 2, NULL, NULL, NULL)"_s);
+        QSqlQuery(db).exec(
+            u"INSERT INTO event_relations (event_id, person_id, role_id) "
+            u"VALUES (1, 10, 1), (1, 11, 3), (2, 10, 1), (2, 12, 2)"_s
+        );
+        return db;
+    }
+
+    void testMigration12BackfillsParentLinks() {
+        auto db = setupVersion1DatabaseWithBirth();
+
+        runMigrations(db);
+
+        QVERIFY(indexExists(db, u"idx_parent_links_parent"_s));
+        // Only the birth event has parents.
+        QCOMPARE(parentLinks(db), QStringList{u"10 11 3 1"_s});
+        QCOMPARE(userVersion(db), LATEST_VERSION);
+    }
+
+    void testParentLinksFollowEventRelations() {
+        auto db = setupVersion1DatabaseWithBirth();
+        runMigrations(db);
+
+        QVERIFY(
+            QSqlQuery(db).exec(u"INSERT INTO event_relations (event_id, person_id, role_id) VALUES (1, 12, 2)"_s)
+        );
+        QCOMPARE(parentLinks(db), QStringList({u"10 11 3 1"_s, u"10 12 2 1"_s}));
+
+        QVERIFY(
+            QSqlQuery(db).exec(u"UPDATE event_relations SET person_id = 13 WHERE event_id = 1 AND role_id = 3"_s)
+        );
+        QCOMPARE(parentLinks(db), QStringList({u"10 12 2 1"_s, u"10 13 3 1"_s}));
+
+        QVERIFY(QSqlQuery(db).exec(u"DELETE FROM event_relations WHERE event_id = 1 AND role_id = 1"_s));
+        QVERIFY(parentLinks(db).isEmpty());
+    }
+
+    void testParentLinksFollowEventsAndRoles() {
+        auto db = setupVersion1DatabaseWithBirth();
+        runMigrations(db);
+
+        QVERIFY(QSqlQuery(db).exec(u"UPDATE events SET type_id = 1 WHERE id = 2"_s));
+        QCOMPARE(parentLinks(db), QStringList({u"10 11 3 1"_s, u"10 12 2 2"_s}));
+
+        QVERIFY(QSqlQuery(db).exec(u"UPDATE event_roles SET role = 'Godfather' WHERE id = 3"_s));
+        QCOMPARE(parentLinks(db), QStringList{u"10 12 2 2"_s});
+
+        QVERIFY(QSqlQuery(db).exec(u"DELETE FROM events WHERE id = 2"_s));
+        QVERIFY(parentLinks(db).isEmpty());
+    }
+
+    void testMigration13BackfillsPrimaryNames() {
+        auto db = setupVersion1Database();
+        QSqlQuery(db).exec(
+            u"INSERT INTO names (person_id, sort, titles, given_names, prefix, surname) "
+            u"VALUES (1, 2, '', 'Jan', 'van', 'Dijk'), (1, 1, 'Dr.', 'Johannes', '', 'Dijk'), (2, 1, '', '', '', '')"_s
+        );
+
+        runMigrations(db);
+
+        QSqlQuery q(db);
+        QVERIFY(q.exec(u"SELECT person_id, name_id, display_name FROM person_primary_name ORDER BY person_id"_s));
+        QVERIFY(q.next());
+        QCOMPARE(q.value(1).toInt(), 2);
+        QCOMPARE(q.value(2).toString(), u"Dr. Johannes Dijk"_s);
+        QVERIFY(q.next());
+        QCOMPARE(q.value(0).toInt(), 2);
+        QCOMPARE(q.value(2).toString(), u""_s);
+        QVERIFY(!q.next());
+        QCOMPARE(userVersion(db), LATEST_VERSION);
+    }
+
+    // ==================== Migration 14 ====================
+
+    void testMigration14DecodesDates() {
+        auto db = setupVersion2Database();
+        const auto march = QDate(1850, 3, 1).toJulianDay();
+        QSqlQuery(db).exec(u"INSERT INTO event_types VALUES (1, 'Birth', true)"_s);
+        QSqlQuery(db).exec(
+            uR"(INSERT INTO events (id, type_id, date) VALUES (1, 1, '{"dateType":"SINGLE","dateModifier":"ABOUT",)"
+            uR"("dateQuality":"ESTIMATED","proleptic":%1,"year":true,"month":true,"day":false,"endProleptic":0,)"
+            uR"("endYear":false,"endMonth":false,"endDay":false,"time":"10:30","userText":""}'), (2, 1, NULL))"_s.arg(
+                march
+            )
+        );
+        QSqlQuery(db).exec(
+            uR"(INSERT INTO locations (id, name, date_start, date_end) VALUES (1, 'Ghent', '{"dateType":"SINGLE",)"
+            uR"("dateModifier":"AFTER","dateQuality":"EXACT","proleptic":%1,"year":true,"month":false,"day":false,)"
+            uR"("endProleptic":0,"endYear":false,"endMonth":false,"endDay":false,"userText":""}', ''))"_s.arg(march)
+        );
+
+        runMigrations(db);
+
+        QVERIFY(!columnExists(db, u"events"_s, u"date"_s));
+        QVERIFY(!columnExists(db, u"locations"_s, u"date_start"_s));
+        QVERIFY(indexExists(db, u"idx_events_date_first_day"_s));
+
+        QSqlQuery q(db);
+        QVERIFY(q.exec(
+            u"SELECT date_type, date_modifier, date_quality, date_precision, date_sort, date_first_day, "
+            u"date_last_day, date_time FROM events ORDER BY id"_s
+        ));
+        QVERIFY(q.next());
+        QCOMPARE(q.value(0).toInt(), 0);
+        QCOMPARE(q.value(1).toInt(), 3);
+        QCOMPARE(q.value(2).toInt(), 1);
+        QCOMPARE(q.value(3).toInt(), 0x01 | 0x02);
+        QCOMPARE(q.value(4).toLongLong(), march);
+        QCOMPARE(q.value(5).toLongLong(), march);
+        QCOMPARE(q.value(6).toLongLong(), QDate(1850, 3, 31).toJulianDay());
+        QCOMPARE(q.value(7).toInt(), 10 * 60 + 30);
+        QVERIFY(q.next());
+        QVERIFY(q.value(0).isNull());
+        QVERIFY(q.value(4).isNull());
+
+        // After 1850 starts the next year, and has no end.
+        QVERIFY(q.exec(
+            u"SELECT start_date_modifier, start_date_first_day, start_date_last_day, end_date_type FROM locations"_s
+        ));
+        QVERIFY(q.next());
+        QCOMPARE(q.value(0).toInt(), 2);
+        QCOMPARE(q.value(1).toLongLong(), QDate(1851, 1, 1).toJulianDay());
+        QCOMPARE(q.value(2).toLongLong(), std::numeric_limits<qint64>::max());
+        QVERIFY(q.value(3).isNull());
+        QCOMPARE(userVersion(db), LATEST_VERSION);
+    }
+
+    void testMigration14MatchesStoredDates() {
+        auto db = setupVersion2Database();
+        QSqlQuery(db).exec(u"INSERT INTO event_types VALUES (1, 'Birth', true)"_s);
+
+        // Random dates as the editors wrote them, and legacy JSON that was written by hand or is damaged.
+        QStringList json = {
+            u"{}"_s,
+            u"{\"userText\":\"Easter\"}"_s,
+            u"{\"userText\":5,\"proleptic\":2452095}"_s,
+            u"{\"proleptic\":2452095.0,\"year\":true}"_s,
+            u"{\"proleptic\":2452095.5,\"year\":true}"_s,
+            u"{\"proleptic\":\"2452095\",\"year\":1,\"dateType\":2,\"time\":1200}"_s,
+            u"{\"proleptic\":true,\"year\":true,\"day\":true,\"dateModifier\":\"AFTER\"}"_s,
+            u"{\"proleptic\":9999999999999,\"year\":true}"_s,
+            u"{\"proleptic\":1000,\"year\":true,\"month\":true,\"dateModifier\":\"BEFORE\"}"_s,
+            u"{\"proleptic\":-500000,\"year\":true,\"month\":true}"_s,
+            u"{\"proleptic\":2452095,\"year\":true,\"day\":true,\"time\":\"24:00\"}"_s,
+            u"{\"dateType\":\"SPAN\",\"endProleptic\":2452500,\"endYear\":true,\"endMonth\":true}"_s,
+        };
+        QRandomGenerator random(14);
+        for (int i = 0; i < 3000; ++i) {
+            json.append(randomDate(random, true).toDatabaseRepresentation());
+        }
+
+        QVERIFY(db.transaction());
+        QSqlQuery insertEvent(db);
+        QVERIFY(insertEvent.prepare(u"INSERT INTO events (id, type_id, date) VALUES (:id, 1, :date)"_s));
+        QSqlQuery insertLocation(db);
+        QVERIFY(insertLocation.prepare(
+            u"INSERT INTO locations (id, name, date_start, date_end) VALUES (:id, 'Place', :start, :end)"_s
+        ));
+        for (int i = 0; i < json.size(); ++i) {
+            insertEvent.bindValue(u":id"_s, i + 1);
+            insertEvent.bindValue(u":date"_s, json[i]);
+            QVERIFY(insertEvent.exec());
+            insertLocation.bindValue(u":id"_s, i + 1);
+            insertLocation.bindValue(u":start"_s, json[i]);
+            insertLocation.bindValue(u":end"_s, json[json.size() - i - 1]);
+            QVERIFY(insertLocation.exec());
+        }
+        QVERIFY(db.commit());
+
+        runMigrations(db);
+        QCOMPARE(userVersion(db), LATEST_VERSION);
+
+        // Every column matches the date decoded from the same JSON in C++.
+        const auto expected = [&json](qsizetype i) {
+            return GenealogicalDate::fromDatabaseRepresentation(json[i]).toStored();
+        };
+        QSqlQuery q(db);
+        QVERIFY(q.exec(u"SELECT "_s + DateColumns<u"date">::select(u"events") + u" FROM events ORDER BY id"_s));
+        for (qsizetype i = 0; i < json.size(); ++i) {
+            QVERIFY(q.next());
+            QVERIFY2(storedDate(q, 0) == expected(i), qPrintable(json[i]));
+        }
+        QVERIFY(q.exec(
+            u"SELECT "_s + DateColumns<u"start_date">::select(u"locations") + u", "_s +
+            DateColumns<u"end_date">::select(u"locations") + u" FROM locations ORDER BY id"_s
+        ));
+        for (qsizetype i = 0; i < json.size(); ++i) {
+            QVERIFY(q.next());
+            QVERIFY2(storedDate(q, 0) == expected(i), qPrintable(json[i]));
+            QVERIFY2(storedDate(q, 10) == expected(json.size() - i - 1), qPrintable(json[json.size() - i - 1]));
+        }
+    }
+
+    void testFreshDatabaseHasParentLinks() {
+        openDatabase(u":memory:"_s, true);
+        auto db = QSqlDatabase::database();
+
+        // The parents of the first person in the sample data.
+        QSqlQuery q(db);
+        QVERIFY(q.exec(u"SELECT parent_id FROM parent_links WHERE child_id = 1 ORDER BY parent_id"_s));
+        QVERIFY(q.next());
+        QCOMPARE(q.value(0).toInt(), 3);
+        QVERIFY(q.next());
+        QCOMPARE(q.value(0).toInt(), 4);
+        QVERIFY(!q.next());
+    }
 };
 
 QTEST_MAIN(TestDatabaseMigrations)
@@ -12,6 +12,7 @@
 #include "database/database.h"
 #include "database/schema.h"
 
+#include <QMap>
 #include <QSqlDatabase>
 #include <QSqlQuery>
 #include <QTest>
@@ -160,7 +161,7 @@ private Q_SLOTS:
         QVERIFY(result.has_value());
         QCOMPARE(result->id, *id);
         QCOMPARE(result->typeId, typeId);
-        QVERIFY(result->date.isEmpty());
+        QVERIFY(result->date.isNull());
         QVERIFY(result->name.isEmpty());
         QVERIFY(result->note.isEmpty());
     }
@@ -171,16 +172,101 @@ private Q_SLOTS:
         auto id = repo.insertEvent(typeId);
         QVERIFY(id.has_value());
 
-        bool ok = repo.updateEvent(*id, typeId, u"1900-01-01"_s, u"Test event"_s, u"A note"_s);
+        const auto date = GenealogicalDate::fromDisplayText(u"1900-01-01"_s);
+        bool ok = repo.updateEvent(*id, typeId, date, u"Test event"_s, u"A note"_s);
         QVERIFY(ok);
 
         auto result = repo.findEventById(*id);
         QVERIFY(result.has_value());
-        QCOMPARE(result->date, u"1900-01-01"_s);
+        QCOMPARE(result->date, date);
         QCOMPARE(result->name, u"Test event"_s);
         QCOMPARE(result->note, u"A note"_s);
     }
 
+    void testDatesAreStoredInColumns() {
+        auto typeId = insertEventType();
+        EventRepository repo;
+        auto id = repo.insertEvent(typeId);
+        QVERIFY(id.has_value());
+
+        auto date = GenealogicalDate::fromDisplayText(u"about 1850-03"_s);
+        date.setStartTime(QTime(10, 30));
+        QVERIFY(repo.updateEvent(*id, typeId, date, {}, {}));
+
+        QSqlQuery query;
+        query.prepare(
+            u"SELECT date_type, date_modifier, date_precision, date_first_day, date_last_day, date_time "
+            u"FROM events WHERE id = :id"_s
+        );
+        query.bindValue(u":id"_s, *id);
+        QVERIFY(query.exec() && query.next());
+        QCOMPARE(query.value(0).toInt(), GenealogicalDate::SINGLE);
+        QCOMPARE(query.value(1).toInt(), GenealogicalDate::ABOUT);
+        QCOMPARE(
+            query.value(2).toInt(),
+            GenealogicalDate::Stored::START_YEAR | GenealogicalDate::Stored::START_MONTH
+        );
+        QCOMPARE(query.value(3).toLongLong(), QDate(1850, 3, 1).toJulianDay());
+        QCOMPARE(query.value(4).toLongLong(), QDate(1850, 3, 31).toJulianDay());
+        QCOMPARE(query.value(5).toInt(), 10 * 60 + 30);
+
+        QCOMPARE(repo.findEventById(*id)->date, date);
+
+        // Clearing the date clears all columns.
+        QVERIFY(repo.updateEvent(*id, typeId, {}, {}, {}));
+        QVERIFY(query.exec() && query.next());
+        QVERIFY(query.value(0).isNull());
+        QVERIFY(query.value(3).isNull());
+        QVERIFY(repo.findEventById(*id)->date.isNull());
+    }
+
+    void testFindEventsOverlapping() {
+        auto typeId = insertEventType();
+        EventRepository repo;
+        QMap<QString, IntegerPrimaryKey> events;
+        for (const auto& text: {
+                 u"1750"_s,
+                 u"1790-05-04"_s,
+                 u"about 1820"_s,
+                 u"before 1780"_s,
+                 u"before 1781"_s,
+                 u"after 1819"_s,
+                 u"after 1820"_s,
+                 u"between 1700 and 1780"_s,
+                 u"from 1821 to 1830"_s,
+             }) {
+            const auto id = repo.insertEvent(typeId);
+            QVERIFY(id.has_value());
+            QVERIFY(repo.updateEvent(*id, typeId, GenealogicalDate::fromDisplayText(text), text, {}));
+            events.insert(text, *id);
+        }
+        // Without a calendar date, an event never overlaps.
+        const auto textOnly = repo.insertEvent(typeId);
+        QVERIFY(repo.updateEvent(
+            *textOnly,
+            typeId,
+            GenealogicalDate(GenealogicalDate::NONE, GenealogicalDate::EXACT, {}, false, false, false, u"Easter"_s),
+            {},
+            {}
+        ));
+
+        QStringList found;
+        for (const auto& event: repo.findEventsOverlapping(GenealogicalDate::fromDisplayText(u"from 1780 to 1820"_s))) {
+            found.append(event.name);
+        }
+        found.sort();
+
+        QStringList expected{
+            u"1790-05-04"_s,
+            u"about 1820"_s,
+            u"after 1819"_s,
+            u"before 1781"_s,
+            u"between 1700 and 1780"_s,
+        };
+        expected.sort();
+        QCOMPARE(found, expected);
+    }
+
     void testDeleteEvent() {
         auto typeId = insertEventType();
         EventRepository repo;
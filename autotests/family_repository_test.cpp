@@ -103,6 +103,40 @@ class TestFamilyRepository : public QObject {
         return {fatherId, motherId, childId};
     }
 
+    // Add a birth of the child with only a father.
+    void addBirth(IntegerPrimaryKey childId, IntegerPrimaryKey fatherId) {
+        QSqlQuery query;
+        auto birthTypeId = selectQuery(u"SELECT id FROM event_types WHERE type = 'Birth'"_s);
+        auto primaryRoleId = selectQuery(u"SELECT id FROM event_roles WHERE role = 'Primary'"_s);
+        auto fatherRoleId = selectQuery(u"SELECT id FROM event_roles WHERE role = 'Father'"_s);
+
+        auto birthEvent = insertQuery(u"INSERT INTO events (type_id) VALUES (%1)"_s.arg(birthTypeId));
+        VERIFY_OR_THROW2(
+            query.exec(u"INSERT INTO event_relations (event_id, person_id, role_id) VALUES (%1, %2, %3)"_s
+                           .arg(birthEvent)
+                           .arg(childId)
+                           .arg(primaryRoleId)),
+            query
+        );
+        VERIFY_OR_THROW2(
+            query.exec(u"INSERT INTO event_relations (event_id, person_id, role_id) VALUES (%1, %2, %3)"_s
+                           .arg(birthEvent)
+                           .arg(fatherId)
+                           .arg(fatherRoleId)),
+            query
+        );
+    }
+
+    // A line of fathers, starting with the child.
+    QList<IntegerPrimaryKey> addLine(int generations) {
+        QList<IntegerPrimaryKey> line{addPerson(u"Child"_s, u"Line"_s, u"Male"_s)};
+        for (int generation = 1; generation < generations; ++generation) {
+            line.append(addPerson(u"Father"_s, u"Line"_s, u"Male"_s));
+            addBirth(line[generation - 1], line[generation]);
+        }
+        return line;
+    }
+
 private Q_SLOTS:
     void init() {
         QVERIFY(QSqlDatabase::isDriverAvailable(u"QSQLITE"_s));
@@ -185,6 +219,68 @@ private Q_SLOTS:
         QCOMPARE(*ancestors.first().motherId, motherId);
     }
 
+    void testFindAncestorsForPersonHasLevels() {
+        const auto line = addLine(40);
+
+        FamilyRepository repo;
+        auto ancestors = repo.findAncestorsForPerson(line.first());
+
+        QCOMPARE(ancestors.size(), 40);
+        for (int generation = 0; generation < 40; ++generation) {
+            QCOMPARE(ancestors[generation].childId, line[generation]);
+            QCOMPARE(ancestors[generation].level, generation + 1);
+        }
+    }
+
+    void testFindAncestorsForPersonLimitsGenerations() {
+        const auto line = addLine(10);
+
+        FamilyRepository repo;
+        auto ancestors = repo.findAncestorsForPerson(line.first(), 3);
+
+        QCOMPARE(ancestors.size(), 3);
+        QCOMPARE(ancestors.last().childId, line[2]);
+        // The father of the last generation is known, but not loaded.
+        QCOMPARE(*ancestors.last().fatherId, line[3]);
+    }
+
+    void testFindAncestorsForPersonLoadsMoreForExpanded() {
+        const auto line = addLine(10);
+
+        FamilyRepository repo;
+        auto ancestors = repo.findAncestorsForPerson(line.first(), 3, {line[2]});
+
+        QCOMPARE(ancestors.size(), 6);
+        QCOMPARE(ancestors.last().childId, line[5]);
+        QCOMPARE(ancestors.last().level, 6);
+    }
+
+    void testFindAncestorsForPersonStopsAtCycle() {
+        auto first = addPerson(u"First"_s, u"Cycle"_s, u"Male"_s);
+        auto second = addPerson(u"Second"_s, u"Cycle"_s, u"Male"_s);
+        addBirth(first, second);
+        addBirth(second, first);
+
+        FamilyRepository repo;
+        auto ancestors = repo.findAncestorsForPerson(first);
+
+        QCOMPARE(ancestors.size(), 2);
+        QCOMPARE(ancestors.last().childId, second);
+        QCOMPARE(*ancestors.last().fatherId, first);
+    }
+
+    void testFindAncestorsOfSkipsKnownPeople() {
+        const auto line = addLine(10);
+
+        FamilyRepository repo;
+        auto ancestors = repo.findAncestorsOf({line[3]}, 4, 2, {line[0], line[1], line[2], line[4]});
+
+        // The father of the first generation is already known.
+        QCOMPARE(ancestors.size(), 1);
+        QCOMPARE(ancestors.first().childId, line[3]);
+        QCOMPARE(ancestors.first().level, 4);
+    }
+
     void testFindParentsForPersonReturnsBothParents() {
         auto [fatherId, motherId, childId] = addParentAndChild();
 
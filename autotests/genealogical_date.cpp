@@ -4,13 +4,36 @@
  * SPDX-License-Identifier: GPL-3.0-or-later
  */
 // ReSharper disable CppMemberFunctionMayBeConst
+#include "dates/date_columns.h"
 #include "dates/genealogical_date.h"
+#include "random_dates.h"
 
+#include <QRandomGenerator>
 #include <QSqlDatabase>
+#include <QSqlQuery>
 #include <QTest>
 
 using namespace Qt::Literals::StringLiterals;
 
+namespace {
+constexpr int BENCHMARK_DATES = 1'000'000;
+
+// A statement with the placeholders of the date columns, which does not need a table.
+QString bindColumnsSql() {
+    const auto columns = DateColumns<u"date">::select(u"t").remove(u"t."_s).split(u", "_s);
+    return u"SELECT :"_s + columns.join(u", :"_s);
+}
+
+QList<GenealogicalDate> randomDates(int count) {
+    QRandomGenerator random(42);
+    QList<GenealogicalDate> result;
+    for (int i = 0; i < count; ++i) {
+        result.append(randomDate(random));
+    }
+    return result;
+}
+}
+
 class TestOpaDate : public QObject {
     Q_OBJECT
 
@@ -240,6 +263,164 @@ private Q_SLOTS:
         QVERIFY(!decoded.startPoint().hasTime);
         QVERIFY(!decoded.startPoint().wallTime.isValid());
     }
+
+    void testStoredYearOnlyLastsTheYear() {
+        const auto d = GenealogicalDate::fromDisplayText(u"1850"_s);
+        const auto stored = d.toStored();
+        QVERIFY(stored.has_value());
+        QCOMPARE(stored->precision, GenealogicalDate::Stored::START_YEAR);
+        QCOMPARE(stored->sortDay, QDate(1850, 1, 1).toJulianDay());
+        QCOMPARE(stored->firstDay, QDate(1850, 1, 1).toJulianDay());
+        QCOMPARE(stored->lastDay, QDate(1850, 12, 31).toJulianDay());
+        QCOMPARE(GenealogicalDate::fromStored(*stored), d);
+    }
+
+    void testStoredBeforeAndAfterAreOpen() {
+        const auto before = GenealogicalDate::fromDisplayText(u"before 1850-03"_s).toStored();
+        QCOMPARE(before->firstDay, GenealogicalDate::Stored::OPEN_START);
+        QCOMPARE(before->lastDay, QDate(1850, 2, 28).toJulianDay());
+
+        const auto after = GenealogicalDate::fromDisplayText(u"after 1850-03"_s).toStored();
+        QCOMPARE(after->firstDay, QDate(1850, 4, 1).toJulianDay());
+        QCOMPARE(after->lastDay, GenealogicalDate::Stored::OPEN_END);
+        QCOMPARE(GenealogicalDate::fromStored(*after), GenealogicalDate::fromDisplayText(u"after 1850-03"_s));
+    }
+
+    void testStoredRangeRoundtrip() {
+        auto d = GenealogicalDate::fromDisplayText(u"from 1850-03 to 1860-02-14"_s);
+        d.setEndTime(QTime(18, 5));
+        const auto stored = d.toStored();
+        QCOMPARE(stored->firstDay, QDate(1850, 3, 1).toJulianDay());
+        QCOMPARE(stored->lastDay, QDate(1860, 2, 14).toJulianDay());
+        QCOMPARE(stored->endTime, 18 * 60 + 5);
+        QVERIFY(!stored->startTime.has_value());
+        QCOMPARE(GenealogicalDate::fromStored(*stored), d);
+
+        const auto range = GenealogicalDate::fromDisplayText(u"between 1850 and 1860-02"_s);
+        QCOMPARE(range.toStored()->lastDay, QDate(1860, 2, 29).toJulianDay());
+        QCOMPARE(GenealogicalDate::fromStored(*range.toStored()), range);
+    }
+
+    void testStoredTextOnlyHasNoDays() {
+        const GenealogicalDate d(GenealogicalDate::NONE, GenealogicalDate::EXACT, {}, false, false, false, u"Easter"_s);
+        const auto stored = d.toStored();
+        QVERIFY(stored.has_value());
+        QVERIFY(!stored->sortDay.has_value());
+        QVERIFY(!stored->firstDay.has_value());
+        QCOMPARE(stored->text, u"Easter"_s);
+        QCOMPARE(GenealogicalDate::fromStored(*stored), d);
+    }
+
+    void testStoredNullIsEmpty() {
+        QVERIFY(!GenealogicalDate().toStored().has_value());
+    }
+
+    void testStoredRoundtripsRandomDates() {
+        QRandomGenerator random(7);
+        for (int i = 0; i < 1000; ++i) {
+            const auto date = randomDate(random);
+            const auto stored = date.toStored();
+            QVERIFY(stored.has_value());
+            QCOMPARE(GenealogicalDate::fromStored(*stored), date);
+        }
+    }
+
+    void testBindsColumnsOfNullDate() {
+        QVariantMap bindings;
+        DateColumns<u"date">::bind(bindings, GenealogicalDate());
+        QCOMPARE(bindings.size(), 10);
+        QVERIFY(bindings[u":date_type"_s].isNull());
+        QVERIFY(bindings[u":date_text"_s].isNull());
+    }
+
+    void testBindsColumnsToQuery() {
+        {
+            auto database = QSqlDatabase::addDatabase(u"QSQLITE"_s, u"bind"_s);
+            database.setDatabaseName(u":memory:"_s);
+            QVERIFY(database.open());
+            QSqlQuery query(database);
+            QVERIFY(query.prepare(bindColumnsSql()));
+
+            DateColumns<u"date">::bind(query, date);
+            const auto stored = date.toStored();
+            QCOMPARE(query.boundValue(u":date_type"_s).toInt(), static_cast<int>(stored->type));
+            QCOMPARE(query.boundValue(u":date_first_day"_s).toLongLong(), *stored->firstDay);
+            QVERIFY(query.boundValue(u":date_time"_s).isNull());
+
+            DateColumns<u"date">::bind(query, GenealogicalDate());
+            QVERIFY(query.boundValue(u":date_type"_s).isNull());
+            QVERIFY(query.boundValue(u":date_text"_s).isNull());
+        }
+        QSqlDatabase::removeDatabase(u"bind"_s);
+    }
+
+    // The JSON format, which dates were stored in before the columns, as the baseline for the columns.
+    void benchmarkToDatabaseRepresentation() {
+        const auto dates = randomDates(1000);
+        qsizetype checksum = 0;
+        QBENCHMARK {
+            for (int i = 0; i < BENCHMARK_DATES; ++i) {
+                checksum += dates[i % dates.size()].toDatabaseRepresentation().size();
+            }
+        }
+        QVERIFY(checksum != 0);
+    }
+
+    void benchmarkFromDatabaseRepresentation() {
+        QStringList json;
+        for (const auto& date: randomDates(1000)) {
+            json.append(date.toDatabaseRepresentation());
+        }
+        qint64 checksum = 0;
+        QBENCHMARK {
+            for (int i = 0; i < BENCHMARK_DATES; ++i) {
+                checksum += GenealogicalDate::fromDatabaseRepresentation(json[i % json.size()]).sortKey();
+            }
+        }
+        QVERIFY(checksum != 0);
+    }
+
+    void benchmarkToStored() {
+        const auto dates = randomDates(1000);
+        qint64 checksum = 0;
+        QBENCHMARK {
+            for (int i = 0; i < BENCHMARK_DATES; ++i) {
+                checksum += dates[i % dates.size()].toStored()->precision;
+            }
+        }
+        QVERIFY(checksum != 0);
+    }
+
+    void benchmarkFromStored() {
+        QList<GenealogicalDate::Stored> stored;
+        for (const auto& date: randomDates(1000)) {
+            stored.append(*date.toStored());
+        }
+        qint64 checksum = 0;
+        QBENCHMARK {
+            for (int i = 0; i < BENCHMARK_DATES; ++i) {
+                checksum += GenealogicalDate::fromStored(stored[i % stored.size()]).sortKey();
+            }
+        }
+        QVERIFY(checksum != 0);
+    }
+
+    void benchmarkBindColumns() {
+        const auto dates = randomDates(1000);
+        {
+            auto database = QSqlDatabase::addDatabase(u"QSQLITE"_s, u"bind"_s);
+            database.setDatabaseName(u":memory:"_s);
+            QVERIFY(database.open());
+            QSqlQuery query(database);
+            QVERIFY(query.prepare(bindColumnsSql()));
+            QBENCHMARK {
+                for (int i = 0; i < BENCHMARK_DATES; ++i) {
+                    DateColumns<u"date">::bind(query, dates[i % dates.size()]);
+                }
+            }
+        }
+        QSqlDatabase::removeDatabase(u"bind"_s);
+    }
 };
 
 QTEST_MAIN(TestOpaDate)
@@ -0,0 +1,338 @@
+/*
+ * SPDX-FileCopyrightText: Niko Strijbol <niko@strijbol.be>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+// ReSharper disable CppMemberFunctionMayBeStatic
+// ReSharper disable CppMemberFunctionMayBeConst
+#include "../src/import/gramps_xml.h"
+
+#include "./test_utils.h"
+#include "database/database.h"
+#include "dates/genealogical_date.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFuture>
+#include <QRegularExpression>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QTest>
+#include <algorithm>
+
+using namespace Qt::Literals::StringLiterals;
+
+namespace {
+// How many times the example file is repeated for the benchmark.
+constexpr int BENCHMARK_COPIES = 10;
+
+// Wraps body in a minimal valid Gramps XML document.
+// URL is built at runtime to avoid moc misreading "//" in raw string literals.
+QString grampsXml(const QString& body = {}) {
+    const auto ns = u"http://gramps-project.org/xml/1.7.2/"_s;
+    return u"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+           "<database xmlns=\""_s +
+           ns +
+           u"\">\n"
+           "  <header>\n"
+           "    <created date=\"2024-01-01\" version=\"5.1.3\"/>\n"
+           "    <researcher/>\n"
+           "  </header>\n"_s +
+           body + u"</database>\n"_s;
+}
+
+// A family with two children, with references to records that come before and after them.
+const auto FAMILY =
+    u"  <events>\n"
+    "    <event handle=\"e1\" change=\"0\" id=\"E0001\"><type>Birth</type><dateval val=\"1900-05-12\" type=\"about\"/>"
+    "<place hlink=\"pl1\"/><citationref hlink=\"c1\"/></event>\n"
+    "    <event handle=\"e2\" change=\"0\" id=\"E0002\"><type>Marriage</type>"
+    "<daterange start=\"1890\" stop=\"1895-06\" quality=\"estimated\"/><description>Wedding</description></event>\n"
+    "    <event handle=\"e3\" change=\"0\" id=\"E0003\"><type>Occupation</type>"
+    "<datestr val=\"in his youth\"/></event>\n"
+    "  </events>\n"
+    "  <people>\n"
+    "    <person handle=\"p1\" change=\"0\" id=\"I0001\"><gender>M</gender><name type=\"Birth Name\"><first>Jan</first>"
+    "<surname prefix=\"van\" derivation=\"Inherited\">Damme</surname></name><eventref hlink=\"e3\" role=\"Primary\"/>"
+    "<parentin hlink=\"f1\"/><noteref hlink=\"n1\"/></person>\n"
+    "    <person handle=\"p2\" change=\"0\" id=\"I0002\"><gender>F</gender><name type=\"Birth Name\">"
+    "<first>Marie</first><surname>Peeters</surname></name><parentin hlink=\"f1\"/></person>\n"
+    "    <person handle=\"p3\" change=\"0\" id=\"I0003\"><gender>F</gender><name type=\"Birth Name\">"
+    "<first>Anna</first><surname>Damme</surname></name><eventref hlink=\"e1\" role=\"Primary\"/>"
+    "<childof hlink=\"f1\"/></person>\n"
+    "    <person handle=\"p4\" change=\"0\" id=\"I0004\"><gender>U</gender><childof hlink=\"f1\"/></person>\n"
+    "  </people>\n"
+    "  <families>\n"
+    "    <family handle=\"f1\" change=\"0\" id=\"F0001\"><rel type=\"Married\"/><father hlink=\"p1\"/>"
+    "<mother hlink=\"p2\"/><eventref hlink=\"e2\" role=\"Family\"/><childref hlink=\"p3\"/>"
+    "<childref hlink=\"p4\" frel=\"Adopted\" mrel=\"Adopted\"/></family>\n"
+    "  </families>\n"
+    "  <citations>\n"
+    "    <citation handle=\"c1\" change=\"0\" id=\"C0001\"><page>Folio 12</page><confidence>3</confidence>"
+    "<sourceref hlink=\"s1\"/></citation>\n"
+    "  </citations>\n"
+    "  <sources>\n"
+    "    <source handle=\"s1\" change=\"0\" id=\"S0001\"><stitle>Parish register</stitle>"
+    "<sauthor>Parish of Gent</sauthor><reporef hlink=\"r1\" medium=\"Book\"/></source>\n"
+    "  </sources>\n"
+    "  <places>\n"
+    "    <placeobj handle=\"pl1\" change=\"0\" id=\"P0001\" type=\"City\"><pname value=\"Gent\"/>"
+    "<coord long=\"3.7174\" lat=\"51.0543\"/><placeref hlink=\"pl2\"/></placeobj>\n"
+    "    <placeobj handle=\"pl2\" change=\"0\" id=\"P0002\" type=\"Country\"><pname value=\"België\"/></placeobj>\n"
+    "  </places>\n"
+    "  <repositories>\n"
+    "    <repository handle=\"r1\" change=\"0\" id=\"R0001\"><rname>State archives</rname><type>Archive</type>"
+    "</repository>\n"
+    "  </repositories>\n"
+    "  <notes>\n"
+    "    <note handle=\"n1\" change=\"0\" id=\"N0001\" type=\"Person Note\"><text>Was a baker.</text></note>\n"
+    "  </notes>\n"_s;
+
+/**
+ * Repeat the records of a Gramps file, giving every copy its own handles and ids.
+ */
+QString scaleGrampsXml(QString xml, int copies) {
+    static const QRegularExpression reference(uR"(\b(handle|hlink|id)="([^"]*)")"_s);
+    for (const auto& section: {u"tags", u"events", u"people", u"families", u"citations", u"sources", u"places",
+                               u"objects", u"repositories", u"notes"}) {
+        const auto opening = xml.indexOf(u"<"_s + section);
+        const auto start = xml.indexOf(u'\n', opening) + 1;
+        const auto end = xml.indexOf(u"  </"_s + section + u'>');
+        if (opening < 0 || end < 0) {
+            continue;
+        }
+        const auto records = xml.sliced(start, end - start);
+        QString extra;
+        for (int copy = 1; copy < copies; ++copy) {
+            extra += QString(records).replace(reference, u"\\1=\"\\2_%1\""_s.arg(copy));
+        }
+        xml.insert(end, extra);
+    }
+    return xml;
+}
+
+GrampsXmlAnalysis validate(const QString& filename) {
+    QPromise<GrampsXmlAnalysis> promise;
+    promise.start();
+    validateGrampsXml(promise, filename);
+    promise.finish();
+    return promise.future().takeResult();
+}
+
+bool importFile(const GrampsXmlAnalysis& analysis) {
+    QPromise<bool> promise;
+    promise.start();
+    importGrampsResult(promise, analysis);
+    promise.finish();
+    const auto future = promise.future();
+    return future.resultCount() == 1 && future.result();
+}
+
+QVariant valueOf(const QString& sql) {
+    QSqlQuery query;
+    VERIFY_OR_THROW2(query.exec(sql), query);
+    VERIFY_OR_THROW2(query.next(), query);
+    return query.value(0);
+}
+
+// The database id of a record by its Gramps id.
+IntegerPrimaryKey idOf(const QString& table, const QString& grampsId) {
+    return valueOf(u"SELECT %1_id FROM %1_external_ids WHERE external_id = '%2'"_s.arg(table, grampsId))
+        .toLongLong();
+}
+}
+
+class TestGrampsImport : public QObject {
+    Q_OBJECT
+
+    QTemporaryDir directory;
+
+    // The import uses its own connection, so the database must be a file.
+    void writeAndImport(const QString& xml) {
+        const auto path = directory.filePath(u"import.gramps"_s);
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        file.write(xml.toUtf8());
+        file.close();
+
+        const auto analysis = validate(path);
+        QVERIFY2(analysis.valid, qPrintable(analysis.error));
+        QVERIFY(importFile(analysis));
+    }
+
+private Q_SLOTS:
+    void init() {
+        QVERIFY(directory.isValid());
+        QFile::remove(directory.filePath(u"opa.db"_s));
+        openDatabase(directory.filePath(u"opa.db"_s), false);
+    }
+
+    void cleanup() {
+        closeDatabase();
+    }
+
+    void testImportsFamily() {
+        writeAndImport(grampsXml(FAMILY));
+
+        QCOMPARE(valueOf(u"SELECT count(*) FROM people"_s).toInt(), 4);
+        QCOMPARE(valueOf(u"SELECT count(*) FROM person_external_ids WHERE type = 'gramps_id'"_s).toInt(), 4);
+        const auto jan = idOf(u"person"_s, u"I0001"_s);
+        const auto marie = idOf(u"person"_s, u"I0002"_s);
+        const auto anna = idOf(u"person"_s, u"I0003"_s);
+        const auto adopted = idOf(u"person"_s, u"I0004"_s);
+        QCOMPARE(valueOf(u"SELECT sex FROM people WHERE id = %1"_s.arg(jan)).toString(), u"Male"_s);
+
+        QSqlQuery name;
+        QVERIFY(name.exec(
+            u"SELECT given_names, prefix, surname, no.origin, names.note FROM names "
+            "JOIN name_origins no ON no.id = names.origin_id WHERE person_id = %1"_s.arg(jan)
+        ));
+        QVERIFY(name.next());
+        QCOMPARE(name.value(0).toString(), u"Jan"_s);
+        QCOMPARE(name.value(1).toString(), u"van"_s);
+        QCOMPARE(name.value(2).toString(), u"Damme"_s);
+        QCOMPARE(name.value(3).toString(), u"Inherited"_s);
+        QCOMPARE(name.value(4).toString(), u"Was a baker."_s);
+
+        // The places come after the events, so these links are made at the end.
+        const auto gent = idOf(u"location"_s, u"P0001"_s);
+        QCOMPARE(
+            valueOf(u"SELECT parent_id FROM locations WHERE id = %1"_s.arg(gent)).toLongLong(),
+            idOf(u"location"_s, u"P0002"_s)
+        );
+        const auto birth = idOf(u"event"_s, u"E0001"_s);
+        QCOMPARE(valueOf(u"SELECT location_id FROM events WHERE id = %1"_s.arg(birth)).toLongLong(), gent);
+        QCOMPARE(
+            valueOf(u"SELECT date_modifier FROM events WHERE id = %1"_s.arg(birth)).toInt(),
+            static_cast<int>(GenealogicalDate::ABOUT)
+        );
+        const auto occupation = idOf(u"event"_s, u"E0003"_s);
+        QCOMPARE(
+            valueOf(u"SELECT date_text FROM events WHERE id = %1"_s.arg(occupation)).toString(),
+            u"in his youth"_s
+        );
+
+        // The partners of the family are in its marriage.
+        const auto marriage = idOf(u"event"_s, u"E0002"_s);
+        const auto family = idOf(u"family"_s, u"F0001"_s);
+        QCOMPARE(valueOf(u"SELECT family_id FROM events WHERE id = %1"_s.arg(marriage)).toLongLong(), family);
+        QCOMPARE(valueOf(u"SELECT name FROM events WHERE id = %1"_s.arg(marriage)).toString(), u"Wedding"_s);
+        QCOMPARE(
+            valueOf(u"SELECT group_concat(r.role || ':' || er.person_id) FROM "
+                    "(SELECT * FROM event_relations ORDER BY person_id) er "
+                    "JOIN event_roles r ON r.id = er.role_id WHERE er.event_id = %1"_s.arg(marriage))
+                .toString(),
+            u"Primary:%1,Partner:%2"_s.arg(jan).arg(marie)
+        );
+
+        // The parents are on the birth of each child, which is added if there is none.
+        const auto parentsOf = [](IntegerPrimaryKey child) {
+            return valueOf(u"SELECT group_concat(r.role || ':' || pl.parent_id) FROM "
+                           "(SELECT * FROM parent_links ORDER BY parent_id) pl "
+                           "JOIN event_roles r ON r.id = pl.role_id WHERE pl.child_id = %1"_s.arg(child))
+                .toString();
+        };
+        QCOMPARE(parentsOf(anna), u"Father:%1,Mother:%2"_s.arg(jan).arg(marie));
+        QCOMPARE(parentsOf(adopted), u"AdoptiveParent:%1,AdoptiveParent:%2"_s.arg(jan).arg(marie));
+
+        // A citation is a source within its source, which is within its repository.
+        const auto citation = idOf(u"source"_s, u"C0001"_s);
+        QCOMPARE(
+            valueOf(u"SELECT source_id FROM event_citations WHERE event_id = %1"_s.arg(birth)).toLongLong(),
+            citation
+        );
+        QCOMPARE(valueOf(u"SELECT title FROM sources WHERE id = %1"_s.arg(citation)).toString(), u"Folio 12"_s);
+        QCOMPARE(valueOf(u"SELECT confidence FROM sources WHERE id = %1"_s.arg(citation)).toString(), u"High"_s);
+        const auto source = idOf(u"source"_s, u"S0001"_s);
+        QCOMPARE(valueOf(u"SELECT parent_id FROM sources WHERE id = %1"_s.arg(citation)).toLongLong(), source);
+        QCOMPARE(
+            valueOf(u"SELECT parent_id FROM sources WHERE id = %1"_s.arg(source)).toLongLong(),
+            idOf(u"source"_s, u"R0001"_s)
+        );
+    }
+
+    void testImportsRealFile() {
+        const QString path = QFINDTESTDATA("example-1.7.2.gramps");
+        QVERIFY2(!path.isEmpty(), "Could not find example-1.7.2.gramps");
+
+        const auto analysis = validate(path);
+        QVERIFY(analysis.valid);
+        QVERIFY(importFile(analysis));
+
+        QCOMPARE(valueOf(u"SELECT count(*) FROM people"_s).toInt(), 2157);
+        QCOMPARE(valueOf(u"SELECT count(*) FROM families"_s).toInt(), 762);
+        QCOMPARE(valueOf(u"SELECT count(*) FROM locations"_s).toInt(), 1296);
+        QCOMPARE(valueOf(u"SELECT count(*) FROM media"_s).toInt(), 7);
+        // The citations, sources and repositories are all sources.
+        QCOMPARE(valueOf(u"SELECT count(*) FROM sources"_s).toInt(), 2854 + 4 + 3);
+        QCOMPARE(valueOf(u"SELECT count(*) FROM event_external_ids"_s).toInt(), 3432);
+        QVERIFY(valueOf(u"SELECT count(*) FROM parent_links"_s).toInt() > 0);
+        QVERIFY(valueOf(u"SELECT count(*) FROM events WHERE location_id IS NOT NULL"_s).toInt() > 0);
+    }
+
+    void testFailedImportIsRemoved() {
+        QSqlQuery query;
+        QVERIFY(query.exec(u"INSERT INTO people (root, sex) VALUES (TRUE, 'F')"_s));
+        // The media come after the other records, so chunks of those were committed when it fails.
+        QVERIFY(query.exec(
+            u"CREATE TRIGGER fail_media BEFORE INSERT ON media BEGIN SELECT RAISE(ABORT, 'broken'); END"_s
+        ));
+
+        const QString path = QFINDTESTDATA("example-1.7.2.gramps");
+        QVERIFY2(!path.isEmpty(), "Could not find example-1.7.2.gramps");
+        const auto analysis = validate(path);
+        QVERIFY(analysis.valid);
+
+        QPromise<bool> promise;
+        promise.start();
+        importGrampsResult(promise, analysis);
+        promise.finish();
+        bool failed = false;
+        try {
+            promise.future().waitForFinished();
+        } catch (const GrampsImportException&) {
+            failed = true;
+        }
+        QVERIFY(failed);
+
+        // Only the person from before the import is left.
+        QCOMPARE(valueOf(u"SELECT count(*) FROM people"_s).toInt(), 1);
+        QCOMPARE(valueOf(u"SELECT count(*) FROM names"_s).toInt(), 0);
+        QCOMPARE(valueOf(u"SELECT count(*) FROM events"_s).toInt(), 0);
+        QCOMPARE(valueOf(u"SELECT count(*) FROM families"_s).toInt(), 0);
+        QCOMPARE(valueOf(u"SELECT count(*) FROM locations"_s).toInt(), 0);
+        QCOMPARE(valueOf(u"SELECT count(*) FROM sources"_s).toInt(), 0);
+        QCOMPARE(valueOf(u"SELECT count(*) FROM person_external_ids"_s).toInt(), 0);
+    }
+
+    void benchmarkImportThroughput() {
+        const QString example = QFINDTESTDATA("example-1.7.2.gramps");
+        QVERIFY2(!example.isEmpty(), "Could not find example-1.7.2.gramps");
+        QFile file(example);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        const auto scaled = scaleGrampsXml(QString::fromUtf8(file.readAll()), BENCHMARK_COPIES);
+
+        const auto path = directory.filePath(u"scaled.gramps"_s);
+        QFile output(path);
+        QVERIFY(output.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        output.write(scaled.toUtf8());
+        output.close();
+        const auto analysis = validate(path);
+        QVERIFY2(analysis.valid, qPrintable(analysis.error));
+
+        QElapsedTimer timer;
+        QBENCHMARK_ONCE {
+            timer.start();
+            QVERIFY(importFile(analysis));
+        }
+        const auto records = analysis.people + analysis.families + analysis.events + analysis.sources +
+                             analysis.places + analysis.media + analysis.repositories + analysis.notes +
+                             analysis.citations;
+        qInfo() << records << "records in" << timer.elapsed() << "ms:"
+                << qRound(records * 1000.0 / std::max<qint64>(timer.elapsed(), 1)) << "records/s";
+    }
+};
+
+QTEST_GUILESS_MAIN(TestGrampsImport)
+#include "gramps_import_test.moc"
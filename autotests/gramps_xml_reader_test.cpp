@@ -0,0 +1,295 @@
+/*
+ * SPDX-FileCopyrightText: Niko Strijbol <niko@strijbol.be>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+// ReSharper disable CppMemberFunctionMayBeStatic
+// ReSharper disable CppMemberFunctionMayBeConst
+#include "../src/import/gramps_xml_reader.h"
+
+#include "../src/import/import_pipeline.h"
+
+#include <QPromise>
+#include <QTemporaryFile>
+#include <QTest>
+#include <QThread>
+#include <algorithm>
+
+using namespace Qt::Literals::StringLiterals;
+
+namespace {
+QString handleOf(const GrampsRecord& record) {
+    return std::visit([](const auto& value) { return value.handle; }, record);
+}
+
+// Wraps body in a minimal valid Gramps XML document.
+// URL is built at runtime to avoid moc misreading "//" in raw string literals.
+QString grampsXml(const QString& body = {}) {
+    const auto ns = u"http://gramps-project.org/xml/1.7.2/"_s;
+    return u"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+           "<database xmlns=\""_s +
+           ns +
+           u"\">\n"
+           "  <header>\n"
+           "    <created date=\"2024-01-01\" version=\"5.1.3\"/>\n"
+           "    <researcher/>\n"
+           "  </header>\n"_s +
+           body + u"</database>\n"_s;
+}
+
+const auto BODY =
+    u"  <events>\n"
+    "    <event handle=\"ee0001\" change=\"0\" id=\"E0001\"><type>Birth</type><place hlink=\"pl0001\"/></event>\n"
+    "  </events>\n"
+    "  <people>\n"
+    "    <person handle=\"pp0001\" change=\"0\" id=\"I0001\">\n"
+    "      <gender>M</gender>\n"
+    "      <name type=\"Birth Name\"><first>Jan</first><surname>Peeters</surname></name>\n"
+    "      <eventref hlink=\"ee0001\" role=\"Primary\"/>\n"
+    "    </person>\n"
+    "  </people>\n"
+    "  <places>\n"
+    "    <placeobj handle=\"pl0001\" change=\"0\" id=\"P0001\" type=\"City\"><pname value=\"Gent\"/></placeobj>\n"
+    "  </places>\n"
+    "  <objects>\n"
+    "    <object handle=\"oo0001\" change=\"0\" id=\"O0001\">\n"
+    "      <file src=\"photo.jpg\" mime=\"image/jpeg\" description=\"Photo\"/>\n"
+    "    </object>\n"
+    "  </objects>\n"
+    "  <notes>\n"
+    "    <note handle=\"nn0001\" change=\"0\" id=\"N0001\" type=\"General\"><text>A note</text></note>\n"
+    "  </notes>\n"_s;
+
+class TemporaryGrampsFile {
+public:
+    explicit TemporaryGrampsFile(const QString& xml) {
+        if (!file.open()) {
+            qFatal("Could not create temporary file for test");
+        }
+        file.write(xml.toUtf8());
+        file.flush();
+        file.close();
+    }
+
+    [[nodiscard]] QString fileName() const {
+        return file.fileName();
+    }
+
+private:
+    QTemporaryFile file;
+};
+
+QList<GrampsRecord> readAll(GrampsXmlReader& reader) {
+    QList<GrampsRecord> records;
+    while (auto record = reader.next()) {
+        records.append(std::move(*record));
+    }
+    return records;
+}
+
+} // namespace
+
+class TestGrampsXmlReader : public QObject {
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testReadsRecordsInFileOrder() {
+        const TemporaryGrampsFile file(grampsXml(BODY));
+        GrampsXmlReader reader(file.fileName());
+
+        const auto records = readAll(reader);
+
+        QVERIFY(!reader.hasError());
+        QCOMPARE(records.size(), 5);
+
+        const auto& event = std::get<GrampsEvent>(records[0]);
+        QCOMPARE(event.id, u"E0001"_s);
+        QCOMPARE(event.type, u"Birth"_s);
+        QCOMPARE(event.placeHandle, u"pl0001"_s);
+
+        const auto& person = std::get<GrampsPerson>(records[1]);
+        QCOMPARE(person.handle, u"pp0001"_s);
+        QCOMPARE(person.sex, u"M"_s);
+        QCOMPARE(person.names.size(), 1);
+        QCOMPARE(person.names.first().givenNames, u"Jan"_s);
+        QCOMPARE(person.eventRefs.first().eventHandle, u"ee0001"_s);
+
+        QCOMPARE(std::get<GrampsPlace>(records[2]).names.first().value, u"Gent"_s);
+        QCOMPARE(std::get<GrampsMedia>(records[3]).filePath, u"photo.jpg"_s);
+        QCOMPARE(std::get<GrampsNote>(records[4]).text, u"A note"_s);
+    }
+
+    void testCountsWhileReading() {
+        const TemporaryGrampsFile file(grampsXml(BODY));
+        GrampsXmlReader reader(file.fileName());
+
+        QVERIFY(reader.next().has_value());
+        QCOMPARE(reader.counts().events, 1);
+        QCOMPARE(reader.counts().total(), 1);
+
+        Q_UNUSED(readAll(reader));
+        QCOMPARE(reader.counts().people, 1);
+        QCOMPARE(reader.counts().places, 1);
+        QCOMPARE(reader.counts().media, 1);
+        QCOMPARE(reader.counts().notes, 1);
+        QCOMPARE(reader.counts().total(), 5);
+    }
+
+    void testSkipToEndOnlyCounts() {
+        const TemporaryGrampsFile file(grampsXml(BODY));
+        GrampsXmlReader reader(file.fileName());
+
+        QVERIFY(reader.skipToEnd());
+        QCOMPARE(reader.counts().total(), 5);
+        QVERIFY(!reader.next().has_value());
+    }
+
+    void testStopsAtInvalidRecord() {
+        const auto body =
+            u"  <people>\n"
+            "    <person handle=\"pp0001\" change=\"0\"><gender>M</gender></person>\n"
+            "    <person handle=\"pp0002\" change=\"0\"><bogus/><gender>F</gender></person>\n"
+            "    <person handle=\"pp0003\" change=\"0\"><gender>F</gender></person>\n"
+            "  </people>\n"_s;
+        const TemporaryGrampsFile file(grampsXml(body));
+        GrampsXmlReader reader(file.fileName());
+
+        const auto records = readAll(reader);
+
+        // The invalid record is not returned, and neither is anything after it.
+        QCOMPARE(records.size(), 1);
+        QCOMPARE(std::get<GrampsPerson>(records.first()).handle, u"pp0001"_s);
+        QVERIFY(reader.hasError());
+        QVERIFY(reader.error().contains(u"bogus"_s));
+    }
+
+    void testReaderWithoutValidationSkipsIt() {
+        const auto body =
+            u"  <people>\n"
+            "    <person handle=\"pp0001\" change=\"0\"><bogus/><gender>F</gender></person>\n"
+            "  </people>\n"_s;
+        const TemporaryGrampsFile file(grampsXml(body));
+        GrampsXmlReader reader(file.fileName(), false);
+
+        const auto records = readAll(reader);
+
+        QVERIFY(!reader.hasError());
+        QCOMPARE(records.size(), 1);
+        QCOMPARE(std::get<GrampsPerson>(records.first()).sex, u"F"_s);
+    }
+
+    void testNonXmlFileHasError() {
+        const TemporaryGrampsFile file(u"this is not xml"_s);
+        GrampsXmlReader reader(file.fileName());
+
+        QVERIFY(!reader.next().has_value());
+        QVERIFY(reader.hasError());
+        QVERIFY(!reader.error().isEmpty());
+    }
+
+    void testNonExistentFileHasError() {
+        GrampsXmlReader reader(u"/tmp/this-file-does-not-exist-opa-test.xml"_s);
+
+        QVERIFY(!reader.skipToEnd());
+        QVERIFY(reader.hasError());
+        QVERIFY(!reader.error().isEmpty());
+    }
+
+    void testReadsRealFile() {
+        const QString path = QFINDTESTDATA("example-1.7.2.gramps");
+        QVERIFY2(!path.isEmpty(), "Could not find example-1.7.2.gramps");
+        GrampsXmlReader reader(path);
+
+        int people = 0;
+        int citations = 0;
+        while (auto record = reader.next()) {
+            people += std::holds_alternative<GrampsPerson>(*record);
+            citations += std::holds_alternative<GrampsCitation>(*record);
+        }
+
+        QVERIFY(!reader.hasError());
+        QCOMPARE(people, 2157);
+        QCOMPARE(citations, 2854);
+        QCOMPARE(reader.counts().people, 2157);
+        QCOMPARE(reader.counts().media, 7);
+        QCOMPARE(reader.counts().notes, 19);
+    }
+
+    void testTreesConvertToTheRecords() {
+        const QString path = QFINDTESTDATA("example-1.7.2.gramps");
+        QVERIFY2(!path.isEmpty(), "Could not find example-1.7.2.gramps");
+
+        // The trees outlive the reader, like when they are converted on other threads.
+        QList<GrampsXmlReader::RecordTree> trees;
+        {
+            GrampsXmlReader reader(path, false);
+            while (auto tree = reader.nextTree()) {
+                trees.append(std::move(*tree));
+            }
+            QVERIFY(!reader.hasError());
+        }
+
+        GrampsXmlReader reader(path, false);
+        for (const auto& tree: std::as_const(trees)) {
+            const auto record = reader.next();
+            QVERIFY(record.has_value());
+            const auto converted = tree.parse();
+            QCOMPARE(converted.index(), record->index());
+            QCOMPARE(handleOf(converted), handleOf(*record));
+        }
+        QVERIFY(!reader.next().has_value());
+    }
+
+    void benchmarkConvertRealFile_data() {
+        QTest::addColumn<int>("converters");
+        QTest::newRow("one thread") << 1;
+        QTest::newRow("all threads") << std::max(1, QThread::idealThreadCount() - 2);
+    }
+
+    void benchmarkConvertRealFile() {
+        QFETCH(int, converters);
+        const QString path = QFINDTESTDATA("example-1.7.2.gramps");
+        QVERIFY2(!path.isEmpty(), "Could not find example-1.7.2.gramps");
+
+        using RecordTree = GrampsXmlReader::RecordTree;
+        QBENCHMARK {
+            QPromise<bool> promise;
+            promise.start();
+            ImportPipeline pipeline(promise);
+            auto trees = pipeline.read<RecordTree>({[&path](BoundedQueue<RecordTree>& output) {
+                GrampsXmlReader reader(path, false);
+                while (auto tree = reader.nextTree()) {
+                    if (!output.push(std::move(*tree))) {
+                        return;
+                    }
+                }
+            }});
+            auto records = pipeline.transform(
+                std::move(trees),
+                [](RecordTree&& tree) { return tree.parse(); },
+                converters
+            );
+            int read = 0;
+            QVERIFY(pipeline.write(records, [&read](GrampsRecord&&) {
+                ++read;
+                return true;
+            }));
+            // All records of the file.
+            QCOMPARE(read, 2157 + 762 + 3432 + 1296 + 19 + 2854 + 4 + 7 + 3);
+        }
+    }
+
+    void benchmarkReadRealFile() {
+        const QString path = QFINDTESTDATA("example-1.7.2.gramps");
+        QVERIFY2(!path.isEmpty(), "Could not find example-1.7.2.gramps");
+
+        QBENCHMARK {
+            GrampsXmlReader reader(path);
+            while (reader.next()) {
+            }
+        }
+    }
+};
+
+QTEST_MAIN(TestGrampsXmlReader)
+#include "gramps_xml_reader_test.moc"
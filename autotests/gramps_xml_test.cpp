@@ -128,6 +128,9 @@ private Q_SLOTS:
         QCOMPARE(result.events, 3432);
         QCOMPARE(result.sources, 4);
         QCOMPARE(result.places, 1296);
+        QCOMPARE(result.media, 7);
+        QCOMPARE(result.citations, 2854);
+        QCOMPARE(result.filename, path);
     }
 
     void testNonExistentFileIsRejected() {
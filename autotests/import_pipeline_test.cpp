@@ -0,0 +1,300 @@
+/*
+ * SPDX-FileCopyrightText: Niko Strijbol <niko@strijbol.be>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+// ReSharper disable CppMemberFunctionMayBeStatic
+// ReSharper disable CppMemberFunctionMayBeConst
+#include "../src/import/import_pipeline.h"
+#include "database/database.h"
+
+#include <QFuture>
+#include <QPromise>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTest>
+#include <QThread>
+#include <QVariantMap>
+#include <algorithm>
+#include <atomic>
+
+using namespace Qt::Literals::StringLiterals;
+
+namespace {
+constexpr int BENCHMARK_VALUES = 200'000;
+
+using IntReader = ImportPipeline<bool>::Reader<int>;
+
+// Reads the numbers from first up to last.
+IntReader numbers(int first, int last) {
+    return [first, last](BoundedQueue<int>& output) {
+        for (int i = first; i < last; ++i) {
+            if (!output.push(int(i))) {
+                return;
+            }
+        }
+    };
+}
+
+// Reads numbers until the pipeline stops.
+IntReader endless() {
+    return [](BoundedQueue<int>& output) {
+        for (int i = 0;; ++i) {
+            if (!output.push(int(i))) {
+                return;
+            }
+        }
+    };
+}
+}
+
+class TestImportPipeline : public QObject {
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testKeepsOrderOfReaders() {
+        QPromise<bool> promise;
+        promise.start();
+        ImportPipeline pipeline(promise);
+
+        auto read = pipeline.read<int>({numbers(0, 3'000), numbers(3'000, 3'010), numbers(3'010, 5'000)});
+        auto doubled = pipeline.transform(std::move(read), [](int value) { return value * 2; });
+        QList<int> written;
+        QVERIFY(pipeline.write(doubled, [&written](int value) {
+            written.append(value);
+            return true;
+        }));
+
+        QCOMPARE(written.size(), 5'000);
+        for (int i = 0; i < written.size(); ++i) {
+            QCOMPARE(written[i], i * 2);
+        }
+        QCOMPARE(promise.future().progressValue(), 5'000);
+    }
+
+    void testParallelTransformKeepsOrder() {
+        QPromise<bool> promise;
+        promise.start();
+        ImportPipeline pipeline(promise);
+
+        auto read = pipeline.read<int>({numbers(0, 3'000), numbers(3'000, 5'001)});
+        auto doubled = pipeline.transform(std::move(read), [](int value) { return value * 2; }, 4);
+        QList<int> written;
+        QVERIFY(pipeline.write(doubled, [&written](int value) {
+            written.append(value);
+            return true;
+        }));
+
+        QCOMPARE(written.size(), 5'001);
+        for (int i = 0; i < written.size(); ++i) {
+            QCOMPARE(written[i], i * 2);
+        }
+    }
+
+    void testFailingReaderStopsParallelTransform() {
+        QPromise<bool> promise;
+        promise.start();
+        ImportPipeline pipeline(promise);
+
+        auto read = pipeline.read<int>({[](BoundedQueue<int>& output) {
+            for (int i = 0; i < 10; ++i) {
+                output.push(int(i));
+            }
+            output.fail(u"broken"_s);
+        }});
+        auto same = pipeline.transform(std::move(read), [](int value) { return value; }, 3);
+        QList<int> written;
+        QVERIFY(!pipeline.write(same, [&written](int value) {
+            written.append(value);
+            return true;
+        }));
+
+        QCOMPARE(written, QList<int>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+    }
+
+    void testChainsTransforms() {
+        QPromise<bool> promise;
+        promise.start();
+        ImportPipeline pipeline(promise);
+
+        auto read = pipeline.read<int>({numbers(0, 10)});
+        auto texts = pipeline.transform(std::move(read), [](int value) { return QString::number(value); });
+        auto lengths = pipeline.transform(std::move(texts), [](const QString& text) { return text.size(); });
+        int total = 0;
+        QVERIFY(pipeline.write(lengths, [&total](qsizetype length) {
+            total += static_cast<int>(length);
+            return true;
+        }));
+
+        QCOMPARE(total, 10);
+    }
+
+    void testProgressTextIsReportedWithProgress() {
+        QPromise<bool> promise;
+        promise.start();
+        promise.setProgressRange(0, 20);
+        promise.setProgressValueAndText(10, u"Preparing"_s);
+        ImportPipeline pipeline(promise);
+
+        auto read = pipeline.read<int>({numbers(0, 10)});
+        QVERIFY(pipeline.write(read, [&pipeline](int value) {
+            if (value == 0) {
+                pipeline.setProgressText(u"Writing"_s);
+            }
+            return true;
+        }));
+
+        QCOMPARE(promise.future().progressValue(), 20);
+        QCOMPARE(promise.future().progressText(), u"Writing"_s);
+    }
+
+    void testQueueWaitsWhileFull() {
+        BoundedQueue<int> queue(2);
+        std::atomic<int> pushed = 0;
+        auto* producer = QThread::create([&] {
+            for (int i = 0; i < 10; ++i) {
+                queue.push(int(i));
+                ++pushed;
+            }
+            queue.finish();
+        });
+        producer->start();
+
+        // The producer can only be as far ahead as the capacity.
+        QTRY_COMPARE(pushed.load(), 2);
+        QTest::qWait(20);
+        QCOMPARE(pushed.load(), 2);
+
+        int popped = 0;
+        while (auto value = queue.pop()) {
+            QCOMPARE(*value, popped++);
+            QVERIFY(pushed.load() - popped <= 2);
+        }
+        QCOMPARE(popped, 10);
+        QVERIFY(producer->wait());
+        delete producer;
+    }
+
+    void testFailingReaderStopsImport() {
+        QPromise<bool> promise;
+        promise.start();
+        ImportPipeline pipeline(promise);
+
+        auto read = pipeline.read<int>({
+            numbers(0, 5),
+            [](BoundedQueue<int>& output) {
+                output.push(5);
+                output.fail(u"broken"_s);
+            },
+            endless(),
+        });
+        QList<int> written;
+        QVERIFY(!pipeline.write(read, [&written](int value) {
+            written.append(value);
+            return true;
+        }));
+
+        QCOMPARE(written, QList<int>({0, 1, 2, 3, 4, 5}));
+    }
+
+    void testFailingWriterStopsReaders() {
+        QPromise<bool> promise;
+        promise.start();
+        ImportPipeline pipeline(promise);
+
+        auto read = pipeline.read<int>({endless(), endless()});
+        auto same = pipeline.transform(std::move(read), [](int value) { return value; });
+        int written = 0;
+        QVERIFY(!pipeline.write(same, [&written](int) { return ++written < 100; }));
+
+        QCOMPARE(written, 100);
+    }
+
+    void testCancelStopsImport() {
+        QPromise<bool> promise;
+        promise.start();
+        ImportPipeline pipeline(promise);
+
+        auto read = pipeline.read<int>({endless()});
+        int written = 0;
+        QVERIFY(!pipeline.write(read, [&](int) {
+            if (++written == 50) {
+                promise.future().cancel();
+            }
+            return true;
+        }));
+
+        QCOMPARE(written, 50);
+    }
+
+    void testFailedCommitIsRolledBack() {
+        openDatabase(u":memory:"_s, false);
+        auto database = QSqlDatabase::database();
+        {
+            ChunkedTransaction transaction(database);
+            QVERIFY(transaction.begin());
+            QSqlQuery query(database);
+            // The foreign key is only checked when committing, which then fails.
+            QVERIFY(query.exec(u"PRAGMA defer_foreign_keys = ON"_s));
+            QVERIFY(query.exec(u"INSERT INTO names (person_id, sort) VALUES (12345, 1)"_s));
+            QVERIFY(!transaction.commit());
+            QVERIFY(hasActiveTransaction(database));
+        }
+        QVERIFY(!hasActiveTransaction(database));
+        closeDatabase();
+    }
+
+    void benchmarkParallelTransform_data() {
+        QTest::addColumn<int>("converters");
+        QTest::newRow("one thread") << 1;
+        QTest::newRow("all threads") << std::max(1, QThread::idealThreadCount() - 2);
+    }
+
+    void benchmarkParallelTransform() {
+        QFETCH(int, converters);
+        QBENCHMARK {
+            QPromise<bool> promise;
+            promise.start();
+            ImportPipeline pipeline(promise);
+
+            auto read = pipeline.read<int>({numbers(0, BENCHMARK_VALUES)});
+            // About the work of converting a record to the values of its row.
+            auto rows = pipeline.transform(
+                std::move(read),
+                [](int value) {
+                    QVariantMap row;
+                    for (int column = 0; column < 8; ++column) {
+                        row.insert(u":column_%1"_s.arg(column), QString::number(value * column));
+                    }
+                    return row;
+                },
+                converters
+            );
+            qsizetype total = 0;
+            QVERIFY(pipeline.write(rows, [&total](QVariantMap&& row) {
+                total += row.size();
+                return true;
+            }));
+        }
+    }
+
+    void benchmarkPipeline() {
+        QBENCHMARK {
+            QPromise<bool> promise;
+            promise.start();
+            ImportPipeline pipeline(promise);
+
+            constexpr int half = BENCHMARK_VALUES / 2;
+            auto read = pipeline.read<int>({numbers(0, half), numbers(half, BENCHMARK_VALUES)});
+            auto texts = pipeline.transform(std::move(read), [](int value) { return QString::number(value); });
+            qsizetype total = 0;
+            QVERIFY(pipeline.write(texts, [&total](QString&& text) {
+                total += text.size();
+                return true;
+            }));
+        }
+    }
+};
+
+QTEST_MAIN(TestImportPipeline)
+#include "import_pipeline_test.moc"
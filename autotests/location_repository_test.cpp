@@ -129,8 +129,8 @@ private Q_SLOTS:
             std::nullopt,
             u"A note"_s,
             Coordinates{52.3, 4.9},
-            u"1815"_s,
-            QString{}
+            GenealogicalDate::fromDisplayText(u"1815"_s),
+            GenealogicalDate{}
         ));
 
         auto result = repo.findById(*id);
@@ -140,8 +140,8 @@ private Q_SLOTS:
         QVERIFY(result->coordinates.has_value());
         QCOMPARE(result->coordinates->latitude, 52.3);
         QCOMPARE(result->coordinates->longitude, 4.9);
-        QCOMPARE(result->dateStart, u"1815"_s);
-        QVERIFY(result->dateEnd.isEmpty());
+        QCOMPARE(result->dateStart, GenealogicalDate::fromDisplayText(u"1815"_s));
+        QVERIFY(result->dateEnd.isNull());
     }
 
     void testDeleteLocation() {
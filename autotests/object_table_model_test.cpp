@@ -0,0 +1,410 @@
+/*
+ * SPDX-FileCopyrightText: Niko Strijbol <niko@strijbol.be>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+// ReSharper disable CppMemberFunctionMayBeStatic
+// ReSharper disable CppMemberFunctionMayBeConst
+#include "core/data_event_broker.h"
+#include "database/schema.h"
+#include "model/object_table_model.h"
+
+#include <QCoreApplication>
+#include <QLocale>
+#include <QSignalSpy>
+#include <QSortFilterProxyModel>
+#include <QTest>
+#include <atomic>
+
+using namespace Qt::Literals::StringLiterals;
+
+namespace {
+constexpr int BENCHMARK_ROWS = 100'000;
+
+struct Item {
+    IntegerPrimaryKey id;
+    QString name;
+
+    bool operator==(const Item&) const = default;
+};
+
+/**
+ * A model of the sources table, where the "database" is a map.
+ */
+class ItemModel : public ObjectTableModel<Item> {
+public:
+    QMap<IntegerPrimaryKey, Item> stored;
+    int reloads = 0;
+    QList<IntegerPrimaryKey> fetched;
+
+    ItemModel() {
+        setColumn(0, u"ID"_s, &Item::id);
+        setColumn(1, u"Name"_s, &Item::name);
+        setRowId(&Item::id);
+        updateRowsOn<Schema::Sources>(
+            [this](IntegerPrimaryKey id) -> std::optional<Item> {
+                fetched.append(id);
+                if (stored.contains(id)) {
+                    return stored.value(id);
+                }
+                return std::nullopt;
+            },
+            [this] {
+                ++reloads;
+                setItems(stored.values());
+            }
+        );
+    }
+};
+
+QList<Item> numbered(int count) {
+    QList<Item> result;
+    result.reserve(count);
+    for (int i = 1; i <= count; ++i) {
+        result.append({i, QString::number(i)});
+    }
+    return result;
+}
+
+/**
+ * Adds a column with the name in upper case, which counts how often it is computed.
+ */
+void addUpperColumn(ObjectTableModel<Item>& model, std::atomic<int>& computed) {
+    model.setColumn(2, u"Upper"_s, [&computed](const Item& item) {
+        ++computed;
+        return item.name.toUpper();
+    });
+}
+
+QStringList column(const QAbstractItemModel& model, int column) {
+    QStringList result;
+    for (int row = 0; row < model.rowCount(); ++row) {
+        result.append(model.index(row, column).data().toString());
+    }
+    return result;
+}
+
+QStringList names(const ItemModel& model) {
+    QStringList result;
+    for (const auto& item: model.getItems()) {
+        result.append(item.name);
+    }
+    return result;
+}
+
+}
+
+class TestObjectTableModel : public QObject {
+    Q_OBJECT
+
+    ItemModel* model = nullptr;
+
+private Q_SLOTS:
+    void init() {
+        model = new ItemModel;
+        model->stored = {{1, {1, u"A"_s}}, {2, {2, u"B"_s}}, {3, {3, u"C"_s}}};
+        model->setItems(model->stored.values());
+    }
+
+    void cleanup() {
+        delete model;
+        model = nullptr;
+    }
+
+    void testChangedRowIsUpdatedInPlace() {
+        QSignalSpy reset(model, &QAbstractItemModel::modelReset);
+        QSignalSpy changed(model, &QAbstractItemModel::dataChanged);
+
+        model->stored[2].name = u"B2"_s;
+        DataEventBroker::instance().notifyChanged<Schema::Sources>(2);
+
+        QCOMPARE(reset.count(), 0);
+        QCOMPARE(changed.count(), 1);
+        QCOMPARE(changed.at(0).at(0).value<QModelIndex>(), model->index(1, 0));
+        QCOMPARE(changed.at(0).at(1).value<QModelIndex>(), model->index(1, 1));
+        QCOMPARE(model->fetched, QList<IntegerPrimaryKey>{2});
+        QCOMPARE(names(*model), QStringList({u"A"_s, u"B2"_s, u"C"_s}));
+    }
+
+    void testNewRowIsAppended() {
+        QSignalSpy reset(model, &QAbstractItemModel::modelReset);
+        QSignalSpy inserted(model, &QAbstractItemModel::rowsInserted);
+
+        model->stored.insert(4, {4, u"D"_s});
+        DataEventBroker::instance().notifyChanged<Schema::Sources>(4);
+
+        QCOMPARE(reset.count(), 0);
+        QCOMPARE(inserted.count(), 1);
+        QCOMPARE(inserted.at(0).at(1).toInt(), 3);
+        QCOMPARE(names(*model), QStringList({u"A"_s, u"B"_s, u"C"_s, u"D"_s}));
+    }
+
+    void testDeletedRowIsRemoved() {
+        QSignalSpy reset(model, &QAbstractItemModel::modelReset);
+        QSignalSpy removed(model, &QAbstractItemModel::rowsRemoved);
+
+        model->stored.remove(1);
+        DataEventBroker::instance().notifyChanged<Schema::Sources>(1);
+
+        QCOMPARE(reset.count(), 0);
+        QCOMPARE(removed.count(), 1);
+        QCOMPARE(removed.at(0).at(1).toInt(), 0);
+        QCOMPARE(names(*model), QStringList({u"B"_s, u"C"_s}));
+
+        // The rows after the removed one are still found.
+        model->stored[3].name = u"C2"_s;
+        DataEventBroker::instance().notifyChanged<Schema::Sources>(3);
+        QCOMPARE(names(*model), QStringList({u"B"_s, u"C2"_s}));
+    }
+
+    void testRowOutsideModelIsIgnored() {
+        QSignalSpy reset(model, &QAbstractItemModel::modelReset);
+        QSignalSpy removed(model, &QAbstractItemModel::rowsRemoved);
+
+        DataEventBroker::instance().notifyChanged<Schema::Sources>(42);
+
+        QCOMPARE(reset.count(), 0);
+        QCOMPARE(removed.count(), 0);
+        QCOMPARE(model->rowCount(), 3);
+    }
+
+    void testTableWideChangeReloads() {
+        QSignalSpy removed(model, &QAbstractItemModel::rowsRemoved);
+
+        model->stored.remove(2);
+        DataEventBroker::instance().notifyChanged<Schema::Sources>(std::nullopt);
+
+        QCOMPARE(model->reloads, 1);
+        QCOMPARE(removed.count(), 1);
+        QVERIFY(model->fetched.isEmpty());
+        QCOMPARE(names(*model), QStringList({u"A"_s, u"C"_s}));
+    }
+
+    void testSetItemsOnlyChangesDifferentRows() {
+        QSignalSpy reset(model, &QAbstractItemModel::modelReset);
+        QSignalSpy removed(model, &QAbstractItemModel::rowsRemoved);
+        QSignalSpy inserted(model, &QAbstractItemModel::rowsInserted);
+        QSignalSpy changed(model, &QAbstractItemModel::dataChanged);
+
+        model->setItems({{1, u"A"_s}, {3, u"C2"_s}, {4, u"D"_s}, {5, u"E"_s}});
+
+        QCOMPARE(reset.count(), 0);
+        QCOMPARE(removed.count(), 1);
+        QCOMPARE(removed.at(0).at(1).toInt(), 1);
+        QCOMPARE(inserted.count(), 1);
+        QCOMPARE(inserted.at(0).at(1).toInt(), 2);
+        QCOMPARE(inserted.at(0).at(2).toInt(), 3);
+        QCOMPARE(changed.count(), 1);
+        QCOMPARE(changed.at(0).at(0).value<QModelIndex>().row(), 1);
+        QCOMPARE(names(*model), QStringList({u"A"_s, u"C2"_s, u"D"_s, u"E"_s}));
+
+        // The ids are indexed again.
+        model->stored = {{5, {5, u"E2"_s}}};
+        DataEventBroker::instance().notifyChanged<Schema::Sources>(5);
+        QCOMPARE(names(*model), QStringList({u"A"_s, u"C2"_s, u"D"_s, u"E2"_s}));
+    }
+
+    void testSetItemsMovesRowsWithLayoutChange() {
+        QPersistentModelIndex first = model->index(0, 1);
+        QSignalSpy reset(model, &QAbstractItemModel::modelReset);
+        QSignalSpy layout(model, &QAbstractItemModel::layoutChanged);
+
+        model->setItems({{3, u"C"_s}, {2, u"B"_s}, {1, u"A"_s}});
+
+        QCOMPARE(reset.count(), 0);
+        QCOMPARE(layout.count(), 1);
+        QCOMPARE(first.row(), 2);
+        QCOMPARE(first.data().toString(), u"A"_s);
+    }
+
+    void testSetItemsWithoutChangesEmitsNothing() {
+        QSignalSpy reset(model, &QAbstractItemModel::modelReset);
+        QSignalSpy changed(model, &QAbstractItemModel::dataChanged);
+
+        model->setItems(model->stored.values());
+
+        QCOMPARE(reset.count(), 0);
+        QCOMPARE(changed.count(), 0);
+    }
+
+    void testSetItemsWithManyChangesResets() {
+        QSignalSpy reset(model, &QAbstractItemModel::modelReset);
+
+        // Every other row is new, which would be many separate insertions.
+        QList<Item> interleaved;
+        for (int i = 1; i <= 300; ++i) {
+            interleaved.append({i, QString::number(i)});
+            interleaved.append({1000 + i, QString::number(1000 + i)});
+        }
+        model->setItems(interleaved);
+        QCOMPARE(reset.count(), 1);
+    }
+
+    void testOtherTablesAreIgnored() {
+        DataEventBroker::instance().notifyChanged<Schema::Media>(1);
+
+        QCOMPARE(model->reloads, 0);
+        QVERIFY(model->fetched.isEmpty());
+    }
+
+    void testProjectedColumnIsComputedOncePerRow() {
+        std::atomic<int> computed = 0;
+        addUpperColumn(*model, computed);
+        model->projectColumn(2);
+        QCOMPARE(computed.load(), 3);
+
+        QCOMPARE(column(*model, 2), QStringList({u"A"_s, u"B"_s, u"C"_s}));
+        QCOMPARE(column(*model, 2), QStringList({u"A"_s, u"B"_s, u"C"_s}));
+        QCOMPARE(computed.load(), 3);
+
+        // Only the fresh rows are computed, not the rows that are read.
+        model->setItems({{1, u"a"_s}, {3, u"c"_s}, {4, u"d"_s}});
+        QCOMPARE(computed.load(), 6);
+        QCOMPARE(column(*model, 2), QStringList({u"A"_s, u"C"_s, u"D"_s}));
+        QCOMPARE(computed.load(), 6);
+    }
+
+    void testProjectedColumnFollowsRowUpdates() {
+        std::atomic<int> computed = 0;
+        addUpperColumn(*model, computed);
+        model->projectColumn(2);
+
+        model->stored[2].name = u"b2"_s;
+        DataEventBroker::instance().notifyChanged<Schema::Sources>(2);
+        model->stored.insert(4, {4, u"d"_s});
+        DataEventBroker::instance().notifyChanged<Schema::Sources>(4);
+        model->stored.remove(1);
+        DataEventBroker::instance().notifyChanged<Schema::Sources>(1);
+
+        QCOMPARE(column(*model, 2), QStringList({u"B2"_s, u"C"_s, u"D"_s}));
+        QCOMPARE(computed.load(), 5);
+    }
+
+    void testProjectedColumnIsCurrentDuringStructuralChanges() {
+        std::atomic<int> computed = 0;
+        addUpperColumn(*model, computed);
+        model->projectColumn(2);
+
+        // What a view reads while the rows are being inserted must match the row.
+        QStringList seen;
+        connect(model, &QAbstractItemModel::rowsInserted, this, [this, &seen](const QModelIndex&, int first, int last) {
+            for (int row = first; row <= last; ++row) {
+                seen.append(model->index(row, 1).data().toString() + model->index(row, 2).data().toString());
+            }
+        });
+        model->setItems({{4, u"d"_s}, {1, u"A"_s}, {2, u"B"_s}, {3, u"C"_s}});
+
+        QCOMPARE(seen, QStringList{u"dD"_s});
+    }
+
+    void testLocaleChangeComputesProjectedColumnsAgain() {
+        std::atomic<int> computed = 0;
+        addUpperColumn(*model, computed);
+        model->projectColumn(2);
+        QSignalSpy changed(model, &QAbstractItemModel::dataChanged);
+
+        QEvent localeChange(QEvent::LocaleChange);
+        QCoreApplication::sendEvent(QCoreApplication::instance(), &localeChange);
+
+        QCOMPARE(computed.load(), 6);
+        QCOMPARE(changed.count(), 1);
+        QCOMPARE(changed.at(0).at(0).value<QModelIndex>(), model->index(0, 2));
+        QCOMPARE(changed.at(0).at(1).value<QModelIndex>(), model->index(2, 2));
+
+        // So does a change of language.
+        QEvent languageChange(QEvent::LanguageChange);
+        QCoreApplication::sendEvent(QCoreApplication::instance(), &languageChange);
+        QCOMPARE(computed.load(), 9);
+        QCOMPARE(changed.count(), 2);
+    }
+
+    void testParallelProjectionMatchesSequential() {
+        std::atomic<int> computedSequential = 0;
+        std::atomic<int> computedParallel = 0;
+        ObjectTableModel<Item> sequential;
+        ObjectTableModel<Item> parallel;
+        for (auto* projected: {&sequential, &parallel}) {
+            projected->setColumn(0, u"ID"_s, &Item::id);
+            projected->setColumn(1, u"Name"_s, &Item::name);
+        }
+        addUpperColumn(sequential, computedSequential);
+        addUpperColumn(parallel, computedParallel);
+        sequential.projectColumn(2);
+        parallel.projectColumn(2, ObjectTableModel<Item>::Projection::PARALLEL);
+        parallel.projectColumn(1);
+
+        const auto items = numbered(5'000);
+        sequential.setItems(items);
+        parallel.setItems(items);
+
+        QCOMPARE(computedParallel.load(), 5'000);
+        QCOMPARE(column(parallel, 2), column(sequential, 2));
+        QCOMPARE(column(parallel, 1), column(sequential, 1));
+    }
+
+    void benchmarkReadColumn_data() {
+        QTest::addColumn<bool>("projected");
+        QTest::newRow("extracted") << false;
+        QTest::newRow("projected") << true;
+    }
+
+    void benchmarkReadColumn() {
+        QFETCH(bool, projected);
+
+        ObjectTableModel<Item> benchmarked;
+        benchmarked.setColumn(0, u"Name"_s, [](const Item& item) {
+            return QLocale().toString(static_cast<double>(item.id) / 7, 'f', 3);
+        });
+        if (projected) {
+            benchmarked.projectColumn(0, ObjectTableModel<Item>::Projection::PARALLEL);
+        }
+        benchmarked.setItems(numbered(BENCHMARK_ROWS));
+
+        // A view reads each cell more than once, e.g. to size, sort and paint it.
+        QBENCHMARK {
+            for (int row = 0; row < BENCHMARK_ROWS; ++row) {
+                Q_UNUSED(benchmarked.index(row, 0).data());
+            }
+        }
+    }
+
+    void benchmarkSetItems_data() {
+        QTest::addColumn<bool>("keyed");
+        QTest::newRow("reset") << false;
+        QTest::newRow("keyed diff") << true;
+    }
+
+    void benchmarkSetItems() {
+        QFETCH(bool, keyed);
+
+        // A reload after a few edits: some rows changed, removed or added.
+        const auto before = numbered(BENCHMARK_ROWS);
+        auto after = before;
+        for (int i = 0; i < BENCHMARK_ROWS; i += 1000) {
+            after[i].name += u"*"_s;
+        }
+        after.remove(BENCHMARK_ROWS / 2, 10);
+        after.append({BENCHMARK_ROWS + 1, u"new"_s});
+
+        ObjectTableModel<Item> benchmarked;
+        benchmarked.setColumn(0, u"Name"_s, &Item::name);
+        if (keyed) {
+            benchmarked.setRowId(&Item::id);
+        }
+        benchmarked.setItems(before);
+        // Proxies on top of the model are where a reset is expensive.
+        QSortFilterProxyModel sorted;
+        sorted.setSourceModel(&benchmarked);
+        sorted.sort(0);
+
+        bool flip = false;
+        QBENCHMARK {
+            benchmarked.setItems(flip ? before : after);
+            flip = !flip;
+        }
+        QCOMPARE(sorted.rowCount(), benchmarked.rowCount());
+    }
+};
+
+QTEST_GUILESS_MAIN(TestObjectTableModel)
+#include "object_table_model_test.moc"
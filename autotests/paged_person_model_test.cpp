@@ -0,0 +1,211 @@
+/*
+ * SPDX-FileCopyrightText: Niko Strijbol <niko@strijbol.be>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+// ReSharper disable CppMemberFunctionMayBeStatic
+// ReSharper disable CppMemberFunctionMayBeConst
+#include "domain/person/paged_person_model.h"
+
+#include "./test_utils.h"
+#include "database/database.h"
+#include "domain/person/person_repository.h"
+
+#include <QSignalSpy>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTest>
+#include <algorithm>
+#include <functional>
+
+using namespace Qt::Literals::StringLiterals;
+
+namespace {
+constexpr int PEOPLE = 5'000;
+constexpr int BENCHMARK_PEOPLE = 100'000;
+
+/**
+ * Insert people 1 to count, with a primary name in another order than their id.
+ */
+void insertPeople(int count) {
+    const auto numbers = u"WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < %1) "_s.arg(count);
+    QSqlQuery query;
+    VERIFY_OR_THROW2(
+        query.exec(u"INSERT INTO people (id, root, sex) "_s + numbers + u"SELECT i, FALSE, 'U' FROM n"_s),
+        query
+    );
+    VERIFY_OR_THROW2(
+        query.exec(
+            u"INSERT INTO names (person_id, sort, given_names, surname) "_s + numbers +
+            u"SELECT i, 1, 'Given ' || i, printf('Surname %05d', (i * 7919) % %1) FROM n"_s.arg(count)
+        ),
+        query
+    );
+}
+
+QList<IntegerPrimaryKey> ids(const QAbstractItemModel& model) {
+    QList<IntegerPrimaryKey> result;
+    for (int row = 0; row < model.rowCount(); ++row) {
+        result.append(model.index(row, PagedPersonModel::ID).data().toLongLong());
+    }
+    return result;
+}
+
+QList<IntegerPrimaryKey> idsFromQuery(const QString& sql) {
+    QList<IntegerPrimaryKey> result;
+    QSqlQuery query;
+    VERIFY_OR_THROW2(query.exec(sql), query);
+    while (query.next()) {
+        result.append(query.value(0).toLongLong());
+    }
+    return result;
+}
+}
+
+class TestPagedPersonModel : public QObject {
+    Q_OBJECT
+
+    QList<IntegerPrimaryKey> unnamed;
+
+private Q_SLOTS:
+    void init() {
+        QVERIFY(QSqlDatabase::isDriverAvailable(u"QSQLITE"_s));
+        openDatabase(u":memory:"_s, false);
+        insertPeople(PEOPLE);
+        PersonRepository repository;
+        unnamed = {*repository.insertPerson(u"U"_s), *repository.insertPerson(u"U"_s)};
+    }
+
+    void cleanup() {
+        closeDatabase();
+    }
+
+    void testOnlyCountsUpFront() {
+        PagedPersonModel model;
+
+        QCOMPARE(model.rowCount(), PEOPLE + 2);
+        QCOMPARE(model.loadedPages(), 0);
+
+        // The first rows are the people without a name.
+        QVERIFY(!model.index(10, PagedPersonModel::NAME).data().toString().isEmpty());
+        QCOMPARE(model.loadedPages(), 1);
+    }
+
+    void testSortsByName() {
+        PagedPersonModel model;
+
+        const auto named =
+            idsFromQuery(u"SELECT person_id FROM person_primary_name ORDER BY sort_key, person_id"_s);
+        QCOMPARE(ids(model), unnamed + named);
+
+        model.sort(PagedPersonModel::NAME, Qt::DescendingOrder);
+        auto reversed = unnamed + named;
+        std::ranges::reverse(reversed);
+        QCOMPARE(ids(model), reversed);
+    }
+
+    void testSortsById() {
+        PagedPersonModel model;
+        model.sort(PagedPersonModel::ID, Qt::DescendingOrder);
+
+        const auto all = ids(model);
+        QCOMPARE(all.size(), PEOPLE + 2);
+        QCOMPARE(all.first(), unnamed.last());
+        QVERIFY(std::ranges::is_sorted(all, std::greater{}));
+    }
+
+    void testFiltersOnName() {
+        PagedPersonModel model;
+        model.setFilterText(u"surname 001"_s);
+
+        const auto expected = idsFromQuery(
+            u"SELECT person_id FROM person_primary_name WHERE display_name LIKE '%surname 001%' "_s
+            u"ORDER BY sort_key, person_id"_s
+        );
+        QVERIFY(!expected.isEmpty());
+        QCOMPARE(model.rowCount(), expected.size());
+        QCOMPARE(ids(model), expected);
+
+        model.setFilterText({});
+        QCOMPARE(model.rowCount(), PEOPLE + 2);
+    }
+
+    void testPagesAreTheSameInAnyOrder_data() {
+        QTest::addColumn<int>("column");
+        QTest::addColumn<Qt::SortOrder>("order");
+        QTest::newRow("name ascending") << int(PagedPersonModel::NAME) << Qt::AscendingOrder;
+        QTest::newRow("name descending") << int(PagedPersonModel::NAME) << Qt::DescendingOrder;
+        QTest::newRow("id descending") << int(PagedPersonModel::ID) << Qt::DescendingOrder;
+    }
+
+    void testPagesAreTheSameInAnyOrder() {
+        QFETCH(int, column);
+        QFETCH(Qt::SortOrder, order);
+        PagedPersonModel scrolled;
+        scrolled.sort(column, order);
+        PagedPersonModel jumped;
+        jumped.sort(column, order);
+
+        // Jump to the end first, then to the middle, and scroll up from there.
+        const auto last = jumped.rowCount() - 1;
+        const auto middle = last / 2;
+        QCOMPARE(jumped.index(last, PagedPersonModel::ID).data(), scrolled.index(last, PagedPersonModel::ID).data());
+        QList<IntegerPrimaryKey> upwards;
+        for (int row = middle; row >= 0; --row) {
+            upwards.prepend(jumped.index(row, PagedPersonModel::ID).data().toLongLong());
+        }
+
+        QCOMPARE(upwards, ids(scrolled).mid(0, middle + 1));
+        QCOMPARE(ids(jumped), ids(scrolled));
+    }
+
+    void testKeepsOnlyRecentPages() {
+        PagedPersonModel model;
+
+        for (int row = 0; row < model.rowCount(); ++row) {
+            Q_UNUSED(model.index(row, PagedPersonModel::NAME).data());
+        }
+        static_assert(PEOPLE > PagedPersonModel::PAGE_SIZE * PagedPersonModel::MAX_PAGES);
+        QCOMPARE(model.loadedPages(), PagedPersonModel::MAX_PAGES);
+    }
+
+    void testChangeReloads() {
+        PagedPersonModel model;
+        QSignalSpy reset(&model, &QAbstractItemModel::modelReset);
+
+        PersonRepository().insertPerson(u"U"_s);
+
+        QTRY_COMPARE(model.rowCount(), PEOPLE + 3);
+        QCOMPARE(reset.count(), 1);
+    }
+
+    void benchmarkFirstScreen_data() {
+        QTest::addColumn<bool>("paged");
+        QTest::newRow("load all") << false;
+        QTest::newRow("paged") << true;
+    }
+
+    void benchmarkFirstScreen() {
+        QFETCH(bool, paged);
+        closeDatabase();
+        openDatabase(u":memory:"_s, false);
+        insertPeople(BENCHMARK_PEOPLE);
+
+        // What a list needs before it can show its first rows, sorted by name.
+        QBENCHMARK {
+            if (paged) {
+                PagedPersonModel model;
+                for (int row = 0; row < 50; ++row) {
+                    Q_UNUSED(model.index(row, PagedPersonModel::NAME).data());
+                }
+            } else {
+                PersonCriteria criteria;
+                criteria.sortColumn = u"primary_name.sort_key"_s;
+                Q_UNUSED(PersonRepository().findPeopleWithPrimaryName(criteria));
+            }
+        }
+    }
+};
+
+QTEST_GUILESS_MAIN(TestPagedPersonModel)
+#include "paged_person_model_test.moc"
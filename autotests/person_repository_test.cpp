@@ -9,6 +9,7 @@
 #include "../src/domain/person/person_repository.h"
 
 #include "../src/domain/name/name_repository.h"
+#include "../src/domain/name/names.h"
 #include "./test_utils.h"
 #include "database/database.h"
 #include "database/schema.h"
@@ -160,6 +161,80 @@ private Q_SLOTS:
         QCOMPARE(display->surname, u"Wonder"_s);
     }
 
+    void testDisplayNameMatchesConstructedName() {
+        PersonRepository repo;
+        auto personId = repo.insertPerson(u"Male"_s);
+        QVERIFY(personId.has_value());
+
+        const QList<QStringList> cases = {
+            {u"Dr."_s, u"Jan"_s, u"van"_s, u"Dijk"_s},
+            {u""_s, u"Jan"_s, u""_s, u"Dijk"_s},
+            {u""_s, u""_s, u""_s, u""_s},
+            {u"Prof."_s, u""_s, u"de"_s, u""_s},
+            {u" Dr "_s, u"Jan  Piet"_s, u""_s, u"Dijk "_s},
+        };
+        NameRepository names;
+        const auto nameId = names.insertName(*personId, 1);
+        QVERIFY(nameId.has_value());
+        for (const auto& parts: cases) {
+            QVERIFY(names.updateName(*nameId, parts[0], parts[1], parts[2], parts[3], {}, std::nullopt));
+            auto display = repo.findDisplayById(*personId);
+            QVERIFY(display.has_value());
+            QCOMPARE(display->displayName, construct_display_name(parts[0], parts[1], parts[2], parts[3]));
+        }
+    }
+
+    void testPrimaryNameFollowsSort() {
+        PersonRepository repo;
+        auto personId = repo.insertPerson(u"Male"_s);
+        QVERIFY(personId.has_value());
+
+        NameRepository names;
+        const auto first = names.insertName(*personId, 2);
+        QVERIFY(names.updateName(*first, {}, u"John"_s, {}, u"Doe"_s, {}, std::nullopt));
+        QCOMPARE(repo.findDisplayById(*personId)->displayName, u"John Doe"_s);
+
+        // A name with a lower sort becomes the primary name.
+        const auto second = names.insertName(*personId, 1);
+        QVERIFY(names.updateName(*second, {}, u"Johnny"_s, {}, u"Doe"_s, {}, std::nullopt));
+        QCOMPARE(repo.findDisplayById(*personId)->displayName, u"Johnny Doe"_s);
+
+        QVERIFY(names.updateNameSort(*second, 3));
+        QCOMPARE(repo.findDisplayById(*personId)->displayName, u"John Doe"_s);
+
+        QVERIFY(names.deleteName(*first));
+        QCOMPARE(repo.findDisplayById(*personId)->displayName, u"Johnny Doe"_s);
+
+        QVERIFY(names.deleteName(*second));
+        auto display = repo.findDisplayById(*personId);
+        QVERIFY(display.has_value());
+        QVERIFY(display->displayName.isEmpty());
+    }
+
+    void testNameSearchIgnoresCaseAndWildcards() {
+        PersonRepository repo;
+        NameRepository names;
+        for (const auto& [given, surname]: {std::pair{u"Émile"_s, u"Zola"_s}, std::pair{u"Anna"_s, u"100%_Kerk"_s}}) {
+            const auto personId = repo.insertPerson(u"Male"_s);
+            QVERIFY(personId.has_value());
+            const auto nameId = names.insertName(*personId, 1);
+            QVERIFY(names.updateName(*nameId, {}, given, {}, surname, {}, std::nullopt));
+        }
+
+        auto count = [&repo](const QString& text) {
+            PersonCriteria criteria;
+            criteria.filterText = text;
+            return static_cast<int>(repo.countNamedPeople(criteria));
+        };
+        QCOMPARE(count(u"émile"_s), 1);
+        QCOMPARE(count(u"ZOLA"_s), 1);
+        QCOMPARE(count(u"%"_s), 1);
+        QCOMPARE(count(u"0%_k"_s), 1);
+        QCOMPARE(count(u"_"_s), 1);
+        QCOMPARE(count(u"a_n"_s), 0);
+        QCOMPARE(count(u"\\"_s), 0);
+    }
+
     void testFindByIdNotFound() {
         PersonRepository repo;
         auto result = repo.findById(9999);
@@ -0,0 +1,143 @@
+/*
+ * SPDX-FileCopyrightText: Niko Strijbol <niko@strijbol.be>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+// ReSharper disable CppMemberFunctionMayBeStatic
+// ReSharper disable CppMemberFunctionMayBeConst
+#include "tree_view/person_tree_graph_model.h"
+
+#include "database/database.h"
+#include "domain/family/ancestor_model.h"
+
+#include <QSignalSpy>
+#include <QSqlDatabase>
+#include <QTest>
+
+using namespace Qt::Literals::StringLiterals;
+
+namespace {
+ConnectionId edge(NodeId parent, NodeId child) {
+    return {.outNodeId = parent, .outPortIndex = 0, .inNodeId = child, .inPortIndex = 0};
+}
+}
+
+class TestPersonTreeGraphModel : public QObject {
+    Q_OBJECT
+
+private Q_SLOTS:
+    void init() {
+        QVERIFY(QSqlDatabase::isDriverAvailable(u"QSQLITE"_s));
+        openDatabase(u":memory:"_s, true);
+    }
+
+    void cleanup() {
+        closeDatabase();
+    }
+
+    void testNodesAreTheAncestors() {
+        PersonTreeGraphModel model{1};
+
+        QVERIFY(model.allNodeIds() == std::unordered_set<NodeId>({1, 3, 4, 5, 6, 7, 8, 9}));
+        QVERIFY(model.nodeExists(9));
+        QVERIFY(!model.nodeExists(2));
+    }
+
+    void testParentsAreIncomingConnections() {
+        PersonTreeGraphModel model{1};
+
+        QVERIFY(model.connections(1, PortType::In, 0) == std::unordered_set<ConnectionId>({edge(3, 1), edge(4, 1)}));
+        QVERIFY(model.connections(6, PortType::In, 0) == std::unordered_set<ConnectionId>({edge(9, 6)}));
+        QVERIFY(model.connections(5, PortType::In, 0).empty());
+    }
+
+    void testChildrenAreOutgoingConnections() {
+        PersonTreeGraphModel model{1};
+
+        // Person 9 is the father of both 6 and 7.
+        QVERIFY(model.connections(9, PortType::Out, 0) == std::unordered_set<ConnectionId>({edge(9, 6), edge(9, 7)}));
+        QVERIFY(model.connections(1, PortType::Out, 0).empty());
+        QVERIFY(model.allConnectionIds(3) == std::unordered_set<ConnectionId>({edge(5, 3), edge(6, 3), edge(3, 1)}));
+    }
+
+    void testConnectionExists() {
+        PersonTreeGraphModel model{1};
+
+        QVERIFY(model.connectionExists(edge(3, 1)));
+        QVERIFY(model.connectionExists(edge(9, 7)));
+        QVERIFY(!model.connectionExists(edge(1, 3)));
+        QVERIFY(!model.connectionExists(edge(5, 4)));
+    }
+
+    void testCaptionHasName() {
+        PersonTreeGraphModel model{1};
+        AncestorModel ancestors{1};
+
+        const auto name = ancestors.index(0, AncestorModel::DISPLAY_NAME).data().toString();
+        QVERIFY(!name.isEmpty());
+        QVERIFY(model.nodeData(1, NodeRole::Caption).toString().startsWith(name));
+    }
+
+    void testFindByChildId() {
+        PersonTreeGraphModel model{1};
+
+        const auto found = model.findByChildId(4);
+        QCOMPARE(found.size(), 1);
+        QCOMPARE(found.first().data(), 4);
+        QVERIFY(model.findByChildId(2).isEmpty());
+    }
+
+    void testCollapsedNodeHidesAncestors() {
+        PersonTreeGraphModel model{1};
+        QSignalSpy nodesDeleted(&model, &PersonTreeGraphModel::nodeDeleted);
+        QSignalSpy connectionsDeleted(&model, &PersonTreeGraphModel::connectionDeleted);
+
+        model.setCollapsed(3, true);
+
+        QVERIFY(model.isCollapsed(3));
+        QVERIFY(model.allNodeIds() == std::unordered_set<NodeId>({1, 3, 4, 7, 8}));
+        QCOMPARE(nodesDeleted.count(), 3);
+        // Person 9 is also the father of 7, but is placed above 6.
+        QCOMPARE(connectionsDeleted.count(), 4);
+        QVERIFY(!model.connectionExists(edge(9, 7)));
+
+        model.setCollapsed(3, false);
+        QCOMPARE(model.allNodeIds().size(), 8);
+    }
+
+    void testParentsAreAboveChildren() {
+        PersonTreeGraphModel model{1};
+
+        const auto child = model.nodeData(1, NodeRole::Position).toPointF();
+        const auto father = model.nodeData(3, NodeRole::Position).toPointF();
+        const auto mother = model.nodeData(4, NodeRole::Position).toPointF();
+        QVERIFY(father.y() < child.y());
+        QCOMPARE(father.y(), mother.y());
+        QCOMPARE((father.x() + mother.x()) / 2, child.x());
+    }
+
+    void testLoadAncestorsAddsNodes() {
+        PersonTreeGraphModel model{1, 2};
+        QVERIFY(model.allNodeIds() == std::unordered_set<NodeId>({1, 3, 4}));
+        QVERIFY(model.hasUnloadedAncestors(3));
+        QVERIFY(!model.hasUnloadedAncestors(1));
+
+        QSignalSpy reset(&model, &PersonTreeGraphModel::modelReset);
+        QSignalSpy nodesCreated(&model, &PersonTreeGraphModel::nodeCreated);
+        QSignalSpy connectionsCreated(&model, &PersonTreeGraphModel::connectionCreated);
+
+        model.loadAncestors(3);
+
+        // All changes of the source model are laid out at once, from the event loop.
+        QCOMPARE(nodesCreated.count(), 0);
+        QTRY_COMPARE(nodesCreated.count(), 3);
+        QCOMPARE(reset.count(), 0);
+        QVERIFY(model.allNodeIds() == std::unordered_set<NodeId>({1, 3, 4, 5, 6, 9}));
+        QCOMPARE(connectionsCreated.count(), 3);
+        QVERIFY(!model.hasUnloadedAncestors(3));
+        QVERIFY(model.hasUnloadedAncestors(4));
+    }
+};
+
+QTEST_MAIN(TestPersonTreeGraphModel)
+#include "person_tree_graph_model_test.moc"
@@ -0,0 +1,468 @@
+/*
+ * SPDX-FileCopyrightText: Niko Strijbol <niko@strijbol.be>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+// ReSharper disable CppMemberFunctionMayBeStatic
+// ReSharper disable CppMemberFunctionMayBeConst
+#include "./test_utils.h"
+#include "database/database.h"
+#include "domain/event/event_repository.h"
+#include "domain/event/event_role_translation_repository.h"
+#include "domain/event/event_type_translation_repository.h"
+#include "domain/family/family_repository.h"
+#include "domain/location/location_repository.h"
+#include "domain/location/location_type_translation_repository.h"
+#include "domain/media/media_repository.h"
+#include "domain/name/name_origin_translation_repository.h"
+#include "domain/name/name_repository.h"
+#include "domain/person/person_repository.h"
+#include "domain/source/source_repository.h"
+#include "domain/source/source_type_translation_repository.h"
+
+#include <QRegularExpression>
+#include <QSqlDatabase>
+#include <QSqlDriver>
+#include <QTest>
+#include <algorithm>
+#include <sqlite3.h>
+
+using namespace Qt::Literals::StringLiterals;
+
+namespace {
+
+// Tables that grow with the size of the tree. Type, role and origin tables (and their
+// translations) only hold a handful of rows, so scanning them is fine.
+const QSet<QString> LARGE_TABLES = {
+    u"people"_s,
+    u"names"_s,
+    u"person_primary_name"_s,
+    u"families"_s,
+    u"events"_s,
+    u"event_relations"_s,
+    u"parent_links"_s,
+    u"locations"_s,
+    u"sources"_s,
+    u"media"_s,
+    u"person_external_ids"_s,
+    u"location_external_ids"_s,
+    u"family_external_ids"_s,
+    u"event_external_ids"_s,
+    u"source_external_ids"_s,
+    u"media_external_ids"_s,
+    u"event_citations"_s,
+    u"event_relation_citations"_s,
+    u"name_citations"_s,
+    u"person_citations"_s,
+    u"person_media"_s,
+    u"name_media"_s,
+    u"event_media"_s,
+    u"event_relation_media"_s,
+    u"source_media"_s,
+    u"location_media"_s,
+};
+
+// Filters for which no index can help, so a scan is the expected plan.
+const QStringList ACCEPTED_SCANS = {
+    // Only a few distinct values, an index would not be selective.
+    u"sex = :sex"_s,
+    // Infix LIKE cannot use an index.
+    u"title LIKE :term"_s,
+};
+
+sqlite3* nativeHandle() {
+    auto qtHandle = QSqlDatabase::database().driver()->handle();
+    if (qtHandle.isValid() && qstrcmp(qtHandle.typeName(), "sqlite3*") == 0) {
+        return *static_cast<sqlite3**>(qtHandle.data());
+    }
+    return nullptr;
+}
+
+int collectStatement(unsigned int type, void* context, void* p, void* x) {
+    Q_UNUSED(x);
+    if (type == SQLITE_TRACE_STMT) {
+        auto* statements = static_cast<QStringList*>(context);
+        const auto sql = QString::fromUtf8(sqlite3_sql(static_cast<sqlite3_stmt*>(p)));
+        if (!statements->contains(sql)) {
+            statements->append(sql);
+        }
+    }
+    return 0;
+}
+
+struct PlanRow {
+    int id;
+    int parent;
+    QString detail;
+};
+
+struct Plan {
+    QList<PlanRow> rows;
+    int parameterCount = 0;
+};
+
+std::optional<Plan> explain(sqlite3* handle, const QString& sql) {
+    const auto explainSql = (u"EXPLAIN QUERY PLAN "_s + sql).toUtf8();
+    sqlite3_stmt* statement = nullptr;
+    if (sqlite3_prepare_v2(handle, explainSql.constData(), -1, &statement, nullptr) != SQLITE_OK) {
+        qWarning() << "Could not explain" << sql << sqlite3_errmsg(handle);
+        sqlite3_finalize(statement);
+        return std::nullopt;
+    }
+
+    // Parameters are left unbound (NULL); the plan does not depend on their values.
+    Plan plan;
+    plan.parameterCount = sqlite3_bind_parameter_count(statement);
+    while (sqlite3_step(statement) == SQLITE_ROW) {
+        plan.rows.append(
+            {.id = sqlite3_column_int(statement, 0),
+             .parent = sqlite3_column_int(statement, 1),
+             .detail = QString::fromUtf8(reinterpret_cast<const char*>(sqlite3_column_text(statement, 3)))}
+        );
+    }
+    sqlite3_finalize(statement);
+    return plan;
+}
+
+// Plans refer to tables by their alias, so map the aliases back to the table names.
+QHash<QString, QString> tableAliases(const QString& sql) {
+    static const QRegularExpression reference(
+        u"\\b(?:FROM|JOIN|UPDATE|INTO)\\s+(\\w+)(?:\\s+(?:AS\\s+)?(\\w+))?"_s,
+        QRegularExpression::CaseInsensitiveOption
+    );
+    static const QSet<QString> keywords = {
+        u"on"_s,
+        u"where"_s,
+        u"left"_s,
+        u"inner"_s,
+        u"cross"_s,
+        u"join"_s,
+        u"order"_s,
+        u"group"_s,
+        u"limit"_s,
+        u"using"_s,
+        u"union"_s,
+        u"set"_s,
+        u"values"_s,
+        u"default"_s,
+        u"select"_s,
+    };
+
+    QHash<QString, QString> aliases;
+    auto matches = reference.globalMatch(sql);
+    while (matches.hasNext()) {
+        const auto match = matches.next();
+        const auto table = match.captured(1).toLower();
+        aliases.insert(table, table);
+        const auto alias = match.captured(2).toLower();
+        if (alias.isEmpty() || keywords.contains(alias)) {
+            continue;
+        }
+        // The same alias can be reused for different tables in CTEs; keep the large one.
+        if (LARGE_TABLES.contains(aliases.value(alias))) {
+            continue;
+        }
+        aliases.insert(alias, table);
+    }
+    return aliases;
+}
+
+/**
+ * Find the problematic full scans in the plan of a statement.
+ *
+ * A scan of a large table is accepted when it is the outer loop of a statement without
+ * parameters: listing everything has to read everything anyway. It is reported when it
+ * is an inner loop of a join, when it happens in a correlated subquery (i.e. once per
+ * row), or when the statement looks up specific rows.
+ */
+QStringList findUnindexedScans(sqlite3* handle, const QString& sql) {
+    const auto plan = explain(handle, sql);
+    if (!plan) {
+        return {u"could not explain statement"_s};
+    }
+
+    QHash<int, QString> details;
+    for (const auto& row: plan->rows) {
+        details.insert(row.id, row.detail);
+    }
+
+    const auto aliases = tableAliases(sql);
+    QSet<int> parentsWithLoop;
+    QStringList problems;
+    for (const auto& [id, parent, detail]: plan->rows) {
+        const bool isScan = detail.startsWith(u"SCAN "_s);
+        if (!isScan && !detail.startsWith(u"SEARCH "_s)) {
+            continue;
+        }
+        const bool outerLoop = !parentsWithLoop.contains(parent);
+        parentsWithLoop.insert(parent);
+
+        const auto name = detail.section(u' ', 1, 1).toLower();
+        const auto table = aliases.value(name, name);
+        if (!LARGE_TABLES.contains(table)) {
+            continue;
+        }
+
+        if (detail.contains(u"AUTOMATIC"_s)) {
+            problems.append(u"temporary index needed: "_s + detail);
+        } else if (!isScan || detail.contains(u" INDEX "_s)) {
+            continue;
+        } else if (!outerLoop) {
+            problems.append(u"scan in inner loop: "_s + detail);
+        } else if (details.value(parent).startsWith(u"CORRELATED"_s)) {
+            problems.append(u"scan in correlated subquery: "_s + detail);
+        } else if (plan->parameterCount > 0) {
+            problems.append(u"scan for lookup: "_s + detail);
+        }
+    }
+    return problems;
+}
+
+bool isDataStatement(const QString& sql) {
+    static const QRegularExpression dataStatement(
+        u"^\\s*(SELECT|WITH|INSERT|UPDATE|DELETE)\\b"_s,
+        QRegularExpression::CaseInsensitiveOption
+    );
+    return dataStatement.match(sql).hasMatch();
+}
+
+}
+
+class TestQueryPlans : public QObject {
+    Q_OBJECT
+
+    QStringList statements;
+
+    // Call every repository method, so every SQL constant is executed (and traced) at least once.
+    void exerciseRepositories() {
+        PersonRepository people;
+        NameRepository names;
+        EventRepository events;
+        FamilyRepository families;
+        LocationRepository locations;
+        SourceRepository sources;
+        MediaRepository media;
+        EventTypeTranslationRepository eventTypeTranslations;
+        EventRoleTranslationRepository eventRoleTranslations;
+        LocationTypeTranslationRepository locationTypeTranslations;
+        NameOriginTranslationRepository nameOriginTranslations;
+        SourceTypeTranslationRepository sourceTypeTranslations;
+
+        const auto father = *people.insertPerson(u"Male"_s);
+        const auto child = *people.insertPerson(u"Female"_s, true);
+        const auto name = *names.insertName(child, 1);
+        names.insertName(father, 1);
+        names.updateName(name, u"Dr."_s, u"Alice"_s, u"van"_s, u"Doe"_s, u"Note"_s, std::nullopt);
+        names.updateNameSort(name, 1);
+
+        const auto birthType = *events.findEventTypeIdByName(u"Birth"_s);
+        const auto primaryRole = *events.findEventRoleIdByName(u"Primary"_s);
+        const auto fatherRole = *events.findEventRoleIdByName(u"Father"_s);
+        const auto birth = *events.insertEventWithRelation(birthType, child, primaryRole);
+        const auto relation = *events.insertEventRelation(birth, father, fatherRole);
+        events.updateEventRelationRole(relation, fatherRole);
+        const auto location = *locations.insert(u"Ghent"_s, std::nullopt, std::nullopt);
+        events.updateEvent(birth, birthType, GenealogicalDate::fromDisplayText(u"1850"_s), u"Birth"_s, {}, location);
+        events.insertFullEvent(birthType, {}, u"Birth"_s, {}, father, primaryRole);
+        const auto family = *families.createFamily();
+        families.linkEventToFamily(birth, family);
+
+        const auto sourceType = *sources.insertSourceType(u"Archive"_s);
+        const auto source = *sources.insert(u"Register"_s, sourceType, {}, {}, u"3"_s, {}, std::nullopt);
+        sources.update(source, u"Register"_s, sourceType, {}, {}, u"3"_s, {}, std::nullopt);
+        events.addEventCitation(birth, source);
+        events.addEventRelationCitation(relation, source);
+
+        const auto item = *media.insert(u"/tmp/photo.jpg"_s, u"Photo"_s, std::nullopt, u"image/jpeg"_s);
+        media.update(item, u"Photo"_s, std::nullopt);
+        media.attachToPerson(child, item);
+        media.attachToName(name, item);
+        media.attachToEvent(birth, item);
+        media.attachToEventRelation(relation, item);
+        media.attachToSource(source, item);
+        media.attachToLocation(location, item);
+
+        QVERIFY(people.findById(child).has_value());
+        QVERIFY(people.findDisplayById(child).has_value());
+        PersonCriteria criteria;
+        criteria.rootOnly = true;
+        criteria.sex = u"Female"_s;
+        QVERIFY(!people.findPeople().isEmpty());
+        QVERIFY(!people.findPeople(criteria).isEmpty());
+        QVERIFY(!people.findPeopleWithPrimaryName().isEmpty());
+        QVERIFY(!people.findPeopleWithPrimaryName(criteria).isEmpty());
+        people.updatePerson(child, u"Female"_s, true);
+
+        QVERIFY(!names.findAllOrigins().isEmpty());
+        QVERIFY(!names.findAllSurnames().isEmpty());
+        QVERIFY(!names.findAllGivenNames().isEmpty());
+        QVERIFY(!names.findNamesForPerson(child).isEmpty());
+        QVERIFY(!names.findNamesWithOriginForPerson(child).isEmpty());
+        QVERIFY(names.findById(name).has_value());
+        QVERIFY(names.findWithOriginById(name).has_value());
+
+        QVERIFY(!events.findAllEventTypes().isEmpty());
+        QVERIFY(events.findEventTypeById(birthType).has_value());
+        QVERIFY(!events.findAllEventRoles().isEmpty());
+        QVERIFY(events.findEventRoleById(primaryRole).has_value());
+        QVERIFY(events.findEventById(birth).has_value());
+        QVERIFY(!events.findAllEvents().isEmpty());
+        QVERIFY(!events.findEventsOverlapping(GenealogicalDate::fromDisplayText(u"between 1800 and 1900"_s)).isEmpty());
+        QVERIFY(!events.findRelationsForEvent(birth).isEmpty());
+        QVERIFY(!events.findRelationsForPerson(child).isEmpty());
+        QVERIFY(!events.findEventsForPerson(child).isEmpty());
+        Q_UNUSED(events.findBirthEventsForPerson(child));
+        Q_UNUSED(events.findDeathEventsForPerson(child));
+        QVERIFY(events.isEventTypeUsed(birthType));
+        QVERIFY(events.isEventRoleUsed(primaryRole));
+        QVERIFY(!events.findCitationsForEvent(birth).isEmpty());
+        QVERIFY(!events.findCitationsForEventRelation(relation).isEmpty());
+
+        Q_UNUSED(families.findFamilyMembersForPerson(child));
+        Q_UNUSED(families.findAllFamiliesOverview());
+        Q_UNUSED(families.findAncestorsForPerson(child));
+        Q_UNUSED(families.findParentsForPerson(child));
+
+        QVERIFY(!locations.findAllLocationTypes().isEmpty());
+        QVERIFY(!locations.findAll().isEmpty());
+        QVERIFY(!locations.findAllWithPaths().isEmpty());
+        QVERIFY(locations.findById(location).has_value());
+        QVERIFY(locations.isUsed(location));
+        QVERIFY(!locations.hasChildren(location));
+        QVERIFY(locations.findOrCreate(u"Ghent"_s, std::nullopt, std::nullopt).has_value());
+        QVERIFY(locations.findOrCreate(u"Center"_s, std::nullopt, location).has_value());
+        const auto locationType = *locations.insertLocationType(u"Hamlet"_s);
+        QVERIFY(locations.findLocationTypeById(locationType).has_value());
+        QVERIFY(!locations.isLocationTypeUsed(locationType));
+        locations.updateLocationType(locationType, u"Village"_s);
+        locations.update(location, u"Ghent"_s, locationType, std::nullopt, {}, std::nullopt, {}, {});
+
+        QVERIFY(!sources.findAll().isEmpty());
+        QVERIFY(sources.findById(source).has_value());
+        QVERIFY(!sources.findByTitleContaining(u"Reg"_s).isEmpty());
+        QVERIFY(!sources.findAllSourceTypes().isEmpty());
+        QVERIFY(sources.findSourceTypeById(sourceType).has_value());
+        QVERIFY(sources.isSourceTypeUsed(sourceType));
+        sources.updateSourceType(sourceType, u"Archives"_s);
+
+        QVERIFY(!media.findAll().isEmpty());
+        QVERIFY(media.findById(item).has_value());
+        QVERIFY(!media.findForPerson(child).isEmpty());
+        QVERIFY(!media.findForName(name).isEmpty());
+        QVERIFY(!media.findForEvent(birth).isEmpty());
+        QVERIFY(!media.findForEventRelation(relation).isEmpty());
+        QVERIFY(!media.findForSource(source).isEmpty());
+        QVERIFY(!media.findForLocation(location).isEmpty());
+
+        const auto eventType = eventTypeTranslations.insert(birthType, u"nl"_s, u"Geboorte"_s);
+        Q_UNUSED(eventTypeTranslations.findAllForType(birthType));
+        Q_UNUSED(eventTypeTranslations.findByTypeIdAndLocale(birthType, u"nl"_s));
+        Q_UNUSED(eventTypeTranslations.findByTypeStringAndLocale(u"Birth"_s, u"nl"_s));
+        const auto eventRole = eventRoleTranslations.insert(primaryRole, u"nl"_s, u"Hoofdpersoon"_s);
+        Q_UNUSED(eventRoleTranslations.findAllForType(primaryRole));
+        Q_UNUSED(eventRoleTranslations.findByTypeIdAndLocale(primaryRole, u"nl"_s));
+        Q_UNUSED(eventRoleTranslations.findByTypeStringAndLocale(u"Primary"_s, u"nl"_s));
+        const auto locationTypeTranslation = locationTypeTranslations.insert(locationType, u"nl"_s, u"Dorp"_s);
+        Q_UNUSED(locationTypeTranslations.findAllForType(locationType));
+        Q_UNUSED(locationTypeTranslations.findByTypeIdAndLocale(locationType, u"nl"_s));
+        Q_UNUSED(locationTypeTranslations.findByTypeStringAndLocale(u"Village"_s, u"nl"_s));
+        const auto origin = names.findAllOrigins().first().id;
+        const auto originTranslation = nameOriginTranslations.insert(origin, u"nl"_s, u"Onbekend"_s);
+        Q_UNUSED(nameOriginTranslations.findAllForType(origin));
+        Q_UNUSED(nameOriginTranslations.findByTypeIdAndLocale(origin, u"nl"_s));
+        Q_UNUSED(nameOriginTranslations.findByTypeStringAndLocale(u"Unknown"_s, u"nl"_s));
+        const auto sourceTypeTranslation = sourceTypeTranslations.insert(sourceType, u"nl"_s, u"Archief"_s);
+        Q_UNUSED(sourceTypeTranslations.findAllForType(sourceType));
+        Q_UNUSED(sourceTypeTranslations.findByTypeIdAndLocale(sourceType, u"nl"_s));
+        Q_UNUSED(sourceTypeTranslations.findByTypeStringAndLocale(u"Archives"_s, u"nl"_s));
+        eventTypeTranslations.remove(*eventType);
+        eventRoleTranslations.remove(*eventRole);
+        locationTypeTranslations.remove(*locationTypeTranslation);
+        nameOriginTranslations.remove(*originTranslation);
+        sourceTypeTranslations.remove(*sourceTypeTranslation);
+
+        // Everything that changes or removes data, in dependency order.
+        media.detachFromPerson(child, item);
+        media.detachFromName(name, item);
+        media.detachFromEvent(birth, item);
+        media.detachFromEventRelation(relation, item);
+        media.detachFromSource(source, item);
+        media.detachFromLocation(location, item);
+        media.remove(item);
+        events.removeEventCitation(birth, source);
+        events.removeEventRelationCitation(relation, source);
+        sources.remove(source);
+        sources.deleteSourceType(sourceType);
+
+        const auto otherType = *events.insertEventType(u"Graduation"_s);
+        events.updateEventType(otherType, u"Promotion"_s);
+        events.reassignEventTypeId(otherType, birthType);
+        events.deleteEventType(otherType);
+        const auto otherRole = *events.insertEventRole(u"Teacher"_s);
+        events.updateEventRole(otherRole, u"Mentor"_s);
+        events.reassignEventRoleId(otherRole, primaryRole);
+        events.deleteEventRole(otherRole);
+
+        events.deleteEventRelation(relation);
+        events.deleteEvent(birth);
+        locations.deleteLocation(location);
+        locations.deleteLocationType(locationType);
+        names.deleteName(name);
+        people.deletePerson(father);
+    }
+
+private Q_SLOTS:
+    void init() {
+        QVERIFY(QSqlDatabase::isDriverAvailable(u"QSQLITE"_s));
+        openDatabase(u":memory:"_s, false);
+        statements.clear();
+    }
+
+    void cleanup() {
+        closeDatabase();
+    }
+
+    void testRepositoryQueriesUseIndexes() {
+        auto* handle = nativeHandle();
+        QVERIFY(handle != nullptr);
+
+        sqlite3_trace_v2(handle, SQLITE_TRACE_STMT, collectStatement, &statements);
+        exerciseRepositories();
+        sqlite3_trace_v2(handle, 0, nullptr, nullptr);
+
+        QVERIFY(!statements.isEmpty());
+
+        QStringList failures;
+        for (const auto& sql: std::as_const(statements)) {
+            if (!isDataStatement(sql)) {
+                continue;
+            }
+            if (std::ranges::any_of(ACCEPTED_SCANS, [&sql](const auto& accepted) { return sql.contains(accepted); })) {
+                continue;
+            }
+            for (const auto& problem: findUnindexedScans(handle, sql)) {
+                failures.append(problem + u"\n    in: "_s + sql.simplified());
+            }
+        }
+
+        if (!failures.isEmpty()) {
+            QFAIL(qPrintable(u"Queries without a usable index:\n"_s + failures.join(u'\n')));
+        }
+    }
+
+    void testMissingIndexIsDetected() {
+        auto* handle = nativeHandle();
+        QVERIFY(handle != nullptr);
+
+        // Guard the detection itself: without the index, looking up names by person must fail.
+        QSqlQuery drop;
+        QVERIFY2(drop.exec(u"DROP INDEX idx_names_person_sort"_s), printError(drop).constData());
+
+        const auto problems = findUnindexedScans(handle, u"SELECT id FROM names n WHERE n.person_id = :id"_s);
+        QCOMPARE(problems.size(), 1);
+        QVERIFY(problems.first().contains(u"SCAN n"_s));
+    }
+};
+
+QTEST_MAIN(TestQueryPlans)
+#include "query_plan_test.moc"
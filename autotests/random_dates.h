@@ -0,0 +1,101 @@
+/*
+ * SPDX-FileCopyrightText: Niko Strijbol <niko@strijbol.be>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+#pragma once
+
+#include "dates/genealogical_date.h"
+
+#include <QRandomGenerator>
+#include <QStringList>
+
+/**
+ * A random date, with any type, modifier, quality, known parts, times and text.
+ *
+ * The missing parts of a point are 1, like the editors make them. With openEnds, some ranges and
+ * spans have an end without a year, like dates that were stored without one.
+ */
+inline GenealogicalDate randomDate(QRandomGenerator& random, bool openEnds = false) {
+    static const QStringList texts{
+        QStringLiteral(""),
+        QStringLiteral("Easter"),
+        QStringLiteral("\"quoted\" \\ /"),
+        QStringLiteral("tab\tnew\nline"),
+        QStringLiteral("ünïcødé 😀"),
+    };
+    struct Point {
+        QDate date;
+        bool year = false;
+        bool month = false;
+        bool day = false;
+    };
+    const auto randomPoint = [&random]() -> Point {
+        const auto date = QDate::fromJulianDay(random.bounded(2'000'000, 2'600'000));
+        switch (random.bounded(3)) {
+            case 0:
+                return {QDate(date.year(), 1, 1), true, false, false};
+            case 1:
+                return {QDate(date.year(), date.month(), 1), true, true, false};
+            default:
+                return {date, true, true, true};
+        }
+    };
+    const auto randomTime = [&random]() {
+        return random.bounded(2) == 0 ? QTime() : QTime(random.bounded(24), random.bounded(60));
+    };
+
+    const auto quality = static_cast<GenealogicalDate::Quality>(random.bounded(3));
+    const auto from = randomPoint();
+    auto to = randomPoint();
+    if (openEnds && random.bounded(4) == 0) {
+        to = {};
+    }
+    GenealogicalDate date;
+    switch (random.bounded(4)) {
+        case 0:
+            date = GenealogicalDate::makeRange(
+                quality,
+                from.date,
+                from.year,
+                from.month,
+                from.day,
+                to.date,
+                to.year,
+                to.month,
+                to.day
+            );
+            date.setEndTime(randomTime());
+            break;
+        case 1:
+            date = GenealogicalDate::makeSpan(
+                quality,
+                from.date,
+                from.year,
+                from.month,
+                from.day,
+                to.date,
+                to.year,
+                to.month,
+                to.day
+            );
+            date.setEndTime(randomTime());
+            break;
+        case 2:
+            // Only a text.
+            date = GenealogicalDate(GenealogicalDate::NONE, quality, {}, false, false, false, texts[1]);
+            break;
+        default:
+            date = GenealogicalDate(
+                static_cast<GenealogicalDate::Modifier>(random.bounded(5)),
+                quality,
+                from.date,
+                from.year,
+                from.month,
+                from.day,
+                texts[random.bounded(texts.size())]
+            );
+    }
+    date.setStartTime(randomTime());
+    return date;
+}
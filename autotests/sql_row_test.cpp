@@ -0,0 +1,174 @@
+/*
+ * SPDX-FileCopyrightText: Niko Strijbol <niko@strijbol.be>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+// ReSharper disable CppMemberFunctionMayBeStatic
+// ReSharper disable CppMemberFunctionMayBeConst
+#include "./test_utils.h"
+#include "core/sql_row.h"
+#include "database/database.h"
+#include "domain/person/person_entities.h"
+#include "domain/person/person_repository.h"
+
+#include <QRegularExpression>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTest>
+
+using namespace Qt::Literals::StringLiterals;
+
+static_assert(PersonDisplayEntity::Columns::size == 8);
+static_assert(PersonDisplayEntity::Columns::indexOf<u"id">() == 0);
+static_assert(PersonDisplayEntity::Columns::indexOf<u"titles">() == 3);
+static_assert(RowMapped<PersonDisplayEntity>);
+static_assert((ColumnName(u"date") + ColumnName(u"_sort")).view() == u"date_sort");
+static_assert(SqlColumns<u"id", u"name">::Join<SqlColumns<u"note">>::size == 3);
+static_assert(SqlColumns<u"id", u"name">::Join<SqlColumns<u"note">>::indexOf<u"note">() == 2);
+
+namespace {
+constexpr int BENCHMARK_ROWS = 100'000;
+
+const auto DISPLAY_SQL = u"SELECT p.id, p.root, p.sex, n.titles, n.given_names, n.prefix, n.surname, pn.display_name "
+                         u"FROM people p JOIN person_primary_name pn ON pn.person_id = p.id "
+                         u"JOIN names n ON n.id = pn.name_id"_s;
+
+// The mapping as it was before the column declarations, to compare against.
+PersonDisplayEntity mapByName(const QSqlQuery& query) {
+    PersonDisplayEntity p;
+    p.id = query.value(u"id"_s).toLongLong();
+    p.root = query.value(u"root"_s).toBool();
+    p.sex = query.value(u"sex"_s).toString();
+    p.titles = query.value(u"titles"_s).toString();
+    p.givenNames = query.value(u"given_names"_s).toString();
+    p.prefix = query.value(u"prefix"_s).toString();
+    p.surname = query.value(u"surname"_s).toString();
+    p.displayName = query.value(u"display_name"_s).toString();
+    return p;
+}
+}
+
+class TestSqlRow : public QObject {
+    Q_OBJECT
+
+private Q_SLOTS:
+    void init() {
+        QVERIFY(QSqlDatabase::isDriverAvailable(u"QSQLITE"_s));
+        openDatabase(u":memory:"_s, false);
+    }
+
+    void cleanup() {
+        closeDatabase();
+    }
+
+    void testColumnsAreReadByPosition() {
+        PersonRepository().insertPerson(u"Female"_s, true);
+
+        // The order of the result differs from the order of the declaration.
+        QSqlQuery query;
+        QVERIFY(query.exec(u"SELECT sex, 'unused' AS other, root, id FROM people"_s));
+        const PersonEntity::Columns::Row row(query);
+        QCOMPARE(row.position<u"id">(), 3);
+        QCOMPARE(row.position<u"sex">(), 0);
+
+        QVERIFY(query.next());
+        const auto person = PersonEntity::fromSql(row);
+        QCOMPARE(person.id, IntegerPrimaryKey{1});
+        QCOMPARE(person.root, true);
+        QCOMPARE(person.sex, u"Female"_s);
+    }
+
+    void testRowFollowsQuery() {
+        PersonRepository repository;
+        repository.insertPerson(u"Male"_s);
+        repository.insertPerson(u"Female"_s);
+
+        QSqlQuery query;
+        QVERIFY(query.exec(u"SELECT id, root, sex FROM people ORDER BY id"_s));
+        const PersonEntity::Columns::Row row(query);
+
+        QStringList sexes;
+        while (query.next()) {
+            sexes << PersonEntity::fromSql(row).sex;
+        }
+        QCOMPARE(sexes, QStringList({u"Male"_s, u"Female"_s}));
+    }
+
+    void testBaseEntityIsMappedFromSubset() {
+        const auto id = PersonRepository().insertPerson(u"Male"_s);
+        QVERIFY(id.has_value());
+        insertQuery(
+            u"INSERT INTO names (person_id, sort, titles, given_names, prefix, surname) "
+            u"VALUES (%1, 1, 'Dr.', 'Jan', 'van', 'Dijk')"_s.arg(*id)
+        );
+
+        QSqlQuery query;
+        QVERIFY(query.exec(DISPLAY_SQL));
+        const PersonDisplayEntity::Columns::Row row(query);
+        QVERIFY(query.next());
+
+        const auto person = PersonDisplayEntity::fromSql(row);
+        QCOMPARE(person.id, *id);
+        QCOMPARE(person.sex, u"Male"_s);
+        QCOMPARE(person.givenNames, u"Jan"_s);
+        QCOMPARE(person.surname, u"Dijk"_s);
+        QCOMPARE(person.displayName, u"Dr. Jan van Dijk"_s);
+    }
+
+    void testMissingColumnIsInvalid() {
+        PersonRepository().insertPerson(u"Male"_s);
+
+        QSqlQuery query;
+        QVERIFY(query.exec(u"SELECT id, sex FROM people"_s));
+        QTest::ignoreMessage(QtWarningMsg, QRegularExpression(u"Column \"root\" is not in the result of"_s));
+        const PersonEntity::Columns::Row row(query);
+        QVERIFY(query.next());
+
+        QCOMPARE(row.position<u"root">(), -1);
+        QVERIFY(!row.value<u"root">().isValid());
+        QCOMPARE(PersonEntity::fromSql(row).sex, u"Male"_s);
+    }
+
+    void benchmarkMapping_data() {
+        QTest::addColumn<bool>("byPosition");
+        QTest::newRow("name lookup per row") << false;
+        QTest::newRow("positions per result set") << true;
+    }
+
+    void benchmarkMapping() {
+        QFETCH(bool, byPosition);
+
+        QSqlQuery setup;
+        QVERIFY(setup.exec(
+            u"WITH RECURSIVE counter(x) AS (SELECT 1 UNION ALL SELECT x + 1 FROM counter WHERE x < %1) "
+            u"INSERT INTO people (id, root, sex) SELECT x, false, 'Male' FROM counter"_s.arg(BENCHMARK_ROWS)
+        ));
+        QVERIFY(setup.exec(
+            u"INSERT INTO names (person_id, sort, titles, given_names, prefix, surname) "
+            u"SELECT id, 1, '', 'Given ' || id, '', 'Surname' FROM people"_s
+        ));
+
+        QList<PersonDisplayEntity> results;
+        results.reserve(BENCHMARK_ROWS);
+        QBENCHMARK {
+            results.clear();
+            QSqlQuery query;
+            query.setForwardOnly(true);
+            query.exec(DISPLAY_SQL);
+            if (byPosition) {
+                const PersonDisplayEntity::Columns::Row row(query);
+                while (query.next()) {
+                    results << PersonDisplayEntity::fromSql(row);
+                }
+            } else {
+                while (query.next()) {
+                    results << mapByName(query);
+                }
+            }
+        }
+        QCOMPARE(results.size(), BENCHMARK_ROWS);
+    }
+};
+
+QTEST_MAIN(TestSqlRow)
+#include "sql_row_test.moc"
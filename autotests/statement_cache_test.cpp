@@ -0,0 +1,247 @@
+/*
+ * SPDX-FileCopyrightText: Niko Strijbol <niko@strijbol.be>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+// ReSharper disable CppMemberFunctionMayBeStatic
+// ReSharper disable CppMemberFunctionMayBeConst
+#include "./test_utils.h"
+#include "core/query_helper.h"
+#include "core/statement_cache.h"
+#include "database/database.h"
+#include "domain/person/person_repository.h"
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTest>
+
+using namespace Qt::Literals::StringLiterals;
+
+class TestStatementCache : public QObject {
+    Q_OBJECT
+
+private Q_SLOTS:
+    void init() {
+        QVERIFY(QSqlDatabase::isDriverAvailable(u"QSQLITE"_s));
+        openDatabase(u":memory:"_s, false);
+        StatementCache::forCurrentThread().setCapacity(StatementCache::DEFAULT_CAPACITY);
+        StatementCache::forCurrentThread().resetStats();
+    }
+
+    void cleanup() {
+        closeDatabase();
+    }
+
+    void testFirstExecutionIsMissSecondIsHit() {
+        auto& cache = StatementCache::forCurrentThread();
+        const auto sql = u"SELECT id FROM people WHERE id = :id"_s;
+
+        {
+            auto [first, ok1] = QueryHelper::executeCached(sql, {{u":id"_s, 1}});
+            QVERIFY(ok1);
+        }
+        QCOMPARE(cache.stats().misses, 1);
+        QCOMPARE(cache.stats().hits, 0);
+
+        {
+            auto [second, ok2] = QueryHelper::executeCached(sql, {{u":id"_s, 2}});
+            QVERIFY(ok2);
+        }
+        QCOMPARE(cache.stats().misses, 1);
+        QCOMPARE(cache.stats().hits, 1);
+        QCOMPARE(cache.size(), 1);
+    }
+
+    void testRepositoryCallsReuseStatements() {
+        auto& cache = StatementCache::forCurrentThread();
+        PersonRepository repo;
+        auto id = repo.insertPerson(u"Male"_s);
+        QVERIFY(id.has_value());
+        repo.insertPerson(u"Female"_s);
+
+        QVERIFY(repo.findById(*id).has_value());
+        QVERIFY(repo.findById(*id).has_value());
+        QCOMPARE(repo.findPeopleWithPrimaryName().size(), 2);
+        QCOMPARE(repo.findPeopleWithPrimaryName().size(), 2);
+
+        // One miss each for the insert, findById and findPeopleWithPrimaryName statements.
+        QCOMPARE(cache.stats().misses, 3);
+        QCOMPARE(cache.stats().hits, 3);
+    }
+
+    void testBindingsDoNotLeakBetweenExecutions() {
+        insertQuery(u"INSERT INTO people (root, sex) VALUES (false, 'Male')"_s);
+        const auto sql = u"SELECT COUNT(*) FROM people WHERE sex = :sex"_s;
+
+        {
+            auto [first, ok1] = QueryHelper::executeCached(sql, {{u":sex"_s, u"Male"_s}});
+            QVERIFY(ok1);
+            QVERIFY(first->next());
+            QCOMPARE(first->value(0).toInt(), 1);
+        }
+
+        // Without bindings, the placeholder must be NULL again, not the previous value.
+        auto [second, ok2] = QueryHelper::executeCached(sql);
+        QVERIFY(ok2);
+        QVERIFY(second->next());
+        QCOMPARE(second->value(0).toInt(), 0);
+    }
+
+    void testReleasedLeaseResetsStatement() {
+        auto& cache = StatementCache::forCurrentThread();
+        insertQuery(u"INSERT INTO people (root, sex) VALUES (false, 'Male')"_s);
+        insertQuery(u"INSERT INTO people (root, sex) VALUES (false, 'Female')"_s);
+        const auto sql = u"SELECT id FROM people ORDER BY id"_s;
+
+        {
+            // Stop in the middle of the results.
+            auto [first, ok1] = QueryHelper::executeCached(sql);
+            QVERIFY(ok1);
+            QVERIFY(first->next());
+        }
+
+        // The statement went back to the cache and starts from the first row again.
+        auto [second, ok2] = QueryHelper::executeCached(sql);
+        QVERIFY(ok2);
+        QVERIFY(second->next());
+        QVERIFY(second->next());
+        QVERIFY(!second->next());
+        QCOMPARE(cache.stats().hits, 1);
+        QCOMPARE(cache.stats().misses, 1);
+    }
+
+    void testReleaseGivesStatementBack() {
+        auto& cache = StatementCache::forCurrentThread();
+        const auto sql = u"SELECT id FROM people"_s;
+
+        auto [first, ok1] = QueryHelper::executeCached(sql);
+        QVERIFY(ok1);
+        first.release();
+        auto [second, ok2] = QueryHelper::executeCached(sql);
+        QVERIFY(ok2);
+
+        QCOMPARE(cache.stats().hits, 1);
+        QCOMPARE(cache.stats().misses, 1);
+    }
+
+    void testInvalidStatementGivesEmptyLease() {
+        auto [query, ok] = QueryHelper::executeCached(u"SELECT nothing FROM nowhere"_s);
+        QVERIFY(!ok);
+        // An empty lease can be released or destroyed without a connection.
+        query.release();
+    }
+
+    void testLeaseOutlivesClearedCache() {
+        auto& cache = StatementCache::forCurrentThread();
+        const auto sql = u"SELECT id FROM people"_s;
+
+        {
+            auto [query, ok] = QueryHelper::executeCached(sql);
+            QVERIFY(ok);
+            cache.clear();
+            QCOMPARE(cache.size(), 0);
+        }
+
+        // The released statement was not put back in the cleared cache.
+        QCOMPARE(cache.size(), 0);
+        auto [again, ok2] = QueryHelper::executeCached(sql);
+        QVERIFY(ok2);
+        QCOMPARE(cache.stats().misses, 2);
+    }
+
+    void testActiveStatementIsNotReused() {
+        auto& cache = StatementCache::forCurrentThread();
+        insertQuery(u"INSERT INTO people (root, sex) VALUES (false, 'Male')"_s);
+        const auto sql = u"SELECT id FROM people"_s;
+
+        auto [outer, ok1] = QueryHelper::executeCached(sql);
+        QVERIFY(ok1);
+        QVERIFY(outer->next());
+
+        {
+            auto [inner, ok2] = QueryHelper::executeCached(sql);
+            QVERIFY(ok2);
+            QVERIFY(inner->next());
+        }
+
+        // The outer query must still be positioned on its row.
+        QVERIFY(outer->isActive());
+        QVERIFY(!outer->next());
+
+        QCOMPARE(cache.stats().misses, 2);
+        QCOMPARE(cache.size(), 1);
+    }
+
+    void testLeastRecentlyUsedStatementIsEvicted() {
+        auto& cache = StatementCache::forCurrentThread();
+        cache.setCapacity(2);
+
+        const auto a = u"SELECT 1"_s;
+        const auto b = u"SELECT 2"_s;
+        const auto c = u"SELECT 3"_s;
+
+        for (const auto& sql: {a, b, a, c}) {
+            auto [query, ok] = QueryHelper::executeCached(sql);
+            QVERIFY(ok);
+        }
+
+        QCOMPARE(cache.size(), 2);
+        QCOMPARE(cache.stats().evictions, 1);
+
+        // "b" was the least recently used, so "a" is still cached.
+        cache.resetStats();
+        auto [query, ok] = QueryHelper::executeCached(a);
+        QVERIFY(ok);
+        QCOMPARE(cache.stats().hits, 1);
+    }
+
+    void testReopeningDatabaseDropsStatements() {
+        auto& cache = StatementCache::forCurrentThread();
+        {
+            auto [query, ok] = QueryHelper::executeCached(u"SELECT id FROM people"_s);
+            QVERIFY(ok);
+        }
+        QCOMPARE(cache.size(), 1);
+
+        closeDatabase();
+        openDatabase(u":memory:"_s, false);
+
+        QCOMPARE(cache.size(), 0);
+        auto [again, ok2] = QueryHelper::executeCached(u"SELECT id FROM people"_s);
+        QVERIFY(ok2);
+    }
+
+    void benchmarkFetch_data() {
+        QTest::addColumn<bool>("cached");
+        QTest::newRow("prepare every call") << false;
+        QTest::newRow("statement cache") << true;
+    }
+
+    void benchmarkFetch() {
+        QFETCH(bool, cached);
+        PersonRepository repo;
+        for (int i = 0; i < 100; ++i) {
+            repo.insertPerson(u"Unknown"_s);
+        }
+
+        const auto sql = u"SELECT p.id, p.root, p.sex, n.titles, n.given_names, n.prefix, n.surname "
+                         u"FROM people p "
+                         u"LEFT JOIN names n ON p.id = n.person_id "
+                         u"AND n.sort = (SELECT MIN(n2.sort) FROM names n2 WHERE n2.person_id = p.id) "
+                         u"WHERE p.id = :id"_s;
+
+        QBENCHMARK {
+            if (cached) {
+                auto [query, ok] = QueryHelper::executeCached(sql, {{u":id"_s, 50}});
+                query->next();
+            } else {
+                auto [query, ok] = QueryHelper::executeWithResult(sql, {{u":id"_s, 50}});
+                query.next();
+                query.finish();
+            }
+        }
+    }
+};
+
+QTEST_MAIN(TestStatementCache)
+#include "statement_cache_test.moc"
@@ -0,0 +1,230 @@
+/*
+ * SPDX-FileCopyrightText: Niko Strijbol <niko@strijbol.be>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+// ReSharper disable CppMemberFunctionMayBeStatic
+// ReSharper disable CppMemberFunctionMayBeConst
+#include "tree_view/tidy_tree_layout.h"
+
+#include <QRandomGenerator>
+#include <QTest>
+#include <algorithm>
+
+using Key = TidyTreeLayout::Key;
+
+namespace {
+constexpr Key BENCHMARK_NODES = 10'000;
+
+/**
+ * A complete binary tree, like a pedigree, with nodes 1 to count.
+ */
+void buildBinaryTree(TidyTreeLayout& layout, Key count) {
+    layout.setRoot(1);
+    for (Key node = 1; 2 * node <= count; ++node) {
+        QList<Key> children{2 * node};
+        if (2 * node + 1 <= count) {
+            children.append(2 * node + 1);
+        }
+        layout.setChildren(node, children);
+    }
+}
+
+/**
+ * A random tree with nodes 1 to count.
+ */
+QList<QList<Key>> randomTree(QRandomGenerator& random, Key count) {
+    QList<QList<Key>> children(count + 1);
+    for (Key node = 2; node <= count; ++node) {
+        children[random.bounded(1u, node)].append(node);
+    }
+    return children;
+}
+
+void build(TidyTreeLayout& layout, const QList<QList<Key>>& children) {
+    layout.setRoot(1);
+    for (Key node = 1; node < children.size(); ++node) {
+        if (!children[node].isEmpty()) {
+            layout.setChildren(node, children[node]);
+        }
+    }
+}
+
+void verifyNoOverlap(const TidyTreeLayout& layout, double spacing) {
+    QHash<double, QList<double>> levels;
+    for (const auto node: layout.visibleNodes()) {
+        const auto position = layout.position(node);
+        levels[position.y()].append(position.x());
+    }
+    for (auto& level: levels) {
+        std::ranges::sort(level);
+        for (qsizetype i = 1; i < level.size(); ++i) {
+            QVERIFY(level[i] - level[i - 1] >= spacing - 1e-9);
+        }
+    }
+}
+}
+
+class TestTidyTreeLayout : public QObject {
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testSingleNodeIsAtOrigin() {
+        TidyTreeLayout layout;
+        layout.setRoot(7);
+
+        QCOMPARE(layout.layout(), QList<Key>{7});
+        QCOMPARE(layout.position(7), QPointF(0, 0));
+        QVERIFY(layout.isVisible(7));
+        QVERIFY(!layout.isVisible(8));
+    }
+
+    void testParentIsCenteredAboveChildren() {
+        TidyTreeLayout layout;
+        layout.setSpacing({.siblings = 2, .subtrees = 3, .levels = 5});
+        layout.setRoot(1);
+        layout.setChildren(1, {2, 3, 4});
+        layout.layout();
+
+        QCOMPARE(layout.position(1), QPointF(0, 0));
+        QCOMPARE(layout.position(2), QPointF(-2, 5));
+        QCOMPARE(layout.position(3), QPointF(0, 5));
+        QCOMPARE(layout.position(4), QPointF(2, 5));
+    }
+
+    void testChildrenAlreadyInTreeAreSkipped() {
+        TidyTreeLayout layout;
+        layout.setRoot(1);
+        layout.setChildren(1, {2, 3});
+        layout.setChildren(2, {4});
+        layout.setChildren(3, {4, 5});
+
+        QCOMPARE(layout.children(2), QList<Key>{4});
+        QCOMPARE(layout.children(3), QList<Key>{5});
+    }
+
+    void testNodesDoNotOverlap() {
+        QRandomGenerator random(42);
+        for (int run = 0; run < 50; ++run) {
+            TidyTreeLayout layout;
+            layout.setSpacing({.siblings = 1, .subtrees = 2, .levels = 1});
+            build(layout, randomTree(random, 200));
+            QCOMPARE(layout.layout().size(), 200);
+            verifyNoOverlap(layout, 1);
+        }
+    }
+
+    void testCollapsedNodeHidesDescendants() {
+        TidyTreeLayout layout;
+        buildBinaryTree(layout, 7);
+        layout.layout();
+
+        layout.setCollapsed(2, true);
+        layout.layout();
+
+        QVERIFY(layout.isCollapsed(2));
+        QVERIFY(layout.isVisible(2));
+        QVERIFY(!layout.isVisible(4));
+        QVERIFY(!layout.isVisible(5));
+        QVERIFY(layout.isVisible(6));
+        QCOMPARE(layout.visibleNodes().size(), 5);
+
+        layout.setCollapsed(2, false);
+        layout.layout();
+        QCOMPARE(layout.visibleNodes().size(), 7);
+    }
+
+    void testIncrementalLayoutMatchesFullLayout() {
+        QRandomGenerator random(7);
+        for (int run = 0; run < 50; ++run) {
+            constexpr Key count = 100;
+            auto children = randomTree(random, count);
+            TidyTreeLayout incremental;
+            build(incremental, children);
+            incremental.layout();
+
+            for (int step = 0; step < 10; ++step) {
+                const auto node = random.bounded(1u, count + 1);
+                if (!incremental.contains(node)) {
+                    continue;
+                }
+                if (random.bounded(2) == 0) {
+                    incremental.setCollapsed(node, !incremental.isCollapsed(node));
+                } else {
+                    // Drop the last child of the node, with its descendants.
+                    auto current = incremental.children(node);
+                    if (!current.isEmpty()) {
+                        current.removeLast();
+                    }
+                    incremental.setChildren(node, current);
+                }
+                incremental.layout();
+
+                TidyTreeLayout full;
+                full.setRoot(1);
+                QList<Key> queue{1};
+                for (qsizetype next = 0; next < queue.size(); ++next) {
+                    full.setChildren(queue[next], incremental.children(queue[next]));
+                    full.setCollapsed(queue[next], incremental.isCollapsed(queue[next]));
+                    queue.append(incremental.children(queue[next]));
+                }
+                full.layout();
+
+                auto visible = incremental.visibleNodes();
+                auto expected = full.visibleNodes();
+                std::ranges::sort(visible);
+                std::ranges::sort(expected);
+                QCOMPARE(visible, expected);
+                for (const auto key: expected) {
+                    QCOMPARE(incremental.position(key), full.position(key));
+                }
+            }
+        }
+    }
+
+    void testUnchangedOutlineOnlyLaysOutSubtree() {
+        TidyTreeLayout layout;
+        layout.setRoot(0);
+        layout.setChildren(0, {1, 2});
+        layout.setChildren(1, {3, 4});
+        layout.setChildren(2, {5, 6});
+        layout.layout();
+        const auto before = layout.position(2);
+
+        // Other children, but the same shape.
+        layout.setChildren(1, {7, 8});
+        auto laidOut = layout.layout();
+        std::ranges::sort(laidOut);
+
+        QCOMPARE(laidOut, QList<Key>({1, 7, 8}));
+        QCOMPARE(layout.position(2), before);
+        QVERIFY(!layout.contains(3));
+    }
+
+    void benchmarkFullLayout() {
+        TidyTreeLayout layout;
+        layout.setSpacing({.siblings = 300, .subtrees = 360, .levels = 150});
+        QBENCHMARK {
+            buildBinaryTree(layout, BENCHMARK_NODES);
+            layout.layout();
+        }
+        QCOMPARE(layout.visibleNodes().size(), qsizetype{BENCHMARK_NODES});
+    }
+
+    void benchmarkCollapse() {
+        TidyTreeLayout layout;
+        layout.setSpacing({.siblings = 300, .subtrees = 360, .levels = 150});
+        buildBinaryTree(layout, BENCHMARK_NODES);
+        layout.layout();
+
+        // The tree gets narrower, so the nodes around the collapsed node move closer.
+        constexpr Key collapsed = BENCHMARK_NODES / 8;
+        QBENCHMARK {
+            layout.setCollapsed(collapsed, !layout.isCollapsed(collapsed));
+            layout.layout();
+        }
+    }
+};
+
+QTEST_GUILESS_MAIN(TestTidyTreeLayout)
+#include "tidy_tree_layout_test.moc"
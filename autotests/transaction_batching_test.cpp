@@ -339,7 +339,14 @@ private Q_SLOTS:
         auto result = executeInTransaction([&]() -> std::optional<IntegerPrimaryKey> {
             EventRepository repo;
 
-            auto eventId = repo.insertFullEvent(typeId, u"1900-01-01"_s, u"Test"_s, u"Note"_s, personId, roleId);
+            auto eventId = repo.insertFullEvent(
+                typeId,
+                GenealogicalDate::fromDisplayText(u"1900-01-01"_s),
+                u"Test"_s,
+                u"Note"_s,
+                personId,
+                roleId
+            );
             VERIFY_OR_THROW(eventId.has_value());
 
             // Nothing should have been emitted yet.
@@ -355,7 +362,7 @@ private Q_SLOTS:
         EventRepository repo;
         auto event = repo.findEventById(*result);
         QVERIFY(event.has_value());
-        QCOMPARE(event->date, u"1900-01-01"_s);
+        QCOMPARE(event->date.toDisplayText(), u"1900-01-01"_s);
         QCOMPARE(event->name, u"Test"_s);
         QCOMPARE(event->note, u"Note"_s);
 
@@ -484,7 +491,14 @@ private Q_SLOTS:
         auto roleId = insertEventRole();
         spy.clear();
 
-        auto result = EventRepository().insertFullEvent(typeId, u"1900-01-01"_s, u"Test"_s, u""_s, personId, roleId);
+        auto result = EventRepository().insertFullEvent(
+            typeId,
+            GenealogicalDate::fromDisplayText(u"1900-01-01"_s),
+            u"Test"_s,
+            u""_s,
+            personId,
+            roleId
+        );
         QVERIFY(result.has_value());
 
         // Check that Events and EventRelations notifications were emitted.
@@ -508,16 +522,21 @@ private Q_SLOTS:
         auto personId = insertPerson();
         auto roleId = insertEventRole();
 
-        auto eventId =
-            EventRepository()
-                .insertFullEvent(typeId, u"1950-06-15"_s, u"Birth of John"_s, u"<p>Hospital</p>"_s, personId, roleId);
+        auto eventId = EventRepository().insertFullEvent(
+            typeId,
+            GenealogicalDate::fromDisplayText(u"1950-06-15"_s),
+            u"Birth of John"_s,
+            u"<p>Hospital</p>"_s,
+            personId,
+            roleId
+        );
         QVERIFY(eventId.has_value());
 
         EventRepository repo;
         auto event = repo.findEventById(*eventId);
         QVERIFY(event.has_value());
         QCOMPARE(event->typeId, typeId);
-        QCOMPARE(event->date, u"1950-06-15"_s);
+        QCOMPARE(event->date.toDisplayText(), u"1950-06-15"_s);
         QCOMPARE(event->name, u"Birth of John"_s);
         QCOMPARE(event->note, u"<p>Hospital</p>"_s);
 
@@ -542,11 +561,24 @@ private Q_SLOTS:
             EventRepository repo;
 
             // Simulate what EventEditorDialog::accept() does.
-            auto eventId = repo.insertFullEvent(typeId, u"1900-01-01"_s, u"Test"_s, u""_s, personId, roleId);
+            auto eventId = repo.insertFullEvent(
+                typeId,
+                GenealogicalDate::fromDisplayText(u"1900-01-01"_s),
+                u"Test"_s,
+                u""_s,
+                personId,
+                roleId
+            );
             VERIFY_OR_THROW(eventId.has_value());
 
             // Additional operations that would fail without batching.
-            bool ok = repo.updateEvent(*eventId, typeId, u"1900-02-02"_s, u"Updated"_s, u"New note"_s);
+            bool ok = repo.updateEvent(
+                *eventId,
+                typeId,
+                GenealogicalDate::fromDisplayText(u"1900-02-02"_s),
+                u"Updated"_s,
+                u"New note"_s
+            );
             VERIFY_OR_THROW(ok);
 
             // All notifications should still be queued.
@@ -576,7 +608,14 @@ private Q_SLOTS:
         auto result = executeInTransaction([&]() -> std::optional<bool> {
             EventRepository repo;
 
-            auto eventId = repo.insertFullEvent(typeId, u"1900-01-01"_s, u"Test"_s, u""_s, personId, roleId);
+            auto eventId = repo.insertFullEvent(
+                typeId,
+                GenealogicalDate::fromDisplayText(u"1900-01-01"_s),
+                u"Test"_s,
+                u""_s,
+                personId,
+                roleId
+            );
             VERIFY_OR_THROW(eventId.has_value());
 
             bool ok = repo.addEventCitation(*eventId, sourceId);
@@ -621,7 +660,14 @@ private Q_SLOTS:
         auto result = executeInTransaction([&]() -> std::optional<bool> {
             EventRepository repo;
 
-            auto eventId = repo.insertFullEvent(typeId, u"1900-01-01"_s, u"Test"_s, u""_s, personId, roleId);
+            auto eventId = repo.insertFullEvent(
+                typeId,
+                GenealogicalDate::fromDisplayText(u"1900-01-01"_s),
+                u"Test"_s,
+                u""_s,
+                personId,
+                roleId
+            );
             VERIFY_OR_THROW(eventId.has_value());
 
             // Try to add a citation with a non-existent source — fails due to FK constraint.
@@ -793,6 +839,95 @@ private Q_SLOTS:
         DataEventBroker::instance().notifyChanged<Schema::Events>(999);
         QCOMPARE(spy.count(), 1);
     }
+
+    // ==================== Coalescing ====================
+
+    void testManyRowsCollapseToTableWideNotification() {
+        auto& broker = DataEventBroker::instance();
+        broker.setCoalesceThreshold(3);
+        QSignalSpy spy(&broker, &DataEventBroker::entityChanged);
+        QVERIFY(spy.isValid());
+
+        {
+            auto guard = broker.batchNotifications();
+            broker.notifyChanged<Schema::People>(1);
+            broker.notifyChanged<Schema::Events>(1);
+            broker.notifyChanged<Schema::People>(2);
+            broker.notifyChanged<Schema::People>(3);
+            broker.notifyChanged<Schema::People>(4);
+            broker.notifyChanged<Schema::People>(5);
+        }
+        broker.setCoalesceThreshold(DataEventBroker::DEFAULT_COALESCE_THRESHOLD);
+
+        // The table-wide notification takes the place of the first one for the table.
+        QCOMPARE(spy.count(), 2);
+        QCOMPARE(spy.at(0).at(0).toString(), Schema::People::table);
+        QCOMPARE(spy.at(0).at(1).value<std::optional<IntegerPrimaryKey>>(), std::nullopt);
+        QCOMPARE(spy.at(1).at(0).toString(), Schema::Events::table);
+        QCOMPARE(spy.at(1).at(1).value<std::optional<IntegerPrimaryKey>>(), 1);
+    }
+
+    void testRowsBelowThresholdAreNotCollapsed() {
+        auto& broker = DataEventBroker::instance();
+        broker.setCoalesceThreshold(3);
+        QSignalSpy spy(&broker, &DataEventBroker::entityChanged);
+
+        {
+            auto guard = broker.batchNotifications();
+            broker.notifyChanged<Schema::People>(1);
+            broker.notifyChanged<Schema::People>(2);
+            broker.notifyChanged<Schema::People>(3);
+            broker.notifyChanged<Schema::People>(1);
+        }
+        broker.setCoalesceThreshold(DataEventBroker::DEFAULT_COALESCE_THRESHOLD);
+
+        QCOMPARE(spy.count(), 3);
+    }
+
+    void testCollapseDoesNotLeakIntoNextBatch() {
+        auto& broker = DataEventBroker::instance();
+        broker.setCoalesceThreshold(1);
+        QSignalSpy spy(&broker, &DataEventBroker::entityChanged);
+
+        {
+            auto guard = broker.batchNotifications();
+            broker.notifyChanged<Schema::People>(1);
+            broker.notifyChanged<Schema::People>(2);
+        }
+        {
+            auto guard = broker.batchNotifications();
+            broker.notifyChanged<Schema::People>(3);
+        }
+        broker.setCoalesceThreshold(DataEventBroker::DEFAULT_COALESCE_THRESHOLD);
+
+        QCOMPARE(spy.count(), 2);
+        QCOMPARE(spy.at(1).at(1).value<std::optional<IntegerPrimaryKey>>(), 3);
+    }
+
+    void testLargeBatchFlushesOneNotification() {
+        auto& broker = DataEventBroker::instance();
+        QSignalSpy spy(&broker, &DataEventBroker::entityChanged);
+
+        {
+            auto guard = broker.batchNotifications();
+            for (IntegerPrimaryKey id = 1; id <= 50'000; ++id) {
+                broker.notifyChanged<Schema::Names>(id);
+            }
+        }
+
+        QCOMPARE(spy.count(), 1);
+        QCOMPARE(spy.at(0).at(1).value<std::optional<IntegerPrimaryKey>>(), std::nullopt);
+    }
+
+    void benchmarkLargeBatch() {
+        auto& broker = DataEventBroker::instance();
+        QBENCHMARK {
+            auto guard = broker.batchNotifications();
+            for (IntegerPrimaryKey id = 1; id <= 50'000; ++id) {
+                broker.notifyChanged<Schema::Names>(id);
+            }
+        }
+    }
 };
 
 QTEST_MAIN(TestTransactionBatching)
@@ -0,0 +1,183 @@
+/*
+ * SPDX-FileCopyrightText: Niko Strijbol <niko@strijbol.be>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+// ReSharper disable CppMemberFunctionMayBeStatic
+// ReSharper disable CppMemberFunctionMayBeConst
+#include "utils/type_translation_cache.h"
+
+#include "./test_utils.h"
+#include "database/change_capture.h"
+#include "database/database.h"
+#include "database/schema.h"
+#include "domain/event/event_role_translation_repository.h"
+#include "domain/event/event_type_translation_repository.h"
+#include "domain/location/location_type_translation_repository.h"
+#include "utils/type_translation_resolver.h"
+
+#include <QSqlDatabase>
+#include <QTest>
+
+using namespace Qt::Literals::StringLiterals;
+
+namespace {
+constexpr int BENCHMARK_TYPES = 50;
+
+TypeTranslationCache& eventTypes() {
+    return TypeTranslationCache::forTable<Schema::EventTypeTranslations>();
+}
+
+IntegerPrimaryKey insertEventType(const QString& type) {
+    return insertQuery(u"INSERT INTO event_types (type, builtin) VALUES ('%1', false)"_s.arg(type));
+}
+}
+
+class TestTypeTranslationCache : public QObject {
+    Q_OBJECT
+
+private Q_SLOTS:
+    void init() {
+        QVERIFY(QSqlDatabase::isDriverAvailable(u"QSQLITE"_s));
+        openDatabase(u":memory:"_s, false);
+    }
+
+    void cleanup() {
+        closeDatabase();
+    }
+
+    void testFindsTranslationForExactLocale() {
+        const auto typeId = insertEventType(u"Adoptie"_s);
+        EventTypeTranslationRepository repo;
+        repo.insert(typeId, u"nl"_s, u"Adoptie NL"_s);
+        repo.insert(typeId, u"fr"_s, u"Adoption"_s);
+
+        QCOMPARE(eventTypes().find(typeId, u"nl"_s), u"Adoptie NL"_s);
+        QCOMPARE(eventTypes().find(typeId, u"fr"_s), u"Adoption"_s);
+        // The fallback to the language is up to the resolver.
+        QCOMPARE(eventTypes().find(typeId, u"nl_BE"_s), std::nullopt);
+        QCOMPARE(eventTypes().find(typeId + 1, u"nl"_s), std::nullopt);
+    }
+
+    void testLoadsEachLocaleOnce() {
+        const auto first = insertEventType(u"Adoptie"_s);
+        const auto second = insertEventType(u"Doop"_s);
+        EventTypeTranslationRepository repo;
+        repo.insert(first, u"en"_s, u"Adoption"_s);
+        repo.insert(second, u"en"_s, u"Baptism"_s);
+        ChangeCapture::deliverCommitted();
+        const auto before = eventTypes().stats();
+
+        for (int i = 0; i < 10; ++i) {
+            QCOMPARE(eventTypes().find(first, u"en"_s), u"Adoption"_s);
+            QCOMPARE(eventTypes().find(second, u"en"_s), u"Baptism"_s);
+            QCOMPARE(eventTypes().find(second, u"en_GB"_s), std::nullopt);
+        }
+
+        const auto after = eventTypes().stats();
+        QCOMPARE(after.lookups - before.lookups, 30);
+        QCOMPARE(after.loads - before.loads, 2);
+    }
+
+    void testChangeToTableEmptiesCache() {
+        const auto typeId = insertEventType(u"Adoptie"_s);
+        QCOMPARE(eventTypes().find(typeId, u"en"_s), std::nullopt);
+
+        EventTypeTranslationRepository repo;
+        const auto id = repo.insert(typeId, u"en"_s, u"Adoption"_s);
+        ChangeCapture::deliverCommitted();
+        QCOMPARE(eventTypes().find(typeId, u"en"_s), u"Adoption"_s);
+
+        QVERIFY(id.has_value());
+        repo.remove(*id);
+        ChangeCapture::deliverCommitted();
+        QCOMPARE(eventTypes().find(typeId, u"en"_s), std::nullopt);
+    }
+
+    void testChangeToOtherTableKeepsCache() {
+        const auto typeId = insertEventType(u"Adoptie"_s);
+        QCOMPARE(eventTypes().find(typeId, u"en"_s), std::nullopt);
+        const auto before = eventTypes().stats();
+
+        const auto locationTypeId = insertQuery(u"INSERT INTO location_types (type, builtin) VALUES ('Dorp', false)"_s);
+        LocationTypeTranslationRepository().insert(locationTypeId, u"en"_s, u"Village"_s);
+        ChangeCapture::deliverCommitted();
+        QCOMPARE(eventTypes().find(typeId, u"en"_s), std::nullopt);
+
+        QCOMPARE(eventTypes().stats().loads, before.loads);
+        QCOMPARE(
+            TypeTranslationCache::forTable<Schema::LocationTypeTranslations>().find(locationTypeId, u"en"_s),
+            u"Village"_s
+        );
+    }
+
+    void testRolesAreTranslated() {
+        const auto roleId = insertQuery(u"INSERT INTO event_roles (role, builtin) VALUES ('Getuige', false)"_s);
+        EventRoleTranslationRepository().insert(roleId, u"en"_s, u"Witness"_s);
+
+        // The roles are keyed by role_id instead of type_id.
+        auto& roles = TypeTranslationCache::forTable<Schema::EventRoleTranslations>();
+        QCOMPARE(roles.find(roleId, u"en"_s), u"Witness"_s);
+    }
+
+    void testOpeningDatabaseEmptiesCache() {
+        const auto typeId = insertEventType(u"Adoptie"_s);
+        EventTypeTranslationRepository().insert(typeId, u"en"_s, u"Adoption"_s);
+        QCOMPARE(eventTypes().find(typeId, u"en"_s), u"Adoption"_s);
+
+        // The same id, but another database.
+        closeDatabase();
+        openDatabase(u":memory:"_s, false);
+        QCOMPARE(insertEventType(u"Doop"_s), typeId);
+        QCOMPARE(eventTypes().find(typeId, u"en"_s), std::nullopt);
+    }
+
+    void testResolverFallsBackToLanguage() {
+        const auto typeId = insertEventType(u"Adoptie"_s);
+        EventTypeTranslationRepository().insert(typeId, u"nl"_s, u"Adoptie NL"_s);
+        const TypeTranslationResolver resolver(
+            [](IntegerPrimaryKey id, const QString& locale) { return eventTypes().find(id, locale); },
+            [](const QString& type) { return type; }
+        );
+
+        QCOMPARE(resolver.resolve(u"Adoptie"_s, false, typeId, u"nl_BE"_s), u"Adoptie NL"_s);
+        QCOMPARE(resolver.resolve(u"Adoptie"_s, false, typeId, u"en_GB"_s), u"Adoptie"_s);
+    }
+
+    void benchmarkResolve_data() {
+        QTest::addColumn<bool>("cached");
+        QTest::newRow("query") << false;
+        QTest::newRow("cache") << true;
+    }
+
+    void benchmarkResolve() {
+        QFETCH(bool, cached);
+
+        // Like painting the rows of a combo box, for a locale with only a translation for the language.
+        QList<IntegerPrimaryKey> typeIds;
+        EventTypeTranslationRepository repo;
+        for (int i = 0; i < BENCHMARK_TYPES; ++i) {
+            typeIds.append(insertEventType(u"Type %1"_s.arg(i)));
+            repo.insert(typeIds.last(), u"nl"_s, u"Soort %1"_s.arg(i));
+        }
+        ChangeCapture::deliverCommitted();
+        const TypeTranslationResolver resolver(
+            [cached](IntegerPrimaryKey id, const QString& locale) {
+                if (cached) {
+                    return eventTypes().find(id, locale);
+                }
+                return EventTypeTranslationRepository().findByTypeIdAndLocale(id, locale);
+            },
+            [](const QString& type) { return type; }
+        );
+
+        QBENCHMARK {
+            for (const auto typeId: std::as_const(typeIds)) {
+                Q_UNUSED(resolver.resolve(u"Type"_s, false, typeId, u"nl_BE"_s));
+            }
+        }
+    }
+};
+
+QTEST_GUILESS_MAIN(TestTypeTranslationCache)
+#include "type_translation_cache_test.moc"
@@ -6,12 +6,18 @@
 #pragma once
 
 #include "data_event_broker.h"
+#include "database/connection_pool.h"
 #include "query_helper.h"
+#include "sql_row.h"
+
+#include <qcoro/qcorofuture.h>
+#include <qcoro/qcorotask.h>
 
 #include <QList>
 #include <QSqlDriver>
 #include <QSqlQuery>
 #include <QVariantMap>
+#include <QtConcurrent>
 #include <optional>
 
 /**
@@ -26,6 +32,10 @@ protected:
     /**
      * Execute a query and get all results.
      *
+     * The prepared statement is kept in the StatementCache and reused on the next call with
+     * the same SQL. For entities declaring their Columns, the column positions are resolved once
+     * for the result set, instead of looking up each column by name for each row.
+     *
      * @tparam T The type of the result objects.
      * @param sql The SQL query to execute.
      * @param bindings Optional bindings for the query parameters.
@@ -34,19 +44,26 @@ protected:
      */
     template<typename T>
     [[nodiscard]] QList<T> fetchAll(const QString& sql, const QVariantMap& bindings = {}) const {
-        auto [query, result] = QueryHelper::executeWithResult(sql, bindings);
+        auto [query, result] = QueryHelper::executeCached(sql, bindings);
 
         QList<T> results;
         if (!result) {
             return results;
         }
 
-        if (query.driver()->hasFeature(QSqlDriver::QuerySize)) {
-            results.reserve(query.size());
+        if (query->driver()->hasFeature(QSqlDriver::QuerySize)) {
+            results.reserve(query->size());
         }
 
-        while (query.next()) {
-            results << T::fromSql(query);
+        if constexpr (RowMapped<T>) {
+            const typename T::Columns::Row row(*query);
+            while (query->next()) {
+                results << T::fromSql(row);
+            }
+        } else {
+            while (query->next()) {
+                results << T::fromSql(*query);
+            }
         }
 
         return results;
@@ -65,24 +82,78 @@ protected:
      */
     template<typename T>
     [[nodiscard]] std::optional<T> fetchOne(const QString& sql, const QVariantMap& bindings = {}) const {
-        auto [query, result] = QueryHelper::executeWithResult(sql, bindings);
+        auto [query, result] = QueryHelper::executeCached(sql, bindings);
 
         if (!result) {
             return std::nullopt;
         }
 
-        if (query.next()) {
-            auto value = T::fromSql(query);
+        std::optional<T> value;
+        if (query->next()) {
+            if constexpr (RowMapped<T>) {
+                value = T::fromSql(typename T::Columns::Row(*query));
+            } else {
+                value = T::fromSql(*query);
+            }
 
             // Be strict about this, to prevent accidental errors or wrong assumptions.
-            if (query.next()) {
+            if (query->next()) {
                 qCritical() << "More than one result returned for fetchOne query, refusing to return.";
-                return std::nullopt;
+                value.reset();
             }
+        }
+
+        return value;
+    }
 
-            return value;
+    /**
+     * Execute a query on a worker thread and get all results.
+     *
+     * The query runs on a thread of the global thread pool, using the read-only connection the
+     * ConnectionPool hands out for that thread. The coroutine resumes on the calling thread once
+     * the results are there, so the caller (e.g. a model on the GUI thread) never blocks on the
+     * database.
+     *
+     * If the database has no readers (an in-memory database), the query runs synchronously on
+     * the calling thread instead, and the returned task is already finished.
+     *
+     * @tparam T The type of the result objects.
+     * @param sql The SQL query to execute.
+     * @param bindings Optional bindings for the query parameters.
+     *
+     * @return A list of result objects.
+     */
+    template<typename T>
+    [[nodiscard]] QCoro::Task<QList<T>> fetchAllAsync(QString sql, QVariantMap bindings = {}) const {
+        if (!ConnectionPool::instance().hasReaders()) {
+            co_return fetchAll<T>(sql, bindings);
+        }
+
+        // Do not capture "this": the repository is usually a temporary that is gone by now.
+        co_return co_await QtConcurrent::run([sql = std::move(sql), bindings = std::move(bindings)] {
+            return BaseRepository().fetchAll<T>(sql, bindings);
+        });
+    }
+
+    /**
+     * Execute a query on a worker thread and get one result.
+     *
+     * See fetchAllAsync() for the threading, and fetchOne() for the semantics.
+     *
+     * @tparam T The type of the result objects.
+     * @param sql The SQL query to execute.
+     * @param bindings Optional bindings for the query parameters.
+     *
+     * @return The resulting object.
+     */
+    template<typename T>
+    [[nodiscard]] QCoro::Task<std::optional<T>> fetchOneAsync(QString sql, QVariantMap bindings = {}) const {
+        if (!ConnectionPool::instance().hasReaders()) {
+            co_return fetchOne<T>(sql, bindings);
         }
 
-        return std::nullopt;
+        co_return co_await QtConcurrent::run([sql = std::move(sql), bindings = std::move(bindings)] {
+            return BaseRepository().fetchOne<T>(sql, bindings);
+        });
     }
 };
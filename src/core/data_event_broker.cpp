@@ -5,7 +5,8 @@
  */
 #include "data_event_broker.h"
 
-#include <algorithm>
+#include <QMutexLocker>
+#include <QThread>
 #include <vector>
 
 using namespace Qt::StringLiterals;
@@ -13,32 +14,214 @@ using namespace Qt::StringLiterals;
 // Every thread uses its own guard, so notifications are managed per thread.
 namespace {
 struct PendingNotification {
-    QString table;
+    std::size_t tableId;
     std::optional<IntegerPrimaryKey> id;
 };
 
+// The ids that are pending for one table, to deduplicate in constant time.
+struct PendingTable {
+    // There is a pending table-wide notification.
+    bool tableWide = false;
+    // The table-wide notification replaced the notifications for single rows.
+    bool collapsed = false;
+    QSet<IntegerPrimaryKey> ids;
+};
+
 thread_local int batchDepth = 0;
+// In order of first notification.
 thread_local std::vector<PendingNotification> pendingNotifications;
+thread_local std::array<PendingTable, Schema::table_count> pendingTables;
 }
 
 BatchGuard DataEventBroker::batchNotifications() {
     return BatchGuard(*this);
 }
 
-void DataEventBroker::enqueueNotification(const QString& table, std::optional<IntegerPrimaryKey> id) const {
-    auto it = std::ranges::find_if(pendingNotifications, [&](const PendingNotification& n) {
-        return n.table == table && n.id == id;
-    });
-    if (it == pendingNotifications.end()) {
-        pendingNotifications.push_back({table, id});
+void DataEventBroker::notifyChanged(std::size_t tableId, std::optional<IntegerPrimaryKey> id) {
+    Q_ASSERT(tableId < Schema::table_count);
+    if (isBatching()) {
+        enqueueNotification(tableId, id);
+    } else {
+        deliver(tableId, id);
+    }
+}
+
+void DataEventBroker::subscribe(
+    std::size_t tableId,
+    QObject* receiver,
+    std::optional<IntegerPrimaryKey> id,
+    Callback callback
+) {
+    Subscription subscription{.receiver = receiver, .guard = receiver, .callback = std::move(callback)};
+
+    bool firstSubscription = false;
+    {
+        QMutexLocker locker(&mutex);
+        auto& table = subscriptions[tableId];
+        if (id.has_value()) {
+            table.byId[*id].push_back(std::move(subscription));
+        } else {
+            table.any.push_back(std::move(subscription));
+        }
+        firstSubscription = !receivers.contains(receiver);
+        receivers.insert(receiver);
+    }
+
+    if (firstSubscription) {
+        // The destroyed signal is emitted on the thread of the receiver, so do not queue it.
+        connect(receiver, &QObject::destroyed, this, [this, receiver] { unsubscribe(receiver); }, Qt::DirectConnection);
+    }
+}
+
+void DataEventBroker::unsubscribe(QObject* receiver) {
+    QMutexLocker locker(&mutex);
+    if (!receivers.remove(receiver)) {
+        return;
+    }
+
+    auto isReceiver = [receiver](const Subscription& subscription) {
+        return subscription.receiver == receiver;
+    };
+    for (auto& table: subscriptions) {
+        std::erase_if(table.any, isReceiver);
+        std::erase_if(table.byId, [&isReceiver](auto& entry) {
+            std::erase_if(entry.second, isReceiver);
+            return entry.second.empty();
+        });
+    }
+}
+
+void DataEventBroker::deliver(std::size_t tableId, std::optional<IntegerPrimaryKey> id) {
+    changeCounts[tableId].fetch_add(1, std::memory_order_release);
+    Q_EMIT entityChanged(Schema::tableName(tableId), id);
+
+    // Copy the callbacks, since they may (un)subscribe receivers while being called.
+    std::vector<Subscription> woken;
+    {
+        QMutexLocker locker(&mutex);
+        const auto& table = subscriptions[tableId];
+        woken = table.any;
+        if (id.has_value()) {
+            if (auto it = table.byId.find(*id); it != table.byId.end()) {
+                woken.insert(woken.end(), it->second.begin(), it->second.end());
+            }
+        } else {
+            // A table-wide change affects every row.
+            for (const auto& [rowId, rowSubscriptions]: table.byId) {
+                woken.insert(woken.end(), rowSubscriptions.begin(), rowSubscriptions.end());
+            }
+        }
+
+        auto& stats = tableStats[tableId];
+        ++stats.notifications;
+        stats.receiversWoken += woken.size();
+    }
+
+    for (const auto& subscription: woken) {
+        // An earlier callback may have destroyed this receiver.
+        QObject* receiver = subscription.guard;
+        if (receiver == nullptr) {
+            continue;
+        }
+        if (receiver->thread() == QThread::currentThread()) {
+            subscription.callback(id);
+        } else {
+            QMetaObject::invokeMethod(
+                receiver,
+                [callback = subscription.callback, id] { callback(id); },
+                Qt::QueuedConnection
+            );
+        }
+    }
+}
+
+qsizetype DataEventBroker::subscriberCount(std::size_t tableId) const {
+    QMutexLocker locker(&mutex);
+    const auto& table = subscriptions[tableId];
+    auto count = static_cast<qsizetype>(table.any.size());
+    for (const auto& [rowId, rowSubscriptions]: table.byId) {
+        count += static_cast<qsizetype>(rowSubscriptions.size());
+    }
+    return count;
+}
+
+DataEventBroker::Stats DataEventBroker::stats(std::size_t tableId) const {
+    QMutexLocker locker(&mutex);
+    return tableStats[tableId];
+}
+
+QHash<QString, DataEventBroker::Stats> DataEventBroker::allStats() const {
+    QMutexLocker locker(&mutex);
+    QHash<QString, Stats> result;
+    for (std::size_t tableId = 0; tableId < Schema::table_count; ++tableId) {
+        if (tableStats[tableId].notifications > 0) {
+            result.insert(Schema::tableName(tableId), tableStats[tableId]);
+        }
     }
+    return result;
+}
+
+void DataEventBroker::resetStats() {
+    QMutexLocker locker(&mutex);
+    tableStats = {};
+}
+
+void DataEventBroker::setCoalesceThreshold(qsizetype threshold) {
+    coalesceThreshold_.store(threshold, std::memory_order_relaxed);
+}
+
+qsizetype DataEventBroker::coalesceThreshold() const {
+    return coalesceThreshold_.load(std::memory_order_relaxed);
+}
+
+void DataEventBroker::enqueueNotification(std::size_t tableId, std::optional<IntegerPrimaryKey> id) const {
+    auto& table = pendingTables[tableId];
+    if (table.collapsed) {
+        return;
+    }
+
+    if (!id.has_value()) {
+        if (!table.tableWide) {
+            table.tableWide = true;
+            pendingNotifications.push_back({tableId, std::nullopt});
+        }
+        return;
+    }
+
+    if (table.ids.contains(*id)) {
+        return;
+    }
+
+    if (table.ids.size() < coalesceThreshold()) {
+        table.ids.insert(*id);
+        pendingNotifications.push_back({tableId, id});
+        return;
+    }
+
+    // Too many rows changed: reloading the whole table once is cheaper than handling every row.
+    // The table-wide notification takes the place of the first notification for the table.
+    table.collapsed = true;
+    table.tableWide = true;
+    table.ids.clear();
+    bool first = true;
+    std::erase_if(pendingNotifications, [tableId, &first](PendingNotification& notification) {
+        if (notification.tableId != tableId) {
+            return false;
+        }
+        if (first) {
+            first = false;
+            notification.id = std::nullopt;
+            return false;
+        }
+        return true;
+    });
 }
 
 void DataEventBroker::flushNotifications() {
     auto notifications = std::move(pendingNotifications);
     discardNotifications();
-    for (const auto& [table, id]: notifications) {
-        Q_EMIT entityChanged(table, id);
+    for (const auto& [tableId, id]: notifications) {
+        deliver(tableId, id);
     }
 }
 
@@ -72,4 +255,5 @@ void DataEventBroker::popBatch() {
 
 void DataEventBroker::discardNotifications() const {
     pendingNotifications.clear();
+    pendingTables = {};
 }
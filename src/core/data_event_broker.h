@@ -7,16 +7,33 @@
 
 #include "database/schema.h"
 
+#include <QHash>
+#include <QMutex>
 #include <QObject>
+#include <QPointer>
+#include <QSet>
+#include <array>
+#include <atomic>
+#include <functional>
 #include <optional>
+#include <unordered_map>
+#include <vector>
 
 class BatchGuard;
 
 /**
  * Event bus for database stuff.
  *
+ * Receivers subscribe to a table (see connectToTable), optionally for a single id only. The
+ * subscriptions are kept per table and per id, so a notification only wakes the receivers
+ * interested in that table or row, instead of every receiver in the application.
+ *
+ * Rows changed in the database are notified by ChangeCapture, so code writing to the database
+ * does not call notifyChanged itself, except for changes the capture does not see (junction tables).
+ *
  * Thread-safe: This class uses thread-local storage for batching.
  * It is safe to call `notifyChanged` and `batchNotifications` from background threads.
+ * Callbacks are always invoked on the thread of their receiver.
  */
 class DataEventBroker : public QObject {
     Q_OBJECT
@@ -31,17 +48,83 @@ public:
 
     ~DataEventBroker() override = default;
 
+    using Callback = std::function<void(std::optional<IntegerPrimaryKey>)>;
+
+    struct Stats {
+        // Notifications delivered for the table, after batching.
+        quint64 notifications = 0;
+        // Callbacks invoked for those notifications.
+        quint64 receiversWoken = 0;
+    };
+
     template<typename T>
     void notifyChanged(std::optional<IntegerPrimaryKey> id) {
         static_assert(Schema::is_table_tag<T>, "notifyChanged must be called with a type from the Schema namespace.");
+        notifyChanged(Schema::table_id<T>, id);
+    }
+
+    /**
+     * Notify about a change to the table with the given id (see Schema::table_id).
+     */
+    void notifyChanged(std::size_t tableId, std::optional<IntegerPrimaryKey> id);
+
+    /**
+     * Call the callback on changes to the table, until the receiver is destroyed.
+     *
+     * @param receiver The context of the callback: it is invoked on the thread of the receiver.
+     * @param id If given, only changes to this row and table-wide changes wake the receiver.
+     * @param callback Gets the id of the changed row, or nullopt if the whole table changed.
+     */
+    template<typename T>
+    void subscribe(QObject* receiver, std::optional<IntegerPrimaryKey> id, Callback callback) {
+        static_assert(Schema::is_table_tag<T>, "subscribe must be called with a type from the Schema namespace.");
+        subscribe(Schema::table_id<T>, receiver, id, std::move(callback));
+    }
 
-        if (isBatching()) {
-            enqueueNotification(T::table, id);
-        } else {
-            Q_EMIT entityChanged(T::table, id);
-        }
+    /**
+     * @return The number of subscriptions to the table, for any id.
+     */
+    template<typename T>
+    [[nodiscard]] qsizetype subscriberCount() const {
+        return subscriberCount(Schema::table_id<T>);
     }
 
+    /**
+     * @return How often the table was notified about, counting from before its receivers are called.
+     *
+     * A cache of a table can compare this with the count at the time it was filled, so it is up to
+     * date for every receiver of the change, whatever the order the receivers subscribed in.
+     */
+    template<typename T>
+    [[nodiscard]] quint64 changeCount() const {
+        static_assert(Schema::is_table_tag<T>, "changeCount must be called with a type from the Schema namespace.");
+        return changeCounts[Schema::table_id<T>].load(std::memory_order_acquire);
+    }
+
+    template<typename T>
+    [[nodiscard]] Stats stats() const {
+        return stats(Schema::table_id<T>);
+    }
+
+    /**
+     * @return The statistics of all tables that had notifications, by table name.
+     */
+    [[nodiscard]] QHash<QString, Stats> allStats() const;
+
+    void resetStats();
+
+    /**
+     * Set the number of distinct rows of one table a batch may notify about.
+     *
+     * When a batch changes more rows of a table, the notifications for that table are replaced
+     * by a single table-wide (nullopt) notification, so receivers reload once.
+     */
+    void setCoalesceThreshold(qsizetype threshold);
+
+    [[nodiscard]] qsizetype coalesceThreshold() const;
+
+    static constexpr qsizetype DEFAULT_COALESCE_THRESHOLD = 256;
+
     /**
      * Get a guard to start RAII batching of notifications.
      *
@@ -51,20 +134,50 @@ public:
     [[nodiscard]] BatchGuard batchNotifications();
 
 Q_SIGNALS:
+    /**
+     * Emitted for every delivered notification, regardless of subscriptions.
+     */
     void entityChanged(const QString& tableName, std::optional<IntegerPrimaryKey> id);
 
 private:
     friend class BatchGuard;
 
+    struct Subscription {
+        QObject* receiver;
+        QPointer<QObject> guard;
+        Callback callback;
+    };
+
+    struct TableSubscriptions {
+        // Receivers of changes to any row.
+        std::vector<Subscription> any;
+        // Receivers of changes to one row, by id.
+        std::unordered_map<IntegerPrimaryKey, std::vector<Subscription>> byId;
+    };
+
     DataEventBroker() = default;
 
-    void enqueueNotification(const QString& table, std::optional<IntegerPrimaryKey> id) const;
+    void subscribe(std::size_t tableId, QObject* receiver, std::optional<IntegerPrimaryKey> id, Callback callback);
+    void unsubscribe(QObject* receiver);
+    void deliver(std::size_t tableId, std::optional<IntegerPrimaryKey> id);
+
+    [[nodiscard]] qsizetype subscriberCount(std::size_t tableId) const;
+    [[nodiscard]] Stats stats(std::size_t tableId) const;
+
+    void enqueueNotification(std::size_t tableId, std::optional<IntegerPrimaryKey> id) const;
     void flushNotifications();
     void discardNotifications() const;
 
     bool isBatching() const;
     void pushBatch() const;
     void popBatch();
+
+    mutable QMutex mutex;
+    std::array<TableSubscriptions, Schema::table_count> subscriptions;
+    std::array<Stats, Schema::table_count> tableStats;
+    QSet<QObject*> receivers;
+    std::atomic<qsizetype> coalesceThreshold_ = DEFAULT_COALESCE_THRESHOLD;
+    std::array<std::atomic<quint64>, Schema::table_count> changeCounts{};
 };
 
 class BatchGuard {
@@ -90,17 +203,7 @@ private:
 
 template<typename T>
 static void connectToTable(QObject* receiver, const std::function<void(std::optional<IntegerPrimaryKey>)>& callback) {
-    auto* broker = &DataEventBroker::instance();
-    QObject::connect(
-        broker,
-        &DataEventBroker::entityChanged,
-        receiver,
-        [callback](const QString& table, std::optional<IntegerPrimaryKey> id) {
-            if (table == T::table) {
-                callback(id);
-            }
-        }
-    );
+    DataEventBroker::instance().subscribe<T>(receiver, std::nullopt, callback);
 }
 
 template<typename T>
@@ -110,10 +213,8 @@ static void connectToTable(QObject* receiver, const std::function<void()>& callb
 
 template<typename T>
 static void connectToTable(QObject* receiver, IntegerPrimaryKey targetId, const std::function<void()>& callback) {
-    connectToTable<T>(receiver, [callback, targetId](std::optional<IntegerPrimaryKey> id) {
-        if (id == targetId || !id) {
-            callback();
-        }
+    DataEventBroker::instance().subscribe<T>(receiver, targetId, [callback](std::optional<IntegerPrimaryKey>) {
+        callback();
     });
 }
 
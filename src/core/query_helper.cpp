@@ -7,6 +7,10 @@
 
 #include "query_helper.h"
 
+#include "database/change_capture.h"
+#include "database/connection_pool.h"
+#include "statement_cache.h"
+
 #include <QSqlError>
 #include <QString>
 
@@ -35,7 +39,7 @@ SqlQueryBuilder& SqlQueryBuilder::bind(const QString& placeholder, const QVarian
 
 SqlQueryBuilder& SqlQueryBuilder::orderBy(const QString& column, Qt::SortOrder order) {
     if (!column.isEmpty()) {
-        orderByClause = column + (order == Qt::AscendingOrder ? u" ASC"_s : u" DESC"_s);
+        orderByClauses << column + (order == Qt::AscendingOrder ? u" ASC"_s : u" DESC"_s);
     }
     return *this;
 }
@@ -52,8 +56,11 @@ SqlQueryBuilder& SqlQueryBuilder::offset(int offset) {
 
 SqlQueryBuilder& SqlQueryBuilder::applyCriteria(const QueryCriteria& criteria) {
     if (!criteria.filterText.isEmpty()) {
-        this->where(u"%1 LIKE :search_text"_s.arg(criteria.filterColumn));
-        this->bind(u":search_text"_s, QString(u"%"_s + criteria.filterText + u"%"_s));
+        // The text is matched literally, so escape the wildcards of LIKE.
+        auto text = criteria.filterText.toCaseFolded();
+        text.replace(u'\\', u"\\\\"_s).replace(u'%', u"\\%"_s).replace(u'_', u"\\_"_s);
+        this->where(u"fold_case(%1) LIKE :search_text ESCAPE '\\'"_s.arg(criteria.filterColumn));
+        this->bind(u":search_text"_s, QString(u"%"_s + text + u"%"_s));
     }
 
     for (const auto [key, value]: criteria.filters.asKeyValueRange()) {
@@ -93,8 +100,8 @@ std::tuple<QString, QVariantMap> SqlQueryBuilder::construct() const {
         }
     }
 
-    if (!orderByClause.isEmpty()) {
-        sql += u" ORDER BY "_s + orderByClause;
+    if (!orderByClauses.isEmpty()) {
+        sql += u" ORDER BY "_s + orderByClauses.join(u", "_s);
     }
 
     if (limitCount > 0) {
@@ -110,15 +117,8 @@ std::tuple<QString, QVariantMap> SqlQueryBuilder::construct() const {
     return {std::move(sql), std::move(copiedBindings)};
 }
 
-std::tuple<QSqlQuery, bool> QueryHelper::executeWithResult(const QString& sql, const QVariantMap& bindings) {
-    QSqlQuery query;
-
-    if (!query.prepare(sql)) {
-        qWarning() << "Failed to prepare query" << sql;
-        qWarning() << query.lastError().text();
-        return {std::move(query), false};
-    }
-
+namespace {
+bool bindAndExecute(QSqlQuery& query, const QVariantMap& bindings) {
     for (const auto& [key, value]: bindings.asKeyValueRange()) {
         query.bindValue(key, value);
     }
@@ -130,22 +130,53 @@ std::tuple<QSqlQuery, bool> QueryHelper::executeWithResult(const QString& sql, c
         qWarning() << query.lastError().text();
     }
 
+    return result;
+}
+}
+
+std::tuple<QSqlQuery, bool> QueryHelper::executeWithResult(const QString& sql, const QVariantMap& bindings) {
+    QSqlQuery query(ConnectionPool::instance().connectionForCurrentThread());
+
+    if (!query.prepare(sql)) {
+        qWarning() << "Failed to prepare query" << sql;
+        qWarning() << query.lastError().text();
+        return {std::move(query), false};
+    }
+
+    auto result = bindAndExecute(query, bindings);
     return {std::move(query), result};
 }
 
+std::tuple<StatementCache::Lease, bool> QueryHelper::executeCached(const QString& sql, const QVariantMap& bindings) {
+    auto lease = StatementCache::forCurrentThread().acquire(sql);
+    if (!lease) {
+        return {StatementCache::Lease(), false};
+    }
+
+    auto result = bindAndExecute(**lease, bindings);
+    return {std::move(*lease), result};
+}
+
 bool QueryHelper::execute(const QString& sql, const QVariantMap& bindings) {
     auto [_, result] = executeWithResult(sql, bindings);
+    if (result) {
+        // Views should be up to date when a write returns, not only after the next event loop iteration.
+        ChangeCapture::deliverCommitted();
+    }
     return result;
 }
 
 std::optional<IntegerPrimaryKey> QueryHelper::insert(const QString& sql, const QVariantMap& bindings) {
-    auto [query, result] = executeWithResult(sql, bindings);
+    auto [query, result] = executeCached(sql, bindings);
 
     if (!result) {
         return std::nullopt;
     }
 
-    auto lastId = query.lastInsertId();
+    auto lastId = query->lastInsertId();
+    // Give the statement back before the receivers run, they might insert with the same SQL.
+    query.release();
+    ChangeCapture::deliverCommitted();
     if (lastId.isValid() && !lastId.isNull()) {
         auto signedId = lastId.toLongLong();
 
@@ -5,7 +5,7 @@
  */
 #pragma once
 
-#include "data_event_broker.h"
+#include "core/statement_cache.h"
 #include "database/schema.h"
 
 #include <QSqlQuery>
@@ -29,7 +29,7 @@ class SqlQueryBuilder {
     QStringList selectColumns;
     QStringList whereClauses;
     QVariantMap bindings;
-    QString orderByClause;
+    QStringList orderByClauses;
     int limitCount = -1;
     int offsetCount = -1;
 
@@ -47,11 +47,19 @@ public:
 
     SqlQueryBuilder& bind(const QString& placeholder, const QVariant& value);
 
+    /**
+     * Sort on the column; sort again to break ties with another column.
+     */
     SqlQueryBuilder& orderBy(const QString& column, Qt::SortOrder order);
 
     SqlQueryBuilder& limit(int limit);
     SqlQueryBuilder& offset(int offset);
 
+    /**
+     * Apply the filters, order and page of the criteria.
+     *
+     * The filter text matches any part of the filter column literally, ignoring case.
+     */
     SqlQueryBuilder& applyCriteria(const QueryCriteria& criteria);
 
     std::tuple<QString, QVariantMap> construct() const;
@@ -68,7 +76,24 @@ public:
 [[nodiscard]] std::tuple<QSqlQuery, bool> executeWithResult(const QString& sql, const QVariantMap& bindings = {});
 
 /**
- * Execute a query and return the success status.
+ * Execute a SQL query with bindings, reusing a prepared statement from the StatementCache.
+ *
+ * The query is leased from the cache: it is reset and reused by the next call once the lease
+ * is destroyed, so do not keep it around longer than needed to read the results.
+ *
+ * @param sql The SQL query to execute
+ * @param bindings Query parameter bindings
+ *
+ * @return Tuple containing the lease of the executed query and result status. The lease is empty if
+ * the statement could not be prepared.
+ */
+[[nodiscard]] std::tuple<StatementCache::Lease, bool>
+executeCached(const QString& sql, const QVariantMap& bindings = {});
+
+/**
+ * Execute a query (nominally a write) and return the success status.
+ *
+ * Afterwards, the committed changes are delivered to the DataEventBroker (see ChangeCapture).
  *
  * @param sql The SQL query to execute
  * @param bindings Optional bindings for the query parameters.
@@ -87,22 +112,4 @@ public:
  */
 [[nodiscard]] std::optional<IntegerPrimaryKey> insert(const QString& sql, const QVariantMap& bindings = {});
 
-/**
- * Execute a query and notify the event broker if the query was successful.
- *
- * @tparam EventType The type of event to notify (e.g. which table)
- * @param id The primary key of the affected row
- * @param sql The SQL query to execute
- * @param bindings Optional bindings for the query parameters
- * @return True if the query was successful, false otherwise
- */
-template<typename EventType>
-[[nodiscard]] bool executeAndNotify(IntegerPrimaryKey id, const QString& sql, const QVariantMap& bindings = {}) {
-    auto result = execute(sql, bindings);
-    if (result) {
-        DataEventBroker::instance().notifyChanged<EventType>(id);
-    }
-    return result;
-}
-
 }
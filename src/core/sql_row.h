@@ -0,0 +1,166 @@
+/*
+ * SPDX-FileCopyrightText: Niko Strijbol <niko@strijbol.be>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+#pragma once
+
+#include <QDebug>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QStringView>
+#include <QVariant>
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <string_view>
+
+/**
+ * The name of a result column, usable as a template argument (e.g. `row.value<u"id">()`).
+ */
+template<std::size_t N>
+struct ColumnName {
+    char16_t chars[N] = {};
+
+    // NOLINTNEXTLINE(*-explicit-constructor): implicit, so string literals can be used as template arguments.
+    consteval ColumnName(const char16_t (&name)[N]) {
+        std::copy_n(name, N, chars);
+    }
+
+    [[nodiscard]] constexpr std::u16string_view view() const {
+        return {chars, N - 1};
+    }
+};
+
+/**
+ * Join two column names, e.g. a prefix and a suffix, at compile time.
+ */
+template<std::size_t N, std::size_t M>
+consteval ColumnName<N + M - 1> operator+(const ColumnName<N>& left, const ColumnName<M>& right) {
+    char16_t chars[N + M - 1] = {};
+    std::copy_n(left.chars, N - 1, chars);
+    std::copy_n(right.chars, M, chars + N - 1);
+    return ColumnName<N + M - 1>(chars);
+}
+
+/**
+ * The list of result columns an entity reads, declared once per entity.
+ *
+ * Reading a column by name with QSqlQuery::value() searches the record for that name, for
+ * every column of every row. Instead, the position of each declared column is resolved once
+ * per result set when constructing a Row, and reading a value is an index lookup. The index
+ * of a name in this list is computed at compile time, so reading a column that was not
+ * declared does not compile.
+ *
+ * Usage:
+ * @code
+ * struct PersonEntity {
+ *     using Columns = SqlColumns<u"id", u"sex">;
+ *
+ *     static PersonEntity fromSql(const Columns::Row& row) {
+ *         return {.id = row.value<u"id">().toLongLong(), .sex = row.value<u"sex">().toString()};
+ *     }
+ * };
+ * @endcode
+ */
+template<ColumnName... Names>
+struct SqlColumns {
+    static constexpr std::size_t size = sizeof...(Names);
+    static constexpr std::array<std::u16string_view, size> names = {Names.view()...};
+
+    /**
+     * The columns of this list followed by more columns, e.g. for an entity deriving from another one.
+     */
+    template<ColumnName... More>
+    using With = SqlColumns<Names..., More...>;
+
+    /**
+     * The columns of this list followed by the columns of another list, e.g. the columns of a date.
+     */
+    template<typename Other>
+    using Join = typename Other::template After<Names...>;
+
+    template<ColumnName... Before>
+    using After = SqlColumns<Before..., Names...>;
+
+    template<ColumnName Name>
+    [[nodiscard]] static consteval std::size_t indexOf() {
+        return std::ranges::find(names, Name.view()) - names.begin();
+    }
+
+    /**
+     * The current row of a query, with the column positions resolved.
+     *
+     * The row refers to the query, so it follows the query when it moves to the next row.
+     */
+    class Row {
+    public:
+        using Positions = std::array<int, size>;
+
+        /**
+         * Resolve the positions of the columns in the result of the (executed) query.
+         */
+        explicit Row(const QSqlQuery& query) : query(&query) {
+            const auto record = query.record();
+            for (std::size_t i = 0; i < size; ++i) {
+                const auto name = QStringView(names[i].data(), static_cast<qsizetype>(names[i].size()));
+                positions[i] = record.indexOf(name.toString());
+                if (positions[i] < 0) {
+                    qWarning() << "Column" << name << "is not in the result of" << query.lastQuery();
+                }
+            }
+        }
+
+        Row(const QSqlQuery& query, const Positions& positions) : query(&query), positions(positions) {
+        }
+
+        /**
+         * @return The value of the column in the current row, or an invalid value if the column
+         *         is not in the result.
+         */
+        template<ColumnName Name>
+        [[nodiscard]] QVariant value() const {
+            const auto index = position<Name>();
+            return index < 0 ? QVariant() : query->value(index);
+        }
+
+        /**
+         * @return The position of the column in the result, or -1 if it is not in the result.
+         */
+        template<ColumnName Name>
+        [[nodiscard]] int position() const {
+            constexpr auto index = indexOf<Name>();
+            static_assert(index < size, "The column is not declared in the Columns of the entity.");
+            return positions[index];
+        }
+
+        /**
+         * Get the same row for a subset of the columns, e.g. to map the fields of a base entity.
+         */
+        template<typename Subset>
+        [[nodiscard]] typename Subset::Row select() const {
+            return Subset::template rowFrom<SqlColumns>(*this);
+        }
+
+        [[nodiscard]] const QSqlQuery& sqlQuery() const {
+            return *query;
+        }
+
+    private:
+        const QSqlQuery* query;
+        Positions positions = {};
+    };
+
+    template<typename Superset>
+    [[nodiscard]] static Row rowFrom(const typename Superset::Row& row) {
+        return Row(row.sqlQuery(), {row.template position<Names>()...});
+    }
+};
+
+/**
+ * An entity with a column declaration, which is mapped by position.
+ */
+template<typename T>
+concept RowMapped = requires(const typename T::Columns::Row& row) {
+    { T::fromSql(row) } -> std::same_as<T>;
+};
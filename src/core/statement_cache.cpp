@@ -0,0 +1,170 @@
+/*
+ * SPDX-FileCopyrightText: Niko Strijbol <niko@strijbol.be>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+#include "statement_cache.h"
+
+#include "database/connection_pool.h"
+
+#include <QSqlDatabase>
+#include <QSqlDriver>
+#include <QSqlError>
+#include <utility>
+
+namespace {
+void* nativeHandle(const QSqlDatabase& database) {
+    auto qtHandle = database.driver()->handle();
+    if (qtHandle.isValid() && qstrcmp(qtHandle.typeName(), "sqlite3*") == 0) {
+        return *static_cast<void**>(qtHandle.data());
+    }
+    return nullptr;
+}
+}
+
+StatementCache& StatementCache::forCurrentThread() {
+    static thread_local StatementCache cache;
+    return cache;
+}
+
+std::optional<StatementCache::Lease> StatementCache::acquire(const QString& sql) {
+    auto database = ConnectionPool::instance().connectionForCurrentThread();
+    const auto handle = nativeHandle(database);
+    Key key{database.connectionName(), sql};
+
+    if (auto it = lookup.find(key); it != lookup.end()) {
+        auto entryIt = it.value();
+        // The connection was reopened, so the statement belongs to a dead handle.
+        if (entryIt->handle != handle) {
+            entries.erase(entryIt);
+            lookup.erase(it);
+        } else if (entryIt->query) {
+            // Move to the front: this is now the most recently used statement.
+            entries.splice(entries.begin(), entries, entryIt);
+            ++counters.hits;
+            auto query = std::move(*entryIt->query);
+            entryIt->query.reset();
+            return Lease(this, key, handle, std::move(query));
+        } else {
+            // The statement is still leased by someone else (e.g. a nested query with the
+            // same SQL). Use a one-off statement instead of clobbering their results.
+            ++counters.misses;
+            QSqlQuery query(database);
+            query.setForwardOnly(true);
+            if (!query.prepare(sql)) {
+                qWarning() << "Failed to prepare query" << sql;
+                qWarning() << query.lastError().text();
+                return std::nullopt;
+            }
+            return Lease(std::move(query));
+        }
+    }
+
+    ++counters.misses;
+    QSqlQuery query(database);
+    // Callers only walk the results once, so avoid the driver caching every row.
+    query.setForwardOnly(true);
+    if (!query.prepare(sql)) {
+        qWarning() << "Failed to prepare query" << sql;
+        qWarning() << query.lastError().text();
+        return std::nullopt;
+    }
+
+    // The entry stays empty until the lease gives the statement back.
+    entries.push_front({.key = key, .query = std::nullopt, .handle = handle});
+    lookup.insert(key, entries.begin());
+    evictOverflow();
+
+    return Lease(this, key, handle, std::move(query));
+}
+
+void StatementCache::clear() {
+    lookup.clear();
+    entries.clear();
+}
+
+void StatementCache::setCapacity(qsizetype capacity) {
+    maxSize = std::max<qsizetype>(capacity, 0);
+    evictOverflow();
+}
+
+qsizetype StatementCache::capacity() const {
+    return maxSize;
+}
+
+qsizetype StatementCache::size() const {
+    return lookup.size();
+}
+
+StatementCache::Stats StatementCache::stats() const {
+    return counters;
+}
+
+void StatementCache::resetStats() {
+    counters = {};
+}
+
+void StatementCache::evictOverflow() {
+    while (static_cast<qsizetype>(entries.size()) > maxSize) {
+        lookup.remove(entries.back().key);
+        entries.pop_back();
+        ++counters.evictions;
+    }
+}
+
+void StatementCache::giveBack(const Key& key, void* handle, QSqlQuery&& query) {
+    // Only return the statement to the entry it was taken from. If that entry was dropped,
+    // or replaced after the connection was reopened, the statement is destroyed.
+    if (auto it = lookup.find(key); it != lookup.end() && !it.value()->query && it.value()->handle == handle) {
+        it.value()->query = std::move(query);
+    }
+}
+
+StatementCache::Lease::Lease(StatementCache* owner, Key key, void* handle, QSqlQuery&& query) :
+    owner(owner),
+    key(std::move(key)),
+    handle(handle),
+    query(std::move(query)) {
+}
+
+StatementCache::Lease::Lease(QSqlQuery&& query) :
+    query(std::move(query)) {
+}
+
+StatementCache::Lease::Lease(Lease&& other) noexcept :
+    owner(std::exchange(other.owner, nullptr)),
+    key(std::move(other.key)),
+    handle(other.handle),
+    query(std::exchange(other.query, std::nullopt)) {
+}
+
+StatementCache::Lease& StatementCache::Lease::operator=(Lease&& other) noexcept {
+    if (this != &other) {
+        release();
+        owner = std::exchange(other.owner, nullptr);
+        key = std::move(other.key);
+        handle = other.handle;
+        query = std::exchange(other.query, std::nullopt);
+    }
+    return *this;
+}
+
+StatementCache::Lease::~Lease() {
+    release();
+}
+
+void StatementCache::Lease::release() {
+    if (!query) {
+        return;
+    }
+    query->finish();
+    // Do not leak bindings into the next execution.
+    for (qsizetype i = 0; i < query->boundValues().size(); ++i) {
+        query->bindValue(static_cast<int>(i), QVariant{});
+    }
+    if (owner != nullptr) {
+        owner->giveBack(key, handle, std::move(*query));
+    }
+    query.reset();
+    owner = nullptr;
+}
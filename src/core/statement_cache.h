@@ -0,0 +1,138 @@
+/*
+ * SPDX-FileCopyrightText: Niko Strijbol <niko@strijbol.be>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+#pragma once
+
+#include <QHash>
+#include <QSqlQuery>
+#include <QString>
+#include <list>
+#include <optional>
+
+/**
+ * LRU cache of prepared statements, keyed by (connection name, SQL text).
+ *
+ * Each cached QSqlQuery keeps its underlying sqlite3_stmt alive, so executing the same
+ * SQL again only has to rebind the parameters instead of parsing and planning the
+ * statement again.
+ *
+ * QSqlDatabase connections can only be used from the thread that created them, so every
+ * thread has its own cache. Use forCurrentThread() to get it.
+ *
+ * acquire() lends the cached query out as a Lease. While the lease is alive, nobody else can
+ * use the statement: a nested acquire() for the same SQL gets a one-off statement instead.
+ * Releasing the lease resets the statement and gives it back to the cache, so keep leases short.
+ */
+class StatementCache {
+public:
+    struct Stats {
+        qint64 hits = 0;
+        qint64 misses = 0;
+        qint64 evictions = 0;
+    };
+
+    static constexpr qsizetype DEFAULT_CAPACITY = 64;
+
+    class Lease;
+
+    StatementCache(const StatementCache&) = delete;
+    StatementCache& operator=(const StatementCache&) = delete;
+
+    static StatementCache& forCurrentThread();
+
+    /**
+     * Get a prepared query for the given SQL on the connection of the current thread.
+     *
+     * @see ConnectionPool::connectionForCurrentThread()
+     *
+     * @return The lease of the prepared query, or std::nullopt if the statement could not be prepared.
+     */
+    [[nodiscard]] std::optional<Lease> acquire(const QString& sql);
+
+    /**
+     * Drop all cached statements.
+     *
+     * This must be called before the connection they belong to is closed or replaced.
+     */
+    void clear();
+
+    void setCapacity(qsizetype capacity);
+
+    [[nodiscard]] qsizetype capacity() const;
+
+    [[nodiscard]] qsizetype size() const;
+
+    [[nodiscard]] Stats stats() const;
+
+    void resetStats();
+
+private:
+    using Key = std::pair<QString, QString>;
+
+    struct Entry {
+        Key key;
+        // Empty while the statement is leased out.
+        std::optional<QSqlQuery> query;
+        // The native handle at the time of preparing, to detect reopened connections.
+        void* handle = nullptr;
+    };
+
+    StatementCache() = default;
+
+    void evictOverflow();
+
+    void giveBack(const Key& key, void* handle, QSqlQuery&& query);
+
+    std::list<Entry> entries;
+    QHash<Key, std::list<Entry>::iterator> lookup;
+    qsizetype maxSize = DEFAULT_CAPACITY;
+    Stats counters;
+};
+
+/**
+ * A statement borrowed from the StatementCache.
+ *
+ * The lease is move-only and must be released on the thread that acquired it. On release, the
+ * statement is finished, its bindings are cleared and it goes back to the cache. If the cache
+ * dropped the statement in the meantime (e.g. it was evicted or cleared), it is destroyed instead.
+ */
+class StatementCache::Lease {
+public:
+    /**
+     * An empty lease, without a statement. It must not be dereferenced.
+     */
+    Lease() = default;
+
+    Lease(Lease&& other) noexcept;
+    Lease& operator=(Lease&& other) noexcept;
+    Lease(const Lease&) = delete;
+    Lease& operator=(const Lease&) = delete;
+    ~Lease();
+
+    QSqlQuery& operator*() {
+        return *query;
+    }
+
+    QSqlQuery* operator->() {
+        return &*query;
+    }
+
+    /**
+     * Give the statement back now instead of when the lease is destroyed. The lease is empty afterwards.
+     */
+    void release();
+
+private:
+    friend class StatementCache;
+
+    Lease(StatementCache* owner, Key key, void* handle, QSqlQuery&& query);
+    // A one-off statement that is not part of the cache; it is destroyed on release.
+    explicit Lease(QSqlQuery&& query);
+
+    StatementCache* owner = nullptr;
+    Key key;
+    void* handle = nullptr;
+    std::optional<QSqlQuery> query;
+};
@@ -0,0 +1,222 @@
+/*
+ * SPDX-FileCopyrightText: Niko Strijbol <niko@strijbol.be>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+#include "change_capture.h"
+
+#include "core/data_event_broker.h"
+#include "database.h"
+#include "schema.h"
+
+#include <sqlite3.h>
+
+#include <QDebug>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSet>
+#include <QSqlDriver>
+#include <QThread>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace {
+struct Change {
+    std::size_t tableId;
+    std::optional<IntegerPrimaryKey> id;
+};
+
+struct PendingTable {
+    // Too many rows changed, so the whole table is notified instead.
+    bool tableWide = false;
+    QSet<IntegerPrimaryKey> ids;
+    // The ids in order of their first change.
+    std::vector<IntegerPrimaryKey> order;
+};
+
+/**
+ * The changes of the open transaction of one connection.
+ *
+ * The hooks run on the thread using the connection, so this is not locked.
+ */
+class ConnectionChanges {
+public:
+    void add(const char* table, IntegerPrimaryKey rowid) {
+        const auto tableId = lookup(table);
+        if (!tableId.has_value() || !Schema::Tables::rowidIsId[*tableId]) {
+            return;
+        }
+
+        auto& pending = tables[*tableId];
+        if (pending.tableWide || pending.ids.contains(rowid)) {
+            return;
+        }
+        if (pending.ids.isEmpty()) {
+            changedTables.push_back(*tableId);
+        }
+        if (pending.ids.size() >= DataEventBroker::instance().coalesceThreshold()) {
+            // Keep the buffer of a large transaction (e.g. an import) small.
+            pending = {.tableWide = true};
+            return;
+        }
+        pending.ids.insert(rowid);
+        pending.order.push_back(rowid);
+    }
+
+    [[nodiscard]] std::vector<Change> take() {
+        std::vector<Change> changes;
+        for (const auto tableId: changedTables) {
+            auto& pending = tables[tableId];
+            if (pending.tableWide) {
+                changes.push_back({tableId, std::nullopt});
+            } else {
+                for (const auto id: pending.order) {
+                    changes.push_back({tableId, id});
+                }
+            }
+            pending = {};
+        }
+        changedTables.clear();
+        return changes;
+    }
+
+    void clear() {
+        for (const auto tableId: changedTables) {
+            tables[tableId] = {};
+        }
+        changedTables.clear();
+    }
+
+private:
+    std::optional<std::size_t> lookup(const char* table) {
+        // Statements usually change many rows of the same table.
+        if (lastTableName == table) {
+            return lastTableId;
+        }
+        lastTableName = table;
+        lastTableId = Schema::tableId(QLatin1String(table));
+        return lastTableId;
+    }
+
+    std::array<PendingTable, Schema::table_count> tables;
+    // The tables with changes, in order of their first change.
+    std::vector<std::size_t> changedTables;
+    QByteArray lastTableName;
+    std::optional<std::size_t> lastTableId;
+};
+
+struct Registry {
+    QMutex mutex;
+    // By connection name.
+    std::map<QString, std::unique_ptr<ConnectionChanges>> connections;
+    // Committed, but not yet delivered to the broker.
+    std::vector<Change> committed;
+    std::atomic_bool deliveryScheduled = false;
+};
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+void publish(std::vector<Change> changes) {
+    auto& shared = registry();
+    {
+        QMutexLocker locker(&shared.mutex);
+        shared.committed.insert(shared.committed.end(), changes.begin(), changes.end());
+    }
+
+    if (!shared.deliveryScheduled.exchange(true)) {
+        QMetaObject::invokeMethod(
+            &DataEventBroker::instance(),
+            [] {
+                registry().deliveryScheduled = false;
+                ChangeCapture::deliverCommitted();
+            },
+            Qt::QueuedConnection
+        );
+    }
+}
+
+void onUpdate(void* context, int, const char*, const char* table, sqlite3_int64 rowid) {
+    static_cast<ConnectionChanges*>(context)->add(table, rowid);
+}
+
+int onCommit(void* context) {
+    auto changes = static_cast<ConnectionChanges*>(context)->take();
+    if (!changes.empty()) {
+        publish(std::move(changes));
+    }
+    // Returning non-zero would turn the commit into a rollback.
+    return 0;
+}
+
+void onRollback(void* context) {
+    static_cast<ConnectionChanges*>(context)->clear();
+}
+
+sqlite3* sqliteHandle(const QSqlDatabase& database) {
+    auto qtHandle = database.driver()->handle();
+    if (qtHandle.isValid() && qstrcmp(qtHandle.typeName(), "sqlite3*") == 0) {
+        return *static_cast<sqlite3**>(qtHandle.data());
+    }
+    return nullptr;
+}
+}
+
+void ChangeCapture::install(const QSqlDatabase& database) {
+    auto* handle = sqliteHandle(database);
+    if (handle == nullptr) {
+        qWarning() << "Cannot capture changes of connection" << database.connectionName();
+        return;
+    }
+
+    auto changes = std::make_unique<ConnectionChanges>();
+    auto* context = changes.get();
+    sqlite3_update_hook(handle, onUpdate, context);
+    sqlite3_commit_hook(handle, onCommit, context);
+    sqlite3_rollback_hook(handle, onRollback, context);
+
+    // The hooks no longer refer to the changes of a previous connection with this name, if any.
+    auto& shared = registry();
+    QMutexLocker locker(&shared.mutex);
+    shared.connections[database.connectionName()] = std::move(changes);
+}
+
+void ChangeCapture::uninstall(const QString& connectionName) {
+    auto& shared = registry();
+    QMutexLocker locker(&shared.mutex);
+    shared.connections.erase(connectionName);
+}
+
+void ChangeCapture::deliverCommitted() {
+    auto& broker = DataEventBroker::instance();
+    if (QThread::currentThread() != broker.thread()) {
+        return;
+    }
+
+    // Do not open the default connection if it was closed.
+    const auto database = QSqlDatabase::database(QString::fromLatin1(QSqlDatabase::defaultConnection), false);
+    if (database.isOpen() && hasActiveTransaction(database)) {
+        // Notifications in a transaction are batched, and would be discarded on rollback.
+        return;
+    }
+
+    std::vector<Change> changes;
+    {
+        auto& shared = registry();
+        QMutexLocker locker(&shared.mutex);
+        changes.swap(shared.committed);
+    }
+    if (changes.empty()) {
+        return;
+    }
+
+    // Rows changed by several commits are only notified once.
+    auto guard = broker.batchNotifications();
+    for (const auto& [tableId, id]: changes) {
+        broker.notifyChanged(tableId, id);
+    }
+}
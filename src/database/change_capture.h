@@ -0,0 +1,54 @@
+/*
+ * SPDX-FileCopyrightText: Niko Strijbol <niko@strijbol.be>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+#pragma once
+
+#include <QSqlDatabase>
+
+/**
+ * Notifies the DataEventBroker about the rows SQLite changed, without the code that made the
+ * change having to do so.
+ *
+ * On every connection, the SQLite update hook records the rows that are inserted, updated or
+ * deleted, including rows changed by a cascade or a trigger. The changes are buffered per
+ * connection until the transaction ends: they are dropped on rollback, and on commit they are
+ * handed to the thread of the broker (the GUI thread), which notifies the broker.
+ *
+ * Only tables with a tag in Schema::Tables are captured. Changes to junction tables are not
+ * captured, since their rowid means nothing to receivers; repositories notify those with the
+ * id of the owning row.
+ *
+ * Changes SQLite does not report to the update hook are not notified either: deleting all rows
+ * of a table without a WHERE clause (the truncate optimisation) and rolling back to a savepoint.
+ */
+namespace ChangeCapture {
+
+/**
+ * Start capturing the changes made through the connection, replacing any capture that was
+ * installed for a connection with the same name.
+ */
+void install(const QSqlDatabase& database);
+
+/**
+ * Release the capture of a connection, once the connection is closed.
+ *
+ * Changes of transactions that were committed before are still delivered.
+ */
+void uninstall(const QString& connectionName);
+
+/**
+ * Notify the broker about the changes that were committed since the last delivery.
+ *
+ * This happens automatically some time after a commit, from the event loop of the thread of the
+ * broker. Call this to deliver them right away, e.g. after a write, so views are up to date when
+ * the write returns. It does nothing when called from another thread, or while the default
+ * connection is in a transaction: the changes are then delivered later.
+ *
+ * The receivers run before this returns, so do not call it in the middle of a read, or while
+ * holding a lock the receivers might need.
+ */
+void deliverCommitted();
+
+}
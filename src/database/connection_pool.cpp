@@ -0,0 +1,157 @@
+/*
+ * SPDX-FileCopyrightText: Niko Strijbol <niko@strijbol.be>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+#include "connection_pool.h"
+
+#include "change_capture.h"
+#include "core/statement_cache.h"
+#include "database.h"
+
+#include <QMutexLocker>
+#include <QThread>
+#include <utility>
+
+using namespace Qt::StringLiterals;
+
+namespace {
+struct ThreadReader {
+    quint64 generation = 0;
+    QString connectionName;
+    // Lives in the thread of the reader, as context of the cleanup when the thread finishes.
+    QObject* finishedContext = nullptr;
+};
+
+thread_local ThreadReader threadReader;
+
+/**
+ * Close the reader of the current thread, if it has one.
+ */
+void dropThreadReader() {
+    if (threadReader.connectionName.isEmpty()) {
+        return;
+    }
+    const auto reader = std::exchange(threadReader, {});
+    // This may run from the finished signal, which is delivered to the context itself.
+    reader.finishedContext->deleteLater();
+    // The cached statements of this thread belong to the reader.
+    StatementCache::forCurrentThread().clear();
+    QSqlDatabase::removeDatabase(reader.connectionName);
+    ChangeCapture::uninstall(reader.connectionName);
+}
+}
+
+ConnectionPool& ConnectionPool::instance() {
+    static ConnectionPool pool;
+    return pool;
+}
+
+void ConnectionPool::open(const QString& file) {
+    close();
+
+    QMutexLocker locker(&mutex);
+    writerThread = QThread::currentThread();
+    // Every connection to an in-memory database is a new, empty database.
+    fileName = file == u":memory:"_s ? QString() : file;
+}
+
+void ConnectionPool::close() {
+    {
+        QMutexLocker locker(&mutex);
+        ++generation;
+        fileName.clear();
+        writerThread = nullptr;
+        readers.clear();
+    }
+
+    // Readers of other threads are still used by them and their statement caches, so those
+    // threads drop them on their next connectionForCurrentThread() or when they finish.
+    dropThreadReader();
+}
+
+bool ConnectionPool::hasReaders() const {
+    QMutexLocker locker(&mutex);
+    return !fileName.isEmpty();
+}
+
+QSqlDatabase ConnectionPool::connectionForCurrentThread() {
+    bool useWriter = false;
+    {
+        QMutexLocker locker(&mutex);
+        if (threadReader.generation == generation && !threadReader.connectionName.isEmpty()) {
+            return QSqlDatabase::database(threadReader.connectionName);
+        }
+        useWriter = writerThread == nullptr || writerThread == QThread::currentThread() || fileName.isEmpty();
+    }
+
+    // Any reader this thread still has belongs to a database that was closed since.
+    dropThreadReader();
+    if (useWriter) {
+        return QSqlDatabase::database();
+    }
+    return openReader();
+}
+
+qsizetype ConnectionPool::readerCount() const {
+    QMutexLocker locker(&mutex);
+    return readers.size();
+}
+
+quint64 ConnectionPool::databaseGeneration() const {
+    QMutexLocker locker(&mutex);
+    return generation;
+}
+
+QSqlDatabase ConnectionPool::openReader() {
+    QString file;
+    quint64 currentGeneration = 0;
+    {
+        QMutexLocker locker(&mutex);
+        file = fileName;
+        currentGeneration = generation;
+    }
+
+    const auto connectionName = u"opa_reader_%1_%2"_s.arg(currentGeneration).arg(
+        reinterpret_cast<quintptr>(QThread::currentThreadId())
+    );
+    auto database = QSqlDatabase::addDatabase(u"QSQLITE"_s, connectionName);
+    database.setDatabaseName(file);
+    database.setConnectOptions(u"QSQLITE_OPEN_READONLY"_s);
+    if (!database.open() || !configureConnection(database)) {
+        qWarning() << "Could not open reader connection" << connectionName << database.lastError().text();
+        database = QSqlDatabase();
+        QSqlDatabase::removeDatabase(connectionName);
+        return {};
+    }
+
+    {
+        QMutexLocker locker(&mutex);
+        if (currentGeneration != generation) {
+            // The database was closed or reopened while we were opening the connection.
+            database = QSqlDatabase();
+            QSqlDatabase::removeDatabase(connectionName);
+            return {};
+        }
+        readers.append(connectionName);
+    }
+    // Threads of a thread pool come and go; do not keep their connections around. The finished
+    // signal is emitted from the finishing thread itself, so the context living in that thread
+    // makes the cleanup run there, where the connection and its cached statements belong.
+    auto* context = new QObject;
+    QObject::connect(QThread::currentThread(), &QThread::finished, context, [this]() { removeReader(); });
+    threadReader = {.generation = currentGeneration, .connectionName = connectionName, .finishedContext = context};
+
+    return database;
+}
+
+void ConnectionPool::removeReader() {
+    {
+        QMutexLocker locker(&mutex);
+        // Only readers of the current database are still counted.
+        if (threadReader.generation == generation) {
+            readers.removeOne(threadReader.connectionName);
+        }
+    }
+    dropThreadReader();
+}
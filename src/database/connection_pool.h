@@ -0,0 +1,92 @@
+/*
+ * SPDX-FileCopyrightText: Niko Strijbol <niko@strijbol.be>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+#pragma once
+
+#include <QMutex>
+#include <QSqlDatabase>
+#include <QString>
+#include <QStringList>
+
+class QThread;
+
+/**
+ * Hands out database connections per thread.
+ *
+ * The default connection, opened by openDatabase(), is the single writer and belongs to the
+ * thread that opened it (normally the GUI thread). Every other thread gets its own read-only
+ * connection to the same file, configured like the writer (foreign keys, tracing).
+ *
+ * File databases are switched to WAL mode, so readers see the last committed state and are
+ * not blocked by a long write transaction (e.g. an import), and the writer is not blocked
+ * by readers.
+ *
+ * In-memory databases cannot be shared between connections, so there are no readers for
+ * them: only the thread owning the default connection can access the database.
+ */
+class ConnectionPool {
+public:
+    ConnectionPool(const ConnectionPool&) = delete;
+    ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+    static ConnectionPool& instance();
+
+    /**
+     * Start handing out readers for the given database file.
+     *
+     * Must be called from the thread that owns the default connection, after it was opened.
+     */
+    void open(const QString& file);
+
+    /**
+     * Stop handing out readers for the current database.
+     *
+     * The reader of the calling thread is closed immediately. Readers of other threads are
+     * closed by those threads: on their next connectionForCurrentThread(), or when they finish.
+     */
+    void close();
+
+    /**
+     * @return True if threads other than the writer thread can get a connection.
+     */
+    [[nodiscard]] bool hasReaders() const;
+
+    /**
+     * Get the connection to use on the current thread.
+     *
+     * This is the default connection on the writer thread, and a read-only connection on
+     * any other thread. The reader is created on first use and reused by later calls from
+     * the same thread. It is removed when the thread finishes, or when the database is closed.
+     */
+    [[nodiscard]] QSqlDatabase connectionForCurrentThread();
+
+    /**
+     * @return The number of reader connections to the current database.
+     */
+    [[nodiscard]] qsizetype readerCount() const;
+
+    /**
+     * @return A number that changes every time a database is opened or closed.
+     *
+     * Caches of what is in the database can compare it to notice another database was opened.
+     */
+    [[nodiscard]] quint64 databaseGeneration() const;
+
+private:
+    ConnectionPool() = default;
+
+    [[nodiscard]] QSqlDatabase openReader();
+
+    // Called on a reader thread when it finishes.
+    void removeReader();
+
+    mutable QMutex mutex;
+    QString fileName;
+    QThread* writerThread = nullptr;
+    // Bumped on every open/close, so threads notice their reader belongs to an old database.
+    quint64 generation = 0;
+    // The readers of the current generation.
+    QStringList readers;
+};
@@ -5,6 +5,11 @@
  */
 #include "database.h"
 
+#include "change_capture.h"
+#include "connection_pool.h"
+#include "core/statement_cache.h"
+#include "utils/type_translation_cache.h"
+
 using namespace Qt::StringLiterals;
 
 #include <sqlite3.h>
@@ -15,11 +20,14 @@ using namespace Qt::StringLiterals;
 #include <QSqlError>
 #include <QSqlQuery>
 #include <QTextStream>
+#include <utility>
 
 Q_LOGGING_CATEGORY(OPA_SQL, "opa.sql");
 
 const static auto driver = u"QSQLITE"_s;
 
+constexpr int BUSY_TIMEOUT_MS = 5000;
+
 namespace {
 struct Migration {
     int version{};
@@ -79,10 +87,38 @@ constexpr std::array migrations = {
         .description = "Add external ID tables for import sources"_L1,
         .resourcePath = ":/migrations/010_add_external_ids.sql"_L1,
     },
+    Migration{
+        .version = 11,
+        .description = "Add secondary indexes for foreign keys and sort columns"_L1,
+        .resourcePath = ":/migrations/011_add_secondary_indexes.sql"_L1,
+    },
+    Migration{
+        .version = 12,
+        .description = "Add parent links maintained by triggers"_L1,
+        .resourcePath = ":/migrations/012_add_parent_links.sql"_L1,
+    },
+    Migration{
+        .version = 13,
+        .description = "Add primary names maintained by triggers"_L1,
+        .resourcePath = ":/migrations/013_add_person_primary_name.sql"_L1,
+    },
+    Migration{
+        .version = 14,
+        .description = "Store dates decoded into columns instead of JSON, with indexes for overlap queries"_L1,
+        .resourcePath = ":/migrations/014_decode_dates.sql"_L1,
+    },
 };
 
 void executeScriptOrAbort(const QString& script, const QSqlDatabase& database) {
-    for (auto& command: script.split(u";"_s)) {
+    QString pending;
+    for (const auto& part: script.split(u";"_s)) {
+        // The body of a trigger has semicolons, so join the parts until the statement is complete.
+        pending += part;
+        if (sqlite3_complete((pending + u";"_s).toUtf8().constData()) == 0) {
+            pending += u";"_s;
+            continue;
+        }
+        auto command = std::exchange(pending, {});
         command.replace(u"\n"_s, u" "_s);
         command = command.trimmed();
         if (command.isEmpty()) {
@@ -182,6 +218,53 @@ int sql_trace_callback(unsigned int type, void* context, void* p, void* x) {
     return 0;
 }
 
+// NOLINTNEXTLINE(*-use-internal-linkage)
+void fold_case_function(sqlite3_context* context, int argc, sqlite3_value** argv) {
+    Q_UNUSED(argc);
+    if (sqlite3_value_type(argv[0]) == SQLITE_NULL) {
+        sqlite3_result_null(context);
+        return;
+    }
+    const auto* text = reinterpret_cast<const char*>(sqlite3_value_text(argv[0]));
+    const auto folded = QString::fromUtf8(text, sqlite3_value_bytes(argv[0])).toCaseFolded().toUtf8();
+    sqlite3_result_text(context, folded.constData(), static_cast<int>(folded.size()), SQLITE_TRANSIENT);
+}
+
+bool configureConnection(QSqlDatabase& database) {
+    QVariant v = database.driver()->handle();
+    if (v.isValid() && (qstrcmp(v.typeName(), "sqlite3*") == 0)) {
+        // v.data() returns a pointer to the handle
+        if (sqlite3* handle = *static_cast<sqlite3**>(v.data())) {
+            sqlite3_trace_v2(handle, SQLITE_TRACE_PROFILE, sql_trace_callback, nullptr);
+            // SQLite only folds ASCII, so "é" would not match "É".
+            const auto flags = SQLITE_UTF8 | SQLITE_DETERMINISTIC | SQLITE_INNOCUOUS;
+            if (sqlite3_create_function_v2(handle, "fold_case", 1, flags, nullptr, fold_case_function, nullptr,
+                                           nullptr, nullptr) != SQLITE_OK) {
+                qWarning() << "Could not register fold_case:" << sqlite3_errmsg(handle);
+                return false;
+            }
+        }
+    }
+
+    ChangeCapture::install(database);
+
+    // Ensure we have foreign keys...
+    QSqlQuery foreignKeys(database);
+    if (!foreignKeys.exec(u"PRAGMA foreign_keys = ON;"_s)) {
+        qWarning() << "Could not enable foreign keys: " << foreignKeys.lastError().text();
+        return false;
+    }
+
+    // Wait for other writers (e.g. the import connection) instead of failing immediately.
+    QSqlQuery busyTimeout(database);
+    if (!busyTimeout.exec(u"PRAGMA busy_timeout = %1"_s.arg(BUSY_TIMEOUT_MS))) {
+        qWarning() << "Could not set busy timeout: " << busyTimeout.lastError().text();
+        return false;
+    }
+
+    return true;
+}
+
 void openDatabase(const QString& file, bool seed, bool initialise) {
     if (!QSqlDatabase::isDriverAvailable(driver)) {
         qCritical() << "SQLite driver is not available. Hu?" << QSqlDatabase::drivers();
@@ -197,6 +280,11 @@ void openDatabase(const QString& file, bool seed, bool initialise) {
         qDebug() << "Looking at file at " << QFileInfo(file).canonicalFilePath();
     }
 
+    // Cached statements, readers and translations belong to the previous connection, if any.
+    ConnectionPool::instance().close();
+    StatementCache::forCurrentThread().clear();
+    TypeTranslationCache::clearAll();
+
     // The main database connection.
     QSqlDatabase database = QSqlDatabase::addDatabase(driver);
     database.setDatabaseName(file);
@@ -207,21 +295,26 @@ void openDatabase(const QString& file, bool seed, bool initialise) {
         abort();
     }
 
-    QVariant v = database.driver()->handle();
-    if (v.isValid() && (qstrcmp(v.typeName(), "sqlite3*") == 0)) {
-        // v.data() returns a pointer to the handle
-        if (sqlite3* handle = *static_cast<sqlite3**>(v.data())) {
-            sqlite3_trace_v2(handle, SQLITE_TRACE_PROFILE, sql_trace_callback, nullptr);
-        }
+    if (!configureConnection(database)) {
+        abort();
     }
 
-    // Ensure we have foreign keys...
-    QSqlQuery foreignKeys(database);
-    if (!foreignKeys.exec(u"PRAGMA foreign_keys = ON;"_s)) {
-        qWarning() << "Could not enable foreign keys: " << foreignKeys.lastError().text();
-        abort();
+    if (file != u":memory:"_s) {
+        // Let readers on other threads work while the writer is in a transaction.
+        QSqlQuery journalMode(database);
+        if (!journalMode.exec(u"PRAGMA journal_mode = WAL"_s) || !journalMode.next() ||
+            journalMode.value(0).toString() != u"wal"_s) {
+            qWarning() << "Could not switch database to WAL mode:" << journalMode.lastError().text();
+        }
+        journalMode.finish();
+        QSqlQuery synchronous(database);
+        if (!synchronous.exec(u"PRAGMA synchronous = NORMAL"_s)) {
+            qWarning() << "Could not set synchronous mode:" << synchronous.lastError().text();
+        }
     }
 
+    ConnectionPool::instance().open(file);
+
     if (existing) {
         qDebug() << "Running migrations on existing database...";
         runMigrations(database);
@@ -280,7 +373,12 @@ void openDatabase(const QString& file, bool seed, bool initialise) {
 }
 
 void closeDatabase() {
-    QSqlDatabase::database().close();
+    ConnectionPool::instance().close();
+    StatementCache::forCurrentThread().clear();
+    TypeTranslationCache::clearAll();
+    auto database = QSqlDatabase::database();
+    database.close();
+    ChangeCapture::uninstall(database.connectionName());
 }
 
 bool hasActiveTransaction(const QSqlDatabase& database) {
@@ -6,6 +6,7 @@
 #pragma once
 
 #include "core/data_event_broker.h"
+#include "database/change_capture.h"
 
 #include <QLoggingCategory>
 #include <QSqlDatabase>
@@ -21,6 +22,17 @@ void openDatabase(const QString& file, bool seed = true, bool initialise = true)
 
 void closeDatabase();
 
+/**
+ * Apply the settings every connection needs: foreign keys, tracing, change capture and a busy timeout.
+ * It also registers the SQL function `fold_case(text)`, which case folds text like QString::toCaseFolded().
+ *
+ * openDatabase() does this for the default connection; use it for additional connections
+ * to the same database.
+ *
+ * @return False if a setting could not be applied.
+ */
+bool configureConnection(QSqlDatabase& database);
+
 /**
  * Apply any pending migrations to the database.
  * Reads the current schema version from PRAGMA user_version and runs each
@@ -89,8 +101,9 @@ auto rawExecuteInTransaction(QSqlDatabase& database, const Function& operation)
 /**
  * Execute a lambda in the context of a database-level transaction.
  *
- * Notifications emitted by repositories during the transaction are batched
- * and flushed (deduplicated) after the transaction commits successfully.
+ * Notifications emitted by repositories during the transaction, and the rows
+ * captured by ChangeCapture, are batched and flushed (deduplicated) after the
+ * transaction commits successfully.
  *
  * @param operation Returns std::nullopt if it should abort, a value otherwise.
  * @return The result of the operation, or std::nullopt on failure.
@@ -104,6 +117,9 @@ auto executeInTransaction(const Function& operation) -> decltype(operation()) {
 
     if (!result.has_value()) {
         guard.discard();
+    } else {
+        // Add the changes of the commit to the batch. Does nothing for a nested call.
+        ChangeCapture::deliverCommitted();
     }
 
     return result;
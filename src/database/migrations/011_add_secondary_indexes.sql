@@ -0,0 +1,47 @@
+CREATE INDEX idx_names_person_sort ON names (person_id, sort);
+
+CREATE INDEX idx_names_surname ON names (surname);
+
+CREATE INDEX idx_names_given_names ON names (given_names);
+
+CREATE INDEX idx_event_relations_person_role ON event_relations (person_id, role_id, event_id);
+
+CREATE INDEX idx_event_relations_role ON event_relations (role_id);
+
+CREATE INDEX idx_events_family ON events (family_id);
+
+CREATE INDEX idx_events_date_sort ON events (date_sort);
+
+CREATE INDEX idx_events_type ON events (type_id);
+
+CREATE INDEX idx_events_location ON events (location_id);
+
+CREATE INDEX idx_locations_parent_name ON locations (parent_id, name);
+
+CREATE INDEX idx_locations_name ON locations (name);
+
+CREATE INDEX idx_locations_type ON locations (type_id);
+
+CREATE INDEX idx_sources_parent ON sources (parent_id);
+
+CREATE INDEX idx_sources_type ON sources (type_id);
+
+CREATE INDEX idx_event_citations_source ON event_citations (source_id, event_id);
+
+CREATE INDEX idx_event_relation_citations_source ON event_relation_citations (source_id, event_relation_id);
+
+CREATE INDEX idx_name_citations_source ON name_citations (source_id, name_id);
+
+CREATE INDEX idx_person_citations_source ON person_citations (source_id, person_id);
+
+CREATE INDEX idx_person_media_media ON person_media (media_id, person_id);
+
+CREATE INDEX idx_name_media_media ON name_media (media_id, name_id);
+
+CREATE INDEX idx_event_media_media ON event_media (media_id, event_id);
+
+CREATE INDEX idx_event_relation_media_media ON event_relation_media (media_id, event_relation_id);
+
+CREATE INDEX idx_source_media_media ON source_media (media_id, source_id);
+
+CREATE INDEX idx_location_media_media ON location_media (media_id, location_id);
@@ -0,0 +1,70 @@
+CREATE TABLE parent_links (
+  child_id INTEGER NOT NULL,
+  parent_id INTEGER NOT NULL,
+  role_id INTEGER NOT NULL,
+  event_id INTEGER NOT NULL,
+  PRIMARY KEY (child_id, event_id, role_id, parent_id)
+) WITHOUT ROWID;
+
+CREATE INDEX idx_parent_links_parent ON parent_links (parent_id, child_id);
+
+CREATE INDEX idx_parent_links_event ON parent_links (event_id);
+
+CREATE VIEW parent_link_sources AS
+SELECT child_relation.person_id  AS child_id,
+       parent_relation.person_id AS parent_id,
+       parent_relation.role_id   AS role_id,
+       events.id                 AS event_id
+FROM events
+       JOIN event_relations AS child_relation ON child_relation.event_id = events.id
+       JOIN event_relations AS parent_relation ON parent_relation.event_id = events.id
+WHERE events.type_id IN (SELECT id FROM event_types WHERE type = 'Birth')
+  AND child_relation.role_id IN (SELECT id FROM event_roles WHERE role = 'Primary')
+  AND parent_relation.role_id IN (SELECT id FROM event_roles WHERE role IN ('Father', 'Mother'));
+
+CREATE TRIGGER parent_links_relation_insert AFTER INSERT ON event_relations
+BEGIN
+  DELETE FROM parent_links WHERE event_id = NEW.event_id;
+  INSERT OR IGNORE INTO parent_links SELECT * FROM parent_link_sources WHERE event_id = NEW.event_id;
+END;
+
+CREATE TRIGGER parent_links_relation_update AFTER UPDATE ON event_relations
+BEGIN
+  DELETE FROM parent_links WHERE event_id IN (OLD.event_id, NEW.event_id);
+  INSERT OR IGNORE INTO parent_links SELECT * FROM parent_link_sources WHERE event_id IN (OLD.event_id, NEW.event_id);
+END;
+
+CREATE TRIGGER parent_links_relation_delete AFTER DELETE ON event_relations
+BEGIN
+  DELETE FROM parent_links WHERE event_id = OLD.event_id;
+  INSERT OR IGNORE INTO parent_links SELECT * FROM parent_link_sources WHERE event_id = OLD.event_id;
+END;
+
+CREATE TRIGGER parent_links_event_type_update AFTER UPDATE OF type_id ON events
+BEGIN
+  DELETE FROM parent_links WHERE event_id = NEW.id;
+  INSERT OR IGNORE INTO parent_links SELECT * FROM parent_link_sources WHERE event_id = NEW.id;
+END;
+
+CREATE TRIGGER parent_links_event_delete AFTER DELETE ON events
+BEGIN
+  DELETE FROM parent_links WHERE event_id = OLD.id;
+END;
+
+CREATE TRIGGER parent_links_role_update AFTER UPDATE OF role ON event_roles
+BEGIN
+  DELETE FROM parent_links WHERE event_id IN (SELECT event_id FROM event_relations WHERE role_id = NEW.id);
+  INSERT OR IGNORE INTO parent_links
+  SELECT * FROM parent_link_sources
+  WHERE event_id IN (SELECT event_id FROM event_relations WHERE role_id = NEW.id);
+END;
+
+CREATE TRIGGER parent_links_type_update AFTER UPDATE OF type ON event_types
+BEGIN
+  DELETE FROM parent_links WHERE event_id IN (SELECT id FROM events WHERE type_id = NEW.id);
+  INSERT OR IGNORE INTO parent_links
+  SELECT * FROM parent_link_sources
+  WHERE event_id IN (SELECT id FROM events WHERE type_id = NEW.id);
+END;
+
+INSERT OR IGNORE INTO parent_links SELECT * FROM parent_link_sources;
@@ -0,0 +1,50 @@
+CREATE TABLE person_primary_name (
+  person_id INTEGER NOT NULL PRIMARY KEY,
+  name_id INTEGER NOT NULL,
+  display_name TEXT NOT NULL,
+  sort_key TEXT NOT NULL COLLATE NOCASE
+);
+
+CREATE INDEX idx_person_primary_name_sort_key ON person_primary_name (sort_key, person_id);
+
+CREATE VIEW person_primary_name_sources AS
+SELECT names.person_id AS person_id,
+       names.id        AS name_id,
+       substr(coalesce(' ' || nullif(names.titles, ''), '')
+                || coalesce(' ' || nullif(names.given_names, ''), '')
+                || coalesce(' ' || nullif(names.prefix, ''), '')
+                || coalesce(' ' || nullif(names.surname, ''), ''),
+              2)       AS display_name,
+       trim(coalesce(names.surname, '') || ' ' || coalesce(names.given_names, '')) AS sort_key
+FROM names
+WHERE names.id = (SELECT first_name.id
+                  FROM names AS first_name
+                  WHERE first_name.person_id = names.person_id
+                  ORDER BY first_name.sort, first_name.id
+                  LIMIT 1);
+
+CREATE TRIGGER person_primary_name_insert AFTER INSERT ON names
+BEGIN
+  DELETE FROM person_primary_name WHERE person_id = NEW.person_id;
+  INSERT INTO person_primary_name SELECT * FROM person_primary_name_sources WHERE person_id = NEW.person_id;
+END;
+
+CREATE TRIGGER person_primary_name_update AFTER UPDATE ON names
+BEGIN
+  DELETE FROM person_primary_name WHERE person_id IN (OLD.person_id, NEW.person_id);
+  INSERT INTO person_primary_name
+  SELECT * FROM person_primary_name_sources WHERE person_id IN (OLD.person_id, NEW.person_id);
+END;
+
+CREATE TRIGGER person_primary_name_delete AFTER DELETE ON names
+BEGIN
+  DELETE FROM person_primary_name WHERE person_id = OLD.person_id;
+  INSERT INTO person_primary_name SELECT * FROM person_primary_name_sources WHERE person_id = OLD.person_id;
+END;
+
+CREATE TRIGGER person_primary_name_person_delete AFTER DELETE ON people
+BEGIN
+  DELETE FROM person_primary_name WHERE person_id = OLD.id;
+END;
+
+INSERT INTO person_primary_name SELECT * FROM person_primary_name_sources;
@@ -0,0 +1,440 @@
+ALTER TABLE events
+ADD COLUMN date_type INTEGER;
+
+ALTER TABLE events
+ADD COLUMN date_modifier INTEGER;
+
+ALTER TABLE events
+ADD COLUMN date_quality INTEGER;
+
+ALTER TABLE events
+ADD COLUMN date_precision INTEGER;
+
+ALTER TABLE events
+ADD COLUMN date_first_day INTEGER;
+
+ALTER TABLE events
+ADD COLUMN date_last_day INTEGER;
+
+ALTER TABLE events
+ADD COLUMN date_time INTEGER;
+
+ALTER TABLE events
+ADD COLUMN date_end_time INTEGER;
+
+ALTER TABLE events
+ADD COLUMN date_text TEXT;
+
+ALTER TABLE locations
+RENAME COLUMN date_start_sort TO start_date_sort;
+
+ALTER TABLE locations
+RENAME COLUMN date_end_sort TO end_date_sort;
+
+ALTER TABLE locations
+ADD COLUMN start_date_type INTEGER;
+
+ALTER TABLE locations
+ADD COLUMN start_date_modifier INTEGER;
+
+ALTER TABLE locations
+ADD COLUMN start_date_quality INTEGER;
+
+ALTER TABLE locations
+ADD COLUMN start_date_precision INTEGER;
+
+ALTER TABLE locations
+ADD COLUMN start_date_first_day INTEGER;
+
+ALTER TABLE locations
+ADD COLUMN start_date_last_day INTEGER;
+
+ALTER TABLE locations
+ADD COLUMN start_date_time INTEGER;
+
+ALTER TABLE locations
+ADD COLUMN start_date_end_time INTEGER;
+
+ALTER TABLE locations
+ADD COLUMN start_date_text TEXT;
+
+ALTER TABLE locations
+ADD COLUMN end_date_type INTEGER;
+
+ALTER TABLE locations
+ADD COLUMN end_date_modifier INTEGER;
+
+ALTER TABLE locations
+ADD COLUMN end_date_quality INTEGER;
+
+ALTER TABLE locations
+ADD COLUMN end_date_precision INTEGER;
+
+ALTER TABLE locations
+ADD COLUMN end_date_first_day INTEGER;
+
+ALTER TABLE locations
+ADD COLUMN end_date_last_day INTEGER;
+
+ALTER TABLE locations
+ADD COLUMN end_date_time INTEGER;
+
+ALTER TABLE locations
+ADD COLUMN end_date_end_time INTEGER;
+
+ALTER TABLE locations
+ADD COLUMN end_date_text TEXT;
+
+CREATE TEMP TABLE legacy_dates AS
+SELECT
+  'event' AS kind,
+  id,
+  date AS json
+FROM
+  events
+WHERE
+  json_valid (date)
+  AND json_type (date) = 'object'
+  AND json (date) <> '{}'
+UNION ALL
+SELECT
+  'start',
+  id,
+  date_start
+FROM
+  locations
+WHERE
+  json_valid (date_start)
+  AND json_type (date_start) = 'object'
+  AND json (date_start) <> '{}'
+UNION ALL
+SELECT
+  'end',
+  id,
+  date_end
+FROM
+  locations
+WHERE
+  json_valid (date_end)
+  AND json_type (date_end) = 'object'
+  AND json (date_end) <> '{}';
+
+CREATE TEMP VIEW legacy_date_points AS
+SELECT
+  kind,
+  id,
+  type,
+  CASE
+    WHEN type = 0 THEN CASE json_extract (json, '$.dateModifier')
+      WHEN 'BEFORE' THEN 1
+      WHEN 'AFTER' THEN 2
+      WHEN 'ABOUT' THEN 3
+      WHEN 'DURING' THEN 4
+      ELSE 0
+    END
+    ELSE 0
+  END AS modifier,
+  CASE json_extract (json, '$.dateQuality')
+    WHEN 'ESTIMATED' THEN 1
+    WHEN 'CALCULATED' THEN 2
+    ELSE 0
+  END AS quality,
+  CASE
+      WHEN coalesce(json_type (json, '$.proleptic'), 'null') NOT IN ('integer', 'real')
+      OR json_extract (json, '$.proleptic') <> CAST(json_extract (json, '$.proleptic') AS INTEGER) THEN 0
+      WHEN json_extract (json, '$.proleptic') BETWEEN -784350574879 AND 784354017364 THEN CAST(json_extract (json, '$.proleptic') AS INTEGER)
+    END AS start_jd,
+  CASE json_type (json, '$.year')
+    WHEN 'true' THEN 1
+    ELSE 0
+  END AS start_year,
+  CASE json_type (json, '$.month')
+    WHEN 'true' THEN 1
+    ELSE 0
+  END AS start_month,
+  CASE json_type (json, '$.day')
+    WHEN 'true' THEN 1
+    ELSE 0
+  END AS start_day,
+  CASE
+      WHEN json_extract (json, '$.time') GLOB '[0-2][0-9]:[0-5][0-9]'
+      AND json_extract (json, '$.time') < '24' THEN substr (json_extract (json, '$.time'), 1, 2) * 60 + substr (json_extract (json, '$.time'), 4, 2)
+    END AS start_time,
+  CASE
+    WHEN type <> 0
+    AND json_type (json, '$.endYear') = 'true' THEN CASE
+      WHEN coalesce(json_type (json, '$.endProleptic'), 'null') NOT IN ('integer', 'real')
+      OR json_extract (json, '$.endProleptic') <> CAST(json_extract (json, '$.endProleptic') AS INTEGER) THEN 0
+      WHEN json_extract (json, '$.endProleptic') BETWEEN -784350574879 AND 784354017364 THEN CAST(json_extract (json, '$.endProleptic') AS INTEGER)
+    END
+  END AS end_jd,
+  CASE
+    WHEN type <> 0
+    AND json_type (json, '$.endYear') = 'true' THEN 1
+    ELSE 0
+  END AS end_year,
+  CASE
+    WHEN type <> 0
+    AND json_type (json, '$.endMonth') = 'true' THEN 1
+    ELSE 0
+  END AS end_month,
+  CASE
+    WHEN type <> 0
+    AND json_type (json, '$.endDay') = 'true' THEN 1
+    ELSE 0
+  END AS end_day,
+  CASE
+    WHEN type <> 0 THEN CASE
+      WHEN json_extract (json, '$.endTime') GLOB '[0-2][0-9]:[0-5][0-9]'
+      AND json_extract (json, '$.endTime') < '24' THEN substr (json_extract (json, '$.endTime'), 1, 2) * 60 + substr (json_extract (json, '$.endTime'), 4, 2)
+    END
+  END AS end_time,
+  CASE json_type (json, '$.userText')
+    WHEN 'text' THEN json_extract (json, '$.userText')
+    ELSE ''
+  END AS text
+FROM
+  (
+    SELECT
+      kind,
+      id,
+      json,
+      CASE json_extract (json, '$.dateType')
+        WHEN 'RANGE' THEN 1
+        WHEN 'SPAN' THEN 2
+        ELSE 0
+      END AS type
+    FROM
+      legacy_dates
+  );
+
+CREATE TEMP VIEW legacy_date_calendar_steps AS
+SELECT
+  *,
+  4 * (start_shifted + 1401 + (((4 * start_shifted + 274277) / 146097) * 3) / 4 - 38) + 3 AS start_e,
+  4 * (end_shifted + 1401 + (((4 * end_shifted + 274277) / 146097) * 3) / 4 - 38) + 3 AS end_e
+FROM
+  (
+    SELECT
+      *,
+      start_jd + 788923800000 AS start_shifted,
+      end_jd + 788923800000 AS end_shifted
+    FROM
+      legacy_date_points
+  );
+
+CREATE TEMP VIEW legacy_date_calendar AS
+SELECT
+  *,
+  ((5 * ((start_e % 1461) / 4) + 2) % 153) / 5 + 1 AS start_day_of_month,
+  ((5 * ((start_e % 1461) / 4) + 2) / 153 + 2) % 12 + 1 AS start_month_of_year,
+  start_e / 1461 - 4716 + (14 - (((5 * ((start_e % 1461) / 4) + 2) / 153 + 2) % 12 + 1)) / 12 AS start_calendar_year,
+  ((5 * ((end_e % 1461) / 4) + 2) % 153) / 5 + 1 AS end_day_of_month,
+  ((5 * ((end_e % 1461) / 4) + 2) / 153 + 2) % 12 + 1 AS end_month_of_year,
+  end_e / 1461 - 4716 + (14 - (((5 * ((end_e % 1461) / 4) + 2) / 153 + 2) % 12 + 1)) / 12 AS end_calendar_year
+FROM
+  legacy_date_calendar_steps;
+
+CREATE TEMP VIEW legacy_date_lengths AS
+SELECT
+  *,
+  start_jd - start_day_of_month + 1 AS start_month_first,
+  CASE
+    WHEN start_month_of_year = 2 THEN 28 + start_leap
+    WHEN start_month_of_year IN (4, 6, 9, 11) THEN 30
+    ELSE 31
+  END AS start_month_length,
+  306 + 365 * (start_calendar_year + 4799) + (start_calendar_year + 4799) / 4 - (start_calendar_year + 4799) / 100 + (start_calendar_year + 4799) / 400 - 32044 - 788923800000 AS start_year_first,
+  365 + start_leap AS start_year_length,
+  end_jd - end_day_of_month + 1 AS end_month_first,
+  CASE
+    WHEN end_month_of_year = 2 THEN 28 + end_leap
+    WHEN end_month_of_year IN (4, 6, 9, 11) THEN 30
+    ELSE 31
+  END AS end_month_length,
+  306 + 365 * (end_calendar_year + 4799) + (end_calendar_year + 4799) / 4 - (end_calendar_year + 4799) / 100 + (end_calendar_year + 4799) / 400 - 32044 - 788923800000 AS end_year_first,
+  365 + end_leap AS end_year_length
+FROM
+  (
+    SELECT
+      *,
+      start_calendar_year % 4 = 0
+      AND (
+        start_calendar_year % 100 <> 0
+        OR start_calendar_year % 400 = 0
+      ) AS start_leap,
+      end_calendar_year % 4 = 0
+      AND (
+        end_calendar_year % 100 <> 0
+        OR end_calendar_year % 400 = 0
+      ) AS end_leap
+    FROM
+      legacy_date_calendar
+  );
+
+CREATE TEMP VIEW legacy_date_periods AS
+SELECT
+  *,
+  CASE
+    WHEN start_day = 1 OR start_year = 0 THEN start_jd
+    WHEN start_month = 1 THEN start_month_first
+    ELSE start_year_first
+  END AS start_first,
+  CASE
+    WHEN start_day = 1 OR start_year = 0 THEN start_jd
+    WHEN start_month = 1 THEN start_month_first + start_month_length - 1
+    ELSE start_year_first + start_year_length - 1
+  END AS start_last,
+  CASE
+    WHEN end_day = 1 OR end_year = 0 THEN end_jd
+    WHEN end_month = 1 THEN end_month_first + end_month_length - 1
+    ELSE end_year_first + end_year_length - 1
+  END AS end_last
+FROM
+  legacy_date_lengths;
+
+CREATE TEMP VIEW legacy_date_values AS
+SELECT
+  kind,
+  id,
+  type,
+  modifier,
+  quality,
+  start_year + 2 * start_month + 4 * start_day + 8 * end_year + 16 * end_month + 32 * end_day AS precision,
+  start_jd AS sort_day,
+  CASE
+    WHEN type = 0
+    AND start_jd IS NULL THEN NULL
+    WHEN type = 0
+    AND modifier = 1 THEN -9223372036854775808
+    WHEN type = 0
+    AND modifier = 2 THEN start_last + 1
+    WHEN type = 0 THEN start_first
+    WHEN start_jd IS NULL
+    AND end_jd IS NULL THEN NULL
+    ELSE coalesce(start_first, -9223372036854775808)
+  END AS first_day,
+  CASE
+    WHEN type = 0
+    AND start_jd IS NULL THEN NULL
+    WHEN type = 0
+    AND modifier = 1 THEN start_first - 1
+    WHEN type = 0
+    AND modifier = 2 THEN 9223372036854775807
+    WHEN type = 0 THEN start_last
+    WHEN start_jd IS NULL
+    AND end_jd IS NULL THEN NULL
+    ELSE coalesce(end_last, 9223372036854775807)
+  END AS last_day,
+  start_time,
+  end_time,
+  text
+FROM
+  legacy_date_periods
+WHERE
+  NOT (
+    type = 0
+    AND start_jd IS NULL
+    AND start_year = 0
+    AND start_month = 0
+    AND start_day = 0
+    AND text = ''
+  );
+
+UPDATE events
+SET
+  date_sort = NULL;
+
+UPDATE locations
+SET
+  start_date_sort = NULL,
+  end_date_sort = NULL;
+
+UPDATE events
+SET
+  date_type = decoded.type,
+  date_modifier = decoded.modifier,
+  date_quality = decoded.quality,
+  date_precision = decoded.precision,
+  date_sort = decoded.sort_day,
+  date_first_day = decoded.first_day,
+  date_last_day = decoded.last_day,
+  date_time = decoded.start_time,
+  date_end_time = decoded.end_time,
+  date_text = decoded.text
+FROM
+  legacy_date_values AS decoded
+WHERE
+  decoded.kind = 'event'
+  AND decoded.id = events.id;
+
+UPDATE locations
+SET
+  start_date_type = decoded.type,
+  start_date_modifier = decoded.modifier,
+  start_date_quality = decoded.quality,
+  start_date_precision = decoded.precision,
+  start_date_sort = decoded.sort_day,
+  start_date_first_day = decoded.first_day,
+  start_date_last_day = decoded.last_day,
+  start_date_time = decoded.start_time,
+  start_date_end_time = decoded.end_time,
+  start_date_text = decoded.text
+FROM
+  legacy_date_values AS decoded
+WHERE
+  decoded.kind = 'start'
+  AND decoded.id = locations.id;
+
+UPDATE locations
+SET
+  end_date_type = decoded.type,
+  end_date_modifier = decoded.modifier,
+  end_date_quality = decoded.quality,
+  end_date_precision = decoded.precision,
+  end_date_sort = decoded.sort_day,
+  end_date_first_day = decoded.first_day,
+  end_date_last_day = decoded.last_day,
+  end_date_time = decoded.start_time,
+  end_date_end_time = decoded.end_time,
+  end_date_text = decoded.text
+FROM
+  legacy_date_values AS decoded
+WHERE
+  decoded.kind = 'end'
+  AND decoded.id = locations.id;
+
+DROP VIEW legacy_date_values;
+
+DROP VIEW legacy_date_periods;
+
+DROP VIEW legacy_date_lengths;
+
+DROP VIEW legacy_date_calendar;
+
+DROP VIEW legacy_date_calendar_steps;
+
+DROP VIEW legacy_date_points;
+
+DROP TABLE legacy_dates;
+
+ALTER TABLE events
+DROP COLUMN date;
+
+ALTER TABLE locations
+DROP COLUMN date_start;
+
+ALTER TABLE locations
+DROP COLUMN date_end;
+
+CREATE INDEX idx_events_date_first_day ON events (date_first_day);
+
+CREATE INDEX idx_events_date_last_day ON events (date_last_day);
+
+CREATE INDEX idx_locations_start_date_first_day ON locations (start_date_first_day);
+
+CREATE INDEX idx_locations_start_date_last_day ON locations (start_date_last_day);
+
+CREATE INDEX idx_locations_end_date_first_day ON locations (end_date_first_day);
+
+CREATE INDEX idx_locations_end_date_last_day ON locations (end_date_last_day);
@@ -6,12 +6,28 @@
 #pragma once
 
 #include <QString>
+#include <algorithm>
+#include <array>
+#include <optional>
 #include <type_traits>
 
 using IntegerPrimaryKey = qlonglong;
 
 namespace Schema {
-struct TableTag {};
+struct TableTag {
+    // The rowid of a row is the value of its id column.
+    static constexpr bool rowid_is_id = true;
+};
+
+/**
+ * A table linking two other tables, with a composite primary key.
+ *
+ * Its rowid does not identify anything outside the table, so changes to it are notified with
+ * the id of the owning row instead (e.g. the event of an event citation).
+ */
+struct JunctionTableTag : TableTag {
+    static constexpr bool rowid_is_id = false;
+};
 
 struct People : TableTag {
     static constexpr auto table = QLatin1String("people");
@@ -58,22 +74,22 @@ struct Sources : TableTag {
 };
 inline constexpr auto SourcesTable = Sources::table;
 
-struct EventCitations : TableTag {
+struct EventCitations : JunctionTableTag {
     static constexpr auto table = QLatin1String("event_citations");
 };
 inline constexpr auto EventCitationsTable = EventCitations::table;
 
-struct EventRelationCitations : TableTag {
+struct EventRelationCitations : JunctionTableTag {
     static constexpr auto table = QLatin1String("event_relation_citations");
 };
 inline constexpr auto EventRelationCitationsTable = EventRelationCitations::table;
 
-struct NameCitations : TableTag {
+struct NameCitations : JunctionTableTag {
     static constexpr auto table = QLatin1String("name_citations");
 };
 inline constexpr auto NameCitationsTable = NameCitations::table;
 
-struct PersonCitations : TableTag {
+struct PersonCitations : JunctionTableTag {
     static constexpr auto table = QLatin1String("person_citations");
 };
 inline constexpr auto PersonCitationsTable = PersonCitations::table;
@@ -123,36 +139,115 @@ struct Media : TableTag {
 };
 inline constexpr auto MediaTable = Media::table;
 
-struct PersonMedia : TableTag {
+struct PersonMedia : JunctionTableTag {
     static constexpr auto table = QLatin1String("person_media");
 };
 inline constexpr auto PersonMediaTable = PersonMedia::table;
 
-struct NameMedia : TableTag {
+struct NameMedia : JunctionTableTag {
     static constexpr auto table = QLatin1String("name_media");
 };
 inline constexpr auto NameMediaTable = NameMedia::table;
 
-struct EventMedia : TableTag {
+struct EventMedia : JunctionTableTag {
     static constexpr auto table = QLatin1String("event_media");
 };
 inline constexpr auto EventMediaTable = EventMedia::table;
 
-struct EventRelationMedia : TableTag {
+struct EventRelationMedia : JunctionTableTag {
     static constexpr auto table = QLatin1String("event_relation_media");
 };
 inline constexpr auto EventRelationMediaTable = EventRelationMedia::table;
 
-struct SourceMedia : TableTag {
+struct SourceMedia : JunctionTableTag {
     static constexpr auto table = QLatin1String("source_media");
 };
 inline constexpr auto SourceMediaTable = SourceMedia::table;
 
-struct LocationMedia : TableTag {
+struct LocationMedia : JunctionTableTag {
     static constexpr auto table = QLatin1String("location_media");
 };
 inline constexpr auto LocationMediaTable = LocationMedia::table;
 
 template<typename T>
 inline constexpr bool is_table_tag = std::is_base_of_v<TableTag, T>;
+
+template<typename... Tags>
+struct TableList {
+    static constexpr std::size_t size = sizeof...(Tags);
+    static constexpr std::array<QLatin1String, size> names = {Tags::table...};
+    static constexpr std::array<bool, size> rowidIsId = {Tags::rowid_is_id...};
+
+    template<typename T>
+    static consteval std::size_t indexOf() {
+        constexpr std::array<bool, size> matches = {std::is_same_v<T, Tags>...};
+        return std::ranges::find(matches, true) - matches.begin();
+    }
+};
+
+/**
+ * All tables, which gives each table tag a compile-time integer id.
+ *
+ * New tags must be added here as well.
+ */
+using Tables = TableList<
+    People,
+    Names,
+    NameOrigins,
+    Families,
+    Events,
+    EventRoles,
+    EventTypes,
+    EventRelations,
+    Sources,
+    EventCitations,
+    EventRelationCitations,
+    NameCitations,
+    PersonCitations,
+    LocationTypes,
+    Locations,
+    EventRoleTranslations,
+    NameOriginTranslations,
+    SourceTypes,
+    SourceTypeTranslations,
+    EventTypeTranslations,
+    LocationTypeTranslations,
+    Media,
+    PersonMedia,
+    NameMedia,
+    EventMedia,
+    EventRelationMedia,
+    SourceMedia,
+    LocationMedia>;
+
+inline constexpr std::size_t table_count = Tables::size;
+
+/**
+ * The id of a table tag, usable as an index into arrays of size table_count.
+ */
+template<typename T>
+    requires is_table_tag<T>
+inline constexpr std::size_t table_id = [] {
+    constexpr auto id = Tables::indexOf<T>();
+    static_assert(id < table_count, "The table tag is missing in Schema::Tables.");
+    return id;
+}();
+
+/**
+ * @return The name of the table with the given id.
+ */
+constexpr QLatin1String tableName(std::size_t tableId) {
+    return Tables::names[tableId];
+}
+
+/**
+ * @return The id of the table with the given name, or std::nullopt if it has no tag.
+ */
+inline std::optional<std::size_t> tableId(QLatin1String name) {
+    const auto it = std::ranges::find(Tables::names, name);
+    if (it == Tables::names.end()) {
+        return std::nullopt;
+    }
+    return static_cast<std::size_t>(it - Tables::names.begin());
+}
 }
@@ -29,6 +29,13 @@ CREATE TABLE names (
   origin_id INTEGER NULL DEFAULT NULL REFERENCES name_origins (id) ON DELETE SET DEFAULT
 );
 
+CREATE TABLE person_primary_name (
+  person_id INTEGER NOT NULL PRIMARY KEY,
+  name_id INTEGER NOT NULL,
+  display_name TEXT NOT NULL,
+  sort_key TEXT NOT NULL COLLATE NOCASE
+);
+
 CREATE TABLE event_types (
   id INTEGER NOT NULL PRIMARY KEY AUTOINCREMENT,
   type TEXT,
@@ -55,10 +62,26 @@ CREATE TABLE locations (
   note TEXT,
   latitude REAL,
   longitude REAL,
-  date_start TEXT,
-  date_start_sort INTEGER,
-  date_end TEXT,
-  date_end_sort INTEGER
+  start_date_type INTEGER,
+  start_date_modifier INTEGER,
+  start_date_quality INTEGER,
+  start_date_precision INTEGER,
+  start_date_sort INTEGER,
+  start_date_first_day INTEGER,
+  start_date_last_day INTEGER,
+  start_date_time INTEGER,
+  start_date_end_time INTEGER,
+  start_date_text TEXT,
+  end_date_type INTEGER,
+  end_date_modifier INTEGER,
+  end_date_quality INTEGER,
+  end_date_precision INTEGER,
+  end_date_sort INTEGER,
+  end_date_first_day INTEGER,
+  end_date_last_day INTEGER,
+  end_date_time INTEGER,
+  end_date_end_time INTEGER,
+  end_date_text TEXT
 );
 
 CREATE TABLE location_external_ids (
@@ -83,8 +106,16 @@ CREATE TABLE family_external_ids (
 CREATE TABLE events (
   id INTEGER NOT NULL PRIMARY KEY AUTOINCREMENT,
   type_id INTEGER NOT NULL REFERENCES event_types (id) ON DELETE RESTRICT,
-  date TEXT,
+  date_type INTEGER,
+  date_modifier INTEGER,
+  date_quality INTEGER,
+  date_precision INTEGER,
   date_sort INTEGER,
+  date_first_day INTEGER,
+  date_last_day INTEGER,
+  date_time INTEGER,
+  date_end_time INTEGER,
+  date_text TEXT,
   name TEXT,
   note TEXT,
   location_id INTEGER NULL REFERENCES locations (id) ON DELETE SET NULL,
@@ -106,13 +137,34 @@ CREATE TABLE event_relations (
   UNIQUE (event_id, person_id, role_id)
 );
 
+CREATE TABLE parent_links (
+  child_id INTEGER NOT NULL,
+  parent_id INTEGER NOT NULL,
+  role_id INTEGER NOT NULL,
+  event_id INTEGER NOT NULL,
+  PRIMARY KEY (child_id, event_id, role_id, parent_id)
+) WITHOUT ROWID;
+
+CREATE TABLE source_types (
+  id INTEGER NOT NULL PRIMARY KEY AUTOINCREMENT,
+  type TEXT NOT NULL,
+  builtin BOOLEAN NOT NULL DEFAULT FALSE
+);
+
+CREATE TABLE source_type_translations (
+  id INTEGER NOT NULL PRIMARY KEY AUTOINCREMENT,
+  type_id INTEGER NOT NULL REFERENCES source_types (id) ON DELETE CASCADE,
+  locale TEXT NOT NULL,
+  name TEXT NOT NULL,
+  UNIQUE (type_id, locale)
+);
+
 CREATE TABLE sources (
   id INTEGER NOT NULL PRIMARY KEY AUTOINCREMENT,
   title TEXT,
-  type TEXT,
+  type_id INTEGER REFERENCES source_types (id) ON DELETE SET NULL,
   author TEXT,
   publication TEXT,
-  -- 1 (min) -> 5 (max)
   confidence INTEGER DEFAULT 3,
   note TEXT,
   parent_id INTEGER REFERENCES sources (id) ON DELETE SET NULL
@@ -231,3 +283,166 @@ CREATE TABLE location_media (
   media_id INTEGER NOT NULL REFERENCES media (id) ON DELETE CASCADE,
   PRIMARY KEY (location_id, media_id)
 );
+
+CREATE INDEX idx_names_person_sort ON names (person_id, sort);
+
+CREATE INDEX idx_names_surname ON names (surname);
+
+CREATE INDEX idx_names_given_names ON names (given_names);
+
+CREATE INDEX idx_event_relations_person_role ON event_relations (person_id, role_id, event_id);
+
+CREATE INDEX idx_event_relations_role ON event_relations (role_id);
+
+CREATE INDEX idx_events_family ON events (family_id);
+
+CREATE INDEX idx_events_date_sort ON events (date_sort);
+
+CREATE INDEX idx_events_date_first_day ON events (date_first_day);
+
+CREATE INDEX idx_events_date_last_day ON events (date_last_day);
+
+CREATE INDEX idx_events_type ON events (type_id);
+
+CREATE INDEX idx_events_location ON events (location_id);
+
+CREATE INDEX idx_locations_parent_name ON locations (parent_id, name);
+
+CREATE INDEX idx_locations_name ON locations (name);
+
+CREATE INDEX idx_locations_type ON locations (type_id);
+
+CREATE INDEX idx_locations_start_date_first_day ON locations (start_date_first_day);
+
+CREATE INDEX idx_locations_start_date_last_day ON locations (start_date_last_day);
+
+CREATE INDEX idx_locations_end_date_first_day ON locations (end_date_first_day);
+
+CREATE INDEX idx_locations_end_date_last_day ON locations (end_date_last_day);
+
+CREATE INDEX idx_sources_parent ON sources (parent_id);
+
+CREATE INDEX idx_sources_type ON sources (type_id);
+
+CREATE INDEX idx_event_citations_source ON event_citations (source_id, event_id);
+
+CREATE INDEX idx_event_relation_citations_source ON event_relation_citations (source_id, event_relation_id);
+
+CREATE INDEX idx_name_citations_source ON name_citations (source_id, name_id);
+
+CREATE INDEX idx_person_citations_source ON person_citations (source_id, person_id);
+
+CREATE INDEX idx_person_media_media ON person_media (media_id, person_id);
+
+CREATE INDEX idx_name_media_media ON name_media (media_id, name_id);
+
+CREATE INDEX idx_event_media_media ON event_media (media_id, event_id);
+
+CREATE INDEX idx_event_relation_media_media ON event_relation_media (media_id, event_relation_id);
+
+CREATE INDEX idx_source_media_media ON source_media (media_id, source_id);
+
+CREATE INDEX idx_location_media_media ON location_media (media_id, location_id);
+
+CREATE INDEX idx_parent_links_parent ON parent_links (parent_id, child_id);
+
+CREATE INDEX idx_parent_links_event ON parent_links (event_id);
+
+CREATE VIEW parent_link_sources AS
+SELECT child_relation.person_id  AS child_id,
+       parent_relation.person_id AS parent_id,
+       parent_relation.role_id   AS role_id,
+       events.id                 AS event_id
+FROM events
+       JOIN event_relations AS child_relation ON child_relation.event_id = events.id
+       JOIN event_relations AS parent_relation ON parent_relation.event_id = events.id
+WHERE events.type_id IN (SELECT id FROM event_types WHERE type = 'Birth')
+  AND child_relation.role_id IN (SELECT id FROM event_roles WHERE role = 'Primary')
+  AND parent_relation.role_id IN (SELECT id FROM event_roles WHERE role IN ('Father', 'Mother'));
+
+CREATE TRIGGER parent_links_relation_insert AFTER INSERT ON event_relations
+BEGIN
+  DELETE FROM parent_links WHERE event_id = NEW.event_id;
+  INSERT OR IGNORE INTO parent_links SELECT * FROM parent_link_sources WHERE event_id = NEW.event_id;
+END;
+
+CREATE TRIGGER parent_links_relation_update AFTER UPDATE ON event_relations
+BEGIN
+  DELETE FROM parent_links WHERE event_id IN (OLD.event_id, NEW.event_id);
+  INSERT OR IGNORE INTO parent_links SELECT * FROM parent_link_sources WHERE event_id IN (OLD.event_id, NEW.event_id);
+END;
+
+CREATE TRIGGER parent_links_relation_delete AFTER DELETE ON event_relations
+BEGIN
+  DELETE FROM parent_links WHERE event_id = OLD.event_id;
+  INSERT OR IGNORE INTO parent_links SELECT * FROM parent_link_sources WHERE event_id = OLD.event_id;
+END;
+
+CREATE TRIGGER parent_links_event_type_update AFTER UPDATE OF type_id ON events
+BEGIN
+  DELETE FROM parent_links WHERE event_id = NEW.id;
+  INSERT OR IGNORE INTO parent_links SELECT * FROM parent_link_sources WHERE event_id = NEW.id;
+END;
+
+CREATE TRIGGER parent_links_event_delete AFTER DELETE ON events
+BEGIN
+  DELETE FROM parent_links WHERE event_id = OLD.id;
+END;
+
+CREATE TRIGGER parent_links_role_update AFTER UPDATE OF role ON event_roles
+BEGIN
+  DELETE FROM parent_links WHERE event_id IN (SELECT event_id FROM event_relations WHERE role_id = NEW.id);
+  INSERT OR IGNORE INTO parent_links
+  SELECT * FROM parent_link_sources
+  WHERE event_id IN (SELECT event_id FROM event_relations WHERE role_id = NEW.id);
+END;
+
+CREATE TRIGGER parent_links_type_update AFTER UPDATE OF type ON event_types
+BEGIN
+  DELETE FROM parent_links WHERE event_id IN (SELECT id FROM events WHERE type_id = NEW.id);
+  INSERT OR IGNORE INTO parent_links
+  SELECT * FROM parent_link_sources
+  WHERE event_id IN (SELECT id FROM events WHERE type_id = NEW.id);
+END;
+
+CREATE INDEX idx_person_primary_name_sort_key ON person_primary_name (sort_key, person_id);
+
+CREATE VIEW person_primary_name_sources AS
+SELECT names.person_id AS person_id,
+       names.id        AS name_id,
+       substr(coalesce(' ' || nullif(names.titles, ''), '')
+                || coalesce(' ' || nullif(names.given_names, ''), '')
+                || coalesce(' ' || nullif(names.prefix, ''), '')
+                || coalesce(' ' || nullif(names.surname, ''), ''),
+              2)       AS display_name,
+       trim(coalesce(names.surname, '') || ' ' || coalesce(names.given_names, '')) AS sort_key
+FROM names
+WHERE names.id = (SELECT first_name.id
+                  FROM names AS first_name
+                  WHERE first_name.person_id = names.person_id
+                  ORDER BY first_name.sort, first_name.id
+                  LIMIT 1);
+
+CREATE TRIGGER person_primary_name_insert AFTER INSERT ON names
+BEGIN
+  DELETE FROM person_primary_name WHERE person_id = NEW.person_id;
+  INSERT INTO person_primary_name SELECT * FROM person_primary_name_sources WHERE person_id = NEW.person_id;
+END;
+
+CREATE TRIGGER person_primary_name_update AFTER UPDATE ON names
+BEGIN
+  DELETE FROM person_primary_name WHERE person_id IN (OLD.person_id, NEW.person_id);
+  INSERT INTO person_primary_name
+  SELECT * FROM person_primary_name_sources WHERE person_id IN (OLD.person_id, NEW.person_id);
+END;
+
+CREATE TRIGGER person_primary_name_delete AFTER DELETE ON names
+BEGIN
+  DELETE FROM person_primary_name WHERE person_id = OLD.person_id;
+  INSERT INTO person_primary_name SELECT * FROM person_primary_name_sources WHERE person_id = OLD.person_id;
+END;
+
+CREATE TRIGGER person_primary_name_person_delete AFTER DELETE ON people
+BEGIN
+  DELETE FROM person_primary_name WHERE person_id = OLD.id;
+END;
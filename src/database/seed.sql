@@ -35,77 +35,144 @@ VALUES
   (9, 9, 1, '', 'Ebenezer', '', 'No name', '', 1);
 
 INSERT INTO
-  events (id, type_id, date, date_sort, name, note)
+  events (
+    id,
+    type_id,
+    date_type,
+    date_modifier,
+    date_quality,
+    date_precision,
+    date_sort,
+    date_first_day,
+    date_last_day,
+    date_text,
+    name,
+    note
+  )
 VALUES
   (
     1,
     1,
-    '{"dateModifier":"NONE","dateQuality":"EXACT","dateType":"SINGLE","day":true,"endDay":false,"month":true,"endMonth":false,"proleptic":2451160,"endProleptic":0,"userText":"","year":true,"endYear":false}',
+    0,
+    0,
+    0,
+    7,
+    2451160,
     2451160,
+    2451160,
+    '',
     'Birth of John',
     ''
   ),
   (
     2,
     1,
-    '{"dateModifier":"NONE","dateQuality":"EXACT","dateType":"SINGLE","day":true,"endDay":false,"month":true,"endMonth":false,"proleptic":2451160,"endProleptic":0,"userText":"","year":true,"endYear":false}',
+    0,
+    0,
+    0,
+    7,
+    2451160,
     2451160,
+    2451160,
+    '',
     'Birth of Jane',
     ''
   ),
   (
     6,
     1,
-    '{"dateModifier":"NONE","dateQuality":"EXACT","dateType":"SINGLE","day":true,"endDay":false,"month":true,"endMonth":false,"proleptic":2451160,"endProleptic":0,"userText":"","year":true,"endYear":false}',
+    0,
+    0,
+    0,
+    7,
+    2451160,
+    2451160,
     2451160,
+    '',
     'Birth of Michael',
     ''
   ),
   (
     7,
     1,
-    '{"dateModifier":"NONE","dateQuality":"EXACT","dateType":"SINGLE","day":true,"endDay":false,"month":true,"endMonth":false,"proleptic":2451160,"endProleptic":0,"userText":"","year":true,"endYear":false}',
+    0,
+    0,
+    0,
+    7,
+    2451160,
+    2451160,
     2451160,
+    '',
     'Birth of Emily',
     ''
   ),
   (
     8,
     1,
-    '{"dateModifier":"NONE","dateQuality":"EXACT","dateType":"SINGLE","day":true,"endDay":false,"month":true,"endMonth":false,"proleptic":2451160,"endProleptic":0,"userText":"","year":true,"endYear":false}',
+    0,
+    0,
+    0,
+    7,
+    2451160,
     2451160,
+    2451160,
+    '',
     'Birth of William',
     ''
   ),
   (
     9,
     1,
-    '{"dateModifier":"NONE","dateQuality":"EXACT","dateType":"SINGLE","day":true,"endDay":false,"month":true,"endMonth":false,"proleptic":2451160,"endProleptic":0,"userText":"","year":true,"endYear":false}',
+    0,
+    0,
+    0,
+    7,
     2451160,
+    2451160,
+    2451160,
+    '',
     'Birth of Elizabeth',
     ''
   ),
   (
     10,
     1,
-    '{"dateModifier":"NONE","dateQuality":"EXACT","dateType":"SINGLE","day":true,"endDay":false,"month":true,"endMonth":false,"proleptic":2451160,"endProleptic":0,"userText":"","year":true,"endYear":false}',
+    0,
+    0,
+    0,
+    7,
     2451160,
+    2451160,
+    2451160,
+    '',
     'Birth of George',
     ''
   ),
   (
     11,
     1,
-    '{"dateModifier":"NONE","dateQuality":"EXACT","dateType":"SINGLE","day":true,"endDay":false,"month":true,"endMonth":false,"proleptic":2451160,"endProleptic":0,"userText":"","year":true,"endYear":false}',
+    0,
+    0,
+    0,
+    7,
     2451160,
+    2451160,
+    2451160,
+    '',
     'Birth of Mary',
     ''
   ),
   (
     16,
     1,
-    '{"dateModifier":"NONE","dateQuality":"EXACT","dateType":"SINGLE","day":true,"endDay":false,"month":true,"endMonth":false,"proleptic":2451160,"endProleptic":0,"userText":"","year":true,"endYear":false}',
+    0,
+    0,
+    0,
+    7,
     2451160,
+    2451160,
+    2451160,
+    '',
     'Birth of Ebenezer',
     ''
   );
@@ -138,29 +205,60 @@ VALUES
   (10, 9, 5);
 
 INSERT INTO
-  events (id, type_id, date, date_sort, name, note)
+  events (
+    id,
+    type_id,
+    date_type,
+    date_modifier,
+    date_quality,
+    date_precision,
+    date_sort,
+    date_first_day,
+    date_last_day,
+    date_text,
+    name,
+    note
+  )
 VALUES
   (
     3,
     3,
-    '{"dateModifier":"NONE","dateQuality":"EXACT","dateType":"SINGLE","day":true,"endDay":false,"month":true,"endMonth":false,"proleptic":2451160,"endProleptic":0,"userText":"","year":true,"endYear":false}',
+    0,
+    0,
+    0,
+    7,
+    2451160,
+    2451160,
     2451160,
+    '',
     'Marriage of Michael and Emily',
     ''
   ),
   (
     4,
     3,
-    '{"dateModifier":"NONE","dateQuality":"EXACT","dateType":"SINGLE","day":true,"endDay":false,"month":true,"endMonth":false,"proleptic":2451160,"endProleptic":0,"userText":"","year":true,"endYear":false}',
+    0,
+    0,
+    0,
+    7,
+    2451160,
     2451160,
+    2451160,
+    '',
     'Marriage of William and Elizabeth',
     ''
   ),
   (
     5,
     3,
-    '{"dateModifier":"NONE","dateQuality":"EXACT","dateType":"SINGLE","day":true,"endDay":false,"month":true,"endMonth":false,"proleptic":2451160,"endProleptic":0,"userText":"","year":true,"endYear":false}',
+    0,
+    0,
+    0,
+    7,
     2451160,
+    2451160,
+    2451160,
+    '',
     'Marriage of George and Mary',
     ''
   );
@@ -176,37 +274,74 @@ VALUES
   (5, 8, 2);
 
 INSERT INTO
-  events (id, type_id, date, date_sort, name, note)
+  events (
+    id,
+    type_id,
+    date_type,
+    date_modifier,
+    date_quality,
+    date_precision,
+    date_sort,
+    date_first_day,
+    date_last_day,
+    date_text,
+    name,
+    note
+  )
 VALUES
   (
     12,
     2,
-    '{"dateModifier":"NONE","dateQuality":"EXACT","dateType":"SINGLE","day":true,"endDay":false,"month":true,"endMonth":false,"proleptic":2451160,"endProleptic":0,"userText":"","year":true,"endYear":false}',
+    0,
+    0,
+    0,
+    7,
+    2451160,
+    2451160,
     2451160,
+    '',
     'Death of William',
     ''
   ),
   (
     13,
     2,
-    '{"dateModifier":"NONE","dateQuality":"EXACT","dateType":"SINGLE","day":true,"endDay":false,"month":true,"endMonth":false,"proleptic":2451160,"endProleptic":0,"userText":"","year":true,"endYear":false}',
+    0,
+    0,
+    0,
+    7,
+    2451160,
+    2451160,
     2451160,
+    '',
     'Death of Elizabeth',
     ''
   ),
   (
     14,
     2,
-    '{"dateModifier":"NONE","dateQuality":"EXACT","dateType":"SINGLE","day":true,"endDay":false,"month":true,"endMonth":false,"proleptic":2451160,"endProleptic":0,"userText":"","year":true,"endYear":false}',
+    0,
+    0,
+    0,
+    7,
+    2451160,
+    2451160,
     2451160,
+    '',
     'Death of George',
     ''
   ),
   (
     15,
     2,
-    '{"dateModifier":"NONE","dateQuality":"EXACT","dateType":"SINGLE","day":true,"endDay":false,"month":true,"endMonth":false,"proleptic":2451160,"endProleptic":0,"userText":"","year":true,"endYear":false}',
+    0,
+    0,
+    0,
+    7,
+    2451160,
+    2451160,
     2451160,
+    '',
     'Death of Mary',
     ''
   );
@@ -0,0 +1,150 @@
+/*
+ * SPDX-FileCopyrightText: Niko Strijbol <niko@strijbol.be>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+#pragma once
+
+#include "core/query_utils.h"
+#include "core/sql_row.h"
+#include "genealogical_date.h"
+
+#include <QSqlQuery>
+#include <QStringList>
+#include <QVariantMap>
+#include <array>
+#include <optional>
+
+/**
+ * The columns a date is stored in. The columns share a prefix, e.g. "date" for the date of an event.
+ *
+ * There is a column for each field of GenealogicalDate::Stored: <prefix>_type, _modifier, _quality,
+ * _precision, _sort, _first_day, _last_day, _time, _end_time and _text. The enums are stored as
+ * their value. A null date is NULL in all columns.
+ *
+ * Usage:
+ * @code
+ * struct EventEntity {
+ *     GenealogicalDate date;
+ *
+ *     using Columns = SqlColumns<u"id">::Join<DateColumns<u"date">::Columns>;
+ *
+ *     static EventEntity fromSql(const Columns::Row& row) {
+ *         return {.date = DateColumns<u"date">::read(row)};
+ *     }
+ * };
+ * @endcode
+ */
+template<ColumnName Prefix>
+struct DateColumns {
+    static constexpr auto TYPE = Prefix + ColumnName(u"_type");
+    static constexpr auto MODIFIER = Prefix + ColumnName(u"_modifier");
+    static constexpr auto QUALITY = Prefix + ColumnName(u"_quality");
+    static constexpr auto PRECISION = Prefix + ColumnName(u"_precision");
+    static constexpr auto SORT = Prefix + ColumnName(u"_sort");
+    static constexpr auto FIRST_DAY = Prefix + ColumnName(u"_first_day");
+    static constexpr auto LAST_DAY = Prefix + ColumnName(u"_last_day");
+    static constexpr auto TIME = Prefix + ColumnName(u"_time");
+    static constexpr auto END_TIME = Prefix + ColumnName(u"_end_time");
+    static constexpr auto TEXT = Prefix + ColumnName(u"_text");
+
+    using Columns = SqlColumns<TYPE, MODIFIER, QUALITY, PRECISION, SORT, FIRST_DAY, LAST_DAY, TIME, END_TIME, TEXT>;
+
+    /**
+     * @return The columns of a table (or its alias), for the select list of a query.
+     */
+    [[nodiscard]] static QString select(QStringView table) {
+        QStringList result;
+        for (const auto name: Columns::names) {
+            result.append(table.toString() + u'.' + columnName(name));
+        }
+        return result.join(u", ");
+    }
+
+    template<typename Row>
+    [[nodiscard]] static GenealogicalDate read(const Row& row) {
+        const auto type = row.template value<TYPE>();
+        if (type.isNull()) {
+            return {};
+        }
+        return GenealogicalDate::fromStored({
+            .type = static_cast<GenealogicalDate::DateType>(type.toInt()),
+            .modifier = static_cast<GenealogicalDate::Modifier>(row.template value<MODIFIER>().toInt()),
+            .quality = static_cast<GenealogicalDate::Quality>(row.template value<QUALITY>().toInt()),
+            .precision = row.template value<PRECISION>().toInt(),
+            .sortDay = validOrOptional<qint64>(row.template value<SORT>()),
+            .firstDay = validOrOptional<qint64>(row.template value<FIRST_DAY>()),
+            .lastDay = validOrOptional<qint64>(row.template value<LAST_DAY>()),
+            .startTime = validOrOptional<int>(row.template value<TIME>()),
+            .endTime = validOrOptional<int>(row.template value<END_TIME>()),
+            .text = row.template value<TEXT>().toString(),
+        });
+    }
+
+    /**
+     * Bind the columns of a date to the placeholders named after them, e.g. ":date_type".
+     */
+    static void bind(QSqlQuery& query, const GenealogicalDate& date) {
+        bind(query, date.toStored());
+    }
+
+    /**
+     * Bind the columns of a stored date, e.g. one that was converted on another thread.
+     */
+    static void bind(QSqlQuery& query, const std::optional<GenealogicalDate::Stored>& stored) {
+        forEachColumn(stored, [&query](const QString& placeholder, const QVariant& value) {
+            query.bindValue(placeholder, value);
+        });
+    }
+
+    /**
+     * Add the columns of a date to the bindings of a single statement, e.g. an update from an editor.
+     * This adds ten entries to the map, so binding many dates should use a query instead.
+     */
+    static void bind(QVariantMap& bindings, const GenealogicalDate& date) {
+        forEachColumn(date.toStored(), [&bindings](const QString& placeholder, const QVariant& value) {
+            bindings.insert(placeholder, value);
+        });
+    }
+
+private:
+    static QString columnName(std::u16string_view name) {
+        return QStringView(name.data(), static_cast<qsizetype>(name.size())).toString();
+    }
+
+    template<typename Function>
+    static void forEachColumn(const std::optional<GenealogicalDate::Stored>& stored, Function bindValue) {
+        const auto& names = placeholders();
+        if (!stored.has_value()) {
+            for (const auto& name: names) {
+                bindValue(name, QVariant());
+            }
+            return;
+        }
+        const auto orNull = [](const auto& value) {
+            return value.has_value() ? QVariant::fromValue(*value) : QVariant();
+        };
+        bindValue(names[Columns::template indexOf<TYPE>()], static_cast<int>(stored->type));
+        bindValue(names[Columns::template indexOf<MODIFIER>()], static_cast<int>(stored->modifier));
+        bindValue(names[Columns::template indexOf<QUALITY>()], static_cast<int>(stored->quality));
+        bindValue(names[Columns::template indexOf<PRECISION>()], stored->precision);
+        bindValue(names[Columns::template indexOf<SORT>()], orNull(stored->sortDay));
+        bindValue(names[Columns::template indexOf<FIRST_DAY>()], orNull(stored->firstDay));
+        bindValue(names[Columns::template indexOf<LAST_DAY>()], orNull(stored->lastDay));
+        bindValue(names[Columns::template indexOf<TIME>()], orNull(stored->startTime));
+        bindValue(names[Columns::template indexOf<END_TIME>()], orNull(stored->endTime));
+        bindValue(names[Columns::template indexOf<TEXT>()], stored->text);
+    }
+
+    // The placeholders of the columns, built once instead of for every bound date.
+    static const std::array<QString, Columns::size>& placeholders() {
+        static const auto names = [] {
+            std::array<QString, Columns::size> result;
+            for (std::size_t i = 0; i < Columns::size; ++i) {
+                result[i] = u':' + columnName(Columns::names[i]);
+            }
+            return result;
+        }();
+        return names;
+    }
+};
@@ -49,6 +49,35 @@ static QString formatDateLocalized(const GenealogicalDate::DatePoint& p) {
     return result;
 }
 
+// The first and last Julian day of the period a point stands for, e.g. the whole year for a year-only point.
+static std::pair<qint64, qint64> periodOf(const GenealogicalDate::DatePoint& p) {
+    if (p.day || !p.year) {
+        return {p.proleptic.toJulianDay(), p.proleptic.toJulianDay()};
+    }
+    if (p.month) {
+        const QDate first(p.proleptic.year(), p.proleptic.month(), 1);
+        return {first.toJulianDay(), first.toJulianDay() + first.daysInMonth() - 1};
+    }
+    const QDate first(p.proleptic.year(), 1, 1);
+    return {first.toJulianDay(), first.toJulianDay() + first.daysInYear() - 1};
+}
+
+// The precision flags of a point, where yearFlag is START_YEAR or END_YEAR; the month and day flags follow it.
+static int precisionOf(const GenealogicalDate::DatePoint& p, int yearFlag) {
+    return (p.year ? yearFlag : 0) | (p.month ? yearFlag << 1 : 0) | (p.day ? yearFlag << 2 : 0);
+}
+
+static std::optional<int> minutesOf(const GenealogicalDate::DatePoint& p) {
+    if (!p.hasTime) {
+        return std::nullopt;
+    }
+    return p.wallTime.msecsSinceStartOfDay() / 60'000;
+}
+
+static QTime timeOf(std::optional<int> minutes) {
+    return minutes.has_value() ? QTime::fromMSecsSinceStartOfDay(*minutes * 60'000) : QTime();
+}
+
 GenealogicalDate::GenealogicalDate(
     Modifier modifier,
     Quality quality,
@@ -167,6 +196,90 @@ void GenealogicalDate::setEndTime(const QTime& wallTime) {
     end.hasTime = wallTime.isValid();
 }
 
+std::optional<GenealogicalDate::Stored> GenealogicalDate::toStored() const {
+    if (isNull()) {
+        return std::nullopt;
+    }
+
+    Stored stored{
+        .type = dateType,
+        .modifier = dateModifier,
+        .quality = dateQuality,
+        .precision = precisionOf(start, Stored::START_YEAR),
+        .startTime = minutesOf(start),
+        .text = userText,
+    };
+    if (dateType != SINGLE) {
+        stored.precision |= precisionOf(end, Stored::END_YEAR);
+        stored.endTime = minutesOf(end);
+    }
+
+    const bool hasStart = start.proleptic.isValid();
+    // Without a year, the end point cannot be stored, and a range is open at the end.
+    const bool hasEnd = dateType != SINGLE && end.proleptic.isValid() && end.year;
+    if (hasStart) {
+        stored.sortDay = start.proleptic.toJulianDay();
+    }
+
+    if (dateType == SINGLE) {
+        if (!hasStart) {
+            return stored;
+        }
+        const auto [first, last] = periodOf(start);
+        if (dateModifier == BEFORE) {
+            stored.firstDay = Stored::OPEN_START;
+            stored.lastDay = first - 1;
+        } else if (dateModifier == AFTER) {
+            stored.firstDay = last + 1;
+            stored.lastDay = Stored::OPEN_END;
+        } else {
+            stored.firstDay = first;
+            stored.lastDay = last;
+        }
+    } else if (hasStart || hasEnd) {
+        stored.firstDay = hasStart ? periodOf(start).first : Stored::OPEN_START;
+        stored.lastDay = hasEnd ? periodOf(end).second : Stored::OPEN_END;
+    }
+    return stored;
+}
+
+GenealogicalDate GenealogicalDate::fromStored(Stored stored) {
+    GenealogicalDate d;
+    d.dateType = stored.type;
+    d.dateModifier = stored.modifier;
+    d.dateQuality = stored.quality;
+    d.userText = std::move(stored.text);
+    d.start = {
+        .proleptic = stored.sortDay.has_value() ? QDate::fromJulianDay(*stored.sortDay) : QDate(),
+        .year = (stored.precision & Stored::START_YEAR) != 0,
+        .month = (stored.precision & Stored::START_MONTH) != 0,
+        .day = (stored.precision & Stored::START_DAY) != 0,
+    };
+    d.setStartTime(timeOf(stored.startTime));
+    if (stored.type == SINGLE) {
+        return d;
+    }
+
+    d.end = {
+        .year = (stored.precision & Stored::END_YEAR) != 0,
+        .month = (stored.precision & Stored::END_MONTH) != 0,
+        .day = (stored.precision & Stored::END_DAY) != 0,
+    };
+    // The last day is the end of the period of the end point; its missing components are 1.
+    if (d.end.year && stored.lastDay.has_value() && *stored.lastDay != Stored::OPEN_END) {
+        const auto last = QDate::fromJulianDay(*stored.lastDay);
+        if (d.end.day) {
+            d.end.proleptic = last;
+        } else if (d.end.month) {
+            d.end.proleptic = QDate(last.year(), last.month(), 1);
+        } else {
+            d.end.proleptic = QDate(last.year(), 1, 1);
+        }
+    }
+    d.setEndTime(timeOf(stored.endTime));
+    return d;
+}
+
 QString GenealogicalDate::toDatabaseRepresentation() const {
     QJsonObject result;
 
@@ -7,6 +7,8 @@
 
 #include <QDate>
 #include <QTime>
+#include <limits>
+#include <optional>
 
 /**
  * Represents dates in Opa.
@@ -33,6 +35,10 @@
  * toDisplayText() produces an ISO 8601 interchange format parseable by fromDisplayText().
  * toLocalizedText() produces a locale-friendly human-readable string for display in views.
  *
+ * In the database, a date is stored decoded into columns (see Stored and DateColumns).
+ * toDatabaseRepresentation() and fromDatabaseRepresentation() are the JSON format that dates
+ * were stored in before, which is still read for legacy data.
+ *
  * TODO: support multiple calendars
  */
 class GenealogicalDate {
@@ -82,6 +88,47 @@ public:
         bool operator==(const DatePoint&) const = default;
     };
 
+    /**
+     * The date decoded into plain values, as it is stored in the columns of the database.
+     *
+     * The first and last day are the Julian days the date can be on, so overlap queries are plain
+     * comparisons: a year-only date lasts the whole year, a range lasts from the start of the
+     * first date to the end of the second one, and a date before or after something is open on
+     * one side. The sort day is the Julian day of the start point, which is needed to get back a
+     * date that is open at the start.
+     *
+     * The days are empty if the date has no calendar date, e.g. if it only has a text.
+     */
+    struct Stored {
+        // Which parts of the start and end point are known.
+        enum Precision {
+            START_YEAR = 0x01,
+            START_MONTH = 0x02,
+            START_DAY = 0x04,
+            END_YEAR = 0x08,
+            END_MONTH = 0x10,
+            END_DAY = 0x20,
+        };
+
+        // The first and last day of a date that is open on that side.
+        static constexpr qint64 OPEN_START = std::numeric_limits<qint64>::min();
+        static constexpr qint64 OPEN_END = std::numeric_limits<qint64>::max();
+
+        DateType type = SINGLE;
+        Modifier modifier = NONE;
+        Quality quality = EXACT;
+        int precision = 0;
+        std::optional<qint64> sortDay;
+        std::optional<qint64> firstDay;
+        std::optional<qint64> lastDay;
+        // In minutes after midnight.
+        std::optional<int> startTime;
+        std::optional<int> endTime;
+        QString text;
+
+        bool operator==(const Stored&) const = default;
+    };
+
     static GenealogicalDate makeRange(
         Quality quality,
         const QDate& from,
@@ -124,6 +171,11 @@ public:
 
     [[nodiscard]] qint64 sortKey() const;
 
+    /**
+     * @return The stored form of the date, or nothing if the date is null.
+     */
+    [[nodiscard]] std::optional<Stored> toStored() const;
+
     [[nodiscard]] QString toDatabaseRepresentation() const;
 
     [[nodiscard]] QString toDisplayText() const;
@@ -140,6 +192,8 @@ public:
     void setStartTime(const QTime& wallTime);
     void setEndTime(const QTime& wallTime);
 
+    static GenealogicalDate fromStored(Stored stored);
+
     static GenealogicalDate fromDatabaseRepresentation(const QString& text);
 
     static GenealogicalDate fromDisplayText(const QString& text);
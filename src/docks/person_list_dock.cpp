@@ -6,14 +6,13 @@
 
 #include "person_list_dock.h"
 
-#include "domain/person/person_display_model.h"
+#include "domain/person/paged_person_model.h"
 #include "utils/formatted_identifier_delegate.h"
 
 #include <KLocalizedString>
 #include <QHeaderView>
 #include <QLineEdit>
 #include <QPushButton>
-#include <QSortFilterProxyModel>
 #include <QVBoxLayout>
 
 PersonListDock::PersonListDock() : DockWidget(QStringLiteral("People"), KDDockWidgets::DockWidgetOption_DeleteOnClose) {
@@ -24,35 +23,31 @@ PersonListDock::PersonListDock() : DockWidget(QStringLiteral("People"), KDDockWi
 }
 
 PersonListWidget::PersonListWidget(QWidget* parent) : QWidget(parent) {
-    auto* baseModel = new PersonDisplayModel(this);
-
-    // Create a searchable model.
-    auto* filtered = new QSortFilterProxyModel(this);
-    filtered->setSourceModel(baseModel);
-    filtered->setFilterKeyColumn(PersonDisplayModel::NAME);
-    filtered->setFilterCaseSensitivity(Qt::CaseInsensitive);
+    // Only loads the rows that are shown; searching and sorting happen in the database.
+    auto* model = new PagedPersonModel(this);
 
     auto* searchBox = new QLineEdit(this);
     searchBox->setPlaceholderText(i18n("Search.."));
     searchBox->setClearButtonEnabled(true);
 
     // Allow searching...
-    connect(searchBox, &QLineEdit::textEdited, filtered, &QSortFilterProxyModel::setFilterFixedString);
+    connect(searchBox, &QLineEdit::textEdited, model, &PagedPersonModel::setFilterText);
 
     tableView = new QTableView(this);
-    tableView->setModel(filtered);
+    tableView->setModel(model);
     tableView->setShowGrid(false);
     tableView->setSelectionBehavior(QTableView::SelectRows);
     tableView->setSelectionMode(QTableView::SelectionMode::SingleSelection);
     tableView->setSortingEnabled(true);
+    tableView->sortByColumn(PagedPersonModel::NAME, Qt::AscendingOrder);
     tableView->verticalHeader()->hide();
     tableView->horizontalHeader()->resizeSections(QHeaderView::Stretch);
-    tableView->horizontalHeader()->setSectionResizeMode(PersonDisplayModel::ID, QHeaderView::ResizeToContents);
-    tableView->horizontalHeader()->setSectionResizeMode(PersonDisplayModel::NAME, QHeaderView::Stretch);
-    tableView->horizontalHeader()->setSectionResizeMode(PersonDisplayModel::ROOT, QHeaderView::ResizeToContents);
+    tableView->horizontalHeader()->setSectionResizeMode(PagedPersonModel::ID, QHeaderView::ResizeToContents);
+    tableView->horizontalHeader()->setSectionResizeMode(PagedPersonModel::NAME, QHeaderView::Stretch);
+    tableView->horizontalHeader()->setSectionResizeMode(PagedPersonModel::ROOT, QHeaderView::ResizeToContents);
     tableView->horizontalHeader()->setHighlightSections(false);
     tableView->setItemDelegateForColumn(
-        PersonDisplayModel::ID,
+        PagedPersonModel::ID,
         new FormattedIdentifierDelegate(tableView, FormattedIdentifierDelegate::PERSON)
     );
 
@@ -74,6 +69,6 @@ void PersonListWidget::handleSelectedNewRow(const QItemSelection& selected) {
     }
 
     // Get the ID of the person we want.
-    auto personId = getIdFromSelection(selected, tableView->model(), PersonDisplayModel::ID);
+    auto personId = getIdFromSelection(selected, tableView->model(), PagedPersonModel::ID);
     Q_EMIT handlePersonSelected(personId);
 }
@@ -0,0 +1,85 @@
+/*
+ * SPDX-FileCopyrightText: Niko Strijbol <niko@strijbol.be>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+#include "builtin_ids.h"
+
+#include "core/data_event_broker.h"
+#include "database/connection_pool.h"
+#include "event_repository.h"
+
+#include <QMutexLocker>
+
+namespace {
+/**
+ * Add the row to the ids if its name is a value of the enum.
+ *
+ * A built-in row wins from a user-defined row with the same name.
+ */
+template<typename E>
+void addIfValue(QHash<E, IntegerPrimaryKey>& ids, const QString& name, IntegerPrimaryKey id, bool builtin) {
+    if (!isValidEnum<E>(name)) {
+        return;
+    }
+    const auto value = enumFromString<E>(name);
+    if (builtin || !ids.contains(value)) {
+        ids.insert(value, id);
+    }
+}
+}
+
+BuiltinIds& BuiltinIds::instance() {
+    static BuiltinIds ids;
+    return ids;
+}
+
+IntegerPrimaryKey BuiltinIds::typeId(EventTypes::Values type) {
+    loadIfNeeded();
+    QMutexLocker locker(&mutex);
+    return types.value(type, -1);
+}
+
+IntegerPrimaryKey BuiltinIds::roleId(EventRoles::Values role) {
+    loadIfNeeded();
+    QMutexLocker locker(&mutex);
+    return roles.value(role, -1);
+}
+
+void BuiltinIds::invalidate() {
+    QMutexLocker locker(&mutex);
+    loaded.reset();
+}
+
+void BuiltinIds::loadIfNeeded() {
+    // Taken before reading, so a change while reading makes the next use read again.
+    const auto& broker = DataEventBroker::instance();
+    const Version current{
+        .generation = ConnectionPool::instance().databaseGeneration(),
+        .types = broker.changeCount<Schema::EventTypes>(),
+        .roles = broker.changeCount<Schema::EventRoles>(),
+    };
+    {
+        QMutexLocker locker(&mutex);
+        if (loaded == current) {
+            return;
+        }
+    }
+
+    // The queries run without the lock: a receiver of a change notification can use the ids while
+    // they are read.
+    QHash<EventTypes::Values, IntegerPrimaryKey> newTypes;
+    QHash<EventRoles::Values, IntegerPrimaryKey> newRoles;
+    const EventRepository repository;
+    for (const auto& type: repository.findAllEventTypes()) {
+        addIfValue(newTypes, type.type, type.id, type.builtin);
+    }
+    for (const auto& role: repository.findAllEventRoles()) {
+        addIfValue(newRoles, role.role, role.id, role.builtin);
+    }
+
+    QMutexLocker locker(&mutex);
+    types.swap(newTypes);
+    roles.swap(newRoles);
+    loaded = current;
+}
@@ -0,0 +1,70 @@
+/*
+ * SPDX-FileCopyrightText: Niko Strijbol <niko@strijbol.be>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+#pragma once
+
+#include "database/schema.h"
+#include "event_roles.h"
+#include "event_types.h"
+
+#include <QHash>
+#include <QMutex>
+#include <optional>
+
+/**
+ * The ids of the built-in event types and roles in the open database.
+ *
+ * Queries bind these ids, instead of joining the type and role tables to compare their names.
+ * The ids are read on first use, and read again after the tables changed or another database
+ * was opened. A change is noticed as soon as the broker starts delivering it, so every receiver
+ * of the change already gets the new ids.
+ *
+ * This can be used from any thread.
+ */
+class BuiltinIds {
+public:
+    BuiltinIds(const BuiltinIds&) = delete;
+    BuiltinIds& operator=(const BuiltinIds&) = delete;
+
+    static BuiltinIds& instance();
+
+    /**
+     * @return The id of the type, or -1 if the database does not have it, which matches no row.
+     */
+    [[nodiscard]] IntegerPrimaryKey typeId(EventTypes::Values type);
+
+    /**
+     * @return The id of the role, or -1 if the database does not have it, which matches no row.
+     */
+    [[nodiscard]] IntegerPrimaryKey roleId(EventRoles::Values role);
+
+    /**
+     * Read the ids again on the next use.
+     */
+    void invalidate();
+
+private:
+    BuiltinIds() = default;
+
+    void loadIfNeeded();
+
+    /**
+     * The state of the database the ids were read from.
+     */
+    struct Version {
+        // The database generation of the connection pool.
+        quint64 generation = 0;
+        // The change counts of the tables in the DataEventBroker.
+        quint64 types = 0;
+        quint64 roles = 0;
+
+        bool operator==(const Version&) const = default;
+    };
+
+    QMutex mutex;
+    std::optional<Version> loaded;
+    QHash<EventTypes::Values, IntegerPrimaryKey> types;
+    QHash<EventRoles::Values, IntegerPrimaryKey> roles;
+};
@@ -6,7 +6,9 @@
 #pragma once
 
 #include "core/query_utils.h"
+#include "core/sql_row.h"
 #include "database/schema.h"
+#include "dates/date_columns.h"
 
 #include <QSqlQuery>
 #include <QString>
@@ -19,13 +21,17 @@ struct EventTypeEntity {
     QString type;
     bool builtin = false;
 
-    static EventTypeEntity fromSql(const QSqlQuery& query) {
+    using Columns = SqlColumns<u"id", u"type", u"builtin">;
+
+    static EventTypeEntity fromSql(const Columns::Row& row) {
         return {
-            .id = query.value(u"id").toLongLong(),
-            .type = query.value(u"type").toString(),
-            .builtin = query.value(u"builtin").toBool(),
+            .id = row.value<u"id">().toLongLong(),
+            .type = row.value<u"type">().toString(),
+            .builtin = row.value<u"builtin">().toBool(),
         };
     }
+
+    bool operator==(const EventTypeEntity&) const = default;
 };
 
 struct EventRoleEntity {
@@ -33,33 +39,40 @@ struct EventRoleEntity {
     QString role;
     bool builtin = false;
 
-    static EventRoleEntity fromSql(const QSqlQuery& query) {
+    using Columns = SqlColumns<u"id", u"role", u"builtin">;
+
+    static EventRoleEntity fromSql(const Columns::Row& row) {
         return {
-            .id = query.value(u"id").toLongLong(),
-            .role = query.value(u"role").toString(),
-            .builtin = query.value(u"builtin").toBool(),
+            .id = row.value<u"id">().toLongLong(),
+            .role = row.value<u"role">().toString(),
+            .builtin = row.value<u"builtin">().toBool(),
         };
     }
+
+    bool operator==(const EventRoleEntity&) const = default;
 };
 
 struct EventEntity {
     IntegerPrimaryKey id = -1;
     IntegerPrimaryKey typeId = -1;
-    QString date;
+    GenealogicalDate date;
     QString name;
     QString note;
     std::optional<IntegerPrimaryKey> locationId;
     std::optional<IntegerPrimaryKey> familyId;
 
-    static EventEntity fromSql(const QSqlQuery& query) {
+    using Columns = SqlColumns<u"id", u"type_id", u"name", u"note", u"location_id", u"family_id">::Join<
+        DateColumns<u"date">::Columns>;
+
+    static EventEntity fromSql(const Columns::Row& row) {
         return {
-            .id = query.value(u"id").toLongLong(),
-            .typeId = query.value(u"type_id").toLongLong(),
-            .date = query.value(u"date").toString(),
-            .name = query.value(u"name").toString(),
-            .note = query.value(u"note").toString(),
-            .locationId = validOrOptional<IntegerPrimaryKey>(query.value(u"location_id")),
-            .familyId = validOrOptional<IntegerPrimaryKey>(query.value(u"family_id")),
+            .id = row.value<u"id">().toLongLong(),
+            .typeId = row.value<u"type_id">().toLongLong(),
+            .date = DateColumns<u"date">::read(row),
+            .name = row.value<u"name">().toString(),
+            .note = row.value<u"note">().toString(),
+            .locationId = validOrOptional<IntegerPrimaryKey>(row.value<u"location_id">()),
+            .familyId = validOrOptional<IntegerPrimaryKey>(row.value<u"family_id">()),
         };
     }
 };
@@ -68,18 +81,22 @@ struct EventDisplayEntity {
     IntegerPrimaryKey id = -1;
     IntegerPrimaryKey typeId = -1;
     QString type;
-    QString date;
+    GenealogicalDate date;
     QString name;
 
-    static EventDisplayEntity fromSql(const QSqlQuery& query) {
+    using Columns = SqlColumns<u"id", u"type_id", u"type", u"name">::Join<DateColumns<u"date">::Columns>;
+
+    static EventDisplayEntity fromSql(const Columns::Row& row) {
         return {
-            .id = query.value(u"id").toLongLong(),
-            .typeId = query.value(u"type_id").toLongLong(),
-            .type = query.value(u"type").toString(),
-            .date = query.value(u"date").toString(),
-            .name = query.value(u"name").toString(),
+            .id = row.value<u"id">().toLongLong(),
+            .typeId = row.value<u"type_id">().toLongLong(),
+            .type = row.value<u"type">().toString(),
+            .date = DateColumns<u"date">::read(row),
+            .name = row.value<u"name">().toString(),
         };
     }
+
+    bool operator==(const EventDisplayEntity&) const = default;
 };
 
 struct PersonEventEntity {
@@ -88,18 +105,21 @@ struct PersonEventEntity {
     IntegerPrimaryKey roleId = -1;
     QString role;
     QString type;
-    QString date;
+    GenealogicalDate date;
     QString name;
 
-    static PersonEventEntity fromSql(const QSqlQuery& query) {
+    using Columns = SqlColumns<u"id", u"relation_id", u"role_id", u"role", u"type", u"name">::Join<
+        DateColumns<u"date">::Columns>;
+
+    static PersonEventEntity fromSql(const Columns::Row& row) {
         return {
-            .id = query.value(u"id").toLongLong(),
-            .relationId = query.value(u"relation_id").toLongLong(),
-            .roleId = query.value(u"role_id").toLongLong(),
-            .role = query.value(u"role").toString(),
-            .type = query.value(u"type").toString(),
-            .date = query.value(u"date").toString(),
-            .name = query.value(u"name").toString(),
+            .id = row.value<u"id">().toLongLong(),
+            .relationId = row.value<u"relation_id">().toLongLong(),
+            .roleId = row.value<u"role_id">().toLongLong(),
+            .role = row.value<u"role">().toString(),
+            .type = row.value<u"type">().toString(),
+            .date = DateColumns<u"date">::read(row),
+            .name = row.value<u"name">().toString(),
         };
     }
 };
@@ -110,12 +130,14 @@ struct EventRelationEntity {
     IntegerPrimaryKey personId = -1;
     IntegerPrimaryKey roleId = -1;
 
-    static EventRelationEntity fromSql(const QSqlQuery& query) {
+    using Columns = SqlColumns<u"id", u"event_id", u"person_id", u"role_id">;
+
+    static EventRelationEntity fromSql(const Columns::Row& row) {
         return {
-            .id = query.value(u"id").toLongLong(),
-            .eventId = query.value(u"event_id").toLongLong(),
-            .personId = query.value(u"person_id").toLongLong(),
-            .roleId = query.value(u"role_id").toLongLong(),
+            .id = row.value<u"id">().toLongLong(),
+            .eventId = row.value<u"event_id">().toLongLong(),
+            .personId = row.value<u"person_id">().toLongLong(),
+            .roleId = row.value<u"role_id">().toLongLong(),
         };
     }
 };
@@ -15,10 +15,21 @@ EventListModel::EventListModel(QObject* parent) : ObjectTableModel(parent) {
     this->setColumn(ID, i18n("ID"), &EventDisplayEntity::id);
     this->setColumn(TYPE_ID, i18n("Type ID"), &EventDisplayEntity::typeId);
     this->setColumn(TYPE, i18n("Type"), &EventDisplayEntity::type);
-    this->setColumn(DATE, i18n("Date"), &EventDisplayEntity::date);
+    this->setColumn(DATE, i18n("Date"), [](const EventDisplayEntity& e) -> QVariant {
+        if (e.date.isNull()) {
+            return {};
+        }
+        return e.date.toLocalizedText();
+    });
     this->setColumn(NAME, i18n("Name"), &EventDisplayEntity::name);
+    // There can be many events, and formatting a date is not cheap.
+    this->projectColumn(DATE, Projection::PARALLEL);
 
-    connectToTable<Schema::Events>(this);
+    this->setRowId(&EventDisplayEntity::id);
+    this->updateRowsOn<Schema::Events>(
+        [](IntegerPrimaryKey id) { return EventRepository().findEventDisplayById(id); },
+        [this] { reload(); }
+    );
     connectToTable<Schema::EventTypes>(this);
 
     reload();
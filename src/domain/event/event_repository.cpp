@@ -6,8 +6,9 @@
 #include "./event_repository.h"
 
 #include "../../core/data_event_broker.h"
+#include "builtin_ids.h"
 #include "database/database.h"
-#include "dates/genealogical_date.h"
+#include "dates/date_columns.h"
 
 using namespace Qt::StringLiterals;
 
@@ -23,21 +24,17 @@ std::optional<EventTypeEntity> EventRepository::findEventTypeById(IntegerPrimary
 
 std::optional<IntegerPrimaryKey> EventRepository::insertEventType(const QString& type) const {
     const auto sql = u"INSERT INTO event_types (type, builtin) VALUES (:type, false)"_s;
-    const auto newId = QueryHelper::insert(sql, {{u":type"_s, type}});
-    if (newId) {
-        DataEventBroker::instance().notifyChanged<Schema::EventTypes>(newId);
-    }
-    return newId;
+    return QueryHelper::insert(sql, {{u":type"_s, type}});
 }
 
 bool EventRepository::updateEventType(IntegerPrimaryKey id, const QString& type) const {
     const auto sql = u"UPDATE event_types SET type = :type WHERE id = :id"_s;
-    return QueryHelper::executeAndNotify<Schema::EventTypes>(id, sql, {{u":type"_s, type}, {u":id"_s, id}});
+    return QueryHelper::execute(sql, {{u":type"_s, type}, {u":id"_s, id}});
 }
 
 bool EventRepository::deleteEventType(IntegerPrimaryKey id) const {
     const auto sql = u"DELETE FROM event_types WHERE id = :id"_s;
-    return QueryHelper::executeAndNotify<Schema::EventTypes>(id, sql, {{u":id"_s, id}});
+    return QueryHelper::execute(sql, {{u":id"_s, id}});
 }
 
 QList<EventRoleEntity> EventRepository::findAllEventRoles() const {
@@ -52,74 +49,89 @@ std::optional<EventRoleEntity> EventRepository::findEventRoleById(IntegerPrimary
 
 std::optional<IntegerPrimaryKey> EventRepository::insertEventRole(const QString& role) const {
     const auto sql = u"INSERT INTO event_roles (role, builtin) VALUES (:role, false)"_s;
-    const auto newId = QueryHelper::insert(sql, {{u":role"_s, role}});
-    if (newId) {
-        DataEventBroker::instance().notifyChanged<Schema::EventRoles>(newId);
-    }
-    return newId;
+    return QueryHelper::insert(sql, {{u":role"_s, role}});
 }
 
 bool EventRepository::updateEventRole(IntegerPrimaryKey id, const QString& role) const {
     const auto sql = u"UPDATE event_roles SET role = :role WHERE id = :id"_s;
-    return QueryHelper::executeAndNotify<Schema::EventRoles>(id, sql, {{u":role"_s, role}, {u":id"_s, id}});
+    return QueryHelper::execute(sql, {{u":role"_s, role}, {u":id"_s, id}});
 }
 
 bool EventRepository::deleteEventRole(IntegerPrimaryKey id) const {
     const auto sql = u"DELETE FROM event_roles WHERE id = :id"_s;
-    return QueryHelper::executeAndNotify<Schema::EventRoles>(id, sql, {{u":id"_s, id}});
+    return QueryHelper::execute(sql, {{u":id"_s, id}});
 }
 
 QList<EventDisplayEntity> EventRepository::findAllEvents() const {
-    const auto sql = u"SELECT e.id, e.type_id, et.type, e.date, e.name "
-                     u"FROM events e LEFT JOIN event_types et ON e.type_id = et.id "
+    const auto sql = u"SELECT e.id, e.type_id, et.type, e.name, "_s + DateColumns<u"date">::select(u"e") +
+                     u" FROM events e LEFT JOIN event_types et ON e.type_id = et.id "
                      u"ORDER BY e.date_sort ASC NULLS LAST"_s;
     return fetchAll<EventDisplayEntity>(sql);
 }
 
+std::optional<EventDisplayEntity> EventRepository::findEventDisplayById(IntegerPrimaryKey id) const {
+    const auto sql = u"SELECT e.id, e.type_id, et.type, e.name, "_s + DateColumns<u"date">::select(u"e") +
+                     u" FROM events e LEFT JOIN event_types et ON e.type_id = et.id "
+                     u"WHERE e.id = :id"_s;
+    return fetchOne<EventDisplayEntity>(sql, {{u":id"_s, id}});
+}
+
+QList<EventDisplayEntity> EventRepository::findEventsOverlapping(const GenealogicalDate& period) const {
+    const auto stored = period.toStored();
+    if (!stored.has_value() || !stored->firstDay.has_value()) {
+        return {};
+    }
+    const auto sql = u"SELECT e.id, e.type_id, et.type, e.name, "_s + DateColumns<u"date">::select(u"e") +
+                     u" FROM events e LEFT JOIN event_types et ON e.type_id = et.id "
+                     u"WHERE e.date_first_day <= :last_day AND e.date_last_day >= :first_day "
+                     u"ORDER BY e.date_sort ASC NULLS LAST"_s;
+    return fetchAll<EventDisplayEntity>(
+        sql,
+        {
+            {u":first_day"_s, *stored->firstDay},
+            {u":last_day"_s, *stored->lastDay},
+        }
+    );
+}
+
 std::optional<EventEntity> EventRepository::findEventById(IntegerPrimaryKey id) const {
-    const auto sql = u"SELECT id, type_id, date, name, note, location_id FROM events WHERE id = :id"_s;
+    const auto sql = u"SELECT id, type_id, name, note, location_id, "_s + DateColumns<u"date">::select(u"events") +
+                     u" FROM events WHERE id = :id"_s;
     return fetchOne<EventEntity>(sql, {{u":id"_s, id}});
 }
 
 std::optional<IntegerPrimaryKey> EventRepository::insertEvent(IntegerPrimaryKey typeId) const {
     const auto sql = u"INSERT INTO events (type_id) VALUES (:type_id)"_s;
-    auto newId = QueryHelper::insert(sql, {{u":type_id"_s, typeId}});
-    if (newId) {
-        DataEventBroker::instance().notifyChanged<Schema::Events>(newId);
-    }
-    return newId;
+    return QueryHelper::insert(sql, {{u":type_id"_s, typeId}});
 }
 
 bool EventRepository::updateEvent(
     IntegerPrimaryKey id,
     IntegerPrimaryKey typeId,
-    const QString& date,
+    const GenealogicalDate& date,
     const QString& name,
     const QString& note,
     std::optional<IntegerPrimaryKey> locationId
 ) const {
-    const auto sql =
-        u"UPDATE events SET type_id = :type_id, date = :date, date_sort = :date_sort, name = :name, note = :note, location_id = :location_id WHERE id = :id"_s;
-    const auto parsedDate = GenealogicalDate::fromDatabaseRepresentation(date);
-    const QVariantMap bindings = {
+    const auto sql = u"UPDATE events SET type_id = :type_id, name = :name, note = :note, location_id = :location_id, "
+                     u"date_type = :date_type, date_modifier = :date_modifier, date_quality = :date_quality, "
+                     u"date_precision = :date_precision, date_sort = :date_sort, date_first_day = :date_first_day, "
+                     u"date_last_day = :date_last_day, date_time = :date_time, date_end_time = :date_end_time, "
+                     u"date_text = :date_text WHERE id = :id"_s;
+    QVariantMap bindings = {
         {u":type_id"_s, typeId},
-        {u":date"_s, date},
-        {u":date_sort"_s, parsedDate.isNull() ? QVariant{} : QVariant{parsedDate.sortKey()}},
         {u":name"_s, name},
         {u":note"_s, note},
         {u":location_id"_s, locationId.has_value() ? QVariant(*locationId) : QVariant{}},
         {u":id"_s, id},
     };
-    const bool ok = QueryHelper::execute(sql, bindings);
-    if (ok) {
-        DataEventBroker::instance().notifyChanged<Schema::Events>(id);
-    }
-    return ok;
+    DateColumns<u"date">::bind(bindings, date);
+    return QueryHelper::execute(sql, bindings);
 }
 
 bool EventRepository::deleteEvent(IntegerPrimaryKey id) const {
     const auto sql = u"DELETE FROM events WHERE id = :id"_s;
-    return QueryHelper::executeAndNotify<Schema::Events>(id, sql, {{u":id"_s, id}});
+    return QueryHelper::execute(sql, {{u":id"_s, id}});
 }
 
 QList<EventRelationEntity> EventRepository::findRelationsForEvent(IntegerPrimaryKey eventId) const {
@@ -144,16 +156,12 @@ std::optional<IntegerPrimaryKey> EventRepository::insertEventRelation(
         {u":person_id"_s, personId},
         {u":role_id"_s, roleId},
     };
-    const auto newId = QueryHelper::insert(sql, bindings);
-    if (newId) {
-        DataEventBroker::instance().notifyChanged<Schema::EventRelations>(newId);
-    }
-    return newId;
+    return QueryHelper::insert(sql, bindings);
 }
 
 bool EventRepository::deleteEventRelation(IntegerPrimaryKey relationId) const {
     const auto sql = u"DELETE FROM event_relations WHERE id = :id"_s;
-    return QueryHelper::executeAndNotify<Schema::EventRelations>(relationId, sql, {{u":id"_s, relationId}});
+    return QueryHelper::execute(sql, {{u":id"_s, relationId}});
 }
 
 bool EventRepository::updateEventRelationRole(IntegerPrimaryKey relationId, IntegerPrimaryKey newRoleId) const {
@@ -162,13 +170,14 @@ bool EventRepository::updateEventRelationRole(IntegerPrimaryKey relationId, Inte
         {u":role_id"_s, newRoleId},
         {u":id"_s, relationId},
     };
-    return QueryHelper::executeAndNotify<Schema::EventRelations>(relationId, sql, bindings);
+    return QueryHelper::execute(sql, bindings);
 }
 
 QList<PersonEventEntity> EventRepository::findEventsForPerson(IntegerPrimaryKey personId) const {
     const auto sql =
-        u"SELECT events.id, erel.id AS relation_id, er.id AS role_id, er.role, et.type, events.date, events.name "
-        u"FROM events "
+        u"SELECT events.id, erel.id AS relation_id, er.id AS role_id, er.role, et.type, events.name, "_s +
+        DateColumns<u"date">::select(u"events") +
+        u" FROM events "
         u"LEFT JOIN event_types AS et ON events.type_id = et.id "
         u"LEFT JOIN event_relations AS erel ON events.id = erel.event_id "
         u"LEFT JOIN event_roles AS er ON er.id = erel.role_id "
@@ -179,31 +188,51 @@ QList<PersonEventEntity> EventRepository::findEventsForPerson(IntegerPrimaryKey
 
 QList<PersonEventEntity> EventRepository::findBirthEventsForPerson(IntegerPrimaryKey personId) const {
     const auto sql =
-        u"SELECT events.id, erel.id AS relation_id, er.id AS role_id, er.role, et.type, events.date, events.name "
-        u"FROM events "
+        u"SELECT events.id, erel.id AS relation_id, er.id AS role_id, er.role, et.type, events.name, "_s +
+        DateColumns<u"date">::select(u"events") +
+        u" FROM events "
         u"LEFT JOIN event_types AS et ON events.type_id = et.id "
         u"LEFT JOIN event_relations AS erel ON events.id = erel.event_id "
         u"LEFT JOIN event_roles AS er ON er.id = erel.role_id "
         u"WHERE erel.person_id = :person_id "
-        u"AND er.role = 'Primary' "
-        u"AND et.type IN ('Birth', 'Baptism') "
-        u"AND LENGTH(events.date) != 0 "
-        u"ORDER BY et.type = 'Birth' DESC, et.type = 'Baptism' DESC"_s;
-    return fetchAll<PersonEventEntity>(sql, {{u":person_id"_s, personId}});
+        u"AND erel.role_id = :primary "
+        u"AND events.type_id IN (:birth, :baptism) "
+        u"AND events.date_type IS NOT NULL "
+        u"ORDER BY events.type_id = :birth DESC, events.type_id = :baptism DESC"_s;
+    auto& ids = BuiltinIds::instance();
+    return fetchAll<PersonEventEntity>(
+        sql,
+        {
+            {u":person_id"_s, personId},
+            {u":primary"_s, ids.roleId(EventRoles::Values::Primary)},
+            {u":birth"_s, ids.typeId(EventTypes::Values::Birth)},
+            {u":baptism"_s, ids.typeId(EventTypes::Values::Baptism)},
+        }
+    );
 }
 
 QList<PersonEventEntity> EventRepository::findDeathEventsForPerson(IntegerPrimaryKey personId) const {
     const auto sql =
-        u"SELECT events.id, erel.id AS relation_id, er.id AS role_id, er.role, et.type, events.date, events.name "
-        u"FROM events "
+        u"SELECT events.id, erel.id AS relation_id, er.id AS role_id, er.role, et.type, events.name, "_s +
+        DateColumns<u"date">::select(u"events") +
+        u" FROM events "
         u"LEFT JOIN event_types AS et ON events.type_id = et.id "
         u"LEFT JOIN event_relations AS erel ON events.id = erel.event_id "
         u"LEFT JOIN event_roles AS er ON er.id = erel.role_id "
         u"WHERE erel.person_id = :person_id "
-        u"AND er.role = 'Primary' "
-        u"AND et.type IN ('Death', 'Funeral') "
-        u"ORDER BY et.type = 'Death' DESC, et.type = 'Funeral' DESC"_s;
-    return fetchAll<PersonEventEntity>(sql, {{u":person_id"_s, personId}});
+        u"AND erel.role_id = :primary "
+        u"AND events.type_id IN (:death, :funeral) "
+        u"ORDER BY events.type_id = :death DESC, events.type_id = :funeral DESC"_s;
+    auto& ids = BuiltinIds::instance();
+    return fetchAll<PersonEventEntity>(
+        sql,
+        {
+            {u":person_id"_s, personId},
+            {u":primary"_s, ids.roleId(EventRoles::Values::Primary)},
+            {u":death"_s, ids.typeId(EventTypes::Values::Death)},
+            {u":funeral"_s, ids.typeId(EventTypes::Values::Funeral)},
+        }
+    );
 }
 
 std::optional<IntegerPrimaryKey> EventRepository::findEventTypeIdByName(const QString& typeName) const {
@@ -236,11 +265,7 @@ bool EventRepository::isEventTypeUsed(IntegerPrimaryKey typeId) const {
 bool EventRepository::reassignEventTypeId(IntegerPrimaryKey fromId, IntegerPrimaryKey toId) const {
     const auto sql = u"UPDATE events SET type_id = :to_id WHERE type_id = :from_id"_s;
     const QVariantMap bindings = {{u":to_id"_s, toId}, {u":from_id"_s, fromId}};
-    const bool ok = QueryHelper::execute(sql, bindings);
-    if (ok) {
-        DataEventBroker::instance().notifyChanged<Schema::Events>(std::nullopt);
-    }
-    return ok;
+    return QueryHelper::execute(sql, bindings);
 }
 
 bool EventRepository::isEventRoleUsed(IntegerPrimaryKey roleId) const {
@@ -255,11 +280,7 @@ bool EventRepository::isEventRoleUsed(IntegerPrimaryKey roleId) const {
 bool EventRepository::reassignEventRoleId(IntegerPrimaryKey fromId, IntegerPrimaryKey toId) const {
     const auto sql = u"UPDATE event_relations SET role_id = :to_id WHERE role_id = :from_id"_s;
     const QVariantMap bindings = {{u":to_id"_s, toId}, {u":from_id"_s, fromId}};
-    const bool ok = QueryHelper::execute(sql, bindings);
-    if (ok) {
-        DataEventBroker::instance().notifyChanged<Schema::EventRelations>(std::nullopt);
-    }
-    return ok;
+    return QueryHelper::execute(sql, bindings);
 }
 
 QList<SourceEntity> EventRepository::findCitationsForEvent(IntegerPrimaryKey eventId) const {
@@ -347,7 +368,7 @@ std::optional<IntegerPrimaryKey> EventRepository::insertEventWithRelation(
 
 std::optional<IntegerPrimaryKey> EventRepository::insertFullEvent(
     IntegerPrimaryKey typeId,
-    const QString& date,
+    const GenealogicalDate& date,
     const QString& name,
     const QString& note,
     IntegerPrimaryKey personId,
@@ -7,6 +7,7 @@
 
 #include "../../core/base_repository.h"
 #include "database/schema.h"
+#include "dates/genealogical_date.h"
 #include "domain/source/source_entities.h"
 #include "event_entities.h"
 
@@ -39,12 +40,23 @@ public:
 
     [[nodiscard]] QList<EventDisplayEntity> findAllEvents() const;
 
+    [[nodiscard]] std::optional<EventDisplayEntity> findEventDisplayById(IntegerPrimaryKey id) const;
+
+    /**
+     * Find the events that may have happened during a date, e.g. a range of years.
+     *
+     * This compares the first and last day the dates can be on, so it also finds events with a
+     * date that only partly overlaps, like a year, a range or a date before or after the period.
+     * Events without a calendar date are not found.
+     */
+    [[nodiscard]] QList<EventDisplayEntity> findEventsOverlapping(const GenealogicalDate& period) const;
+
     std::optional<IntegerPrimaryKey> insertEvent(IntegerPrimaryKey typeId) const;
 
     bool updateEvent(
         IntegerPrimaryKey id,
         IntegerPrimaryKey typeId,
-        const QString& date,
+        const GenealogicalDate& date,
         const QString& name,
         const QString& note,
         std::optional<IntegerPrimaryKey> locationId = std::nullopt
@@ -78,7 +90,7 @@ public:
 
     std::optional<IntegerPrimaryKey> insertFullEvent(
         IntegerPrimaryKey typeId,
-        const QString& date,
+        const GenealogicalDate& date,
         const QString& name,
         const QString& note,
         IntegerPrimaryKey personId,
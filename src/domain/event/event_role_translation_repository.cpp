@@ -5,7 +5,6 @@
  */
 #include "event_role_translation_repository.h"
 
-#include "core/data_event_broker.h"
 #include "core/query_helper.h"
 
 using namespace Qt::StringLiterals;
@@ -19,22 +18,14 @@ QList<EventRoleTranslationEntity> EventRoleTranslationRepository::findAllForType
 
 std::optional<IntegerPrimaryKey>
 EventRoleTranslationRepository::insert(IntegerPrimaryKey roleId, const QString& locale, const QString& name) const {
-    auto newId = QueryHelper::insert(
+    return QueryHelper::insert(
         u"INSERT INTO event_role_translations (role_id, locale, name) VALUES (:role_id, :locale, :name)"_s,
         {{u":role_id"_s, roleId}, {u":locale"_s, locale}, {u":name"_s, name}}
     );
-    if (newId) {
-        DataEventBroker::instance().notifyChanged<Schema::EventRoleTranslations>(newId);
-    }
-    return newId;
 }
 
 bool EventRoleTranslationRepository::remove(IntegerPrimaryKey id) const {
-    return QueryHelper::executeAndNotify<Schema::EventRoleTranslations>(
-        id,
-        u"DELETE FROM event_role_translations WHERE id = :id"_s,
-        {{u":id"_s, id}}
-    );
+    return QueryHelper::execute(u"DELETE FROM event_role_translations WHERE id = :id"_s, {{u":id"_s, id}});
 }
 
 std::optional<QString>
@@ -23,7 +23,11 @@ EventRolesListModel::EventRolesListModel(QObject* parent) : ObjectTableModel(par
     });
     this->setColumn(BUILTIN, i18n("Built-in"), &EventRoleEntity::builtin);
 
-    connectToTable<Schema::EventRoles>(this);
+    this->setRowId(&EventRoleEntity::id);
+    this->updateRowsOn<Schema::EventRoles>(
+        [](IntegerPrimaryKey id) { return EventRepository().findEventRoleById(id); },
+        [this] { reload(); }
+    );
 
     reload();
 }
@@ -5,7 +5,6 @@
  */
 #include "event_type_translation_repository.h"
 
-#include "core/data_event_broker.h"
 #include "core/query_helper.h"
 
 using namespace Qt::StringLiterals;
@@ -19,22 +18,14 @@ QList<EventTypeTranslationEntity> EventTypeTranslationRepository::findAllForType
 
 std::optional<IntegerPrimaryKey>
 EventTypeTranslationRepository::insert(IntegerPrimaryKey typeId, const QString& locale, const QString& name) const {
-    auto newId = QueryHelper::insert(
+    return QueryHelper::insert(
         u"INSERT INTO event_type_translations (type_id, locale, name) VALUES (:type_id, :locale, :name)"_s,
         {{u":type_id"_s, typeId}, {u":locale"_s, locale}, {u":name"_s, name}}
     );
-    if (newId) {
-        DataEventBroker::instance().notifyChanged<Schema::EventTypeTranslations>(newId);
-    }
-    return newId;
 }
 
 bool EventTypeTranslationRepository::remove(IntegerPrimaryKey id) const {
-    return QueryHelper::executeAndNotify<Schema::EventTypeTranslations>(
-        id,
-        u"DELETE FROM event_type_translations WHERE id = :id"_s,
-        {{u":id"_s, id}}
-    );
+    return QueryHelper::execute(u"DELETE FROM event_type_translations WHERE id = :id"_s, {{u":id"_s, id}});
 }
 
 std::optional<QString>
@@ -23,7 +23,11 @@ EventTypesListModel::EventTypesListModel(QObject* parent) : ObjectTableModel(par
     });
     this->setColumn(BUILTIN, i18n("Built-in"), &EventTypeEntity::builtin);
 
-    connectToTable<Schema::EventTypes>(this);
+    this->setRowId(&EventTypeEntity::id);
+    this->updateRowsOn<Schema::EventTypes>(
+        [](IntegerPrimaryKey id) { return EventRepository().findEventTypeById(id); },
+        [this] { reload(); }
+    );
 
     reload();
 }
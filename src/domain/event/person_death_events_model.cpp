@@ -20,13 +20,14 @@ PersonDeathEventsModel::PersonDeathEventsModel(IntegerPrimaryKey personId, QObje
     this->setColumn(ROLE, i18n("Role"), &PersonEventEntity::role);
     this->setColumn(TYPE, i18n("Type"), &PersonEventEntity::type);
     this->setColumn(DATE, i18n("Date"), [](const PersonEventEntity& e) -> QVariant {
-        if (e.date.isEmpty()) {
+        if (e.date.isNull()) {
             return {};
         }
-        return GenealogicalDate::fromDatabaseRepresentation(e.date).toLocalizedText();
+        return e.date.toLocalizedText();
     });
     this->setColumn(NAME, i18n("Name"), &PersonEventEntity::name);
     this->setColumn(DATE_RAW, i18n("Date (raw)"), &PersonEventEntity::date);
+    this->projectColumn(DATE);
 
     connectToTable<Schema::Events>(this);
     connectToTable<Schema::EventTypes>(this);
@@ -18,15 +18,16 @@ PersonEventListModel::PersonEventListModel(IntegerPrimaryKey personId, QObject*
     this->setColumn(ROLE, i18n("Role"), &PersonEventEntity::role);
     this->setColumn(TYPE, i18n("Type"), &PersonEventEntity::type);
     this->setColumn(DATE, i18n("Date"), [](const PersonEventEntity& e) -> QVariant {
-        if (e.date.isEmpty()) {
+        if (e.date.isNull()) {
             return {};
         }
-        return GenealogicalDate::fromDatabaseRepresentation(e.date).toLocalizedText();
+        return e.date.toLocalizedText();
     });
     this->setColumn(NAME, i18n("Name"), &PersonEventEntity::name);
     this->setColumn(ID, i18n("ID"), &PersonEventEntity::id);
     this->setColumn(ROLE_ID, i18n("Role ID"), &PersonEventEntity::roleId);
     this->setColumn(RELATION_ID, i18n("Relation ID"), &PersonEventEntity::relationId);
+    this->projectColumn(DATE);
 
     connectToTable<Schema::Events>(this);
     connectToTable<Schema::EventTypes>(this);
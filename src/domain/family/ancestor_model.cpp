@@ -10,10 +10,33 @@
 #include "family_repository.h"
 
 #include <KLocalizedString>
+#include <algorithm>
 
-AncestorModel::AncestorModel(IntegerPrimaryKey personId, QObject* parent) :
+namespace {
+void markUnloadedParents(QList<AncestorEntity>& rows) {
+    QSet<IntegerPrimaryKey> loaded;
+    loaded.reserve(rows.size());
+    for (const auto& row: std::as_const(rows)) {
+        loaded.insert(row.childId);
+    }
+    for (auto& row: rows) {
+        row.unloadedParents = (row.fatherId.has_value() && !loaded.contains(*row.fatherId)) ||
+            (row.motherId.has_value() && !loaded.contains(*row.motherId));
+    }
+}
+
+QCoro::Task<QList<AncestorEntity>>
+withUnloadedParents(QList<AncestorEntity> rows, QCoro::Task<QList<AncestorEntity>> task) {
+    rows.append(co_await std::move(task));
+    markUnloadedParents(rows);
+    co_return rows;
+}
+}
+
+AncestorModel::AncestorModel(IntegerPrimaryKey personId, int generations, QObject* parent) :
     ObjectTableModel(parent),
-    personId(personId) {
+    personId(personId),
+    generations(generations) {
 
     this->setColumn(CHILD_ID, i18n("Child ID"), &AncestorEntity::childId);
     this->setColumn(FATHER_ID, i18n("Father ID"), [](const AncestorEntity& e) -> QVariant {
@@ -22,11 +45,14 @@ AncestorModel::AncestorModel(IntegerPrimaryKey personId, QObject* parent) :
     this->setColumn(MOTHER_ID, i18n("Mother ID"), [](const AncestorEntity& e) -> QVariant {
         return e.motherId.has_value() ? QVariant(*e.motherId) : QVariant();
     });
-    this->setColumn(VISITED, i18n("Visited"), &AncestorEntity::visited);
+    this->setColumn(UNLOADED_PARENTS, i18n("Unloaded parents"), &AncestorEntity::unloadedParents);
     this->setColumn(LEVEL, i18n("Level"), &AncestorEntity::level);
     this->setColumn(DISPLAY_NAME, i18n("Name"), [](const AncestorEntity& e) {
         return construct_display_name(e.titles, e.givenNames, e.prefix, e.surname);
     });
+    this->projectColumn(DISPLAY_NAME);
+    // Loading more generations then only inserts the new rows.
+    this->setRowId(&AncestorEntity::childId);
 
     connectToTable<Schema::People>(this);
     connectToTable<Schema::Names>(this);
@@ -38,6 +64,36 @@ AncestorModel::AncestorModel(IntegerPrimaryKey personId, QObject* parent) :
 }
 
 void AncestorModel::reload() {
-    FamilyRepository repo;
-    this->setItems(repo.findAncestorsForPerson(personId));
+    this->setItemsAsync(
+        withUnloadedParents({}, FamilyRepository().findAncestorsForPersonAsync(personId, generations, expanded))
+    );
+}
+
+void AncestorModel::loadMoreGenerations(IntegerPrimaryKey ancestorId) {
+    const auto& rows = getItems();
+    const auto row = std::ranges::find(rows, ancestorId, &AncestorEntity::childId);
+    if (row == rows.end() || !row->unloadedParents) {
+        return;
+    }
+    expanded.insert(ancestorId);
+    if (hasPendingReload()) {
+        // The reload would overwrite the new rows, but includes them.
+        reload();
+        return;
+    }
+
+    QSet<IntegerPrimaryKey> known;
+    known.reserve(rows.size());
+    for (const auto& loaded: rows) {
+        known.insert(loaded.childId);
+    }
+    QList<IntegerPrimaryKey> parents;
+    for (const auto& parentId: {row->fatherId, row->motherId}) {
+        if (parentId.has_value() && !known.contains(*parentId)) {
+            parents.append(*parentId);
+        }
+    }
+
+    auto task = FamilyRepository().findAncestorsOfAsync(parents, row->level + 1, generations, known);
+    this->setItemsAsync(withUnloadedParents(rows, std::move(task)));
 }
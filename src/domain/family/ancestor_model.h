@@ -7,17 +7,45 @@
 #include "family_entities.h"
 #include "model/object_table_model.h"
 
+#include <QSet>
+
+/**
+ * A person and their ancestors, one row per person.
+ *
+ * Only a number of generations is loaded at first. The rows of the last generation have
+ * unloaded parents (see UNLOADED_PARENTS), whose ancestors can be loaded later.
+ */
 class AncestorModel : public ObjectTableModel<AncestorEntity> {
     Q_OBJECT
 public:
-    enum Columns { CHILD_ID = 0, FATHER_ID, MOTHER_ID, VISITED, LEVEL, DISPLAY_NAME };
+    enum Columns { CHILD_ID = 0, FATHER_ID, MOTHER_ID, UNLOADED_PARENTS, LEVEL, DISPLAY_NAME };
     Q_ENUM(Columns);
 
-    explicit AncestorModel(IntegerPrimaryKey personId, QObject* parent = nullptr);
+    static constexpr int DEFAULT_GENERATIONS = 5;
+
+    /**
+     * @param generations The number of generations to load, including the person, and to load
+     *                    more of at a time.
+     */
+    explicit AncestorModel(
+        IntegerPrimaryKey personId,
+        int generations = DEFAULT_GENERATIONS,
+        QObject* parent = nullptr
+    );
+
+    /**
+     * Load more generations of the ancestors of a person with unloaded parents.
+     *
+     * The new ancestors are added at the end. They are kept when the model is reloaded.
+     */
+    void loadMoreGenerations(IntegerPrimaryKey personId);
 
 public Q_SLOTS:
     void reload();
 
 private:
     IntegerPrimaryKey personId;
+    int generations;
+    // The people for whom more generations were loaded.
+    QSet<IntegerPrimaryKey> expanded;
 };
@@ -6,7 +6,9 @@
 #pragma once
 
 #include "core/query_utils.h"
+#include "core/sql_row.h"
 #include "database/schema.h"
+#include "dates/date_columns.h"
 
 #include <QSqlQuery>
 #include <QString>
@@ -18,10 +20,12 @@ struct FamilyEntity {
     IntegerPrimaryKey id = -1;
     std::optional<QString> note;
 
-    static FamilyEntity fromSql(const QSqlQuery& query) {
+    using Columns = SqlColumns<u"id", u"note">;
+
+    static FamilyEntity fromSql(const Columns::Row& row) {
         return {
-            .id = query.value(u"id"_s).toLongLong(),
-            .note = validOrOptional<QString>(query.value(u"note"_s)),
+            .id = row.value<u"id">().toLongLong(),
+            .note = validOrOptional<QString>(row.value<u"note">()),
         };
     }
 };
@@ -33,25 +37,37 @@ struct FamilyMemberEntity {
     std::optional<IntegerPrimaryKey> partnerId;
     std::optional<IntegerPrimaryKey> familyId;
     IntegerPrimaryKey eventId = -1;
-    QString date;
+    GenealogicalDate date;
     QString titles;
     QString givenNames;
     QString prefix;
     QString surname;
 
-    static FamilyMemberEntity fromSql(const QSqlQuery& query) {
+    using Columns = SqlColumns<
+        u"event_type",
+        u"event_type_id",
+        u"person_id",
+        u"partner_id",
+        u"family_id",
+        u"event_id",
+        u"titles",
+        u"given_names",
+        u"prefix",
+        u"surname">::Join<DateColumns<u"date">::Columns>;
+
+    static FamilyMemberEntity fromSql(const Columns::Row& row) {
         FamilyMemberEntity e;
-        e.eventType = query.value(u"event_type"_s).toString();
-        e.eventTypeId = query.value(u"event_type_id"_s).toLongLong();
-        e.personId = query.value(u"person_id"_s).toLongLong();
-        e.partnerId = validOrOptional<IntegerPrimaryKey>(query.value(u"partner_id"_s));
-        e.familyId = validOrOptional<IntegerPrimaryKey>(query.value(u"family_id"_s));
-        e.eventId = query.value(u"event_id"_s).toLongLong();
-        e.date = query.value(u"event_date"_s).toString();
-        e.titles = query.value(u"titles"_s).toString();
-        e.givenNames = query.value(u"given_names"_s).toString();
-        e.prefix = query.value(u"prefix"_s).toString();
-        e.surname = query.value(u"surname"_s).toString();
+        e.eventType = row.value<u"event_type">().toString();
+        e.eventTypeId = row.value<u"event_type_id">().toLongLong();
+        e.personId = row.value<u"person_id">().toLongLong();
+        e.partnerId = validOrOptional<IntegerPrimaryKey>(row.value<u"partner_id">());
+        e.familyId = validOrOptional<IntegerPrimaryKey>(row.value<u"family_id">());
+        e.eventId = row.value<u"event_id">().toLongLong();
+        e.date = DateColumns<u"date">::read(row);
+        e.titles = row.value<u"titles">().toString();
+        e.givenNames = row.value<u"given_names">().toString();
+        e.prefix = row.value<u"prefix">().toString();
+        e.surname = row.value<u"surname">().toString();
         return e;
     }
 };
@@ -61,7 +77,7 @@ struct FamilyOverviewRow {
     QString familyDisplayName;
     IntegerPrimaryKey eventId = -1;
     QString eventType;
-    QString eventDate;
+    GenealogicalDate eventDate;
     IntegerPrimaryKey personId = -1;
     QString role;
     QString titles;
@@ -69,19 +85,31 @@ struct FamilyOverviewRow {
     QString prefix;
     QString surname;
 
-    static FamilyOverviewRow fromSql(const QSqlQuery& query) {
+    using Columns = SqlColumns<
+        u"family_id",
+        u"family_display_name",
+        u"event_id",
+        u"event_type",
+        u"person_id",
+        u"role",
+        u"titles",
+        u"given_names",
+        u"prefix",
+        u"surname">::Join<DateColumns<u"date">::Columns>;
+
+    static FamilyOverviewRow fromSql(const Columns::Row& row) {
         FamilyOverviewRow e;
-        e.familyId = query.value(u"family_id"_s).toLongLong();
-        e.familyDisplayName = query.value(u"family_display_name"_s).toString();
-        e.eventId = query.value(u"event_id"_s).toLongLong();
-        e.eventType = query.value(u"event_type"_s).toString();
-        e.eventDate = query.value(u"event_date"_s).toString();
-        e.personId = query.value(u"person_id"_s).toLongLong();
-        e.role = query.value(u"role"_s).toString();
-        e.titles = query.value(u"titles"_s).toString();
-        e.givenNames = query.value(u"given_names"_s).toString();
-        e.prefix = query.value(u"prefix"_s).toString();
-        e.surname = query.value(u"surname"_s).toString();
+        e.familyId = row.value<u"family_id">().toLongLong();
+        e.familyDisplayName = row.value<u"family_display_name">().toString();
+        e.eventId = row.value<u"event_id">().toLongLong();
+        e.eventType = row.value<u"event_type">().toString();
+        e.eventDate = DateColumns<u"date">::read(row);
+        e.personId = row.value<u"person_id">().toLongLong();
+        e.role = row.value<u"role">().toString();
+        e.titles = row.value<u"titles">().toString();
+        e.givenNames = row.value<u"given_names">().toString();
+        e.prefix = row.value<u"prefix">().toString();
+        e.surname = row.value<u"surname">().toString();
         return e;
     }
 };
@@ -90,28 +118,41 @@ struct AncestorEntity {
     IntegerPrimaryKey childId = -1;
     std::optional<IntegerPrimaryKey> fatherId;
     std::optional<IntegerPrimaryKey> motherId;
-    QString visited;
+    // The generation, where the person whose ancestors these are is 1.
     int level = 0;
+    // If the person has parents that are not loaded.
+    bool unloadedParents = false;
     QString titles;
     QString givenNames;
     QString prefix;
     QString surname;
 
-    static AncestorEntity fromSql(const QSqlQuery& query) {
+    using Columns = SqlColumns<
+        u"child_id",
+        u"father_id",
+        u"mother_id",
+        u"level",
+        u"titles",
+        u"given_names",
+        u"prefix",
+        u"surname">;
+
+    static AncestorEntity fromSql(const Columns::Row& row) {
         AncestorEntity e;
-        e.childId = query.value(u"child_id"_s).toLongLong();
-        const auto fatherValue = query.value(u"father_id"_s);
+        e.childId = row.value<u"child_id">().toLongLong();
+        const auto fatherValue = row.value<u"father_id">();
         e.fatherId = fatherValue.isNull() ? std::nullopt : std::optional<IntegerPrimaryKey>{fatherValue.toLongLong()};
-        const auto motherValue = query.value(u"mother_id"_s);
+        const auto motherValue = row.value<u"mother_id">();
         e.motherId = motherValue.isNull() ? std::nullopt : std::optional<IntegerPrimaryKey>{motherValue.toLongLong()};
-        e.visited = query.value(u"visited"_s).toString();
-        e.level = query.value(u"level"_s).toInt();
-        e.titles = query.value(u"titles"_s).toString();
-        e.givenNames = query.value(u"given_names"_s).toString();
-        e.prefix = query.value(u"prefix"_s).toString();
-        e.surname = query.value(u"surname"_s).toString();
+        e.level = row.value<u"level">().toInt();
+        e.titles = row.value<u"titles">().toString();
+        e.givenNames = row.value<u"given_names">().toString();
+        e.prefix = row.value<u"prefix">().toString();
+        e.surname = row.value<u"surname">().toString();
         return e;
     }
+
+    bool operator==(const AncestorEntity&) const = default;
 };
 
 struct ParentEntity {
@@ -123,15 +164,17 @@ struct ParentEntity {
     QString prefix;
     QString surname;
 
-    static ParentEntity fromSql(const QSqlQuery& query) {
+    using Columns = SqlColumns<u"person_id", u"role_id", u"role", u"titles", u"given_names", u"prefix", u"surname">;
+
+    static ParentEntity fromSql(const Columns::Row& row) {
         return {
-            .personId = query.value(u"person_id"_s).toLongLong(),
-            .roleId = query.value(u"role_id"_s).toLongLong(),
-            .role = query.value(u"role"_s).toString(),
-            .titles = query.value(u"titles"_s).toString(),
-            .givenNames = query.value(u"given_names"_s).toString(),
-            .prefix = query.value(u"prefix"_s).toString(),
-            .surname = query.value(u"surname"_s).toString(),
+            .personId = row.value<u"person_id">().toLongLong(),
+            .roleId = row.value<u"role_id">().toLongLong(),
+            .role = row.value<u"role">().toString(),
+            .titles = row.value<u"titles">().toString(),
+            .givenNames = row.value<u"given_names">().toString(),
+            .prefix = row.value<u"prefix">().toString(),
+            .surname = row.value<u"surname">().toString(),
         };
     }
 };
@@ -9,6 +9,8 @@
 #include "dates/genealogical_date.h"
 #include "domain/name/names.h"
 #include "family_repository.h"
+#include "utils/async.h"
+#include "utils/locale_change_notifier.h"
 
 #include <KLocalizedString>
 
@@ -36,16 +38,33 @@ FamilyListModel::FamilyListModel(QObject* parent) : QAbstractItemModel(parent) {
     connectToTable<Schema::Events>(this);
     connectToTable<Schema::EventRelations>(this);
     connectToTable<Schema::Names>(this);
+    connect(&LocaleChangeNotifier::instance(), &LocaleChangeNotifier::changed, this, &FamilyListModel::onLocaleChanged);
 
     reload();
 }
 
 void FamilyListModel::reload() {
-    beginResetModel();
-    FamilyRepository repo;
-    rows = repo.findAllFamiliesOverview();
-    rebuildMapping();
-    endResetModel();
+    // Keep showing the current rows until the new ones are there.
+    const auto generation = ++reloadGeneration;
+    auto apply = [this, generation](const QList<FamilyOverviewRow>& fresh) {
+        if (generation != reloadGeneration) {
+            // A newer reload was started in the meantime.
+            return;
+        }
+        beginResetModel();
+        rows = fresh;
+        rebuildMapping();
+        endResetModel();
+    };
+
+    auto future = spawn(FamilyRepository().findAllFamiliesOverviewAsync());
+    if (future.isFinished()) {
+        if (future.resultCount() > 0) {
+            apply(future.result());
+        }
+        return;
+    }
+    future.then(this, apply);
 }
 
 void FamilyListModel::rebuildMapping() {
@@ -61,6 +80,30 @@ void FamilyListModel::rebuildMapping() {
         }
         childRows[row.familyId].append(i);
     }
+    formatRows();
+}
+
+void FamilyListModel::formatRows() {
+    rowDisplayNames.clear();
+    rowDates.clear();
+    rowDisplayNames.reserve(rows.size());
+    rowDates.reserve(rows.size());
+    for (const auto& row: std::as_const(rows)) {
+        rowDisplayNames.append(construct_display_name(row.titles, row.givenNames, row.prefix, row.surname));
+        rowDates.append(row.eventDate.isNull() ? QVariant() : QVariant(row.eventDate.toLocalizedText()));
+    }
+}
+
+void FamilyListModel::onLocaleChanged() {
+    formatRows();
+    for (int familyListIndex = 0; familyListIndex < families.size(); ++familyListIndex) {
+        const auto childCount = static_cast<int>(childRows[families[familyListIndex]].size());
+        if (childCount == 0) {
+            continue;
+        }
+        const auto parent = index(familyListIndex, 0);
+        Q_EMIT dataChanged(index(0, DISPLAY_NAME, parent), index(childCount - 1, DATE, parent));
+    }
 }
 
 QModelIndex FamilyListModel::index(int row, int column, const QModelIndex& parent) const {
@@ -162,14 +205,11 @@ QVariant FamilyListModel::data(const QModelIndex& index, int role) const {
         case FAMILY_ID:
             return {};
         case DISPLAY_NAME:
-            return construct_display_name(row.titles, row.givenNames, row.prefix, row.surname);
+            return rowDisplayNames[rowIndex];
         case TYPE:
             return row.eventType;
         case DATE:
-            if (row.eventDate.isEmpty()) {
-                return {};
-            }
-            return GenealogicalDate::fromDatabaseRepresentation(row.eventDate).toLocalizedText();
+            return rowDates[rowIndex];
         case ROLE:
             return row.role;
         case PERSON_ID:
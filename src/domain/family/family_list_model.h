@@ -38,6 +38,12 @@ public:
     [[nodiscard]] Qt::ItemFlags flags(const QModelIndex& index) const override;
 
 public Q_SLOTS:
+    /**
+     * Reload the families on a worker thread.
+     *
+     * The current rows are shown until the new ones arrive. Results of a reload that was
+     * overtaken by a newer one are dropped.
+     */
     void reload();
 
 private:
@@ -45,6 +51,12 @@ private:
     QList<IntegerPrimaryKey> families;
     QHash<IntegerPrimaryKey, QList<int>> childRows;
     QHash<IntegerPrimaryKey, QString> familyDisplayNames;
+    // The name and date of each row, formatted once instead of each time a view asks for them.
+    QList<QString> rowDisplayNames;
+    QList<QVariant> rowDates;
+    quint64 reloadGeneration = 0;
 
     void rebuildMapping();
+    void formatRows();
+    void onLocaleChanged();
 };
@@ -211,7 +211,10 @@ QVariant FamilyMembersModel::dataForItem(const FamilyMemberEntity& item, int col
         case TYPE:
             return item.eventType;
         case DATE:
-            return item.date;
+            if (item.date.isNull()) {
+                return {};
+            }
+            return item.date.toLocalizedText();
         case PERSON_ID:
             return item.personId;
         case DISPLAY_NAME:
@@ -5,22 +5,22 @@
  */
 #include "./family_repository.h"
 
-#include "../../core/data_event_broker.h"
+#include "../../core/query_helper.h"
+#include "dates/date_columns.h"
+#include "domain/event/builtin_ids.h"
 
-#include <QSqlQuery>
+#include <QHash>
+#include <QStringList>
+#include <algorithm>
 
 using namespace Qt::StringLiterals;
 
 static const auto FAMILY_MEMBERS_SQL = QStringLiteral(R"-(
 WITH my_families AS (
     SELECT DISTINCT e.family_id
-    FROM events e
-    JOIN event_relations er ON e.id = er.event_id
-    JOIN event_roles r ON er.role_id = r.id
-    JOIN event_types et ON e.type_id = et.id
-    WHERE er.person_id = :id
-      AND r.role IN ('Father', 'Mother')
-      AND et.type = 'Birth'
+    FROM parent_links
+    JOIN events e ON e.id = parent_links.event_id
+    WHERE parent_links.parent_id = :id
       AND e.family_id IS NOT NULL
 )
 SELECT et.type           AS event_type,
@@ -28,104 +28,67 @@ SELECT et.type           AS event_type,
        er.person_id      AS person_id,
        NULL              AS partner_id,
        e.id              AS event_id,
-       e.date            AS event_date,
-       e.date_sort       AS event_date_sort,
        e.family_id       AS family_id,
        names.titles      AS titles,
        names.given_names AS given_names,
        names.prefix      AS prefix,
-       names.surname     AS surname
+       names.surname     AS surname,
+       %1
 FROM events e
 JOIN event_types et ON e.type_id = et.id
 JOIN event_relations er ON e.id = er.event_id
-JOIN event_roles r ON er.role_id = r.id
-LEFT JOIN names ON er.person_id = names.person_id
+LEFT JOIN person_primary_name primary_name ON er.person_id = primary_name.person_id
+LEFT JOIN names ON primary_name.name_id = names.id
 WHERE e.family_id IN (SELECT family_id FROM my_families)
   AND (
-      (et.type = 'Birth' AND r.role = 'Primary')
-      OR (et.type = 'Marriage' AND r.role IN ('Primary', 'Partner') AND er.person_id != :id)
+      (e.type_id = :birth AND er.role_id = :primary)
+      OR (e.type_id = :marriage AND er.role_id IN (:primary, :partner) AND er.person_id != :id)
   )
-  AND (names.sort = (SELECT MIN(n2.sort) FROM names AS n2 WHERE n2.person_id = er.person_id) OR names.sort IS NULL)
-ORDER BY event_type, event_date_sort ASC NULLS LAST;
-)-");
+ORDER BY event_type, e.date_sort ASC NULLS LAST;
+)-").arg(DateColumns<u"date">::select(u"e"));
 
+// One generation of ancestors: the parents and primary name of each person in the :people array.
+// The parents are those of the first birth event of the person that has a father or mother.
 static const auto ANCESTORS_SQL = QStringLiteral(R"-(
-WITH RECURSIVE
-  parent_of(child_id, father_id, mother_id) AS
-    (SELECT child_relation.person_id  AS child_id,
-            father_relation.person_id AS father_id,
-            mother_relation.person_id AS mother_id
-     FROM event_relations AS child_relation
-            LEFT JOIN event_relations AS father_relation
-                      ON child_relation.event_id = father_relation.event_id
-                        AND father_relation.role_id = (SELECT id FROM event_roles WHERE role = 'Father')
-            LEFT JOIN event_relations AS mother_relation
-                      ON child_relation.event_id = mother_relation.event_id
-                        AND mother_relation.role_id = (SELECT id FROM event_roles WHERE role = 'Mother')
-     WHERE child_relation.role_id = (SELECT id FROM event_roles WHERE role = 'Primary')
-     GROUP BY child_relation.person_id
-
-     UNION ALL
-
-     SELECT er.person_id AS child_id, NULL AS father_id, NULL AS mother_id
-     FROM event_relations er
-            JOIN event_roles ON er.role_id = event_roles.id
-     WHERE event_roles.role IN ('Father', 'Mother')
-       AND er.person_id NOT IN (SELECT person_id
-                                FROM event_relations
-                                WHERE role_id = (SELECT id FROM event_roles WHERE role = 'Primary'))
-     GROUP BY er.person_id
-
-     UNION ALL
-
-     SELECT :person, NULL, NULL),
-  ancestor_tree(child_id, father_id, mother_id, visited) AS
-    (SELECT child_id,
-            father_id,
-            mother_id,
-            CAST(child_id AS TEXT) AS visited
-     FROM parent_of
-     WHERE child_id = :person
-
-     UNION ALL
-
-     SELECT parent_of.child_id                                 AS child_id,
-            parent_of.father_id                                AS father_id,
-            parent_of.mother_id                                AS mother_id,
-            ancestor_tree.visited || ',' || parent_of.child_id AS visited
-     FROM ancestor_tree
-            LEFT JOIN parent_of
-                      ON parent_of.child_id = ancestor_tree.father_id
-                        OR parent_of.child_id = ancestor_tree.mother_id
-     WHERE parent_of.child_id IS NOT NULL
-       AND ',' || ancestor_tree.visited || ',' NOT LIKE '%,' || parent_of.child_id || ',%')
-SELECT child_id,
-       father_id,
-       mother_id,
-       visited,
-       json_array_length('[' || visited || ']') AS level,
+WITH generation(person_id) AS
+       (SELECT DISTINCT value FROM json_each(:people)),
+     parent_event(person_id, event_id) AS MATERIALIZED
+       (SELECT generation.person_id,
+               (SELECT MIN(parent_links.event_id) FROM parent_links WHERE parent_links.child_id = generation.person_id)
+        FROM generation)
+SELECT parent_event.person_id AS child_id,
+       (SELECT MIN(father_link.parent_id)
+        FROM parent_links AS father_link
+        WHERE father_link.child_id = parent_event.person_id
+          AND father_link.event_id = parent_event.event_id
+          AND father_link.role_id = :father)
+                              AS father_id,
+       (SELECT MIN(mother_link.parent_id)
+        FROM parent_links AS mother_link
+        WHERE mother_link.child_id = parent_event.person_id
+          AND mother_link.event_id = parent_event.event_id
+          AND mother_link.role_id = :mother)
+                              AS mother_id,
+       :level                 AS level,
        names.titles,
        names.given_names,
        names.prefix,
        names.surname
-FROM ancestor_tree
-       LEFT JOIN names ON ancestor_tree.child_id = names.person_id
-WHERE names.sort = (SELECT MIN(n2.sort) FROM names AS n2 WHERE n2.person_id = ancestor_tree.child_id) OR names.sort IS NULL
-GROUP BY child_id
-ORDER BY level, child_id
+FROM parent_event
+       LEFT JOIN person_primary_name AS primary_name ON primary_name.person_id = parent_event.person_id
+       LEFT JOIN names ON names.id = primary_name.name_id
+ORDER BY parent_event.person_id
 )-");
 
 static const auto FAMILIES_OVERVIEW_SQL = QStringLiteral(R"-(
 WITH parent_surnames AS (
     SELECT e.family_id, er.person_id, n.surname
     FROM events e
-    JOIN event_types et ON e.type_id = et.id
     JOIN event_relations er ON e.id = er.event_id
-    JOIN event_roles r ON er.role_id = r.id
-    JOIN names n ON er.person_id = n.person_id
-    WHERE et.type = 'Birth'
-      AND r.role IN ('Father', 'Mother')
-      AND (n.sort = (SELECT MIN(n2.sort) FROM names n2 WHERE n2.person_id = er.person_id) OR n.sort IS NULL)
+    JOIN person_primary_name primary_name ON er.person_id = primary_name.person_id
+    JOIN names n ON primary_name.name_id = n.id
+    WHERE e.type_id = :birth
+      AND er.role_id IN (:father, :mother)
     GROUP BY e.family_id, er.person_id
 ),
 parent_names AS (
@@ -137,58 +100,186 @@ SELECT f.id                                           AS family_id,
        COALESCE(pn.display_name, 'Family #' || f.id) AS family_display_name,
        e.id                                           AS event_id,
        et.type                                        AS event_type,
-       e.date                                         AS event_date,
-       e.date_sort                                    AS event_date_sort,
        er.person_id                                   AS person_id,
        r.role                                         AS role,
        n.titles                                       AS titles,
        n.given_names                                  AS given_names,
        n.prefix                                       AS prefix,
-       n.surname                                      AS surname
+       n.surname                                      AS surname,
+       %1
 FROM families f
 LEFT JOIN parent_names pn ON f.id = pn.family_id
 JOIN events e ON e.family_id = f.id
 JOIN event_types et ON e.type_id = et.id
 JOIN event_relations er ON e.id = er.event_id
 JOIN event_roles r ON er.role_id = r.id
-LEFT JOIN names n ON er.person_id = n.person_id
-WHERE ((et.type = 'Birth' AND r.role = 'Primary')
-    OR (et.type = 'Marriage' AND r.role IN ('Primary', 'Partner')))
-  AND (n.sort = (SELECT MIN(n2.sort) FROM names n2 WHERE n2.person_id = er.person_id) OR n.sort IS NULL)
+LEFT JOIN person_primary_name primary_name ON er.person_id = primary_name.person_id
+LEFT JOIN names n ON primary_name.name_id = n.id
+WHERE ((e.type_id = :birth AND er.role_id = :primary)
+    OR (e.type_id = :marriage AND er.role_id IN (:primary, :partner)))
 ORDER BY f.id,
-         CASE WHEN et.type = 'Marriage' THEN 0 ELSE 1 END,
+         CASE WHEN e.type_id = :marriage THEN 0 ELSE 1 END,
          e.date_sort ASC NULLS LAST
-)-");
+)-").arg(DateColumns<u"date">::select(u"e"));
 
 static const auto PARENTS_SQL = QStringLiteral(R"-(
-SELECT parent_relation.person_id,
-       parent_relation.role_id,
+SELECT parent_links.parent_id AS person_id,
+       parent_links.role_id,
        event_roles.role,
        names.titles,
        names.given_names,
        names.prefix,
        names.surname
-FROM event_relations AS child_relation
-       LEFT JOIN event_relations AS parent_relation ON child_relation.event_id = parent_relation.event_id
-       LEFT JOIN event_roles ON parent_relation.role_id = event_roles.id
-       LEFT JOIN names ON parent_relation.person_id = names.person_id
-WHERE child_relation.person_id = :person
-  AND child_relation.role_id = (SELECT id FROM event_roles WHERE role = 'Primary')
-  AND event_roles.role IN ('Father', 'Mother')
-  AND (names.sort = (SELECT MIN(name2.sort) FROM names AS name2 WHERE name2.person_id = parent_relation.person_id) OR names.sort = NULL)
-ORDER BY parent_relation.person_id;
+FROM parent_links
+       JOIN event_roles ON parent_links.role_id = event_roles.id
+       LEFT JOIN person_primary_name AS primary_name ON parent_links.parent_id = primary_name.person_id
+       LEFT JOIN names ON primary_name.name_id = names.id
+WHERE parent_links.child_id = :person
+ORDER BY parent_links.parent_id;
 )-");
 
+static QVariantMap familiesOverviewBindings() {
+    auto& ids = BuiltinIds::instance();
+    return {
+        {u":birth"_s, ids.typeId(EventTypes::Values::Birth)},
+        {u":marriage"_s, ids.typeId(EventTypes::Values::Marriage)},
+        {u":primary"_s, ids.roleId(EventRoles::Values::Primary)},
+        {u":partner"_s, ids.roleId(EventRoles::Values::Partner)},
+        {u":father"_s, ids.roleId(EventRoles::Values::Father)},
+        {u":mother"_s, ids.roleId(EventRoles::Values::Mother)},
+    };
+}
+
 QList<FamilyOverviewRow> FamilyRepository::findAllFamiliesOverview() const {
-    return fetchAll<FamilyOverviewRow>(FAMILIES_OVERVIEW_SQL, {});
+    return fetchAll<FamilyOverviewRow>(FAMILIES_OVERVIEW_SQL, familiesOverviewBindings());
+}
+
+QCoro::Task<QList<FamilyOverviewRow>> FamilyRepository::findAllFamiliesOverviewAsync() const {
+    return fetchAllAsync<FamilyOverviewRow>(FAMILIES_OVERVIEW_SQL, familiesOverviewBindings());
 }
 
 QList<FamilyMemberEntity> FamilyRepository::findFamilyMembersForPerson(IntegerPrimaryKey personId) const {
-    return fetchAll<FamilyMemberEntity>(FAMILY_MEMBERS_SQL, {{u":id"_s, personId}});
+    auto& ids = BuiltinIds::instance();
+    return fetchAll<FamilyMemberEntity>(
+        FAMILY_MEMBERS_SQL,
+        {
+            {u":id"_s, personId},
+            {u":birth"_s, ids.typeId(EventTypes::Values::Birth)},
+            {u":marriage"_s, ids.typeId(EventTypes::Values::Marriage)},
+            {u":primary"_s, ids.roleId(EventRoles::Values::Primary)},
+            {u":partner"_s, ids.roleId(EventRoles::Values::Partner)},
+        }
+    );
+}
+
+QList<AncestorEntity> FamilyRepository::findAncestorsForPerson(
+    IntegerPrimaryKey personId,
+    int generations,
+    const QSet<IntegerPrimaryKey>& expanded
+) const {
+    return findAncestors({personId}, 1, generations, expanded, {});
+}
+
+QCoro::Task<QList<AncestorEntity>> FamilyRepository::findAncestorsForPersonAsync(
+    IntegerPrimaryKey personId,
+    int generations,
+    QSet<IntegerPrimaryKey> expanded
+) const {
+    if (!ConnectionPool::instance().hasReaders()) {
+        co_return findAncestorsForPerson(personId, generations, expanded);
+    }
+
+    // Every generation is a query, so run them all on the worker thread.
+    co_return co_await QtConcurrent::run([personId, generations, expanded = std::move(expanded)] {
+        return FamilyRepository().findAncestorsForPerson(personId, generations, expanded);
+    });
+}
+
+QList<AncestorEntity> FamilyRepository::findAncestorsOf(
+    const QList<IntegerPrimaryKey>& people,
+    int level,
+    int generations,
+    const QSet<IntegerPrimaryKey>& known
+) const {
+    return findAncestors(people, level, generations, {}, known);
+}
+
+QCoro::Task<QList<AncestorEntity>> FamilyRepository::findAncestorsOfAsync(
+    QList<IntegerPrimaryKey> people,
+    int level,
+    int generations,
+    QSet<IntegerPrimaryKey> known
+) const {
+    if (!ConnectionPool::instance().hasReaders()) {
+        co_return findAncestorsOf(people, level, generations, known);
+    }
+
+    co_return co_await QtConcurrent::run(
+        [people = std::move(people), level, generations, known = std::move(known)] {
+            return FamilyRepository().findAncestorsOf(people, level, generations, known);
+        }
+    );
 }
 
-QList<AncestorEntity> FamilyRepository::findAncestorsForPerson(IntegerPrimaryKey personId) const {
-    return fetchAll<AncestorEntity>(ANCESTORS_SQL, {{u":person"_s, personId}});
+QList<AncestorEntity> FamilyRepository::findAncestors(
+    const QList<IntegerPrimaryKey>& people,
+    int level,
+    int generations,
+    const QSet<IntegerPrimaryKey>& expanded,
+    QSet<IntegerPrimaryKey> known
+) const {
+    // The number of generations that are still loaded, starting with the person itself.
+    QHash<IntegerPrimaryKey, int> remaining;
+    QList<IntegerPrimaryKey> generation;
+    for (const auto personId: people) {
+        if (!known.contains(personId)) {
+            known.insert(personId);
+            remaining.insert(personId, generations);
+            generation.append(personId);
+        }
+    }
+
+    QList<AncestorEntity> result;
+    while (!generation.isEmpty()) {
+        QStringList ids;
+        ids.reserve(generation.size());
+        for (const auto personId: std::as_const(generation)) {
+            ids.append(QString::number(personId));
+        }
+        const auto rows = fetchAll<AncestorEntity>(
+            ANCESTORS_SQL,
+            {
+                {u":people"_s, u"["_s + ids.join(u',') + u"]"_s},
+                {u":level"_s, level},
+                {u":father"_s, BuiltinIds::instance().roleId(EventRoles::Values::Father)},
+                {u":mother"_s, BuiltinIds::instance().roleId(EventRoles::Values::Mother)},
+            }
+        );
+
+        QList<IntegerPrimaryKey> next;
+        for (const auto& row: rows) {
+            auto parentGenerations = remaining.value(row.childId) - 1;
+            if (expanded.contains(row.childId)) {
+                parentGenerations = std::max(parentGenerations, generations);
+            }
+            if (parentGenerations <= 0) {
+                continue;
+            }
+            for (const auto& parentId: {row.fatherId, row.motherId}) {
+                // Everyone is loaded once: this ends cycles, and shared ancestors are not loaded again.
+                if (parentId.has_value() && !known.contains(*parentId)) {
+                    known.insert(*parentId);
+                    remaining.insert(*parentId, parentGenerations);
+                    next.append(*parentId);
+                }
+            }
+        }
+
+        result.append(rows);
+        generation = std::move(next);
+        ++level;
+    }
+    return result;
 }
 
 QList<ParentEntity> FamilyRepository::findParentsForPerson(IntegerPrimaryKey personId) const {
@@ -196,23 +287,10 @@ QList<ParentEntity> FamilyRepository::findParentsForPerson(IntegerPrimaryKey per
 }
 
 std::optional<IntegerPrimaryKey> FamilyRepository::createFamily() {
-    QSqlQuery query;
-    if (!query.exec(u"INSERT INTO families DEFAULT VALUES"_s)) {
-        return std::nullopt;
-    }
-    auto id = query.lastInsertId().toLongLong();
-    DataEventBroker::instance().notifyChanged<Schema::Families>(id);
-    return id;
+    return QueryHelper::insert(u"INSERT INTO families DEFAULT VALUES"_s);
 }
 
 bool FamilyRepository::linkEventToFamily(IntegerPrimaryKey eventId, IntegerPrimaryKey familyId) {
-    QSqlQuery query;
-    query.prepare(u"UPDATE events SET family_id = :fid WHERE id = :eid"_s);
-    query.bindValue(u":fid"_s, familyId);
-    query.bindValue(u":eid"_s, eventId);
-    if (!query.exec()) {
-        return false;
-    }
-    DataEventBroker::instance().notifyChanged<Schema::Events>(eventId);
-    return true;
+    const auto sql = u"UPDATE events SET family_id = :fid WHERE id = :eid"_s;
+    return QueryHelper::execute(sql, {{u":fid"_s, familyId}, {u":eid"_s, eventId}});
 }
@@ -10,6 +10,8 @@
 #include "family_entities.h"
 
 #include <QList>
+#include <QSet>
+#include <limits>
 
 class FamilyRepository : public BaseRepository {
 public:
@@ -17,11 +19,76 @@ public:
 
     [[nodiscard]] QList<FamilyOverviewRow> findAllFamiliesOverview() const;
 
-    [[nodiscard]] QList<AncestorEntity> findAncestorsForPerson(IntegerPrimaryKey personId) const;
+    /**
+     * Like findAllFamiliesOverview(), but runs the query on a worker thread.
+     */
+    [[nodiscard]] QCoro::Task<QList<FamilyOverviewRow>> findAllFamiliesOverviewAsync() const;
+
+    static constexpr int ALL_GENERATIONS = std::numeric_limits<int>::max();
+
+    /**
+     * Find a person and their ancestors, ordered by generation and id.
+     *
+     * The ancestors are loaded one generation at a time, with one query per generation. Everyone is
+     * only included once, at the first (lowest) generation they are found in.
+     *
+     * @param personId The person, who is the first generation.
+     * @param generations The number of generations to load, including the person.
+     * @param expanded People for whom more generations were requested: for them, the given number
+     *                 of generations of their parents is loaded, even if they are in the last one.
+     */
+    [[nodiscard]] QList<AncestorEntity> findAncestorsForPerson(
+        IntegerPrimaryKey personId,
+        int generations = ALL_GENERATIONS,
+        const QSet<IntegerPrimaryKey>& expanded = {}
+    ) const;
+
+    /**
+     * Like findAncestorsForPerson(), but runs the queries on a worker thread.
+     */
+    [[nodiscard]] QCoro::Task<QList<AncestorEntity>> findAncestorsForPersonAsync(
+        IntegerPrimaryKey personId,
+        int generations = ALL_GENERATIONS,
+        QSet<IntegerPrimaryKey> expanded = {}
+    ) const;
+
+    /**
+     * Find people and their ancestors, to load more generations of an ancestor tree.
+     *
+     * @param people The people, who are one generation.
+     * @param level The generation of the people.
+     * @param generations The number of generations to load, including the people.
+     * @param known People that are already loaded. They, and their ancestors, are skipped.
+     */
+    [[nodiscard]] QList<AncestorEntity> findAncestorsOf(
+        const QList<IntegerPrimaryKey>& people,
+        int level,
+        int generations,
+        const QSet<IntegerPrimaryKey>& known
+    ) const;
+
+    /**
+     * Like findAncestorsOf(), but runs the queries on a worker thread.
+     */
+    [[nodiscard]] QCoro::Task<QList<AncestorEntity>> findAncestorsOfAsync(
+        QList<IntegerPrimaryKey> people,
+        int level,
+        int generations,
+        QSet<IntegerPrimaryKey> known
+    ) const;
 
     [[nodiscard]] QList<ParentEntity> findParentsForPerson(IntegerPrimaryKey personId) const;
 
     [[nodiscard]] std::optional<IntegerPrimaryKey> createFamily();
 
     bool linkEventToFamily(IntegerPrimaryKey eventId, IntegerPrimaryKey familyId);
+
+private:
+    [[nodiscard]] QList<AncestorEntity> findAncestors(
+        const QList<IntegerPrimaryKey>& people,
+        int level,
+        int generations,
+        const QSet<IntegerPrimaryKey>& expanded,
+        QSet<IntegerPrimaryKey> known
+    ) const;
 };
@@ -18,6 +18,7 @@ ParentsModel::ParentsModel(IntegerPrimaryKey personId, QObject* parent) : Object
     this->setColumn(DISPLAY_NAME, i18n("Name"), [](const ParentEntity& e) {
         return construct_display_name(e.titles, e.givenNames, e.prefix, e.surname);
     });
+    this->projectColumn(DISPLAY_NAME);
 
     connectToTable<Schema::People>(this);
     connectToTable<Schema::Names>(this);
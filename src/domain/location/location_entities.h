@@ -6,7 +6,9 @@
 #pragma once
 
 #include "core/query_utils.h"
+#include "core/sql_row.h"
 #include "database/schema.h"
+#include "dates/date_columns.h"
 
 #include <QSqlQuery>
 #include <QString>
@@ -17,19 +19,25 @@ struct LocationTypeEntity {
     QString type;
     bool builtin = false;
 
-    static LocationTypeEntity fromSql(const QSqlQuery& query) {
+    using Columns = SqlColumns<u"id", u"type", u"builtin">;
+
+    static LocationTypeEntity fromSql(const Columns::Row& row) {
         using namespace Qt::StringLiterals;
         return {
-            .id = query.value(u"id").toLongLong(),
-            .type = query.value(u"type").toString(),
-            .builtin = query.value(u"builtin").toBool(),
+            .id = row.value<u"id">().toLongLong(),
+            .type = row.value<u"type">().toString(),
+            .builtin = row.value<u"builtin">().toBool(),
         };
     }
+
+    bool operator==(const LocationTypeEntity&) const = default;
 };
 
 struct Coordinates {
     double latitude = 0.0;
     double longitude = 0.0;
+
+    bool operator==(const Coordinates&) const = default;
 };
 
 struct LocationEntity {
@@ -39,28 +47,33 @@ struct LocationEntity {
     std::optional<IntegerPrimaryKey> parentId;
     QString note;
     std::optional<Coordinates> coordinates;
-    QString dateStart;
-    QString dateEnd;
+    GenealogicalDate dateStart;
+    GenealogicalDate dateEnd;
 
-    static LocationEntity fromSql(const QSqlQuery& query) {
+    using Columns = SqlColumns<u"id", u"name", u"type_id", u"parent_id", u"note", u"latitude", u"longitude">::Join<
+        DateColumns<u"start_date">::Columns>::Join<DateColumns<u"end_date">::Columns>;
+
+    static LocationEntity fromSql(const Columns::Row& row) {
         using namespace Qt::StringLiterals;
-        const auto lat = validOrOptional<double>(query.value(u"latitude"));
-        const auto lon = validOrOptional<double>(query.value(u"longitude"));
+        const auto lat = validOrOptional<double>(row.value<u"latitude">());
+        const auto lon = validOrOptional<double>(row.value<u"longitude">());
         std::optional<Coordinates> coords;
         if (lat.has_value() && lon.has_value()) {
             coords = Coordinates{*lat, *lon};
         }
         return {
-            .id = query.value(u"id").toLongLong(),
-            .name = query.value(u"name").toString(),
-            .typeId = validOrOptional<IntegerPrimaryKey>(query.value(u"type_id")),
-            .parentId = validOrOptional<IntegerPrimaryKey>(query.value(u"parent_id")),
-            .note = query.value(u"note").toString(),
+            .id = row.value<u"id">().toLongLong(),
+            .name = row.value<u"name">().toString(),
+            .typeId = validOrOptional<IntegerPrimaryKey>(row.value<u"type_id">()),
+            .parentId = validOrOptional<IntegerPrimaryKey>(row.value<u"parent_id">()),
+            .note = row.value<u"note">().toString(),
             .coordinates = coords,
-            .dateStart = query.value(u"date_start").toString(),
-            .dateEnd = query.value(u"date_end").toString(),
+            .dateStart = DateColumns<u"start_date">::read(row),
+            .dateEnd = DateColumns<u"end_date">::read(row),
         };
     }
+
+    bool operator==(const LocationEntity&) const = default;
 };
 
 // Used in comboboxes — full ancestral path resolved via recursive CTE.
@@ -69,12 +82,14 @@ struct LocationDisplayEntity {
     QString name;
     QString fullPath; // e.g. "Netherlands > Groningen"
 
-    static LocationDisplayEntity fromSql(const QSqlQuery& query) {
+    using Columns = SqlColumns<u"id", u"name", u"full_path">;
+
+    static LocationDisplayEntity fromSql(const Columns::Row& row) {
         using namespace Qt::StringLiterals;
         return {
-            .id = query.value(u"id").toLongLong(),
-            .name = query.value(u"name").toString(),
-            .fullPath = query.value(u"full_path").toString(),
+            .id = row.value<u"id">().toLongLong(),
+            .name = row.value<u"name">().toString(),
+            .fullPath = row.value<u"full_path">().toString(),
         };
     }
 };
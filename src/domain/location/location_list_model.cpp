@@ -21,7 +21,11 @@ LocationListModel::LocationListModel(QObject* parent) : ObjectTableModel(parent)
         return e.parentId.has_value() ? QVariant(*e.parentId) : QVariant{};
     });
 
-    connectToTable<Schema::Locations>(this);
+    this->setRowId(&LocationEntity::id);
+    this->updateRowsOn<Schema::Locations>(
+        [](IntegerPrimaryKey id) { return LocationRepository().findById(id); },
+        [this] { reload(); }
+    );
 
     reload();
 }
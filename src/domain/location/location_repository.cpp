@@ -5,9 +5,8 @@
  */
 #include "location_repository.h"
 
-#include "core/data_event_broker.h"
 #include "core/query_helper.h"
-#include "dates/genealogical_date.h"
+#include "dates/date_columns.h"
 
 using namespace Qt::StringLiterals;
 
@@ -25,30 +24,21 @@ std::optional<LocationTypeEntity> LocationRepository::findLocationTypeById(Integ
 }
 
 std::optional<IntegerPrimaryKey> LocationRepository::insertLocationType(const QString& type) const {
-    auto newId = QueryHelper::insert(
+    return QueryHelper::insert(
         u"INSERT INTO location_types (type, builtin) VALUES (:type, false)"_s,
         {{u":type"_s, type}}
     );
-    if (newId) {
-        DataEventBroker::instance().notifyChanged<Schema::LocationTypes>(newId);
-    }
-    return newId;
 }
 
 bool LocationRepository::updateLocationType(IntegerPrimaryKey id, const QString& type) const {
-    return QueryHelper::executeAndNotify<Schema::LocationTypes>(
-        id,
+    return QueryHelper::execute(
         u"UPDATE location_types SET type = :type WHERE id = :id"_s,
         {{u":type"_s, type}, {u":id"_s, id}}
     );
 }
 
 bool LocationRepository::deleteLocationType(IntegerPrimaryKey id) const {
-    return QueryHelper::executeAndNotify<Schema::LocationTypes>(
-        id,
-        u"DELETE FROM location_types WHERE id = :id"_s,
-        {{u":id"_s, id}}
-    );
+    return QueryHelper::execute(u"DELETE FROM location_types WHERE id = :id"_s, {{u":id"_s, id}});
 }
 
 bool LocationRepository::isLocationTypeUsed(IntegerPrimaryKey id) const {
@@ -59,10 +49,13 @@ bool LocationRepository::isLocationTypeUsed(IntegerPrimaryKey id) const {
 
 // ── Locations ─────────────────────────────────────────────────────────────────
 
+static const auto LOCATION_COLUMNS = u"id, name, type_id, parent_id, note, latitude, longitude, "_s +
+                                     DateColumns<u"start_date">::select(u"locations") + u", "_s +
+                                     DateColumns<u"end_date">::select(u"locations");
+
 QList<LocationEntity> LocationRepository::findAll() const {
     return fetchAll<LocationEntity>(
-        u"SELECT id, name, type_id, parent_id, note, latitude, longitude, date_start, date_end "
-        u"FROM locations ORDER BY name"_s
+        u"SELECT "_s + LOCATION_COLUMNS + u" FROM locations ORDER BY name"_s
     );
 }
 
@@ -78,8 +71,7 @@ QList<LocationDisplayEntity> LocationRepository::findAllWithPaths() const {
 
 std::optional<LocationEntity> LocationRepository::findById(IntegerPrimaryKey id) const {
     return fetchOne<LocationEntity>(
-        u"SELECT id, name, type_id, parent_id, note, latitude, longitude, date_start, date_end "
-        u"FROM locations WHERE id = :id"_s,
+        u"SELECT "_s + LOCATION_COLUMNS + u" FROM locations WHERE id = :id"_s,
         {{u":id"_s, id}}
     );
 }
@@ -89,7 +81,7 @@ std::optional<IntegerPrimaryKey> LocationRepository::insert(
     std::optional<IntegerPrimaryKey> typeId,
     std::optional<IntegerPrimaryKey> parentId
 ) const {
-    auto newId = QueryHelper::insert(
+    return QueryHelper::insert(
         u"INSERT INTO locations (name, type_id, parent_id) VALUES (:name, :type_id, :parent_id)"_s,
         {
             {u":name"_s, name},
@@ -97,10 +89,6 @@ std::optional<IntegerPrimaryKey> LocationRepository::insert(
             {u":parent_id"_s, parentId.has_value() ? QVariant(*parentId) : QVariant{}},
         }
     );
-    if (newId) {
-        DataEventBroker::instance().notifyChanged<Schema::Locations>(newId);
-    }
-    return newId;
 }
 
 bool LocationRepository::update(
@@ -110,39 +98,39 @@ bool LocationRepository::update(
     std::optional<IntegerPrimaryKey> parentId,
     const QString& note,
     std::optional<Coordinates> coordinates,
-    const QString& dateStart,
-    const QString& dateEnd
+    const GenealogicalDate& dateStart,
+    const GenealogicalDate& dateEnd
 ) const {
-    const auto parsedStart = GenealogicalDate::fromDatabaseRepresentation(dateStart);
-    const auto parsedEnd = GenealogicalDate::fromDatabaseRepresentation(dateEnd);
-    return QueryHelper::executeAndNotify<Schema::Locations>(
-        id,
+    QVariantMap bindings = {
+        {u":name"_s, name},
+        {u":type_id"_s, typeId.has_value() ? QVariant(*typeId) : QVariant{}},
+        {u":parent_id"_s, parentId.has_value() ? QVariant(*parentId) : QVariant{}},
+        {u":note"_s, note},
+        {u":latitude"_s, coordinates.has_value() ? QVariant(coordinates->latitude) : QVariant{}},
+        {u":longitude"_s, coordinates.has_value() ? QVariant(coordinates->longitude) : QVariant{}},
+        {u":id"_s, id},
+    };
+    DateColumns<u"start_date">::bind(bindings, dateStart);
+    DateColumns<u"end_date">::bind(bindings, dateEnd);
+    return QueryHelper::execute(
         u"UPDATE locations SET name = :name, type_id = :type_id, parent_id = :parent_id, "
         u"note = :note, latitude = :latitude, longitude = :longitude, "
-        u"date_start = :date_start, date_start_sort = :date_start_sort, "
-        u"date_end = :date_end, date_end_sort = :date_end_sort WHERE id = :id"_s,
-        {
-            {u":name"_s, name},
-            {u":type_id"_s, typeId.has_value() ? QVariant(*typeId) : QVariant{}},
-            {u":parent_id"_s, parentId.has_value() ? QVariant(*parentId) : QVariant{}},
-            {u":note"_s, note},
-            {u":latitude"_s, coordinates.has_value() ? QVariant(coordinates->latitude) : QVariant{}},
-            {u":longitude"_s, coordinates.has_value() ? QVariant(coordinates->longitude) : QVariant{}},
-            {u":date_start"_s, dateStart},
-            {u":date_start_sort"_s, parsedStart.isNull() ? QVariant{} : QVariant{parsedStart.sortKey()}},
-            {u":date_end"_s, dateEnd},
-            {u":date_end_sort"_s, parsedEnd.isNull() ? QVariant{} : QVariant{parsedEnd.sortKey()}},
-            {u":id"_s, id},
-        }
+        u"start_date_type = :start_date_type, start_date_modifier = :start_date_modifier, "
+        u"start_date_quality = :start_date_quality, start_date_precision = :start_date_precision, "
+        u"start_date_sort = :start_date_sort, start_date_first_day = :start_date_first_day, "
+        u"start_date_last_day = :start_date_last_day, start_date_time = :start_date_time, "
+        u"start_date_end_time = :start_date_end_time, start_date_text = :start_date_text, "
+        u"end_date_type = :end_date_type, end_date_modifier = :end_date_modifier, "
+        u"end_date_quality = :end_date_quality, end_date_precision = :end_date_precision, "
+        u"end_date_sort = :end_date_sort, end_date_first_day = :end_date_first_day, "
+        u"end_date_last_day = :end_date_last_day, end_date_time = :end_date_time, "
+        u"end_date_end_time = :end_date_end_time, end_date_text = :end_date_text WHERE id = :id"_s,
+        bindings
     );
 }
 
 bool LocationRepository::deleteLocation(IntegerPrimaryKey id) const {
-    return QueryHelper::executeAndNotify<Schema::Locations>(
-        id,
-        u"DELETE FROM locations WHERE id = :id"_s,
-        {{u":id"_s, id}}
-    );
+    return QueryHelper::execute(u"DELETE FROM locations WHERE id = :id"_s, {{u":id"_s, id}});
 }
 
 bool LocationRepository::isUsed(IntegerPrimaryKey id) const {
@@ -167,14 +155,12 @@ std::optional<IntegerPrimaryKey> LocationRepository::findOrCreate(
     std::optional<LocationEntity> existing;
     if (parentId.has_value()) {
         existing = fetchOne<LocationEntity>(
-            u"SELECT id, name, type_id, parent_id, note, latitude, longitude, date_start, date_end "
-            u"FROM locations WHERE name = :name AND parent_id = :parent_id"_s,
+            u"SELECT "_s + LOCATION_COLUMNS + u" FROM locations WHERE name = :name AND parent_id = :parent_id"_s,
             {{u":name"_s, name}, {u":parent_id"_s, *parentId}}
         );
     } else {
         existing = fetchOne<LocationEntity>(
-            u"SELECT id, name, type_id, parent_id, note, latitude, longitude, date_start, date_end "
-            u"FROM locations WHERE name = :name AND parent_id IS NULL"_s,
+            u"SELECT "_s + LOCATION_COLUMNS + u" FROM locations WHERE name = :name AND parent_id IS NULL"_s,
             {{u":name"_s, name}}
         );
     }
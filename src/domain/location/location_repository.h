@@ -38,8 +38,8 @@ public:
         std::optional<IntegerPrimaryKey> parentId,
         const QString& note,
         std::optional<Coordinates> coordinates,
-        const QString& dateStart,
-        const QString& dateEnd
+        const GenealogicalDate& dateStart,
+        const GenealogicalDate& dateEnd
     ) const;
     bool deleteLocation(IntegerPrimaryKey id) const;
     [[nodiscard]] bool isUsed(IntegerPrimaryKey id) const;
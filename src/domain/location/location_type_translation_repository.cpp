@@ -5,7 +5,6 @@
  */
 #include "location_type_translation_repository.h"
 
-#include "core/data_event_broker.h"
 #include "core/query_helper.h"
 
 using namespace Qt::StringLiterals;
@@ -19,22 +18,14 @@ QList<LocationTypeTranslationEntity> LocationTypeTranslationRepository::findAllF
 
 std::optional<IntegerPrimaryKey>
 LocationTypeTranslationRepository::insert(IntegerPrimaryKey typeId, const QString& locale, const QString& name) const {
-    auto newId = QueryHelper::insert(
+    return QueryHelper::insert(
         u"INSERT INTO location_type_translations (type_id, locale, name) VALUES (:type_id, :locale, :name)"_s,
         {{u":type_id"_s, typeId}, {u":locale"_s, locale}, {u":name"_s, name}}
     );
-    if (newId) {
-        DataEventBroker::instance().notifyChanged<Schema::LocationTypeTranslations>(newId);
-    }
-    return newId;
 }
 
 bool LocationTypeTranslationRepository::remove(IntegerPrimaryKey id) const {
-    return QueryHelper::executeAndNotify<Schema::LocationTypeTranslations>(
-        id,
-        u"DELETE FROM location_type_translations WHERE id = :id"_s,
-        {{u":id"_s, id}}
-    );
+    return QueryHelper::execute(u"DELETE FROM location_type_translations WHERE id = :id"_s, {{u":id"_s, id}});
 }
 
 std::optional<QString>
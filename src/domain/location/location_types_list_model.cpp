@@ -28,7 +28,11 @@ LocationTypesListModel::LocationTypesListModel(QObject* parent) : ObjectTableMod
     );
     this->setColumn(BUILTIN, i18n("Built-in"), &LocationTypeEntity::builtin);
 
-    connectToTable<Schema::LocationTypes>(this);
+    this->setRowId(&LocationTypeEntity::id);
+    this->updateRowsOn<Schema::LocationTypes>(
+        [](IntegerPrimaryKey id) { return LocationRepository().findLocationTypeById(id); },
+        [this] { reload(); }
+    );
 
     reload();
 }
@@ -5,6 +5,7 @@
  */
 #pragma once
 
+#include "core/sql_row.h"
 #include "database/schema.h"
 
 #include <QSqlQuery>
@@ -20,15 +21,19 @@ struct MediaEntity {
     std::optional<QString> note;
     QString mimeType;
 
-    static MediaEntity fromSql(const QSqlQuery& query) {
-        auto title = query.value(u"title");
-        auto note = query.value(u"note");
+    using Columns = SqlColumns<u"id", u"path", u"title", u"note", u"mime_type">;
+
+    static MediaEntity fromSql(const Columns::Row& row) {
+        auto title = row.value<u"title">();
+        auto note = row.value<u"note">();
         return {
-            .id = query.value(u"id").toLongLong(),
-            .path = query.value(u"path").toString(),
+            .id = row.value<u"id">().toLongLong(),
+            .path = row.value<u"path">().toString(),
             .title = title.isNull() ? std::nullopt : std::make_optional(title.toString()),
             .note = note.isNull() ? std::nullopt : std::make_optional(note.toString()),
-            .mimeType = query.value(u"mime_type").toString(),
+            .mimeType = row.value<u"mime_type">().toString(),
         };
     }
+
+    bool operator==(const MediaEntity&) const = default;
 };
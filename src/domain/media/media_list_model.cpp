@@ -20,7 +20,11 @@ MediaListModel::MediaListModel(QObject* parent) : ObjectTableModel(parent) {
     });
     this->setColumn(PATH, i18n("File"), &MediaEntity::path);
     this->setColumn(MIME_TYPE, i18n("Type"), &MediaEntity::mimeType);
-    connectToTable<Schema::Media>(this);
+    this->setRowId(&MediaEntity::id);
+    this->updateRowsOn<Schema::Media>(
+        [](IntegerPrimaryKey id) { return MediaRepository().findById(id); },
+        [this] { reload(); }
+    );
     reload();
 }
 
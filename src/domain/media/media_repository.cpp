@@ -5,7 +5,6 @@
  */
 #include "media_repository.h"
 
-#include "../../core/data_event_broker.h"
 #include "../../core/query_helper.h"
 
 #include <optional>
@@ -29,7 +28,7 @@ std::optional<IntegerPrimaryKey> MediaRepository::insert(
     const QString& mimeType
 ) const {
     const auto sql = u"INSERT INTO media (path, title, note, mime_type) VALUES (:path, :title, :note, :mime_type)"_s;
-    const auto newId = QueryHelper::insert(
+    return QueryHelper::insert(
         sql,
         {
             {u":path"_s, path},
@@ -38,10 +37,6 @@ std::optional<IntegerPrimaryKey> MediaRepository::insert(
             {u":mime_type"_s, mimeType},
         }
     );
-    if (newId) {
-        DataEventBroker::instance().notifyChanged<Schema::Media>(newId);
-    }
-    return newId;
 }
 
 bool MediaRepository::update(
@@ -49,8 +44,7 @@ bool MediaRepository::update(
     const std::optional<QString>& title,
     const std::optional<QString>& note
 ) const {
-    return QueryHelper::executeAndNotify<Schema::Media>(
-        id,
+    return QueryHelper::execute(
         u"UPDATE media SET title = :title, note = :note WHERE id = :id"_s,
         {{u":title"_s, title ? QVariant(*title) : QVariant{}},
          {u":note"_s, note ? QVariant(*note) : QVariant{}},
@@ -59,7 +53,7 @@ bool MediaRepository::update(
 }
 
 bool MediaRepository::remove(IntegerPrimaryKey id) const {
-    return QueryHelper::executeAndNotify<Schema::Media>(id, u"DELETE FROM media WHERE id = :id"_s, {{u":id"_s, id}});
+    return QueryHelper::execute(u"DELETE FROM media WHERE id = :id"_s, {{u":id"_s, id}});
 }
 
 // --- Person ---
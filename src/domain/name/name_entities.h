@@ -6,6 +6,7 @@
 #pragma once
 
 #include "../../core/query_utils.h"
+#include "core/sql_row.h"
 #include "database/schema.h"
 
 #include <QSqlQuery>
@@ -25,17 +26,28 @@ struct NameEntity {
     QString note;
     std::optional<IntegerPrimaryKey> originId;
 
-    static NameEntity fromSql(const QSqlQuery& query) {
+    using Columns = SqlColumns<
+        u"id",
+        u"person_id",
+        u"sort",
+        u"titles",
+        u"given_names",
+        u"prefix",
+        u"surname",
+        u"note",
+        u"origin_id">;
+
+    static NameEntity fromSql(const Columns::Row& row) {
         return {
-            .id = query.value(u"id").toLongLong(),
-            .personId = query.value(u"person_id").toLongLong(),
-            .sort = query.value(u"sort").toInt(),
-            .titles = query.value(u"titles").toString(),
-            .givenNames = query.value(u"given_names").toString(),
-            .prefix = query.value(u"prefix").toString(),
-            .surname = query.value(u"surname").toString(),
-            .note = query.value(u"note").toString(),
-            .originId = validOrOptional<IntegerPrimaryKey>(query.value(u"origin_id")),
+            .id = row.value<u"id">().toLongLong(),
+            .personId = row.value<u"person_id">().toLongLong(),
+            .sort = row.value<u"sort">().toInt(),
+            .titles = row.value<u"titles">().toString(),
+            .givenNames = row.value<u"given_names">().toString(),
+            .prefix = row.value<u"prefix">().toString(),
+            .surname = row.value<u"surname">().toString(),
+            .note = row.value<u"note">().toString(),
+            .originId = validOrOptional<IntegerPrimaryKey>(row.value<u"origin_id">()),
         };
     }
 };
@@ -43,13 +55,15 @@ struct NameEntity {
 struct NameWithOriginEntity : NameEntity {
     QString origin;
 
-    static NameWithOriginEntity fromSql(const QSqlQuery& query) {
+    using Columns = NameEntity::Columns::With<u"origin">;
+
+    static NameWithOriginEntity fromSql(const Columns::Row& row) {
         NameWithOriginEntity n;
 
         // C++ here we go
-        static_cast<NameEntity&>(n) = NameEntity::fromSql(query);
+        static_cast<NameEntity&>(n) = NameEntity::fromSql(row.select<NameEntity::Columns>());
 
-        n.origin = query.value(u"origin").toString();
+        n.origin = row.value<u"origin">().toString();
 
         return n;
     }
@@ -60,11 +74,13 @@ struct NameOriginEntity {
     QString origin;
     bool builtin = false;
 
-    static NameOriginEntity fromSql(const QSqlQuery& query) {
+    using Columns = SqlColumns<u"id", u"origin", u"builtin">;
+
+    static NameOriginEntity fromSql(const Columns::Row& row) {
         return {
-            .id = query.value(u"id").toLongLong(),
-            .origin = query.value(u"origin").toString(),
-            .builtin = query.value(u"builtin").toBool(),
+            .id = row.value<u"id">().toLongLong(),
+            .origin = row.value<u"origin">().toString(),
+            .builtin = row.value<u"builtin">().toBool(),
         };
     }
 };
@@ -5,6 +5,7 @@
  */
 #pragma once
 
+#include "core/sql_row.h"
 #include "database/schema.h"
 
 #include <QSqlQuery>
@@ -16,13 +17,15 @@ struct NameOriginTranslationEntity {
     QString locale;
     QString name;
 
-    static NameOriginTranslationEntity fromSql(const QSqlQuery& query) {
+    using Columns = SqlColumns<u"id", u"origin_id", u"locale", u"name">;
+
+    static NameOriginTranslationEntity fromSql(const Columns::Row& row) {
         using namespace Qt::StringLiterals;
         return {
-            .id = query.value(u"id").toLongLong(),
-            .originId = query.value(u"origin_id").toLongLong(),
-            .locale = query.value(u"locale").toString(),
-            .name = query.value(u"name").toString(),
+            .id = row.value<u"id">().toLongLong(),
+            .originId = row.value<u"origin_id">().toLongLong(),
+            .locale = row.value<u"locale">().toString(),
+            .name = row.value<u"name">().toString(),
         };
     }
 };
@@ -5,7 +5,6 @@
  */
 #include "name_origin_translation_repository.h"
 
-#include "core/data_event_broker.h"
 #include "core/query_helper.h"
 
 using namespace Qt::StringLiterals;
@@ -19,22 +18,14 @@ QList<NameOriginTranslationEntity> NameOriginTranslationRepository::findAllForTy
 
 std::optional<IntegerPrimaryKey>
 NameOriginTranslationRepository::insert(IntegerPrimaryKey originId, const QString& locale, const QString& name) const {
-    auto newId = QueryHelper::insert(
+    return QueryHelper::insert(
         u"INSERT INTO name_origin_translations (origin_id, locale, name) VALUES (:origin_id, :locale, :name)"_s,
         {{u":origin_id"_s, originId}, {u":locale"_s, locale}, {u":name"_s, name}}
     );
-    if (newId) {
-        DataEventBroker::instance().notifyChanged<Schema::NameOriginTranslations>(newId);
-    }
-    return newId;
 }
 
 bool NameOriginTranslationRepository::remove(IntegerPrimaryKey id) const {
-    return QueryHelper::executeAndNotify<Schema::NameOriginTranslations>(
-        id,
-        u"DELETE FROM name_origin_translations WHERE id = :id"_s,
-        {{u":id"_s, id}}
-    );
+    return QueryHelper::execute(u"DELETE FROM name_origin_translations WHERE id = :id"_s, {{u":id"_s, id}});
 }
 
 std::optional<QString>
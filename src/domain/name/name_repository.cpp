@@ -5,7 +5,6 @@
  */
 #include "./name_repository.h"
 
-#include "../../core/data_event_broker.h"
 #include "names.h"
 
 using namespace Qt::StringLiterals;
@@ -83,12 +82,7 @@ std::optional<IntegerPrimaryKey> NameRepository::insertName(IntegerPrimaryKey pe
         {u":person_id"_s, personId},
         {u":sort"_s, sort},
     };
-    const auto newId = QueryHelper::insert(sql, bindings);
-    if (newId) {
-        DataEventBroker::instance().notifyChanged<Schema::Names>(newId);
-    }
-
-    return newId;
+    return QueryHelper::insert(sql, bindings);
 }
 
 bool NameRepository::updateName(
@@ -119,7 +113,7 @@ bool NameRepository::updateName(
         bindings[u":origin_id"_s] = QVariant(QMetaType::fromType<IntegerPrimaryKey>());
     }
 
-    return QueryHelper::executeAndNotify<Schema::Names>(id, sql, bindings);
+    return QueryHelper::execute(sql, bindings);
 }
 
 bool NameRepository::updateNameSort(IntegerPrimaryKey id, int sort) const {
@@ -128,10 +122,10 @@ bool NameRepository::updateNameSort(IntegerPrimaryKey id, int sort) const {
         {u":sort"_s, sort},
         {u":id"_s, id},
     };
-    return QueryHelper::executeAndNotify<Schema::Names>(id, sql, bindings);
+    return QueryHelper::execute(sql, bindings);
 }
 
 bool NameRepository::deleteName(IntegerPrimaryKey id) const {
     const auto sql = u"DELETE FROM names WHERE id = :id"_s;
-    return QueryHelper::executeAndNotify<Schema::Names>(id, sql, {{u":id"_s, id}});
+    return QueryHelper::execute(sql, {{u":id"_s, id}});
 }
@@ -14,6 +14,8 @@
  * Create a single display name from the different name parts.
  *
  * Any of the parts can be empty.
+ *
+ * The person_primary_name table has the same display name, built in SQL; keep them the same.
  */
 QString
 construct_display_name(const QString& titles, const QString& givenNames, const QString& prefix, const QString& surname);
@@ -0,0 +1,239 @@
+/*
+ * SPDX-FileCopyrightText: Niko Strijbol <niko@strijbol.be>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+#include "paged_person_model.h"
+
+#include "core/data_event_broker.h"
+#include "database/schema.h"
+
+#include <KLocalizedString>
+#include <QTimer>
+#include <algorithm>
+
+using namespace Qt::StringLiterals;
+
+PagedPersonModel::PagedPersonModel(QObject* parent) : QAbstractTableModel(parent) {
+    criteria.sortColumn = PersonRepository::SORT_BY_NAME;
+
+    connectToTable<Schema::People>(this, [this] { scheduleReload(); });
+    connectToTable<Schema::Names>(this, [this] { scheduleReload(); });
+
+    count();
+}
+
+int PagedPersonModel::rowCount(const QModelIndex& parent) const {
+    if (parent.isValid()) {
+        return 0;
+    }
+    return static_cast<int>(total);
+}
+
+int PagedPersonModel::columnCount(const QModelIndex& parent) const {
+    if (parent.isValid()) {
+        return 0;
+    }
+    return 3; // ID, NAME, ROOT
+}
+
+QVariant PagedPersonModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || (role != Qt::DisplayRole && role != Qt::EditRole)) {
+        return {};
+    }
+    const auto* person = row(index.row());
+    if (person == nullptr) {
+        return {};
+    }
+    switch (index.column()) {
+        case ID:
+            return person->id;
+        case NAME:
+            return person->displayName;
+        case ROOT:
+            return person->root;
+        default:
+            return {};
+    }
+}
+
+QVariant PagedPersonModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (role != Qt::DisplayRole || orientation != Qt::Horizontal) {
+        return {};
+    }
+    switch (section) {
+        case ID:
+            return i18n("ID");
+        case NAME:
+            return i18n("Name");
+        case ROOT:
+            return i18n("Root");
+        default:
+            return {};
+    }
+}
+
+void PagedPersonModel::sort(int column, Qt::SortOrder order) {
+    QString sortColumn;
+    if (column == ID) {
+        sortColumn = PersonRepository::SORT_BY_ID;
+    } else if (column == NAME) {
+        sortColumn = PersonRepository::SORT_BY_NAME;
+    } else {
+        return;
+    }
+    if (sortColumn == criteria.sortColumn && order == criteria.sortOrder) {
+        return;
+    }
+    criteria.sortColumn = sortColumn;
+    criteria.sortOrder = order;
+    reload();
+}
+
+qsizetype PagedPersonModel::loadedPages() const {
+    return pages.size();
+}
+
+void PagedPersonModel::setFilterText(const QString& text) {
+    if (text == criteria.filterText) {
+        return;
+    }
+    criteria.filterText = text;
+    reload();
+}
+
+void PagedPersonModel::reload() {
+    reloadPending = false;
+    beginResetModel();
+    count();
+    endResetModel();
+}
+
+void PagedPersonModel::scheduleReload() {
+    // A change often comes with others, e.g. a person with their name.
+    if (reloadPending) {
+        return;
+    }
+    reloadPending = true;
+    QTimer::singleShot(0, this, [this] {
+        if (reloadPending) {
+            reload();
+        }
+    });
+}
+
+void PagedPersonModel::count() {
+    pages.clear();
+    seekKeys.clear();
+    PersonRepository repository;
+    total = repository.countNamedPeople(criteria);
+    unnamed.clear();
+    if (criteria.filterText.isEmpty()) {
+        const auto everyone = repository.countPeople();
+        if (everyone > total) {
+            unnamed = repository.findUnnamedPersonIds();
+            if (criteria.sortOrder == Qt::DescendingOrder) {
+                std::ranges::reverse(unnamed);
+            }
+            total += unnamed.size();
+        }
+    }
+}
+
+const PersonDisplayEntity* PagedPersonModel::row(int row) const {
+    if (row < 0 || row >= total) {
+        return nullptr;
+    }
+    const auto number = row / PAGE_SIZE;
+    const auto offset = row % PAGE_SIZE;
+    // Prefetch the next page, so scrolling down does not wait for the database.
+    if (offset >= PAGE_SIZE * 3 / 4 && (number + 1) * PAGE_SIZE < total) {
+        page(number + 1);
+    }
+    const auto& rows = page(number).rows;
+    // A person can be deleted between counting and loading the page.
+    return offset < rows.size() ? &rows[offset] : nullptr;
+}
+
+const PagedPersonModel::Page& PagedPersonModel::page(qsizetype number) const {
+    if (auto existing = pages.find(number); existing != pages.end()) {
+        existing->lastUsed = ++useCounter;
+        return *existing;
+    }
+
+    if (pages.size() >= MAX_PAGES) {
+        auto oldest = pages.begin();
+        for (auto candidate = pages.begin(); candidate != pages.end(); ++candidate) {
+            if (candidate->lastUsed < oldest->lastUsed) {
+                oldest = candidate;
+            }
+        }
+        pages.erase(oldest);
+    }
+    const auto ids = pageIds(number);
+    return *pages.insert(number, {PersonRepository().findDisplayByIds(ids), ++useCounter});
+}
+
+QList<IntegerPrimaryKey> PagedPersonModel::pageIds(qsizetype number) const {
+    const auto first = number * PAGE_SIZE;
+    const auto last = std::min(first + PAGE_SIZE, total);
+
+    // By id, the people without a name are among the others; see the class documentation.
+    const auto byId = criteria.sortColumn == PersonRepository::SORT_BY_ID;
+    if (byId && !unnamed.isEmpty()) {
+        QList<IntegerPrimaryKey> result;
+        PersonCriteria everyone;
+        everyone.sortColumn = u"id"_s;
+        everyone.sortOrder = criteria.sortOrder;
+        everyone.limit = static_cast<int>(last - first);
+        seek(everyone, first);
+        for (const auto& person: PersonRepository().findPeople(everyone)) {
+            result.append(person.id);
+        }
+        if (!result.isEmpty()) {
+            seekKeys.insert(first + result.size(), {.sortKey = {}, .id = result.last()});
+        }
+        return result;
+    }
+
+    // The people without a name come first by name, so last in descending order.
+    const auto unnamedCount = byId ? 0 : unnamed.size();
+    const auto unnamedFirst = criteria.sortOrder == Qt::AscendingOrder ? 0 : total - unnamedCount;
+    QList<IntegerPrimaryKey> result;
+    result.reserve(last - first);
+    auto position = first;
+    while (position < last) {
+        if (position >= unnamedFirst && position < unnamedFirst + unnamedCount) {
+            const auto end = std::min(last, unnamedFirst + unnamedCount);
+            result.append(unnamed.mid(position - unnamedFirst, end - position));
+            position = end;
+        } else {
+            const auto namedOffset = position < unnamedFirst ? position : position - unnamedCount;
+            const auto end = position < unnamedFirst ? std::min(last, unnamedFirst) : last;
+            PersonCriteria named = criteria;
+            named.limit = static_cast<int>(end - position);
+            seek(named, namedOffset);
+            const auto keys = PersonRepository().findNamedPersonKeys(named);
+            for (const auto& key: keys) {
+                result.append(key.id);
+            }
+            if (!keys.isEmpty()) {
+                seekKeys.insert(namedOffset + keys.size(), keys.last());
+            }
+            position = end;
+        }
+    }
+    return result;
+}
+
+void PagedPersonModel::seek(PersonCriteria& page, qsizetype position) const {
+    // Normally this is the end of the page before, unless the view jumped ahead.
+    auto known = seekKeys.upperBound(position);
+    if (known == seekKeys.begin()) {
+        page.offset = static_cast<int>(position);
+        return;
+    }
+    --known;
+    page.after = known.value();
+    page.offset = static_cast<int>(position - known.key());
+}
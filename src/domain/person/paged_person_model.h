@@ -0,0 +1,91 @@
+/*
+ * SPDX-FileCopyrightText: Niko Strijbol <niko@strijbol.be>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+#pragma once
+
+#include "person_entities.h"
+#include "person_repository.h"
+
+#include <QAbstractTableModel>
+#include <QHash>
+#include <QList>
+#include <QMap>
+
+/**
+ * All people, with the same columns as PersonDisplayModel, for trees too large to load at once.
+ *
+ * Only the number of people is loaded up front. The rows are loaded in pages when a view asks
+ * for them, and only the most recently used pages are kept, so the memory does not grow with the
+ * size of the database. Sorting and filtering happen in the database instead of in a proxy.
+ * A page is found by seeking from the last person of the page before it (keyset paging), so
+ * scrolling down does not make the database skip more and more rows.
+ *
+ * By name, people without a name come before the others. A filter only matches people with a name.
+ */
+class PagedPersonModel : public QAbstractTableModel {
+    Q_OBJECT
+
+public:
+    enum Columns { ID = 0, NAME, ROOT };
+    Q_ENUM(Columns);
+
+    static constexpr qsizetype PAGE_SIZE = 256;
+    static constexpr qsizetype MAX_PAGES = 16;
+
+    explicit PagedPersonModel(QObject* parent = nullptr);
+
+    [[nodiscard]] int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    [[nodiscard]] int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    [[nodiscard]] QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    [[nodiscard]] QVariant
+    headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    /**
+     * Sort on the ID or NAME column; other columns cannot be sorted on.
+     */
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+    /**
+     * @return The number of pages that are loaded now.
+     */
+    [[nodiscard]] qsizetype loadedPages() const;
+
+public Q_SLOTS:
+    /**
+     * Only show people whose name contains the text.
+     */
+    void setFilterText(const QString& text);
+
+    /**
+     * Count the people again and forget the loaded pages.
+     */
+    void reload();
+
+private:
+    struct Page {
+        QList<PersonDisplayEntity> rows;
+        quint64 lastUsed = 0;
+    };
+
+    PersonCriteria criteria;
+    qsizetype total = 0;
+    // The people without a name, which are not in the primary name table. Only without a filter.
+    QList<IntegerPrimaryKey> unnamed;
+    mutable QHash<qsizetype, Page> pages;
+    // The last person before a position in the queried list of people, for each loaded page.
+    mutable QMap<qsizetype, PersonSortKey> seekKeys;
+    mutable quint64 useCounter = 0;
+    bool reloadPending = false;
+
+    [[nodiscard]] const PersonDisplayEntity* row(int row) const;
+    const Page& page(qsizetype number) const;
+    [[nodiscard]] QList<IntegerPrimaryKey> pageIds(qsizetype number) const;
+    /**
+     * Start the query at the position, after the closest known person before it.
+     */
+    void seek(PersonCriteria& page, qsizetype position) const;
+    void count();
+    void scheduleReload();
+};
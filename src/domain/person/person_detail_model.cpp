@@ -5,7 +5,6 @@
  */
 #include "person_detail_model.h"
 
-#include "../name/names.h"
 #include "core/data_event_broker.h"
 #include "database/schema.h"
 #include "person_repository.h"
@@ -22,9 +21,7 @@ PersonDetailModel::PersonDetailModel(IntegerPrimaryKey personId, QObject* parent
     this->setColumn(SURNAME, i18n("Surname"), &PersonDisplayEntity::surname);
     this->setColumn(ROOT, i18n("Root"), &PersonDisplayEntity::root);
     this->setColumn(SEX, i18n("Sex"), &PersonDisplayEntity::sex);
-    this->setColumn(DISPLAY_NAME, i18n("Name"), [](const PersonDisplayEntity& p) {
-        return construct_display_name(p.titles, p.givenNames, p.prefix, p.surname);
-    });
+    this->setColumn(DISPLAY_NAME, i18n("Name"), &PersonDisplayEntity::displayName);
 
     connectToTable<Schema::People>(this, this->personId);
     connectToTable<Schema::Names>(this, this->personId);
@@ -5,7 +5,6 @@
  */
 #include "person_display_model.h"
 
-#include "../name/names.h"
 #include "core/data_event_broker.h"
 #include "database/schema.h"
 #include "person_repository.h"
@@ -15,18 +14,19 @@
 PersonDisplayModel::PersonDisplayModel(QObject* parent) : ObjectTableModel(parent) {
 
     this->setColumn(ID, i18n("ID"), &PersonDisplayEntity::id);
-    this->setColumn(NAME, i18n("Name"), [](const PersonDisplayEntity& p) {
-        return construct_display_name(p.titles, p.givenNames, p.prefix, p.surname);
-    });
+    this->setColumn(NAME, i18n("Name"), &PersonDisplayEntity::displayName);
     this->setColumn(ROOT, i18n("Root"), &PersonDisplayEntity::root);
 
-    connectToTable<Schema::People>(this);
+    this->setRowId(&PersonDisplayEntity::id);
+    this->updateRowsOn<Schema::People>(
+        [](IntegerPrimaryKey id) { return PersonRepository().findDisplayById(id); },
+        [this] { reload(); }
+    );
     connectToTable<Schema::Names>(this);
 
     reload();
 }
 
 void PersonDisplayModel::reload() {
-    PersonRepository repo;
-    this->setItems(repo.findPeopleWithPrimaryName());
+    this->setItemsAsync(PersonRepository().findPeopleWithPrimaryNameAsync());
 }
@@ -5,6 +5,7 @@
  */
 #pragma once
 
+#include "core/sql_row.h"
 #include "database/schema.h"
 
 #include <QSqlQuery>
@@ -17,13 +18,17 @@ struct PersonEntity {
     bool root = false;
     QString sex;
 
-    static PersonEntity fromSql(const QSqlQuery& query) {
+    using Columns = SqlColumns<u"id", u"root", u"sex">;
+
+    static PersonEntity fromSql(const Columns::Row& row) {
         return {
-            .id = query.value(u"id"_s).toLongLong(),
-            .root = query.value(u"root"_s).toBool(),
-            .sex = query.value(u"sex"_s).toString()
+            .id = row.value<u"id">().toLongLong(),
+            .root = row.value<u"root">().toBool(),
+            .sex = row.value<u"sex">().toString()
         };
     }
+
+    bool operator==(const PersonEntity&) const = default;
 };
 
 struct PersonDisplayEntity : PersonEntity {
@@ -31,17 +36,24 @@ struct PersonDisplayEntity : PersonEntity {
     QString givenNames;
     QString prefix;
     QString surname;
+    // The primary name as one string, see construct_display_name.
+    QString displayName;
 
-    static PersonDisplayEntity fromSql(const QSqlQuery& query) {
+    using Columns = PersonEntity::Columns::With<u"titles", u"given_names", u"prefix", u"surname", u"display_name">;
+
+    static PersonDisplayEntity fromSql(const Columns::Row& row) {
         PersonDisplayEntity p;
 
-        static_cast<PersonEntity&>(p) = PersonEntity::fromSql(query);
+        static_cast<PersonEntity&>(p) = PersonEntity::fromSql(row.select<PersonEntity::Columns>());
 
-        p.titles = query.value(u"titles"_s).toString();
-        p.givenNames = query.value(u"given_names"_s).toString();
-        p.prefix = query.value(u"prefix"_s).toString();
-        p.surname = query.value(u"surname"_s).toString();
+        p.titles = row.value<u"titles">().toString();
+        p.givenNames = row.value<u"given_names">().toString();
+        p.prefix = row.value<u"prefix">().toString();
+        p.surname = row.value<u"surname">().toString();
+        p.displayName = row.value<u"display_name">().toString();
 
         return p;
     }
+
+    bool operator==(const PersonDisplayEntity&) const = default;
 };
@@ -10,10 +10,10 @@
 using namespace Qt::StringLiterals;
 
 static const auto PRIMARY_NAME_JOIN = QStringLiteral(
-    "SELECT p.id, p.root, p.sex, n.titles, n.given_names, n.prefix, n.surname "
+    "SELECT p.id, p.root, p.sex, n.titles, n.given_names, n.prefix, n.surname, primary_name.display_name "
     "FROM people p "
-    "LEFT JOIN names n ON p.id = n.person_id "
-    "AND n.sort = (SELECT MIN(n2.sort) FROM names n2 WHERE n2.person_id = p.id)"
+    "LEFT JOIN person_primary_name primary_name ON primary_name.person_id = p.id "
+    "LEFT JOIN names n ON n.id = primary_name.name_id"
 );
 
 QList<PersonEntity> PersonRepository::findPeople(const PersonCriteria& criteria) const {
@@ -28,6 +28,11 @@ QList<PersonEntity> PersonRepository::findPeople(const PersonCriteria& criteria)
         builder.where(u"sex = :sex"_s);
         builder.bind(u":sex"_s, criteria.sex.value());
     }
+    if (criteria.after.has_value()) {
+        Q_ASSERT(criteria.sortColumn == u"id"_s);
+        builder.where(criteria.sortOrder == Qt::AscendingOrder ? u"id > :after_id"_s : u"id < :after_id"_s);
+        builder.bind(u":after_id"_s, criteria.after->id);
+    }
 
     builder.applyCriteria(criteria);
 
@@ -40,7 +45,7 @@ std::optional<PersonEntity> PersonRepository::findById(IntegerPrimaryKey id) con
     return fetchOne<PersonEntity>(sql, {{u":id"_s, id}});
 }
 
-QList<PersonDisplayEntity> PersonRepository::findPeopleWithPrimaryName(const PersonCriteria& criteria) const {
+static QueryHelper::SqlQueryBuilder primaryNameQuery(const PersonCriteria& criteria) {
     QueryHelper::SqlQueryBuilder builder{PRIMARY_NAME_JOIN};
 
     if (criteria.rootOnly.has_value() && *criteria.rootOnly) {
@@ -52,27 +57,138 @@ QList<PersonDisplayEntity> PersonRepository::findPeopleWithPrimaryName(const Per
     }
 
     builder.applyCriteria(criteria);
+    return builder;
+}
 
-    auto [sql, bindings] = builder.construct();
+QList<PersonDisplayEntity> PersonRepository::findPeopleWithPrimaryName(const PersonCriteria& criteria) const {
+    auto [sql, bindings] = primaryNameQuery(criteria).construct();
     return fetchAll<PersonDisplayEntity>(sql, bindings);
 }
 
+QCoro::Task<QList<PersonDisplayEntity>>
+PersonRepository::findPeopleWithPrimaryNameAsync(const PersonCriteria& criteria) const {
+    auto [sql, bindings] = primaryNameQuery(criteria).construct();
+    return fetchAllAsync<PersonDisplayEntity>(sql, bindings);
+}
+
 std::optional<PersonDisplayEntity> PersonRepository::findDisplayById(IntegerPrimaryKey id) const {
     const QString sql = PRIMARY_NAME_JOIN + u" WHERE p.id = :id"_s;
     return fetchOne<PersonDisplayEntity>(sql, {{u":id"_s, id}});
 }
 
+QList<PersonDisplayEntity> PersonRepository::findDisplayByIds(const QList<IntegerPrimaryKey>& ids) const {
+    QStringList idList;
+    idList.reserve(ids.size());
+    for (const auto id: ids) {
+        idList.append(QString::number(id));
+    }
+    const QString sql = PRIMARY_NAME_JOIN + u" WHERE p.id IN (SELECT value FROM json_each(:ids))"_s;
+    const auto found = fetchAll<PersonDisplayEntity>(sql, {{u":ids"_s, u"["_s + idList.join(u',') + u"]"_s}});
+
+    QHash<IntegerPrimaryKey, qsizetype> positions;
+    positions.reserve(found.size());
+    for (qsizetype i = 0; i < found.size(); ++i) {
+        positions.insert(found[i].id, i);
+    }
+    QList<PersonDisplayEntity> result;
+    result.reserve(found.size());
+    for (const auto id: ids) {
+        if (const auto position = positions.constFind(id); position != positions.cend()) {
+            result.append(found[*position]);
+        }
+    }
+    return result;
+}
+
+namespace {
+struct IdResult {
+    IntegerPrimaryKey id;
+    static IdResult fromSql(const QSqlQuery& q) {
+        return {.id = q.value(0).toLongLong()};
+    }
+};
+
+struct SortKeyResult {
+    PersonSortKey key;
+    static SortKeyResult fromSql(const QSqlQuery& q) {
+        return {.key = {.sortKey = q.value(1).toString(), .id = q.value(0).toLongLong()}};
+    }
+};
+
+struct CountResult {
+    qsizetype count = 0;
+    static CountResult fromSql(const QSqlQuery& q) {
+        return {.count = q.value(0).toLongLong()};
+    }
+};
+
+QueryHelper::SqlQueryBuilder namedPeopleQuery(const QString& column, const PersonCriteria& criteria) {
+    QueryHelper::SqlQueryBuilder builder;
+    builder.from(u"person_primary_name"_s).select({column});
+    QueryHelper::QueryCriteria page = criteria;
+    page.filterColumn = u"display_name"_s;
+    page.filters.clear();
+    builder.applyCriteria(page);
+    return builder;
+}
+}
+
+QList<PersonSortKey> PersonRepository::findNamedPersonKeys(const PersonCriteria& criteria) const {
+    auto builder = namedPeopleQuery(u"person_id, sort_key"_s, criteria);
+    const auto byId = criteria.sortColumn == SORT_BY_ID;
+    if (!byId) {
+        // Pages must not overlap, so the order has to be total. The index covers this order.
+        builder.orderBy(SORT_BY_ID, criteria.sortOrder);
+    }
+    if (criteria.after.has_value()) {
+        const auto comparison = criteria.sortOrder == Qt::AscendingOrder ? u">"_s : u"<"_s;
+        if (byId) {
+            builder.where(u"person_id %1 :after_id"_s.arg(comparison));
+        } else {
+            builder.where(u"(sort_key, person_id) %1 (:after_key, :after_id)"_s.arg(comparison));
+            builder.bind(u":after_key"_s, criteria.after->sortKey);
+        }
+        builder.bind(u":after_id"_s, criteria.after->id);
+    }
+    auto [sql, bindings] = builder.construct();
+    QList<PersonSortKey> result;
+    for (const auto& row: fetchAll<SortKeyResult>(sql, bindings)) {
+        result.append(row.key);
+    }
+    return result;
+}
+
+qsizetype PersonRepository::countNamedPeople(const PersonCriteria& criteria) const {
+    PersonCriteria count;
+    count.filterText = criteria.filterText;
+    auto [sql, bindings] = namedPeopleQuery(u"COUNT(*)"_s, count).construct();
+    const auto result = fetchOne<CountResult>(sql, bindings);
+    return result ? result->count : 0;
+}
+
+QList<IntegerPrimaryKey> PersonRepository::findUnnamedPersonIds() const {
+    const auto sql =
+        u"SELECT p.id FROM people p WHERE NOT EXISTS (SELECT 1 FROM person_primary_name pn WHERE pn.person_id = p.id) "
+        u"ORDER BY p.id"_s;
+    QList<IntegerPrimaryKey> result;
+    for (const auto& row: fetchAll<IdResult>(sql)) {
+        result.append(row.id);
+    }
+    return result;
+}
+
+qsizetype PersonRepository::countPeople() const {
+    const auto result = fetchOne<CountResult>(u"SELECT COUNT(*) FROM people"_s);
+    return result ? result->count : 0;
+}
+
 std::optional<IntegerPrimaryKey> PersonRepository::insertPerson(const QString& sex, bool root) const {
     const auto sql = u"INSERT INTO people (root, sex) VALUES (:root, :sex)"_s;
     const QVariantMap bindings = {
         {u":root"_s, root},
         {u":sex"_s, sex},
     };
-    const auto newId = QueryHelper::insert(sql, bindings);
-    if (newId.has_value()) {
-        DataEventBroker::instance().notifyChanged<Schema::People>(newId);
-    }
-    return newId;
+    return QueryHelper::insert(sql, bindings);
 }
 
 bool PersonRepository::updatePerson(IntegerPrimaryKey id, const QString& sex, bool root) const {
@@ -82,18 +198,10 @@ bool PersonRepository::updatePerson(IntegerPrimaryKey id, const QString& sex, bo
         {u":sex"_s, sex},
         {u":id"_s, id},
     };
-    const bool ok = QueryHelper::execute(sql, bindings);
-    if (ok) {
-        DataEventBroker::instance().notifyChanged<Schema::People>(id);
-    }
-    return ok;
+    return QueryHelper::execute(sql, bindings);
 }
 
 bool PersonRepository::deletePerson(IntegerPrimaryKey id) const {
     const auto sql = u"DELETE FROM people WHERE id = :id"_s;
-    const bool ok = QueryHelper::execute(sql, {{u":id"_s, id}});
-    if (ok) {
-        DataEventBroker::instance().notifyChanged<Schema::People>(id);
-    }
-    return ok;
+    return QueryHelper::execute(sql, {{u":id"_s, id}});
 }
@@ -13,21 +13,70 @@
 #include <QList>
 #include <optional>
 
+/**
+ * Where a person is in a sorted list of people, to continue the list after them.
+ */
+struct PersonSortKey {
+    // The sort key of the primary name; not used when sorting on the id.
+    QString sortKey;
+    IntegerPrimaryKey id = 0;
+};
+
 struct PersonCriteria : QueryHelper::QueryCriteria {
     std::optional<bool> rootOnly;
     std::optional<QString> sex;
+    // Only the people after this one in the sort order (keyset paging). The offset counts from there.
+    std::optional<PersonSortKey> after;
 };
 
 class PersonRepository : public BaseRepository {
 public:
+    /**
+     * Find people. To start after a key, the people must be sorted on the id.
+     */
     [[nodiscard]] QList<PersonEntity> findPeople(const PersonCriteria& criteria = {}) const;
 
     [[nodiscard]] std::optional<PersonEntity> findById(IntegerPrimaryKey id) const;
 
     [[nodiscard]] QList<PersonDisplayEntity> findPeopleWithPrimaryName(const PersonCriteria& criteria = {}) const;
 
+    /**
+     * Like findPeopleWithPrimaryName(), but runs the query on a worker thread.
+     */
+    [[nodiscard]] QCoro::Task<QList<PersonDisplayEntity>>
+    findPeopleWithPrimaryNameAsync(const PersonCriteria& criteria = {}) const;
+
     [[nodiscard]] std::optional<PersonDisplayEntity> findDisplayById(IntegerPrimaryKey id) const;
 
+    /**
+     * @return The people with these ids, in the same order. Ids without a person are skipped.
+     */
+    [[nodiscard]] QList<PersonDisplayEntity> findDisplayByIds(const QList<IntegerPrimaryKey>& ids) const;
+
+    /**
+     * Get a page of the people with a primary name, so a list does not need to load all of them.
+     *
+     * The filter text of the criteria is matched against the display name. The sort column is
+     * SORT_BY_NAME or SORT_BY_ID; ties are sorted on the id. With a key to start after, the index
+     * is used to seek to the page instead of skipping all rows before it. The other criteria are ignored.
+     */
+    [[nodiscard]] QList<PersonSortKey> findNamedPersonKeys(const PersonCriteria& criteria) const;
+
+    /**
+     * @return The number of people with a primary name that matches the filter text of the criteria.
+     */
+    [[nodiscard]] qsizetype countNamedPeople(const PersonCriteria& criteria = {}) const;
+
+    /**
+     * @return The ids of the people without a name, in order.
+     */
+    [[nodiscard]] QList<IntegerPrimaryKey> findUnnamedPersonIds() const;
+
+    [[nodiscard]] qsizetype countPeople() const;
+
+    static inline const auto SORT_BY_NAME = QStringLiteral("sort_key");
+    static inline const auto SORT_BY_ID = QStringLiteral("person_id");
+
     std::optional<IntegerPrimaryKey> insertPerson(const QString& sex, bool root = false) const;
 
     bool updatePerson(IntegerPrimaryKey id, const QString& sex, bool root) const;
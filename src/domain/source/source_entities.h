@@ -5,6 +5,7 @@
  */
 #pragma once
 
+#include "core/sql_row.h"
 #include "../../core/query_utils.h"
 #include "database/schema.h"
 
@@ -24,16 +25,28 @@ struct SourceEntity {
     QString note;
     std::optional<IntegerPrimaryKey> parentId;
 
-    static SourceEntity fromSql(const QSqlQuery& query) {
+    using Columns = SqlColumns<
+        u"id",
+        u"title",
+        u"type_id",
+        u"author",
+        u"publication",
+        u"confidence",
+        u"note",
+        u"parent_id">;
+
+    static SourceEntity fromSql(const Columns::Row& row) {
         return {
-            .id = query.value(u"id").toLongLong(),
-            .title = query.value(u"title").toString(),
-            .typeId = validOrOptional<IntegerPrimaryKey>(query.value(u"type_id")),
-            .author = query.value(u"author").toString(),
-            .publication = query.value(u"publication").toString(),
-            .confidence = query.value(u"confidence").toString(),
-            .note = query.value(u"note").toString(),
-            .parentId = validOrOptional<IntegerPrimaryKey>(query.value(u"parent_id")),
+            .id = row.value<u"id">().toLongLong(),
+            .title = row.value<u"title">().toString(),
+            .typeId = validOrOptional<IntegerPrimaryKey>(row.value<u"type_id">()),
+            .author = row.value<u"author">().toString(),
+            .publication = row.value<u"publication">().toString(),
+            .confidence = row.value<u"confidence">().toString(),
+            .note = row.value<u"note">().toString(),
+            .parentId = validOrOptional<IntegerPrimaryKey>(row.value<u"parent_id">()),
         };
     }
+
+    bool operator==(const SourceEntity&) const = default;
 };
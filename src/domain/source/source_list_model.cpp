@@ -23,7 +23,11 @@ SourcesListModel::SourcesListModel(QObject* parent) : ObjectTableModel(parent) {
     this->setColumn(PARENT_ID, i18n("Parent"), [](const SourceEntity& e) -> QVariant {
         return e.parentId.has_value() ? QVariant(e.parentId.value()) : QVariant{};
     });
-    connectToTable<Schema::Sources>(this);
+    this->setRowId(&SourceEntity::id);
+    this->updateRowsOn<Schema::Sources>(
+        [](IntegerPrimaryKey id) { return SourceRepository().findById(id); },
+        [this] { reload(); }
+    );
     reload();
 }
 
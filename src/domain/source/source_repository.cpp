@@ -5,7 +5,6 @@
  */
 #include "source_repository.h"
 
-#include "../../core/data_event_broker.h"
 #include "../../core/query_helper.h"
 
 using namespace Qt::StringLiterals;
@@ -56,11 +55,7 @@ std::optional<IntegerPrimaryKey> SourceRepository::insert(
     } else {
         bindings[u":parent_id"_s] = QVariant(QMetaType::fromType<IntegerPrimaryKey>());
     }
-    const auto newId = QueryHelper::insert(sql, bindings);
-    if (newId) {
-        DataEventBroker::instance().notifyChanged<Schema::Sources>(newId);
-    }
-    return newId;
+    return QueryHelper::insert(sql, bindings);
 }
 
 bool SourceRepository::update(
@@ -94,12 +89,12 @@ bool SourceRepository::update(
     } else {
         bindings[u":parent_id"_s] = QVariant(QMetaType::fromType<IntegerPrimaryKey>());
     }
-    return QueryHelper::executeAndNotify<Schema::Sources>(id, sql, bindings);
+    return QueryHelper::execute(sql, bindings);
 }
 
 bool SourceRepository::remove(IntegerPrimaryKey id) const {
     const auto sql = u"DELETE FROM sources WHERE id = :id"_s;
-    return QueryHelper::executeAndNotify<Schema::Sources>(id, sql, {{u":id"_s, id}});
+    return QueryHelper::execute(sql, {{u":id"_s, id}});
 }
 
 QList<SourceTypeEntity> SourceRepository::findAllSourceTypes() const {
@@ -114,28 +109,21 @@ std::optional<SourceTypeEntity> SourceRepository::findSourceTypeById(IntegerPrim
 }
 
 std::optional<IntegerPrimaryKey> SourceRepository::insertSourceType(const QString& type) const {
-    auto newId =
-        QueryHelper::insert(u"INSERT INTO source_types (type, builtin) VALUES (:type, FALSE)"_s, {{u":type"_s, type}});
-    if (newId) {
-        DataEventBroker::instance().notifyChanged<Schema::SourceTypes>(newId);
-    }
-    return newId;
+    return QueryHelper::insert(
+        u"INSERT INTO source_types (type, builtin) VALUES (:type, FALSE)"_s,
+        {{u":type"_s, type}}
+    );
 }
 
 bool SourceRepository::updateSourceType(IntegerPrimaryKey id, const QString& type) const {
-    return QueryHelper::executeAndNotify<Schema::SourceTypes>(
-        id,
+    return QueryHelper::execute(
         u"UPDATE source_types SET type = :type WHERE id = :id AND builtin = FALSE"_s,
         {{u":type"_s, type}, {u":id"_s, id}}
     );
 }
 
 bool SourceRepository::deleteSourceType(IntegerPrimaryKey id) const {
-    return QueryHelper::executeAndNotify<Schema::SourceTypes>(
-        id,
-        u"DELETE FROM source_types WHERE id = :id AND builtin = FALSE"_s,
-        {{u":id"_s, id}}
-    );
+    return QueryHelper::execute(u"DELETE FROM source_types WHERE id = :id AND builtin = FALSE"_s, {{u":id"_s, id}});
 }
 
 bool SourceRepository::isSourceTypeUsed(IntegerPrimaryKey typeId) const {
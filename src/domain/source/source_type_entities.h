@@ -5,6 +5,7 @@
  */
 #pragma once
 
+#include "core/sql_row.h"
 #include "database/schema.h"
 
 #include <QSqlQuery>
@@ -15,12 +16,16 @@ struct SourceTypeEntity {
     QString type;
     bool builtin = false;
 
-    static SourceTypeEntity fromSql(const QSqlQuery& query) {
+    using Columns = SqlColumns<u"id", u"type", u"builtin">;
+
+    static SourceTypeEntity fromSql(const Columns::Row& row) {
         using namespace Qt::StringLiterals;
         return {
-            .id = query.value(u"id").toLongLong(),
-            .type = query.value(u"type").toString(),
-            .builtin = query.value(u"builtin").toBool(),
+            .id = row.value<u"id">().toLongLong(),
+            .type = row.value<u"type">().toString(),
+            .builtin = row.value<u"builtin">().toBool(),
         };
     }
+
+    bool operator==(const SourceTypeEntity&) const = default;
 };
@@ -5,6 +5,7 @@
  */
 #pragma once
 
+#include "core/sql_row.h"
 #include "database/schema.h"
 
 #include <QSqlQuery>
@@ -16,13 +17,15 @@ struct SourceTypeTranslationEntity {
     QString locale;
     QString name;
 
-    static SourceTypeTranslationEntity fromSql(const QSqlQuery& query) {
+    using Columns = SqlColumns<u"id", u"type_id", u"locale", u"name">;
+
+    static SourceTypeTranslationEntity fromSql(const Columns::Row& row) {
         using namespace Qt::StringLiterals;
         return {
-            .id = query.value(u"id").toLongLong(),
-            .typeId = query.value(u"type_id").toLongLong(),
-            .locale = query.value(u"locale").toString(),
-            .name = query.value(u"name").toString(),
+            .id = row.value<u"id">().toLongLong(),
+            .typeId = row.value<u"type_id">().toLongLong(),
+            .locale = row.value<u"locale">().toString(),
+            .name = row.value<u"name">().toString(),
         };
     }
 };
@@ -5,7 +5,6 @@
  */
 #include "source_type_translation_repository.h"
 
-#include "core/data_event_broker.h"
 #include "core/query_helper.h"
 
 using namespace Qt::StringLiterals;
@@ -19,22 +18,14 @@ QList<SourceTypeTranslationEntity> SourceTypeTranslationRepository::findAllForTy
 
 std::optional<IntegerPrimaryKey>
 SourceTypeTranslationRepository::insert(IntegerPrimaryKey typeId, const QString& locale, const QString& name) const {
-    auto newId = QueryHelper::insert(
+    return QueryHelper::insert(
         u"INSERT INTO source_type_translations (type_id, locale, name) VALUES (:type_id, :locale, :name)"_s,
         {{u":type_id"_s, typeId}, {u":locale"_s, locale}, {u":name"_s, name}}
     );
-    if (newId) {
-        DataEventBroker::instance().notifyChanged<Schema::SourceTypeTranslations>(newId);
-    }
-    return newId;
 }
 
 bool SourceTypeTranslationRepository::remove(IntegerPrimaryKey id) const {
-    return QueryHelper::executeAndNotify<Schema::SourceTypeTranslations>(
-        id,
-        u"DELETE FROM source_type_translations WHERE id = :id"_s,
-        {{u":id"_s, id}}
-    );
+    return QueryHelper::execute(u"DELETE FROM source_type_translations WHERE id = :id"_s, {{u":id"_s, id}});
 }
 
 std::optional<QString>
@@ -23,7 +23,11 @@ SourceTypesListModel::SourceTypesListModel(QObject* parent) : ObjectTableModel(p
     });
     this->setColumn(BUILTIN, i18n("Built-in"), &SourceTypeEntity::builtin);
 
-    connectToTable<Schema::SourceTypes>(this);
+    this->setRowId(&SourceTypeEntity::id);
+    this->updateRowsOn<Schema::SourceTypes>(
+        [](IntegerPrimaryKey id) { return SourceRepository().findSourceTypeById(id); },
+        [this] { reload(); }
+    );
 
     reload();
 }
@@ -9,10 +9,8 @@
 #include "dates/genealogical_date.h"
 #include "dates/genealogical_date_editor_dialog.h"
 #include "domain/event/event_repository.h"
-#include "domain/event/event_role_translation_repository.h"
 #include "domain/event/event_roles.h"
 #include "domain/event/event_roles_model.h"
-#include "domain/event/event_type_translation_repository.h"
 #include "domain/event/event_types.h"
 #include "domain/event/event_types_model.h"
 #include "domain/location/location_paths_model.h"
@@ -26,6 +24,7 @@
 #include "ui_event_editor_dialog.h"
 #include "utils/formatted_identifier_delegate.h"
 #include "utils/translating_proxy_model.h"
+#include "utils/type_translation_cache.h"
 
 #include <KLocalizedString>
 #include <QComboBox>
@@ -87,8 +86,8 @@ EventEditorDialog::EventEditorDialog(
             form->eventTypeComboBox->setCurrentIndex(typeIndex.constFirst().row());
         }
 
-        if (!event->date.isEmpty()) {
-            form->eventDatePicker->setText(GenealogicalDate::fromDatabaseRepresentation(event->date).toDisplayText());
+        if (!event->date.isNull()) {
+            form->eventDatePicker->setText(event->date.toDisplayText());
         }
         form->eventNameEdit->setText(event->name);
         form->noteEdit->setTextOrHtml(event->note);
@@ -126,7 +125,7 @@ void EventEditorDialog::setupUi() {
     auto* typesProxy = new TranslatingProxyModel(
         TypeTranslationResolver(
             [](IntegerPrimaryKey typeId, const QString& locale) {
-                return EventTypeTranslationRepository().findByTypeIdAndLocale(typeId, locale);
+                return TypeTranslationCache::forTable<Schema::EventTypeTranslations>().find(typeId, locale);
             },
             EventTypes::toDisplayString
         ),
@@ -140,7 +139,7 @@ void EventEditorDialog::setupUi() {
     auto* rolesProxy = new TranslatingProxyModel(
         TypeTranslationResolver(
             [](IntegerPrimaryKey roleId, const QString& locale) {
-                return EventRoleTranslationRepository().findByTypeIdAndLocale(roleId, locale);
+                return TypeTranslationCache::forTable<Schema::EventRoleTranslations>().find(roleId, locale);
             },
             EventRoles::toDisplayString
         ),
@@ -248,8 +247,7 @@ void EventEditorDialog::accept() {
     auto typeId = typesModel->index(typeRow, EventTypesListModel::ID).data().toLongLong();
 
     auto displayDate = form->eventDatePicker->text();
-    auto date = displayDate.isEmpty() ? QString{}
-                                      : GenealogicalDate::fromDisplayText(displayDate).toDatabaseRepresentation();
+    auto date = displayDate.isEmpty() ? GenealogicalDate{} : GenealogicalDate::fromDisplayText(displayDate);
     auto name = form->eventNameEdit->text();
     auto note = form->noteEdit->textOrHtml();
 
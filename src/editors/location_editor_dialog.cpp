@@ -8,7 +8,6 @@
 #include "dates/genealogical_date.h"
 #include "dates/genealogical_date_editor_dialog.h"
 #include "domain/location/location_repository.h"
-#include "domain/location/location_type_translation_repository.h"
 #include "domain/location/location_types.h"
 #include "domain/location/location_types_list_model.h"
 #include "link_existing/choose_existing_location_window.h"
@@ -16,6 +15,7 @@
 #include "ui_location_editor_dialog.h"
 #include "utils/formatted_identifier_delegate.h"
 #include "utils/translating_proxy_model.h"
+#include "utils/type_translation_cache.h"
 
 #include <KLocalizedString>
 
@@ -46,7 +46,7 @@ LocationEditorDialog::LocationEditorDialog(
     auto* typesProxy = new TranslatingProxyModel(
         TypeTranslationResolver(
             [](IntegerPrimaryKey typeId, const QString& locale) {
-                return LocationTypeTranslationRepository().findByTypeIdAndLocale(typeId, locale);
+                return TypeTranslationCache::forTable<Schema::LocationTypeTranslations>().find(typeId, locale);
             },
             LocationTypes::toDisplayString
         ),
@@ -85,15 +85,11 @@ LocationEditorDialog::LocationEditorDialog(
                 form->longitudeSpinBox->setValue(entity->coordinates->longitude);
             }
 
-            if (!entity->dateStart.isEmpty()) {
-                form->dateStartEdit->setText(
-                    GenealogicalDate::fromDatabaseRepresentation(entity->dateStart).toDisplayText()
-                );
+            if (!entity->dateStart.isNull()) {
+                form->dateStartEdit->setText(entity->dateStart.toDisplayText());
             }
-            if (!entity->dateEnd.isEmpty()) {
-                form->dateEndEdit->setText(
-                    GenealogicalDate::fromDatabaseRepresentation(entity->dateEnd).toDisplayText()
-                );
+            if (!entity->dateEnd.isNull()) {
+                form->dateEndEdit->setText(entity->dateEnd.toDisplayText());
             }
 
             parentId = entity->parentId;
@@ -133,14 +129,11 @@ void LocationEditorDialog::accept() {
     }
 
     const auto dateStartText = form->dateStartEdit->text();
-    const auto dateStart = dateStartText.isEmpty()
-                               ? QString{}
-                               : GenealogicalDate::fromDisplayText(dateStartText).toDatabaseRepresentation();
+    const auto dateStart =
+        dateStartText.isEmpty() ? GenealogicalDate{} : GenealogicalDate::fromDisplayText(dateStartText);
 
     const auto dateEndText = form->dateEndEdit->text();
-    const auto dateEnd = dateEndText.isEmpty()
-                             ? QString{}
-                             : GenealogicalDate::fromDisplayText(dateEndText).toDatabaseRepresentation();
+    const auto dateEnd = dateEndText.isEmpty() ? GenealogicalDate{} : GenealogicalDate::fromDisplayText(dateEndText);
 
     if (!locationId.has_value()) {
         const auto newId = repo.insert(name, typeId, parentId);
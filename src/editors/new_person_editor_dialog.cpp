@@ -6,13 +6,13 @@
 
 #include "new_person_editor_dialog.h"
 
-#include "../domain/name/name_origin_translation_repository.h"
 #include "../domain/name/name_origins_model.h"
 #include "../domain/name/name_repository.h"
 #include "../domain/name/names.h"
 #include "../domain/person/person_repository.h"
 #include "ui_new_person_editor_dialog.h"
 #include "utils/translating_proxy_model.h"
+#include "utils/type_translation_cache.h"
 
 #include <KLocalizedString>
 #include <QCompleter>
@@ -67,7 +67,7 @@ NewPersonEditorDialog::NewPersonEditorDialog(QWidget* parent) :
     auto* originsProxy = new TranslatingProxyModel(
         TypeTranslationResolver(
             [](IntegerPrimaryKey originId, const QString& locale) {
-                return NameOriginTranslationRepository().findByTypeIdAndLocale(originId, locale);
+                return TypeTranslationCache::forTable<Schema::NameOriginTranslations>().find(originId, locale);
             },
             NameOrigins::toDisplayString
         ),
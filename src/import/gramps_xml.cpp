@@ -14,1087 +14,1233 @@
 
 #include "gramps_xml.h"
 
+#include "database/change_capture.h"
 #include "database/database.h"
+#include "database/schema.h"
+#include "dates/date_columns.h"
+#include "domain/event/event_roles.h"
+#include "domain/event/event_types.h"
+#include "domain/person/person_sex.h"
+#include "domain/source/source.h"
+#include "gramps_xml_reader.h"
+#include "import_pipeline.h"
 #include "utils/resource_exception.h"
-#include <libxml/parser.h>
-#include <libxml/relaxng.h>
 
 #include <KLocalizedString>
-#include <QFile>
+#include <QHash>
 #include <QLoggingCategory>
 #include <QSqlError>
 #include <QSqlQuery>
 #include <QString>
 #include <QStringList>
 #include <QThread>
-#include <cstdarg>
+#include <QVariantMap>
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <utility>
+#include <variant>
 
 using namespace Qt::StringLiterals;
 
 static const auto GRAMPS_ID = QLatin1String("gramps_id");
 
-static void relaxNgErrorCollector(void* ctx, const char* msg, ...) {
-    if (!ctx) {
-        return;
-    }
-
-    auto* errorList = static_cast<QStringList*>(ctx);
-
-    va_list args;
-    va_start(args, msg);
-    QString formattedError = QString::vasprintf(msg, args);
-    va_end(args);
-
-    errorList->append(formattedError.trimmed());
-}
-
-static int countElementChildren(const xmlNode* parent) {
-    int count = 0;
-    for (const xmlNode* child = parent->children; child != nullptr; child = child->next) {
-        if (child->type == XML_ELEMENT_NODE) {
-            ++count;
-        }
-    }
-    return count;
-}
-
-static bool nodeNameIs(const xmlNode* node, const char* name) {
-    // ReSharper disable once CppCStyleCast
-    return xmlStrEqual(node->name, BAD_CAST name) != 0;
-}
-
-static QString attrStr(const xmlNode* node, const char* name) {
-    // ReSharper disable once CppCStyleCast
-    xmlChar* val = xmlGetProp(node, BAD_CAST name);
-    if (!val) {
-        return {};
-    }
-
-    QString result = QString::fromUtf8(val);
-    xmlFree(val);
-    return result;
-}
-
-static QString textContent(const xmlNode* node) {
-    xmlChar* val = xmlNodeGetContent(node);
-    if (!val) {
-        return {};
-    }
-    QString result = QString::fromUtf8(val);
-    xmlFree(val);
-    return result;
-}
-
 void validateGrampsXml(QPromise<GrampsXmlAnalysis>& promise, const QString& filename) {
-    QFile rngSchemaFile(u":/schema/grampsxml-1.7.2.rng"_s);
-
-    if (!rngSchemaFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        qWarning() << "Could not open Gramps XML schema file.";
-        promise.setException(ResourceNotFoundException());
-        return;
-    }
-
-    QByteArray rngSchemaBytes = rngSchemaFile.readAll();
-    rngSchemaFile.close();
-
-    xmlRelaxNGParserCtxtPtr rawParserContext =
-        xmlRelaxNGNewMemParserCtxt(rngSchemaBytes.constData(), rngSchemaBytes.size());
-    if (!rawParserContext) {
-        qWarning() << "Failed to create RelaxNG parser context from memory.";
-        promise.setException(ResourceNotFoundException());
+    std::optional<GrampsXmlReader> reader;
+    try {
+        reader.emplace(filename);
+    } catch (const ResourceNotFoundException& exception) {
+        promise.setException(exception);
         return;
     }
-    std::unique_ptr<xmlRelaxNGParserCtxt, decltype(&xmlRelaxNGFreeParserCtxt)> parserContext(
-        rawParserContext,
-        xmlRelaxNGFreeParserCtxt
-    );
-
-    xmlRelaxNGPtr rawSchema = xmlRelaxNGParse(parserContext.get());
-    if (!rawSchema) {
-        qWarning() << "Failed to create RelaxNG schema.";
-        promise.setException(ResourceNotFoundException());
-        return;
-    }
-    std::unique_ptr<xmlRelaxNG, decltype(&xmlRelaxNGFree)> schema(rawSchema, xmlRelaxNGFree);
-
-    xmlRelaxNGValidCtxtPtr rawValidationContext = xmlRelaxNGNewValidCtxt(schema.get());
-    if (!rawValidationContext) {
-        qWarning() << "Failed to create RelaxNG validation context.";
-        promise.setException(ResourceNotFoundException());
-        return;
-    }
-    std::unique_ptr<xmlRelaxNGValidCtxt, decltype(&xmlRelaxNGFreeValidCtxt)> validationContext(
-        rawValidationContext,
-        xmlRelaxNGFreeValidCtxt
-    );
-
-    QStringList validationErrors;
-    xmlRelaxNGSetValidErrors(validationContext.get(), relaxNgErrorCollector, nullptr, &validationErrors);
-
-    QByteArray rawFilename = filename.toUtf8();
-    xmlDocPtr rawDocument = xmlReadFile(rawFilename.constData(), nullptr, XML_PARSE_NONET);
-    if (!rawDocument) {
-        qWarning() << "Failed to parse XML file.";
-        GrampsXmlAnalysis result {
-            .valid = false,
-            .error = i18n("Could not parse XML file"),
-        };
-        promise.addResult(std::move(result));
-        return;
-    }
-    GrampsXmlRoot document(rawDocument, xmlFreeDoc);
-
-    int validationResult = xmlRelaxNGValidateDoc(validationContext.get(), document.get());
 
-    if (validationResult > 0) {
+    if (!reader->skipToEnd()) {
         qDebug() << "Invalid Gramps XML file.";
-
         GrampsXmlAnalysis result {
             .valid = false,
-            .error = validationErrors.join(u"\n"_s),
+            .error = reader->error(),
         };
         promise.addResult(std::move(result));
         return;
-    } else if (validationResult < 0) {
-        qWarning() << "Internal error while validating XML file.";
-        promise.setException(ResourceNotFoundException());
-        return;
     }
 
-    assert(validationResult == 0);
-
+    const auto& counts = reader->counts();
     GrampsXmlAnalysis result {
-        .document = std::move(document),
+        .filename = filename,
         .valid = true,
         .error = {},
+        .people = counts.people,
+        .families = counts.families,
+        .events = counts.events,
+        .sources = counts.sources,
+        .places = counts.places,
+        .media = counts.media,
+        .repositories = counts.repositories,
+        .notes = counts.notes,
+        .citations = counts.citations,
     };
-
-    // <database>
-    const xmlNode* root = xmlDocGetRootElement(result.document.get());
-
-    for (const xmlNode* c = root->children; c; c = c->next) {
-        if (nodeNameIs(c, "people")) {
-            result.people = countElementChildren(c);
-        } else if (nodeNameIs(c, "families")) {
-            result.families = countElementChildren(c);
-        } else if (nodeNameIs(c, "events")) {
-            result.events = countElementChildren(c);
-        } else if (nodeNameIs(c, "sources")) {
-            result.sources = countElementChildren(c);
-        } else if (nodeNameIs(c, "places")) {
-            result.places = countElementChildren(c);
-        } else if (nodeNameIs(c, "media")) {
-            result.media = countElementChildren(c);
-        } else if (nodeNameIs(c, "repositories")) {
-            result.repositories = countElementChildren(c);
-        } else if (nodeNameIs(c, "notes")) {
-            result.notes = countElementChildren(c);
-        } else if (nodeNameIs(c, "citations")) {
-            result.citations = countElementChildren(c);
-        }
-    }
-
     promise.addResult(std::move(result));
 }
 
-struct GrampsDate {
-    QString type;
-    // dateval.val or datestr.val
-    QString value;
-    // daterange/datespan.start
-    QString start;
-    // daterange/datespan.stop
-    QString stop;
-    // before/after/about (dateval only)
-    QString modifier;
-    // estimated/calculated
-    QString quality;
-    QString calendarFormat;
-    bool isDualDated = false;
-    QString newYear;
-};
-
-struct GrampsSurname {
-    QString surname;
-    QString prefix;
-    QString derivation;
-    QString connector;
-    bool isPrimary = false;
-};
-
-struct GrampsAddress {
-    GrampsDate date;
-    QString street;
-    QString locality;
-    QString city;
-    QString county;
-    QString state;
-    QString country;
-    QString postal;
-    QString phone;
-    QList<QString> noteHandles;
-    QList<QString> citationHandles;
-};
-
-struct GrampsName {
-    bool isAlternate = false;
-    QString type;
-    QString sortAs;
-    QString displayAs;
-    QString givenNames;
-    QString callName;
-    QList<GrampsSurname> surnames;
-    QString suffix;
-    QString title;
-    QString nickname;
-    QString familyNickname;
-    QString groupAs;
-    GrampsDate date;
-    QList<QString> noteHandles;
-    QList<QString> citationHandles;
-};
-
-struct GrampsEventRef {
-    QString eventHandle;
-    QString role;
-    QList<QString> noteHandles;
-    QList<QString> citationHandles;
-};
-
-struct GrampsMediaRef {
-    QString mediaHandle;
-    QList<QString> citationHandles;
-    QList<QString> noteHandles;
-};
-
-struct GrampsPersonRef {
-    QString personHandle;
-    QString relation;
-    QList<QString> citationHandles;
-    QList<QString> noteHandles;
-};
-
-struct GrampsChildRef {
-    QString personHandle;
-    QString motherRelationType;
-    QString fatherRelationType;
-    QList<QString> citationHandles;
-    QList<QString> noteHandles;
-};
-
-struct GrampsPerson {
-    QString handle, id, sex;
-    QList<GrampsName> names;
-    QList<GrampsEventRef> eventRefs;
-    QList<GrampsMediaRef> mediaRefs;
-    QList<GrampsAddress> addresses;
-    QList<GrampsPersonRef> personRefs;
-    QList<QString> noteHandles;
-    QList<QString> citationHandles;
-};
-
-struct GrampsFamily {
-    QString handle, id;
-    QString relationshipType;
-    QString fatherHandle;
-    QString motherHandle;
-    QList<GrampsEventRef> eventRefs;
-    QList<GrampsChildRef> childRefs;
-    QList<GrampsMediaRef> mediaRefs;
-    GrampsDate date;
-    QList<QString> noteHandles;
-    QList<QString> citationHandles;
-};
-
-struct GrampsEvent {
-    QString handle, id, type, description;
-    GrampsDate date;
-    QString placeHandle;
-    QList<GrampsMediaRef> mediaRefs;
-    QList<QString> noteHandles;
-    QList<QString> citationHandles;
-};
-
-struct GrampsPlaceName {
-    QString value;
-    QString language;
-    GrampsDate date;
-};
-
-struct GrampsPlace {
-    QString handle, id, type;
-    QString title;
-    QString code;
-    QList<GrampsPlaceName> names;
-    double latitude = 0.0, longitude = 0.0;
-    bool hasCoordinates = false;
-    QList<QString> parentHandles;
-    QList<GrampsMediaRef> mediaRefs;
-    QList<QString> noteHandles;
-    QList<QString> citationHandles;
-};
-
-struct GrampsNote {
-    QString handle, id, type;
-    QString text;
-};
-
-struct GrampsSrcAttribute {
-    QString type;
-    QString value;
-};
-
-struct GrampsRepositoryRef {
-    QString repositoryHandle;
-    QString callNumber;
-    QString medium;
-    QList<QString> noteHandles;
-};
-
-struct GrampsCitation {
-    QString handle, id;
-    GrampsDate date;
-    QString page;
-    QString confidence;
-    QString sourceHandle;
-    QList<GrampsSrcAttribute> sourceAttributes;
-    QList<GrampsMediaRef> mediaRefs;
-    QList<QString> noteHandles;
-};
+namespace {
+/**
+ * The ids of the rows of a table of types, such as the event types, by their name.
+ *
+ * Names that are not in the table yet are added as types that are not built in.
+ */
+class TypeIds {
+public:
+    TypeIds(const QSqlDatabase& db, const QString& table, const QString& column) :
+        table(table),
+        column(column),
+        insert(db),
+        select(db) {
+    }
 
-struct GrampsSource {
-    QString handle, id;
-    QString title;
-    QString author;
-    QString publicationInfo;
-    QString abbreviation;
-    QList<GrampsSrcAttribute> sourceAttributes;
-    QList<GrampsRepositoryRef> repositoryRefs;
-    QList<GrampsMediaRef> mediaRefs;
-    QList<QString> noteHandles;
-};
+    bool prepare() {
+        if (!select.exec(u"SELECT id, %1 FROM %2"_s.arg(column, table))) {
+            qCritical() << "Failed to read" << table << select.lastError().text();
+            return false;
+        }
+        while (select.next()) {
+            ids.insert(select.value(1).toString(), select.value(0).toLongLong());
+        }
+        select.finish();
+        if (!insert.prepare(u"INSERT INTO %1 (%2, builtin) VALUES (:name, FALSE)"_s.arg(table, column))) {
+            qCritical() << "Failed to prepare insert into" << table << insert.lastError().text();
+            return false;
+        }
+        return true;
+    }
 
-struct GrampsMedia {
-    QString handle, id;
-    QString filePath;
-    QString mimeType;
-    QString checksum;
-    QString description;
-    GrampsDate date;
-    QList<QString> noteHandles;
-    QList<QString> citationHandles;
-};
+    /**
+     * @return The id of the type, or nothing if the name is empty or the type could not be added.
+     */
+    std::optional<IntegerPrimaryKey> idOf(const QString& name) {
+        if (name.isEmpty()) {
+            return std::nullopt;
+        }
+        if (const auto existing = ids.constFind(name); existing != ids.cend()) {
+            return *existing;
+        }
+        insert.bindValue(u":name"_s, name);
+        if (!insert.exec()) {
+            qCritical() << "Failed to insert into" << table << name << insert.lastError().text();
+            return std::nullopt;
+        }
+        const auto id = insert.lastInsertId().toLongLong();
+        ids.insert(name, id);
+        return id;
+    }
 
-struct GrampsRepository {
-    QString handle, id;
-    QString name;
-    QString type;
-    QList<GrampsAddress> addresses;
-    QList<QString> noteHandles;
+private:
+    QString table;
+    QString column;
+    QSqlQuery insert;
+    QSqlQuery select;
+    QHash<QString, IntegerPrimaryKey> ids;
 };
 
-struct GrampsData {
-    QHash<QString, GrampsPerson> people;
-    QHash<QString, GrampsFamily> families;
-    QHash<QString, GrampsEvent> events;
-    QHash<QString, GrampsPlace> places;
-    QHash<QString, GrampsNote> notesById;
-    QHash<QString, GrampsNote> notesByHandle;
-    QHash<QString, GrampsCitation> citations;
-    QHash<QString, GrampsSource> sources;
-    QHash<QString, GrampsMedia> media;
-    QHash<QString, GrampsRepository> repositories;
+struct GrampsDatePoint {
+    QDate date;
+    bool hasMonth = false;
+    bool hasDay = false;
 };
 
-static GrampsDate parseDate(const xmlNode* node) {
-    GrampsDate date;
-
-    if (nodeNameIs(node, "daterange")) {
-        date = {
-            .type = u"daterange"_s,
-            .start = attrStr(node, "start"),
-            .stop = attrStr(node, "stop"),
-            .quality = attrStr(node, "quality"),
-            .calendarFormat = attrStr(node, "cformat"),
-            .isDualDated = attrStr(node, "dualdated") == u"1"_s,
-            .newYear = attrStr(node, "newyear"),
-        };
-    } else if (nodeNameIs(node, "datespan")) {
-        date = {
-            .type = u"datespan"_s,
-            .start = attrStr(node, "start"),
-            .stop = attrStr(node, "stop"),
-            .quality = attrStr(node, "quality"),
-            .calendarFormat = attrStr(node, "cformat"),
-            .isDualDated = attrStr(node, "dualdated") == u"1"_s,
-            .newYear = attrStr(node, "newyear"),
-        };
-    } else if (nodeNameIs(node, "dateval")) {
-        date = {
-            .type = u"dateval"_s,
-            .value = attrStr(node, "val"),
-            .modifier = attrStr(node, "type"),
-            .quality = attrStr(node, "quality"),
-            .calendarFormat = attrStr(node, "cformat"),
-            .isDualDated = attrStr(node, "dualdated") == u"1"_s,
-            .newYear = attrStr(node, "newyear"),
-        };
-    } else if (nodeNameIs(node, "datestr")) {
-        date = {
-            .type = u"datestr"_s,
-            .value = attrStr(node, "val"),
-        };
-    } else {
-        qWarning() << "Unknown node type" << node->type;
+/**
+ * Parse a date value of Gramps: "yyyy", "yyyy-mm" or "yyyy-mm-dd", where an unknown month or day is 0.
+ */
+std::optional<GrampsDatePoint> parseGrampsDateValue(const QString& value) {
+    const bool negative = value.startsWith(u'-');
+    const auto parts = QStringView(value).mid(negative ? 1 : 0).split(u'-');
+    if (parts.size() > 3) {
+        return std::nullopt;
     }
-
-    return date;
-}
-
-static bool isDateNode(const xmlNode* c) {
-    return nodeNameIs(c, "dateval") || nodeNameIs(c, "daterange") || nodeNameIs(c, "datespan") ||
-           nodeNameIs(c, "datestr");
+    bool ok = false;
+    const auto year = parts[0].toInt(&ok) * (negative ? -1 : 1);
+    if (!ok || year == 0) {
+        return std::nullopt;
+    }
+    const auto month = parts.size() > 1 ? parts[1].toInt(&ok) : 0;
+    if (!ok) {
+        return std::nullopt;
+    }
+    const auto day = parts.size() > 2 && month != 0 ? parts[2].toInt(&ok) : 0;
+    if (!ok) {
+        return std::nullopt;
+    }
+    const QDate date(year, month == 0 ? 1 : month, day == 0 ? 1 : day);
+    if (!date.isValid()) {
+        return std::nullopt;
+    }
+    return GrampsDatePoint {.date = date, .hasMonth = month != 0, .hasDay = day != 0};
 }
 
-static GrampsSurname parseSurname(const xmlNode* node) {
-    return {
-        .surname = textContent(node),
-        .prefix = attrStr(node, "prefix"),
-        .derivation = attrStr(node, "derivation"),
-        .connector = attrStr(node, "connector"),
-        .isPrimary = attrStr(node, "prim") == u"1"_s,
-    };
+GenealogicalDate textOnlyDate(const QString& text) {
+    return {GenealogicalDate::NONE, GenealogicalDate::EXACT, {}, false, false, false, text};
 }
 
-static GrampsName parseName(const xmlNode* node) {
-    GrampsName name {
-        .isAlternate = attrStr(node, "alt") == u"1"_s,
-        .type = attrStr(node, "type"),
-        .sortAs = attrStr(node, "sort"),
-        .displayAs = attrStr(node, "display"),
-    };
-
-    for (const xmlNode* c = node->children; c; c = c->next) {
-        if (nodeNameIs(c, "first")) {
-            name.givenNames = textContent(c);
-        } else if (nodeNameIs(c, "call")) {
-            name.callName = textContent(c);
-        } else if (nodeNameIs(c, "surname")) {
-            name.surnames.append(parseSurname(c));
-        } else if (nodeNameIs(c, "suffix")) {
-            name.suffix = textContent(c);
-        } else if (nodeNameIs(c, "title")) {
-            name.title = textContent(c);
-        } else if (nodeNameIs(c, "nick")) {
-            name.nickname = textContent(c);
-        } else if (nodeNameIs(c, "familynick")) {
-            name.familyNickname = textContent(c);
-        } else if (nodeNameIs(c, "group")) {
-            name.groupAs = textContent(c);
-        } else if (nodeNameIs(c, "noteref")) {
-            name.noteHandles.append(attrStr(c, "hlink"));
-        } else if (nodeNameIs(c, "citationref")) {
-            name.citationHandles.append(attrStr(c, "hlink"));
-        } else if (isDateNode(c)) {
-            name.date = parseDate(c);
-        }
+GenealogicalDate toGenealogicalDate(const GrampsDate& date) {
+    if (date.type.isEmpty()) {
+        return {};
+    }
+    if (date.type == u"datestr"_s) {
+        return textOnlyDate(date.value);
     }
 
-    return name;
-}
+    const bool isInterval = date.type == u"daterange"_s || date.type == u"datespan"_s;
+    const auto original = isInterval ? date.start + u" - "_s + date.stop : date.value;
+    // Opa only has the Gregorian calendar, so keep dates in other calendars as text.
+    if (!date.calendarFormat.isEmpty()) {
+        return textOnlyDate(original + u" ("_s + date.calendarFormat + u')');
+    }
 
-static GrampsEventRef parseEventRef(const xmlNode* node) {
-    GrampsEventRef ref {
-        .eventHandle = attrStr(node, "hlink"),
-        .role = attrStr(node, "role"),
-    };
+    auto quality = GenealogicalDate::EXACT;
+    if (date.quality == u"estimated"_s) {
+        quality = GenealogicalDate::ESTIMATED;
+    } else if (date.quality == u"calculated"_s) {
+        quality = GenealogicalDate::CALCULATED;
+    }
 
-    for (const xmlNode* c = node->children; c; c = c->next) {
-        if (nodeNameIs(c, "noteref")) {
-            ref.noteHandles.append(attrStr(c, "hlink"));
-        } else if (nodeNameIs(c, "citationref")) {
-            ref.citationHandles.append(attrStr(c, "hlink"));
+    if (isInterval) {
+        const auto start = parseGrampsDateValue(date.start);
+        const auto stop = parseGrampsDateValue(date.stop);
+        if (!start || !stop) {
+            return textOnlyDate(original);
         }
+        return (date.type == u"daterange"_s ? GenealogicalDate::makeRange : GenealogicalDate::makeSpan)(
+            quality,
+            start->date,
+            true,
+            start->hasMonth,
+            start->hasDay,
+            stop->date,
+            true,
+            stop->hasMonth,
+            stop->hasDay
+        );
     }
 
-    return ref;
+    auto modifier = GenealogicalDate::NONE;
+    if (date.modifier == u"before"_s) {
+        modifier = GenealogicalDate::BEFORE;
+    } else if (date.modifier == u"after"_s) {
+        modifier = GenealogicalDate::AFTER;
+    } else if (date.modifier == u"about"_s) {
+        modifier = GenealogicalDate::ABOUT;
+    }
+    const auto point = parseGrampsDateValue(date.value);
+    if (!point) {
+        return textOnlyDate(original);
+    }
+    return {modifier, quality, point->date, true, point->hasMonth, point->hasDay, {}};
 }
 
-static GrampsMediaRef parseMediaRef(const xmlNode* node) {
-    GrampsMediaRef ref {
-        .mediaHandle = attrStr(node, "hlink"),
-    };
-
-    for (const xmlNode* c = node->children; c; c = c->next) {
-        if (nodeNameIs(c, "citationref")) {
-            ref.citationHandles.append(attrStr(c, "hlink"));
-        } else if (nodeNameIs(c, "noteref")) {
-            ref.noteHandles.append(attrStr(c, "hlink"));
-        }
+QString toSex(const QString& gender) {
+    if (gender == u"M"_s) {
+        return enumToString(Sex::Values::Male);
     }
-
-    return ref;
+    if (gender == u"F"_s) {
+        return enumToString(Sex::Values::Female);
+    }
+    return enumToString(Sex::Values::Unknown);
 }
 
-static GrampsPersonRef parsePersonRef(const xmlNode* node) {
-    GrampsPersonRef ref {
-        .personHandle = attrStr(node, "hlink"),
-        .relation = attrStr(node, "rel"),
-    };
-
-    for (const xmlNode* c = node->children; c; c = c->next) {
-        if (nodeNameIs(c, "citationref")) {
-            ref.citationHandles.append(attrStr(c, "hlink"));
-        } else if (nodeNameIs(c, "noteref")) {
-            ref.noteHandles.append(attrStr(c, "hlink"));
-        }
+QString toConfidence(const QString& confidence) {
+    bool ok = false;
+    const auto value = confidence.toInt(&ok);
+    // Gramps goes from very low (0) to very high (4), like Opa.
+    const auto veryLow = qToUnderlying(Confidence::Values::VeryLow);
+    const auto veryHigh = qToUnderlying(Confidence::Values::VeryHigh);
+    if (!ok || value < veryLow || value > veryHigh) {
+        return enumToString(Confidence::Values::Unknown);
     }
-
-    return ref;
+    return enumToString(static_cast<Confidence::Values>(value));
 }
 
-static GrampsChildRef parseChildRef(const xmlNode* node) {
-    GrampsChildRef ref {
-        .personHandle = attrStr(node, "hlink"),
-        .motherRelationType = attrStr(node, "mrel"),
-        .fatherRelationType = attrStr(node, "frel"),
-    };
+/**
+ * The role of a parent of a child in a family, from the relation of the child to that parent.
+ */
+EventRoles::Values toParentRole(const QString& relation, EventRoles::Values biological) {
+    if (relation.isEmpty() || relation == u"Birth"_s) {
+        return biological;
+    }
+    if (relation == u"Adopted"_s) {
+        return EventRoles::Values::AdoptiveParent;
+    }
+    if (relation == u"Stepchild"_s) {
+        return EventRoles::Values::Stepparent;
+    }
+    if (relation == u"Foster"_s) {
+        return EventRoles::Values::FosterParent;
+    }
+    return EventRoles::Values::RecognizedParent;
+}
 
-    for (const xmlNode* c = node->children; c; c = c->next) {
-        if (nodeNameIs(c, "citationref")) {
-            ref.citationHandles.append(attrStr(c, "hlink"));
-        } else if (nodeNameIs(c, "noteref")) {
-            ref.noteHandles.append(attrStr(c, "hlink"));
+/**
+ * The prefix and surname of a name. Names with more than one surname get all of them, in order.
+ */
+std::pair<QString, QString> toPrefixAndSurname(const QList<GrampsSurname>& surnames) {
+    if (surnames.isEmpty()) {
+        return {};
+    }
+    const auto primary = std::ranges::find_if(surnames, &GrampsSurname::isPrimary);
+    const auto& prefixed = primary == surnames.end() ? surnames.first() : *primary;
+    QStringList parts;
+    for (const auto& surname: surnames) {
+        if (&surname != &prefixed && !surname.prefix.isEmpty()) {
+            parts.append(surname.prefix);
+        }
+        parts.append(surname.surname);
+        if (!surname.connector.isEmpty()) {
+            parts.append(surname.connector);
         }
     }
+    return {prefixed.prefix, parts.join(u' ')};
+}
+
+/**
+ * A record with the values of its rows, which are converted before the record is imported.
+ */
+struct GrampsRow {
+    GrampsRecord record;
+    // The values of the row of the record, by placeholder. The ids are only known when importing.
+    QVariantMap values;
+    // The values of the names of a person.
+    QList<QVariantMap> names;
+    // The date of an event, bound to its columns when importing.
+    std::optional<GenealogicalDate::Stored> date;
+};
 
-    return ref;
+QVariant orNull(const QString& value) {
+    return value.isEmpty() ? QVariant() : value;
 }
 
-static GrampsSrcAttribute parseSrcAttribute(const xmlNode* node) {
+QVariantMap
+sourceValues(const QString& title, const QString& author, const QString& publication, const QString& confidence) {
     return {
-        .type = attrStr(node, "type"),
-        .value = attrStr(node, "value"),
+        {u":title"_s, title},
+        {u":author"_s, orNull(author)},
+        {u":publication"_s, orNull(publication)},
+        {u":confidence"_s, confidence},
     };
 }
 
-static GrampsRepositoryRef parseRepositoryRef(const xmlNode* node) {
-    GrampsRepositoryRef ref {
-        .repositoryHandle = attrStr(node, "hlink"),
-        .callNumber = attrStr(node, "callno"),
-        .medium = attrStr(node, "medium"),
+QVariantMap valuesOf(const GrampsPlace& place) {
+    return {
+        {u":name"_s, place.names.isEmpty() ? place.title : place.names.first().value},
+        {u":latitude"_s, place.hasCoordinates ? QVariant(place.latitude) : QVariant()},
+        {u":longitude"_s, place.hasCoordinates ? QVariant(place.longitude) : QVariant()},
     };
+}
 
-    for (const xmlNode* c = node->children; c; c = c->next) {
-        if (nodeNameIs(c, "noteref")) {
-            ref.noteHandles.append(attrStr(c, "hlink"));
-        }
-    }
+QVariantMap valuesOf(const GrampsEvent& event) {
+    return {{u":name"_s, orNull(event.description)}};
+}
 
-    return ref;
+QVariantMap valuesOf(const GrampsPerson& person) {
+    return {{u":sex"_s, toSex(person.sex)}};
 }
 
-static GrampsPerson parsePerson(const xmlNode* node) {
-    GrampsPerson person {
-        .handle = attrStr(node, "handle"),
-        .id = attrStr(node, "id"),
-    };
+QVariantMap valuesOf(const GrampsCitation& citation) {
+    // A citation is a source in Opa, with the cited source as its parent.
+    return sourceValues(citation.page, {}, {}, toConfidence(citation.confidence));
+}
 
-    for (const xmlNode* c = node->children; c; c = c->next) {
-        if (nodeNameIs(c, "gender")) {
-            person.sex = textContent(c);
-        } else if (nodeNameIs(c, "name")) {
-            person.names.append(parseName(c));
-        } else if (nodeNameIs(c, "eventref")) {
-            person.eventRefs.append(parseEventRef(c));
-        } else if (nodeNameIs(c, "objref")) {
-            person.mediaRefs.append(parseMediaRef(c));
-        } else if (nodeNameIs(c, "personref")) {
-            person.personRefs.append(parsePersonRef(c));
-        } else if (nodeNameIs(c, "noteref")) {
-            person.noteHandles.append(attrStr(c, "hlink"));
-        } else if (nodeNameIs(c, "citationref")) {
-            person.citationHandles.append(attrStr(c, "hlink"));
-        }
-    }
+QVariantMap valuesOf(const GrampsSource& source) {
+    const auto unknown = enumToString(Confidence::Values::Unknown);
+    return sourceValues(source.title, source.author, source.publicationInfo, unknown);
+}
 
-    return person;
+QVariantMap valuesOf(const GrampsRepository& repository) {
+    return sourceValues(repository.name, {}, {}, enumToString(Confidence::Values::Unknown));
 }
 
-static GrampsFamily parseFamily(const xmlNode* node) {
-    GrampsFamily family {
-        .handle = attrStr(node, "handle"),
-        .id = attrStr(node, "id"),
+QVariantMap valuesOf(const GrampsMedia& media) {
+    return {
+        {u":path"_s, media.filePath},
+        {u":mime_type"_s, media.mimeType.isEmpty() ? u"application/octet-stream"_s : media.mimeType},
+        {u":title"_s, media.description},
     };
+}
 
-    for (const xmlNode* c = node->children; c; c = c->next) {
-        if (nodeNameIs(c, "rel")) {
-            family.relationshipType = attrStr(c, "type");
-        } else if (nodeNameIs(c, "father")) {
-            family.fatherHandle = attrStr(c, "hlink");
-        } else if (nodeNameIs(c, "mother")) {
-            family.motherHandle = attrStr(c, "hlink");
-        } else if (nodeNameIs(c, "eventref")) {
-            family.eventRefs.append(parseEventRef(c));
-        } else if (nodeNameIs(c, "childref")) {
-            family.childRefs.append(parseChildRef(c));
-        } else if (nodeNameIs(c, "objref")) {
-            family.mediaRefs.append(parseMediaRef(c));
-        } else if (nodeNameIs(c, "noteref")) {
-            family.noteHandles.append(attrStr(c, "hlink"));
-        } else if (nodeNameIs(c, "citationref")) {
-            family.citationHandles.append(attrStr(c, "hlink"));
-        } else if (isDateNode(c)) {
-            family.date = parseDate(c);
-        }
-    }
+QVariantMap valuesOf(const auto&) {
+    return {};
+}
 
-    return family;
+QList<QVariantMap> namesOf(const GrampsRecord& record) {
+    const auto* person = std::get_if<GrampsPerson>(&record);
+    if (person == nullptr) {
+        return {};
+    }
+    QList<QVariantMap> names;
+    names.reserve(person->names.size());
+    for (int i = 0; i < person->names.size(); ++i) {
+        const auto& name = person->names[i];
+        const auto [prefix, surname] = toPrefixAndSurname(name.surnames);
+        names.append({
+            {u":sort"_s, i + 1},
+            {u":titles"_s, name.title},
+            {u":given_names"_s, name.givenNames},
+            {u":prefix"_s, prefix},
+            {u":surname"_s, surname},
+        });
+    }
+    return names;
 }
 
-static GrampsEvent parseEvent(const xmlNode* node) {
-    GrampsEvent event {
-        .handle = attrStr(node, "handle"),
-        .id = attrStr(node, "id"),
+GrampsRow toRow(GrampsXmlReader::RecordTree&& tree) {
+    auto record = tree.parse();
+    auto values = std::visit([](const auto& value) { return valuesOf(value); }, record);
+    auto names = namesOf(record);
+    std::optional<GenealogicalDate::Stored> date;
+    if (const auto* event = std::get_if<GrampsEvent>(&record)) {
+        date = toGenealogicalDate(event->date).toStored();
+    }
+    return {
+        .record = std::move(record),
+        .values = std::move(values),
+        .names = std::move(names),
+        .date = std::move(date),
     };
+}
 
-    for (const xmlNode* c = node->children; c; c = c->next) {
-        if (nodeNameIs(c, "type")) {
-            event.type = textContent(c);
-        } else if (nodeNameIs(c, "place")) {
-            event.placeHandle = attrStr(c, "hlink");
-        } else if (nodeNameIs(c, "description")) {
-            event.description = textContent(c);
-        } else if (nodeNameIs(c, "objref")) {
-            event.mediaRefs.append(parseMediaRef(c));
-        } else if (nodeNameIs(c, "noteref")) {
-            event.noteHandles.append(attrStr(c, "hlink"));
-        } else if (nodeNameIs(c, "citationref")) {
-            event.citationHandles.append(attrStr(c, "hlink"));
-        } else if (isDateNode(c)) {
-            event.date = parseDate(c);
-        }
+/**
+ * Inserts the records of a Gramps file as they are read.
+ *
+ * Only the database ids of the records are kept, by their handle, to resolve the references between
+ * records. A reference to a record that was read before is written right away. A Gramps file has
+ * its records in a fixed order (events, people, families, citations, sources, places, media,
+ * repositories and notes), so references to later records, e.g. from an event to its place, wait
+ * until all records are read. They are then linked in the order of their dependencies: places,
+ * events, citations and media.
+ */
+class GrampsImporter {
+public:
+    explicit GrampsImporter(const QSqlDatabase& db) :
+        db(db),
+        eventTypes(db, u"event_types"_s, u"type"_s),
+        eventRoles(db, u"event_roles"_s, u"role"_s),
+        locationTypes(db, u"location_types"_s, u"type"_s),
+        nameOrigins(db, u"name_origins"_s, u"origin"_s),
+        sourceTypes(db, u"source_types"_s, u"type"_s),
+        insertPlace(db),
+        insertEvent(db),
+        insertPerson(db),
+        insertName(db),
+        insertEventRelation(db),
+        insertFamily(db),
+        setEventFamily(db),
+        findBirthEvent(db),
+        insertBirthEvent(db),
+        insertSource(db),
+        insertMedia(db),
+        locationParent {QSqlQuery(db), &locationIdByHandle},
+        eventLocation {QSqlQuery(db), &locationIdByHandle},
+        citationSource {QSqlQuery(db), &sourceIdByHandle},
+        sourceRepository {QSqlQuery(db), &sourceIdByRepositoryHandle},
+        eventCitation {QSqlQuery(db), &sourceIdByCitationHandle},
+        eventRelationCitation {QSqlQuery(db), &sourceIdByCitationHandle},
+        nameCitation {QSqlQuery(db), &sourceIdByCitationHandle},
+        personCitation {QSqlQuery(db), &sourceIdByCitationHandle},
+        personMedia {QSqlQuery(db), &mediaIdByHandle},
+        eventMedia {QSqlQuery(db), &mediaIdByHandle},
+        locationMedia {QSqlQuery(db), &mediaIdByHandle},
+        sourceMedia {QSqlQuery(db), &mediaIdByHandle} {
     }
 
-    return event;
-}
+    GrampsImporter(const GrampsImporter&) = delete;
+    GrampsImporter& operator=(const GrampsImporter&) = delete;
+
+    bool prepare() {
+        const auto dateColumns = DateColumns<u"date">::select(u"events").remove(u"events."_s);
+        const auto datePlaceholders = u':' + dateColumns.split(u", "_s).join(u", :"_s);
+
+        const auto prepared =
+            eventTypes.prepare() && eventRoles.prepare() && locationTypes.prepare() && nameOrigins.prepare() &&
+            sourceTypes.prepare() &&
+            prepareStatement(
+                insertPlace,
+                u"INSERT INTO locations (name, type_id, latitude, longitude) "
+                "VALUES (:name, :type_id, :latitude, :longitude)"_s
+            ) &&
+            prepareStatement(
+                insertEvent,
+                u"INSERT INTO events (type_id, name, %1) VALUES (:type_id, :name, %2)"_s.arg(
+                    dateColumns,
+                    datePlaceholders
+                )
+            ) &&
+            prepareStatement(insertPerson, u"INSERT INTO people (root, sex) VALUES (FALSE, :sex)"_s) &&
+            prepareStatement(
+                insertName,
+                u"INSERT INTO names (person_id, sort, titles, given_names, prefix, surname, origin_id) "
+                "VALUES (:person_id, :sort, :titles, :given_names, :prefix, :surname, :origin_id)"_s
+            ) &&
+            prepareStatement(
+                insertEventRelation,
+                u"INSERT OR IGNORE INTO event_relations (event_id, person_id, role_id) "
+                "VALUES (:event_id, :person_id, :role_id)"_s
+            ) &&
+            prepareStatement(insertFamily, u"INSERT INTO families DEFAULT VALUES"_s) &&
+            prepareStatement(
+                setEventFamily,
+                u"UPDATE events SET family_id = coalesce(family_id, :family_id) WHERE id = :id"_s
+            ) &&
+            prepareStatement(
+                findBirthEvent,
+                u"SELECT min(event_id) FROM event_relations "
+                "WHERE person_id = :person_id AND role_id = :primary "
+                "AND event_id IN (SELECT id FROM events WHERE type_id = :birth)"_s
+            ) &&
+            prepareStatement(insertBirthEvent, u"INSERT INTO events (type_id) VALUES (:type_id)"_s) &&
+            prepareStatement(
+                insertSource,
+                u"INSERT INTO sources (title, type_id, author, publication, confidence) "
+                "VALUES (:title, :type_id, :author, :publication, :confidence)"_s
+            ) &&
+            prepareStatement(
+                insertMedia,
+                u"INSERT INTO media (path, mime_type, title) VALUES (:path, :mime_type, :title)"_s
+            ) &&
+            prepareLink(locationParent, u"UPDATE locations SET parent_id = :target WHERE id = :id"_s) &&
+            prepareLink(eventLocation, u"UPDATE events SET location_id = :target WHERE id = :id"_s) &&
+            prepareLink(citationSource, u"UPDATE sources SET parent_id = :target WHERE id = :id"_s) &&
+            prepareLink(sourceRepository, u"UPDATE sources SET parent_id = :target WHERE id = :id"_s) &&
+            prepareLink(eventCitation, junctionSql(u"event_citations"_s, u"event_id"_s, u"source_id"_s)) &&
+            prepareLink(
+                eventRelationCitation,
+                junctionSql(u"event_relation_citations"_s, u"event_relation_id"_s, u"source_id"_s)
+            ) &&
+            prepareLink(nameCitation, junctionSql(u"name_citations"_s, u"name_id"_s, u"source_id"_s)) &&
+            prepareLink(personCitation, junctionSql(u"person_citations"_s, u"person_id"_s, u"source_id"_s)) &&
+            prepareLink(personMedia, junctionSql(u"person_media"_s, u"person_id"_s, u"media_id"_s)) &&
+            prepareLink(eventMedia, junctionSql(u"event_media"_s, u"event_id"_s, u"media_id"_s)) &&
+            prepareLink(locationMedia, junctionSql(u"location_media"_s, u"location_id"_s, u"media_id"_s)) &&
+            prepareLink(sourceMedia, junctionSql(u"source_media"_s, u"source_id"_s, u"media_id"_s));
+        if (!prepared) {
+            return false;
+        }
 
-static GrampsPlace parsePlace(const xmlNode* node) {
-    GrampsPlace place {
-        .handle = attrStr(node, "handle"),
-        .id = attrStr(node, "id"),
-        .type = attrStr(node, "type"),
-    };
+        for (const auto type: EXTERNAL_IDS) {
+            const auto [table, column] = externalIdTable(type);
+            const auto sql = u"INSERT INTO %1 (%2, type, external_id) VALUES (:id, :type, :external_id)"_s;
+            if (!prepareStatement(*insertExternalIds.insert(type, QSqlQuery(db)), sql.arg(table, column))) {
+                return false;
+            }
+        }
+        for (const auto table: NOTE_TABLES) {
+            const auto sql = u"UPDATE %1 SET note = coalesce(note || char(10), '') || :text WHERE id = :id"_s;
+            if (!prepareStatement(*appendNotes.insert(table, QSqlQuery(db)), sql.arg(noteTableName(table)))) {
+                return false;
+            }
+        }
 
-    for (const xmlNode* c = node->children; c; c = c->next) {
-        if (nodeNameIs(c, "ptitle")) {
-            place.title = textContent(c);
-        } else if (nodeNameIs(c, "code")) {
-            place.code = textContent(c);
-        } else if (nodeNameIs(c, "pname")) {
-            GrampsPlaceName name {
-                .value = attrStr(c, "value"),
-                .language = attrStr(c, "lang"),
-            };
-            for (const xmlNode* d = c->children; d; d = d->next) {
-                if (isDateNode(d)) {
-                    name.date = parseDate(d);
-                }
+        const auto roleOrNothing = [this](EventRoles::Values role) {
+            return eventRoles.idOf(enumToString(role));
+        };
+        for (const auto role: EventRoles::parentRoles()) {
+            if (const auto id = roleOrNothing(role)) {
+                parentRoleIds.insert(role, *id);
             }
-            place.names.append(name);
-        } else if (nodeNameIs(c, "coord")) {
-            place.latitude = attrStr(c, "lat").toDouble();
-            place.longitude = attrStr(c, "long").toDouble();
-            place.hasCoordinates = true;
-        } else if (nodeNameIs(c, "placeref")) {
-            place.parentHandles.append(attrStr(c, "hlink"));
-        } else if (nodeNameIs(c, "location")) {
-            // TODO
-        } else if (nodeNameIs(c, "objref")) {
-            place.mediaRefs.append(parseMediaRef(c));
-        } else if (nodeNameIs(c, "noteref")) {
-            place.noteHandles.append(attrStr(c, "hlink"));
-        } else if (nodeNameIs(c, "citationref")) {
-            place.citationHandles.append(attrStr(c, "hlink"));
         }
+        primaryRoleId = roleOrNothing(EventRoles::Values::Primary);
+        partnerRoleId = roleOrNothing(EventRoles::Values::Partner);
+        birthTypeId = eventTypes.idOf(enumToString(EventTypes::Values::Birth));
+        return primaryRoleId && partnerRoleId && birthTypeId;
     }
 
-    return place;
-}
-
-static GrampsNote parseNote(const xmlNode* node) {
-    GrampsNote note {
-        .handle = attrStr(node, "handle"),
-        .id = attrStr(node, "id"),
-        .type = attrStr(node, "type"),
-    };
+    bool add(const GrampsRow& row) {
+        return std::visit([this, &row](const auto& record) { return add(record, row); }, row.record);
+    }
 
-    for (const xmlNode* c = node->children; c; c = c->next) {
-        if (nodeNameIs(c, "text")) {
-            note.text = textContent(c);
+    /**
+     * Link the references that waited for records that came later in the file.
+     */
+    bool finish(QPromise<bool>& promise, ChunkedTransaction& transaction) {
+        // In the order of their dependencies.
+        for (auto* statement: {
+                 &locationParent,
+                 &eventLocation,
+                 &citationSource,
+                 &sourceRepository,
+                 &eventCitation,
+                 &eventRelationCitation,
+                 &nameCitation,
+                 &personCitation,
+                 &personMedia,
+                 &eventMedia,
+                 &locationMedia,
+                 &sourceMedia,
+             }) {
+            for (const auto& [id, handle]: std::exchange(statement->pending, {})) {
+                if (promise.isCanceled()) {
+                    return false;
+                }
+                const auto target = statement->targets->constFind(handle);
+                if (target == statement->targets->cend()) {
+                    qWarning() << "Reference to an unknown record" << handle;
+                    continue;
+                }
+                if (!execLink(*statement, id, *target) || !transaction.step()) {
+                    return false;
+                }
+            }
         }
+        if (!noteTargets.isEmpty()) {
+            qWarning() << "References to" << noteTargets.size() << "unknown notes";
+        }
+        return true;
     }
 
-    return note;
-}
-
-static GrampsCitation parseCitation(const xmlNode* node) {
-    GrampsCitation citation {
-        .handle = attrStr(node, "handle"),
-        .id = attrStr(node, "id"),
-    };
-
-    for (const xmlNode* c = node->children; c; c = c->next) {
-        if (nodeNameIs(c, "page")) {
-            citation.page = textContent(c);
-        } else if (nodeNameIs(c, "confidence")) {
-            citation.confidence = textContent(c);
-        } else if (nodeNameIs(c, "sourceref")) {
-            citation.sourceHandle = attrStr(c, "hlink");
-        } else if (nodeNameIs(c, "objref")) {
-            citation.mediaRefs.append(parseMediaRef(c));
-        } else if (nodeNameIs(c, "srcattribute")) {
-            citation.sourceAttributes.append(parseSrcAttribute(c));
-        } else if (nodeNameIs(c, "sourceref")) {
-            citation.sourceHandle = attrStr(c, "hlink");
-        } else if (isDateNode(c)) {
-            citation.date = parseDate(c);
+    /**
+     * Delete the records of an import that failed or was canceled, including those in the chunks
+     * that were already committed, and commit that.
+     *
+     * The rows of the records, e.g. names and citations, are deleted with them.
+     *
+     * @return False if the committed records could not be deleted, so they are still in the database.
+     */
+    bool removeImported(ChunkedTransaction& transaction) {
+        // Deleting in the open chunk, so no other connection can reuse the ids of its rows.
+        if (!transaction.isOpen() && !transaction.begin()) {
+            return false;
+        }
+        for (const auto& [table, ids]: importedIds.asKeyValueRange()) {
+            QStringList idList;
+            idList.reserve(ids.size());
+            for (const auto id: ids) {
+                idList.append(QString::number(id));
+            }
+            QSqlQuery remove(db);
+            if (!remove.prepare(u"DELETE FROM %1 WHERE id IN (SELECT value FROM json_each(:ids))"_s.arg(table))) {
+                qCritical() << "Failed to prepare removing imported" << table << remove.lastError().text();
+                return false;
+            }
+            remove.bindValue(u":ids"_s, u"["_s + idList.join(u',') + u"]"_s);
+            if (!remove.exec()) {
+                qCritical() << "Failed to remove imported" << table << remove.lastError().text();
+                return false;
+            }
         }
+        return transaction.commit();
     }
 
-    return citation;
-}
-
-static GrampsSource parseSource(const xmlNode* node) {
-    GrampsSource source {
-        .handle = attrStr(node, "handle"),
-        .id = attrStr(node, "id"),
-    };
-
-    for (const xmlNode* c = node->children; c; c = c->next) {
-        if (nodeNameIs(c, "stitle")) {
-            source.title = textContent(c);
-        } else if (nodeNameIs(c, "sauthor")) {
-            source.author = textContent(c);
-        } else if (nodeNameIs(c, "spubinfo")) {
-            source.publicationInfo = textContent(c);
-        } else if (nodeNameIs(c, "sabbrev")) {
-            source.abbreviation = textContent(c);
-        } else if (nodeNameIs(c, "noteref")) {
-            source.noteHandles.append(attrStr(c, "hlink"));
-        } else if (nodeNameIs(c, "objref")) {
-            source.mediaRefs.append(parseMediaRef(c));
-        } else if (nodeNameIs(c, "srcattribute")) {
-            source.sourceAttributes.append(parseSrcAttribute(c));
-        } else if (nodeNameIs(c, "reporef")) {
-            source.repositoryRefs.append(parseRepositoryRef(c));
+private:
+    bool add(const GrampsPlace& place, const GrampsRow& row) {
+        bindValues(insertPlace, row.values);
+        insertPlace.bindValue(u":type_id"_s, orNull(locationTypes.idOf(place.type)));
+        const auto id = execInsert(insertPlace, place.id);
+        if (!id) {
+            return false;
         }
+        locationIdByHandle.insert(place.handle, *id);
+        importedIds[u"locations"_s].append(*id);
+        addNoteTargets(place.noteHandles, NoteTable::LOCATIONS, *id);
+        // Opa has one parent per location.
+        const auto parent = place.parentHandles.isEmpty() ? QString() : place.parentHandles.first();
+        return addExternalId(ExternalId::LOCATION, *id, place.id) && link(locationParent, *id, parent) &&
+               linkAll(locationMedia, *id, mediaHandles(place.mediaRefs));
     }
 
-    return source;
-}
-
-// Called object-content in the XML
-static GrampsMedia parseMedia(const xmlNode* node) {
-    GrampsMedia media {
-        .handle = attrStr(node, "handle"),
-        .id = attrStr(node, "id"),
-    };
-
-    for (const xmlNode* c = node->children; c; c = c->next) {
-        if (nodeNameIs(c, "file")) {
-            media.filePath = attrStr(c, "src");
-            media.mimeType = attrStr(c, "mime");
-            media.checksum = attrStr(c, "checksum");
-            media.description = attrStr(c, "description");
-        } else if (nodeNameIs(c, "noteref")) {
-            media.noteHandles.append(attrStr(c, "hlink"));
-        } else if (nodeNameIs(c, "citationref")) {
-            media.citationHandles.append(attrStr(c, "hlink"));
-        } else if (isDateNode(c)) {
-            media.date = parseDate(c);
+    bool add(const GrampsEvent& event, const GrampsRow& row) {
+        // Every event needs a type.
+        const auto typeId = eventTypes.idOf(event.type.isEmpty() ? u"Unknown"_s : event.type);
+        if (!typeId) {
+            return false;
         }
+        bindValues(insertEvent, row.values);
+        DateColumns<u"date">::bind(insertEvent, row.date);
+        insertEvent.bindValue(u":type_id"_s, *typeId);
+        const auto id = execInsert(insertEvent, event.id);
+        if (!id) {
+            return false;
+        }
+        eventIdByHandle.insert(event.handle, *id);
+        importedIds[u"events"_s].append(*id);
+        addNoteTargets(event.noteHandles, NoteTable::EVENTS, *id);
+        return addExternalId(ExternalId::EVENT, *id, event.id) && link(eventLocation, *id, event.placeHandle) &&
+               linkAll(eventCitation, *id, event.citationHandles) &&
+               linkAll(eventMedia, *id, mediaHandles(event.mediaRefs));
     }
 
-    return media;
-}
-
-static GrampsRepository parseRepository(const xmlNode* node) {
-    GrampsRepository repository {
-        .handle = attrStr(node, "handle"),
-        .id = attrStr(node, "id"),
-    };
-
-    for (const xmlNode* c = node->children; c; c = c->next) {
-        if (nodeNameIs(c, "rname")) {
-            repository.name = textContent(c);
-        } else if (nodeNameIs(c, "type")) {
-            repository.type = textContent(c);
-        } else if (nodeNameIs(c, "noteref")) {
-            repository.noteHandles.append(attrStr(c, "hlink"));
+    bool add(const GrampsPerson& person, const GrampsRow& row) {
+        bindValues(insertPerson, row.values);
+        const auto id = execInsert(insertPerson, person.id);
+        if (!id) {
+            return false;
+        }
+        personIdByHandle.insert(person.handle, *id);
+        importedIds[u"people"_s].append(*id);
+        if (!addExternalId(ExternalId::PERSON, *id, person.id) ||
+            !linkAll(personCitation, *id, person.citationHandles) ||
+            !linkAll(personMedia, *id, mediaHandles(person.mediaRefs))) {
+            return false;
         }
-    }
 
-    return repository;
-}
+        for (int i = 0; i < person.names.size(); ++i) {
+            const auto& name = person.names[i];
+            const auto origin = name.surnames.isEmpty() ? QString() : name.surnames.first().derivation;
+            bindValues(insertName, row.names[i]);
+            insertName.bindValue(u":person_id"_s, *id);
+            insertName.bindValue(u":origin_id"_s, orNull(nameOrigins.idOf(origin)));
+            const auto nameId = execInsert(insertName, person.id);
+            if (!nameId) {
+                return false;
+            }
+            addNoteTargets(name.noteHandles, NoteTable::NAMES, *nameId);
+            // People have no note, so their notes go to their first name.
+            if (i == 0) {
+                addNoteTargets(person.noteHandles, NoteTable::NAMES, *nameId);
+            }
+            if (!linkAll(nameCitation, *nameId, name.citationHandles)) {
+                return false;
+            }
+        }
 
-static GrampsData parseGrampsData(QPromise<bool>& promise, int& progress, const GrampsXmlRoot& root) {
-    const xmlNode* db = xmlDocGetRootElement(root.get());
-    if (!db) {
-        return {};
+        for (const auto& ref: person.eventRefs) {
+            const auto eventId = eventIdByHandle.constFind(ref.eventHandle);
+            if (eventId == eventIdByHandle.cend()) {
+                qWarning() << "Person" << person.id << "refers to an unknown event" << ref.eventHandle;
+                continue;
+            }
+            const auto role = ref.role.isEmpty() ? enumToString(EventRoles::Values::Primary) : ref.role;
+            const auto roleId = eventRoles.idOf(role);
+            if (!roleId) {
+                return false;
+            }
+            const auto relationId = addEventRelation(*eventId, *id, *roleId);
+            if (!relationId.has_value()) {
+                return false;
+            }
+            if (*relationId && !linkAll(eventRelationCitation, **relationId, ref.citationHandles)) {
+                return false;
+            }
+        }
+        return true;
     }
 
-    GrampsData data;
+    bool add(const GrampsFamily& family, const GrampsRow&) {
+        const auto id = execInsert(insertFamily, family.id);
+        if (!id) {
+            return false;
+        }
+        importedIds[u"families"_s].append(*id);
+        addNoteTargets(family.noteHandles, NoteTable::FAMILIES, *id);
+        if (!addExternalId(ExternalId::FAMILY, *id, family.id)) {
+            return false;
+        }
 
-    for (const xmlNode* c = db->children; c; c = c->next) {
-        // TODO: remove this maybe?
-        QThread::msleep(10);
-        if (nodeNameIs(c, "people")) {
-            for (const xmlNode* d = c->children; d; d = d->next) {
-                if (d->type == XML_ELEMENT_NODE) {
-                    promise.setProgressValueAndText(progress++, i18n("Parsing people"));
-                    auto person = parsePerson(d);
-                    data.people.insert(person.id, person);
-                }
+        // The people come before the families in a Gramps file.
+        const auto father = personIdByHandle.constFind(family.fatherHandle);
+        const auto mother = personIdByHandle.constFind(family.motherHandle);
+        const auto hasFather = father != personIdByHandle.cend();
+        const auto hasMother = mother != personIdByHandle.cend();
+
+        // The partners are the primary and the partner of the events of the family, e.g. the marriage.
+        for (const auto& ref: family.eventRefs) {
+            const auto eventId = eventIdByHandle.constFind(ref.eventHandle);
+            if (eventId == eventIdByHandle.cend()) {
+                qWarning() << "Family" << family.id << "refers to an unknown event" << ref.eventHandle;
+                continue;
             }
-        } else if (nodeNameIs(c, "families")) {
-            for (const xmlNode* d = c->children; d; d = d->next) {
-                if (d->type == XML_ELEMENT_NODE) {
-                    promise.setProgressValueAndText(progress++, i18n("Parsing families"));
-                    auto family = parseFamily(d);
-                    data.families.insert(family.id, family);
-                }
+            if (!setFamily(*eventId, *id)) {
+                return false;
             }
-        } else if (nodeNameIs(c, "events")) {
-            for (const xmlNode* d = c->children; d; d = d->next) {
-                if (d->type == XML_ELEMENT_NODE) {
-                    promise.setProgressValueAndText(progress++, i18n("Parsing events"));
-                    auto event = parseEvent(d);
-                    data.events.insert(event.id, event);
-                }
+            if (hasFather && !addEventRelation(*eventId, *father, *primaryRoleId)) {
+                return false;
             }
-        } else if (nodeNameIs(c, "sources")) {
-            for (const xmlNode* d = c->children; d; d = d->next) {
-                if (d->type == XML_ELEMENT_NODE) {
-                    promise.setProgressValueAndText(progress++, i18n("Parsing sources"));
-                    auto source = parseSource(d);
-                    data.sources.insert(source.id, source);
-                }
-            }
-        } else if (nodeNameIs(c, "places")) {
-            for (const xmlNode* d = c->children; d; d = d->next) {
-                if (d->type == XML_ELEMENT_NODE) {
-                    promise.setProgressValueAndText(progress++, i18n("Parsing places"));
-                    auto place = parsePlace(d);
-                    data.places.insert(place.id, place);
-                }
+            const auto motherRole = hasFather ? *partnerRoleId : *primaryRoleId;
+            if (hasMother && !addEventRelation(*eventId, *mother, motherRole)) {
+                return false;
             }
-        } else if (nodeNameIs(c, "citations")) {
-            for (const xmlNode* d = c->children; d; d = d->next) {
-                if (d->type == XML_ELEMENT_NODE) {
-                    promise.setProgressValueAndText(progress++, i18n("Parsing citations"));
-                    auto citation = parseCitation(d);
-                    data.citations.insert(citation.id, citation);
-                }
+        }
+
+        // The parents are linked to the birth event of each child.
+        for (const auto& ref: family.childRefs) {
+            const auto child = personIdByHandle.constFind(ref.personHandle);
+            if (child == personIdByHandle.cend()) {
+                qWarning() << "Family" << family.id << "refers to an unknown child" << ref.personHandle;
+                continue;
             }
-        } else if (nodeNameIs(c, "objects")) {
-            for (const xmlNode* d = c->children; d; d = d->next) {
-                if (d->type == XML_ELEMENT_NODE) {
-                    promise.setProgressValueAndText(progress++, i18n("Parsing media"));
-                    auto media = parseMedia(d);
-                    data.media.insert(media.id, media);
-                }
+            const auto birthEventId = birthEventOf(*child);
+            if (!birthEventId || !setFamily(*birthEventId, *id)) {
+                return false;
             }
-        } else if (nodeNameIs(c, "repositories")) {
-            for (const xmlNode* d = c->children; d; d = d->next) {
-                if (d->type == XML_ELEMENT_NODE) {
-                    promise.setProgressValueAndText(progress++, i18n("Parsing repositories"));
-                    auto repository = parseRepository(d);
-                    data.repositories.insert(repository.id, repository);
-                }
+            const auto fatherRole = toParentRole(ref.fatherRelationType, EventRoles::Values::Father);
+            if (hasFather && !addParent(*birthEventId, *father, fatherRole)) {
+                return false;
             }
-        } else if (nodeNameIs(c, "notes")) {
-            for (const xmlNode* d = c->children; d; d = d->next) {
-                if (d->type == XML_ELEMENT_NODE) {
-                    promise.setProgressValueAndText(progress++, i18n("Parsing notes"));
-                    auto note = parseNote(d);
-                    data.notesById.insert(note.id, note);
-                    data.notesByHandle.insert(note.handle, note);
-                }
+            const auto motherRole = toParentRole(ref.motherRelationType, EventRoles::Values::Mother);
+            if (hasMother && !addParent(*birthEventId, *mother, motherRole)) {
+                return false;
             }
         }
+        return true;
     }
 
-    return data;
-}
-
-static std::optional<QHash<QString, IntegerPrimaryKey>>
-importMedia(QPromise<bool>& promise, int& progress, const GrampsData& data, const QSqlDatabase& db) {
-    QSqlQuery insert(db);
-    if (!insert.prepare(
-            u"INSERT INTO media (path, mime_type, title, note) VALUES (:path, :mime_type, :title, :note)"_s
-        )) {
-        qCritical() << "Failed to prepare media insert statement" << insert.lastError().text();
-        return {};
+    bool add(const GrampsCitation& citation, const GrampsRow& row) {
+        const auto id = addSource(row.values, std::nullopt, citation.id);
+        if (!id) {
+            return false;
+        }
+        sourceIdByCitationHandle.insert(citation.handle, *id);
+        addNoteTargets(citation.noteHandles, NoteTable::SOURCES, *id);
+        return link(citationSource, *id, citation.sourceHandle) &&
+               linkAll(sourceMedia, *id, mediaHandles(citation.mediaRefs));
     }
 
-    QSqlQuery externalIdInsert(db);
-    if (!externalIdInsert.prepare(
-            u"INSERT INTO media_external_id (media_id, type, external_id) VALUES (:media_id, :type, :external_id)"_s
-        )) {
-        qCritical() << "Failed to prepare media external id insert statement" << externalIdInsert.lastError().text();
-        return {};
+    bool add(const GrampsSource& source, const GrampsRow& row) {
+        const auto id = addSource(row.values, std::nullopt, source.id);
+        if (!id) {
+            return false;
+        }
+        sourceIdByHandle.insert(source.handle, *id);
+        addNoteTargets(source.noteHandles, NoteTable::SOURCES, *id);
+        // A source is in its repository, which is also a source in Opa.
+        const auto& refs = source.repositoryRefs;
+        const auto repository = refs.isEmpty() ? QString() : refs.first().repositoryHandle;
+        return link(sourceRepository, *id, repository) && linkAll(sourceMedia, *id, mediaHandles(source.mediaRefs));
     }
 
-    QHash<QString, IntegerPrimaryKey> mediaIdByHandle;
+    bool add(const GrampsMedia& media, const GrampsRow& row) {
+        bindValues(insertMedia, row.values);
+        const auto id = execInsert(insertMedia, media.id);
+        if (!id) {
+            return false;
+        }
+        mediaIdByHandle.insert(media.handle, *id);
+        importedIds[u"media"_s].append(*id);
+        addNoteTargets(media.noteHandles, NoteTable::MEDIA, *id);
+        return addExternalId(ExternalId::MEDIA, *id, media.id);
+    }
 
-    for (const auto& media: data.media) {
-        if (promise.isCanceled()) {
-            return {};
+    bool add(const GrampsRepository& repository, const GrampsRow& row) {
+        const auto id = addSource(row.values, sourceTypes.idOf(repository.type), repository.id);
+        if (!id) {
+            return false;
         }
-        promise.setProgressValueAndText(progress++, i18n("Importing media"));
+        sourceIdByRepositoryHandle.insert(repository.handle, *id);
+        addNoteTargets(repository.noteHandles, NoteTable::SOURCES, *id);
+        return true;
+    }
 
-        QStringList noteParts;
-        for (const auto& handle: media.noteHandles) {
-            if (const auto it = data.notesByHandle.constFind(handle); it != data.notesByHandle.constEnd()) {
-                noteParts.append(it->text);
+    bool add(const GrampsNote& note, const GrampsRow&) {
+        // The notes come after the records that refer to them, so their text is added afterwards.
+        for (const auto& [table, id]: noteTargets.take(note.handle)) {
+            auto& query = appendNotes[table];
+            query.bindValue(u":text"_s, note.text);
+            query.bindValue(u":id"_s, id);
+            if (!query.exec()) {
+                qCritical() << "Failed to add note" << note.id << query.lastError().text();
+                return false;
             }
         }
+        return true;
+    }
 
-        insert.bindValue(u":path"_s, media.filePath);
-        insert.bindValue(u":mime_type"_s, media.mimeType.isEmpty() ? u"application/octet-stream"_s : media.mimeType);
-        insert.bindValue(u":title"_s, media.description);
-        insert.bindValue(u":note"_s, noteParts.isEmpty() ? QVariant() : noteParts.join(u"\n"_s));
+    enum class ExternalId { PERSON, FAMILY, EVENT, LOCATION, SOURCE, MEDIA };
+    enum class NoteTable { NAMES, FAMILIES, EVENTS, LOCATIONS, SOURCES, MEDIA };
 
-        if (!insert.exec()) {
-            qCritical() << "Failed to insert media" << media.filePath << insert.lastError().text();
-            return {};
+    static constexpr std::array EXTERNAL_IDS = {
+        ExternalId::PERSON,
+        ExternalId::FAMILY,
+        ExternalId::EVENT,
+        ExternalId::LOCATION,
+        ExternalId::SOURCE,
+        ExternalId::MEDIA,
+    };
+    static constexpr std::array NOTE_TABLES = {
+        NoteTable::NAMES,
+        NoteTable::FAMILIES,
+        NoteTable::EVENTS,
+        NoteTable::LOCATIONS,
+        NoteTable::SOURCES,
+        NoteTable::MEDIA,
+    };
+
+    /**
+     * A statement linking a row to a record that is referred to by its handle, binding ":id" and ":target".
+     */
+    struct LinkStatement {
+        QSqlQuery query;
+        // The rows of the records that can be linked to, by their handle.
+        const QHash<QString, IntegerPrimaryKey>* targets;
+        // The links to records that were not read yet.
+        QList<std::pair<IntegerPrimaryKey, QString>> pending = {};
+    };
+
+    struct NoteTarget {
+        NoteTable table;
+        IntegerPrimaryKey id;
+    };
+
+    QSqlDatabase db;
+    TypeIds eventTypes;
+    TypeIds eventRoles;
+    TypeIds locationTypes;
+    TypeIds nameOrigins;
+    TypeIds sourceTypes;
+
+    std::optional<IntegerPrimaryKey> primaryRoleId;
+    std::optional<IntegerPrimaryKey> partnerRoleId;
+    std::optional<IntegerPrimaryKey> birthTypeId;
+    QHash<EventRoles::Values, IntegerPrimaryKey> parentRoleIds;
+
+    QSqlQuery insertPlace;
+    QSqlQuery insertEvent;
+    QSqlQuery insertPerson;
+    QSqlQuery insertName;
+    QSqlQuery insertEventRelation;
+    QSqlQuery insertFamily;
+    QSqlQuery setEventFamily;
+    QSqlQuery findBirthEvent;
+    QSqlQuery insertBirthEvent;
+    QSqlQuery insertSource;
+    QSqlQuery insertMedia;
+
+    QHash<QString, IntegerPrimaryKey> locationIdByHandle;
+    QHash<QString, IntegerPrimaryKey> eventIdByHandle;
+    QHash<QString, IntegerPrimaryKey> personIdByHandle;
+    QHash<QString, IntegerPrimaryKey> sourceIdByCitationHandle;
+    QHash<QString, IntegerPrimaryKey> sourceIdByHandle;
+    QHash<QString, IntegerPrimaryKey> sourceIdByRepositoryHandle;
+    QHash<QString, IntegerPrimaryKey> mediaIdByHandle;
+    // The rows of the records, by their table, to remove them if the import fails.
+    QHash<QString, QList<IntegerPrimaryKey>> importedIds;
+    // The rows waiting for the text of a note, by the handle of the note.
+    QHash<QString, QList<NoteTarget>> noteTargets;
+    // Prepared for this database in prepare().
+    QHash<ExternalId, QSqlQuery> insertExternalIds;
+    QHash<NoteTable, QSqlQuery> appendNotes;
+
+    LinkStatement locationParent;
+    LinkStatement eventLocation;
+    LinkStatement citationSource;
+    LinkStatement sourceRepository;
+    LinkStatement eventCitation;
+    LinkStatement eventRelationCitation;
+    LinkStatement nameCitation;
+    LinkStatement personCitation;
+    LinkStatement personMedia;
+    LinkStatement eventMedia;
+    LinkStatement locationMedia;
+    LinkStatement sourceMedia;
+
+    static bool prepareStatement(QSqlQuery& query, const QString& sql) {
+        if (!query.prepare(sql)) {
+            qCritical() << "Failed to prepare import statement" << sql << query.lastError().text();
+            return false;
         }
+        return true;
+    }
 
-        qlonglong insertedId = insert.lastInsertId().toLongLong();
-        mediaIdByHandle.insert(media.handle, insertedId);
+    static bool prepareLink(LinkStatement& statement, const QString& sql) {
+        return prepareStatement(statement.query, sql);
+    }
 
-        externalIdInsert.bindValue(u":media_id"_s, insertedId);
-        externalIdInsert.bindValue(u":type"_s, GRAMPS_ID);
-        externalIdInsert.bindValue(u":external_id"_s, media.id);
+    static QString junctionSql(const QString& table, const QString& column, const QString& targetColumn) {
+        return u"INSERT OR IGNORE INTO %1 (%2, %3) VALUES (:id, :target)"_s.arg(table, column, targetColumn);
+    }
 
-        if (!externalIdInsert.exec()) {
-            qCritical() << "Failed to insert media" << media.filePath << externalIdInsert.lastError().text();
-            return {};
+    static std::pair<QString, QString> externalIdTable(ExternalId type) {
+        switch (type) {
+            case ExternalId::PERSON:
+                return {u"person_external_ids"_s, u"person_id"_s};
+            case ExternalId::FAMILY:
+                return {u"family_external_ids"_s, u"family_id"_s};
+            case ExternalId::EVENT:
+                return {u"event_external_ids"_s, u"event_id"_s};
+            case ExternalId::LOCATION:
+                return {u"location_external_ids"_s, u"location_id"_s};
+            case ExternalId::SOURCE:
+                return {u"source_external_ids"_s, u"source_id"_s};
+            case ExternalId::MEDIA:
+                return {u"media_external_ids"_s, u"media_id"_s};
         }
+        Q_UNREACHABLE();
     }
 
-    return mediaIdByHandle;
-}
+    static QString noteTableName(NoteTable table) {
+        switch (table) {
+            case NoteTable::NAMES:
+                return u"names"_s;
+            case NoteTable::FAMILIES:
+                return u"families"_s;
+            case NoteTable::EVENTS:
+                return u"events"_s;
+            case NoteTable::LOCATIONS:
+                return u"locations"_s;
+            case NoteTable::SOURCES:
+                return u"sources"_s;
+            case NoteTable::MEDIA:
+                return u"media"_s;
+        }
+        Q_UNREACHABLE();
+    }
 
-static std::optional<QHash<QString, qlonglong>>
-importRepositorySource(QPromise<bool>& promise, int& progress, const GrampsData& data, const QSqlDatabase& db) {
-    QHash<QString, IntegerPrimaryKey> sourceIdByRepositoryHandle;
+    static QVariant orNull(const std::optional<IntegerPrimaryKey>& id) {
+        return id.has_value() ? QVariant(*id) : QVariant();
+    }
 
-    QSqlQuery insertRepository(db);
-    if (!insertRepository.prepare(u"INSERT INTO sources (title, type, note, confidence) VALUES (:title, :type, :note, 5)"_s)) {
-        qCritical() << "Failed to prepare repositore insert statement" << insertRepository.lastError().text();
-        return {};
+    static void bindValues(QSqlQuery& query, const QVariantMap& values) {
+        for (const auto& [placeholder, value]: values.asKeyValueRange()) {
+            query.bindValue(placeholder, value);
+        }
     }
 
-    QSqlQuery externalIdInsert(db);
-    if (!externalIdInsert.prepare(
-            u"INSERT INTO source_external_ids (media_id, type, external_id) VALUES (:media_id, :type, :external_id)"_s
-        )) {
-        qCritical() << "Failed to prepare repository external id insert statement"
-                    << externalIdInsert.lastError().text();
-        return {};
+    static QList<QString> mediaHandles(const QList<GrampsMediaRef>& refs) {
+        QList<QString> handles;
+        handles.reserve(refs.size());
+        for (const auto& ref: refs) {
+            handles.append(ref.mediaHandle);
+        }
+        return handles;
     }
 
-    for (const auto& repository: data.repositories) {
-        if (promise.isCanceled()) {
-            return {};
+    static std::optional<IntegerPrimaryKey> execInsert(QSqlQuery& query, const QString& grampsId) {
+        if (!query.exec()) {
+            qCritical() << "Failed to insert" << grampsId << query.lastError().text();
+            return std::nullopt;
         }
+        return query.lastInsertId().toLongLong();
+    }
 
-        promise.setProgressValueAndText(progress++, i18n("Importing repositores"));
+    static bool execLink(LinkStatement& statement, IntegerPrimaryKey id, IntegerPrimaryKey target) {
+        statement.query.bindValue(u":id"_s, id);
+        statement.query.bindValue(u":target"_s, target);
+        if (!statement.query.exec()) {
+            qCritical() << "Failed to link" << id << "to" << target << statement.query.lastError().text();
+            return false;
+        }
+        return true;
+    }
 
-        QStringList noteParts;
-        for (const auto& handle: repository.noteHandles) {
-            if (const auto it = data.notesByHandle.constFind(handle); it != data.notesByHandle.constEnd()) {
-                noteParts.append(it->text);
-            }
+    /**
+     * Link the row to the record with the handle now if it was read, or once all records are read.
+     */
+    static bool link(LinkStatement& statement, IntegerPrimaryKey id, const QString& handle) {
+        if (handle.isEmpty()) {
+            return true;
+        }
+        if (const auto target = statement.targets->constFind(handle); target != statement.targets->cend()) {
+            return execLink(statement, id, *target);
         }
+        statement.pending.append({id, handle});
+        return true;
+    }
 
-        insertRepository.bindValue(u":title"_s, repository.name);
-        insertRepository.bindValue(u":type"_s, repository.type);
-        insertRepository.bindValue(u":note"_s, noteParts.isEmpty() ? QVariant() : noteParts.join(u"\n"_s));
+    static bool linkAll(LinkStatement& statement, IntegerPrimaryKey id, const QList<QString>& handles) {
+        return std::ranges::all_of(handles, [&](const QString& handle) { return link(statement, id, handle); });
+    }
 
-        if (!insertRepository.exec()) {
-            qCritical() << "Failed to insert media" << repository.id << insertRepository.lastError().text();
-            return {};
+    bool addExternalId(ExternalId type, IntegerPrimaryKey id, const QString& grampsId) {
+        if (grampsId.isEmpty()) {
+            return true;
         }
+        auto& query = insertExternalIds[type];
+        query.bindValue(u":id"_s, id);
+        query.bindValue(u":type"_s, GRAMPS_ID);
+        query.bindValue(u":external_id"_s, grampsId);
+        if (!query.exec()) {
+            qCritical() << "Failed to insert external id" << grampsId << query.lastError().text();
+            return false;
+        }
+        return true;
+    }
 
-        qlonglong insertedId = insertRepository.lastInsertId().toLongLong();
-        sourceIdByRepositoryHandle.insert(repository.handle, insertedId);
+    void addNoteTargets(const QList<QString>& handles, NoteTable table, IntegerPrimaryKey id) {
+        for (const auto& handle: handles) {
+            noteTargets[handle].append({table, id});
+        }
+    }
 
-        externalIdInsert.bindValue(u":media_id"_s, insertedId);
-        externalIdInsert.bindValue(u":type"_s, GRAMPS_ID);
-        externalIdInsert.bindValue(u":external_id"_s, repository.id);
+    std::optional<IntegerPrimaryKey>
+    addSource(const QVariantMap& values, const std::optional<IntegerPrimaryKey>& typeId, const QString& grampsId) {
+        bindValues(insertSource, values);
+        insertSource.bindValue(u":type_id"_s, orNull(typeId));
+        const auto id = execInsert(insertSource, grampsId);
+        if (!id) {
+            return std::nullopt;
+        }
+        importedIds[u"sources"_s].append(*id);
+        if (!addExternalId(ExternalId::SOURCE, *id, grampsId)) {
+            return std::nullopt;
+        }
+        return id;
+    }
 
-        if (!externalIdInsert.exec()) {
-            qCritical() << "Failed to insert media" << repository.id << externalIdInsert.lastError().text();
-            return {};
+    /**
+     * @return The id of the relation, zero if the person already had that role in the event, or
+     *         nothing on an error.
+     */
+    std::optional<IntegerPrimaryKey>
+    addEventRelation(IntegerPrimaryKey eventId, IntegerPrimaryKey personId, IntegerPrimaryKey roleId) {
+        insertEventRelation.bindValue(u":event_id"_s, eventId);
+        insertEventRelation.bindValue(u":person_id"_s, personId);
+        insertEventRelation.bindValue(u":role_id"_s, roleId);
+        if (!insertEventRelation.exec()) {
+            qCritical() << "Failed to insert event relation" << insertEventRelation.lastError().text();
+            return std::nullopt;
         }
+        if (insertEventRelation.numRowsAffected() == 0) {
+            return 0;
+        }
+        return insertEventRelation.lastInsertId().toLongLong();
+    }
+
+    bool addParent(IntegerPrimaryKey birthEventId, IntegerPrimaryKey parentId, EventRoles::Values role) {
+        const auto roleId = parentRoleIds.constFind(role);
+        return roleId != parentRoleIds.cend() && addEventRelation(birthEventId, parentId, *roleId).has_value();
     }
 
-    return sourceIdByRepositoryHandle;
+    bool setFamily(IntegerPrimaryKey eventId, IntegerPrimaryKey familyId) {
+        setEventFamily.bindValue(u":family_id"_s, familyId);
+        setEventFamily.bindValue(u":id"_s, eventId);
+        if (!setEventFamily.exec()) {
+            qCritical() << "Failed to set family of event" << eventId << setEventFamily.lastError().text();
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @return The birth event of the person, which is added if the person has none.
+     */
+    std::optional<IntegerPrimaryKey> birthEventOf(IntegerPrimaryKey personId) {
+        findBirthEvent.bindValue(u":person_id"_s, personId);
+        findBirthEvent.bindValue(u":primary"_s, *primaryRoleId);
+        findBirthEvent.bindValue(u":birth"_s, *birthTypeId);
+        if (!findBirthEvent.exec() || !findBirthEvent.next()) {
+            qCritical() << "Failed to find birth event of" << personId << findBirthEvent.lastError().text();
+            return std::nullopt;
+        }
+        const auto existing = findBirthEvent.value(0);
+        findBirthEvent.finish();
+        if (!existing.isNull()) {
+            return existing.toLongLong();
+        }
+
+        insertBirthEvent.bindValue(u":type_id"_s, *birthTypeId);
+        const auto eventId = execInsert(insertBirthEvent, {});
+        if (!eventId) {
+            return std::nullopt;
+        }
+        importedIds[u"events"_s].append(*eventId);
+        if (!addEventRelation(*eventId, personId, *primaryRoleId)) {
+            return std::nullopt;
+        }
+        return eventId;
+    }
+};
+
+void readRecords(const QString& filename, BoundedQueue<GrampsXmlReader::RecordTree>& output) {
+    // The file was validated before it is imported.
+    GrampsXmlReader reader(filename, false);
+    while (auto record = reader.nextTree()) {
+        if (!output.push(std::move(*record))) {
+            return;
+        }
+    }
+    if (reader.hasError()) {
+        output.fail(reader.error());
+    }
+}
 }
 
 void importGrampsResult(QPromise<bool>& promise, const GrampsXmlAnalysis& result) {
     int total = result.people + result.families + result.events + result.sources + result.places + result.media +
                 result.repositories + result.notes + result.citations;
-    int progress = 0;
-    // We first parse everything into one, and then insert it, and one extra step for preparation.
-    promise.setProgressRange(0, total * 2 + 1);
-    promise.setProgressValueAndText(progress++, i18n("Preparing"));
-
-    // Begin by creating lookup tables.
-    auto data = parseGrampsData(promise, progress, result.document);
-
-    if (promise.isCanceled()) {
-        return;
-    }
+    // The records are read and inserted in one go, with one extra step for preparation and one for linking.
+    // The progress is the number of started steps: the promise ignores a text without a higher value.
+    promise.setProgressRange(0, total + 2);
+    promise.setProgressValueAndText(1, i18n("Preparing"));
 
     const auto connectionName = u"gramps_import_%1"_s.arg(reinterpret_cast<quintptr>(QThread::currentThreadId()));
 
     auto db = QSqlDatabase::cloneDatabase(QSqlDatabase::database(), connectionName);
-    if (!db.open()) {
-        qCritical() << "Failed to open import DB connection:" << db.lastError().text();
-        return;
-    }
 
-    QSqlQuery fk(db);
-    if (!fk.exec(u"PRAGMA foreign_keys = ON"_s)) {
-        qCritical() << "Failed to enable foreign keys:" << fk.lastError().text();
-        return;
-    }
-
-    auto transactionResult = rawExecuteInTransaction(db, [&]() -> std::optional<bool> {
-        auto mediaIdByHandle = importMedia(promise, progress, data, db);
-        if (!mediaIdByHandle) {
-            qWarning() << "Failed to import media, aborting...";
-            return {};
+    // In the order of GrampsRecord.
+    const QStringList progressTexts = {
+        i18n("Importing people"),
+        i18n("Importing families"),
+        i18n("Importing events"),
+        i18n("Importing places"),
+        i18n("Importing notes"),
+        i18n("Importing citations"),
+        i18n("Importing sources"),
+        i18n("Importing media"),
+        i18n("Importing repositories"),
+    };
+    Q_ASSERT(static_cast<std::size_t>(progressTexts.size()) == std::variant_size_v<GrampsRecord>);
+
+    // If the import failed after committing records, which could not be removed again.
+    bool recordsKept = false;
+    const auto imported = [&] {
+        if (!db.open()) {
+            qCritical() << "Failed to open import DB connection:" << db.lastError().text();
+            return false;
+        }
+        if (!configureConnection(db)) {
+            qCritical() << "Failed to configure import DB connection";
+            return false;
         }
 
-        auto sourceByRepositoryHandle = importRepositorySource(promise, progress, data, db);
-        if (!sourceByRepositoryHandle) {
-            qWarning() << "Failed to import repositories, aborting...";
-            return {};
+        GrampsImporter importer(db);
+        ChunkedTransaction transaction(db);
+        if (!importer.prepare() || !transaction.begin()) {
+            return false;
         }
 
-        return true;
-    });
+        // The file is read once, on its own thread. Converting the records takes longer, so that is
+        // done on the other threads, and only the import itself happens on this thread.
+        ImportPipeline pipeline(promise);
+        using RecordTree = GrampsXmlReader::RecordTree;
+        auto records = pipeline.read<RecordTree>({[&filename = result.filename](BoundedQueue<RecordTree>& output) {
+            readRecords(filename, output);
+        }});
+        // One thread reads the file, and this one writes the rows.
+        const auto converters = std::max(1, QThread::idealThreadCount() - 2);
+        auto rows = pipeline.transform(std::move(records), &toRow, converters);
+
+        std::size_t lastRecordType = std::variant_npos;
+        const auto written = pipeline.write(rows, [&](GrampsRow&& row) {
+            if (row.record.index() != lastRecordType) {
+                lastRecordType = row.record.index();
+                pipeline.setProgressText(progressTexts[static_cast<qsizetype>(lastRecordType)]);
+            }
+            if (!importer.add(row)) {
+                qWarning() << "Failed to import record, aborting...";
+                return false;
+            }
+            return transaction.step();
+        });
+        if (written) {
+            promise.setProgressValueAndText(total + 2, i18n("Linking records"));
+            if (importer.finish(promise, transaction) && transaction.commit()) {
+                return true;
+            }
+        }
 
-    if (transactionResult.has_value()) {
-        promise.addResult(*transactionResult);
+        // The records are committed in chunks, so remove those of the chunks before.
+        recordsKept = !importer.removeImported(transaction);
+        return false;
+    }();
+
+    db.close();
+    db = QSqlDatabase();
+    ChangeCapture::uninstall(connectionName);
+    QSqlDatabase::removeDatabase(connectionName);
+
+    if (imported) {
+        promise.addResult(true);
+    } else if (recordsKept) {
+        qCritical() << "Failed to import, and to remove the imported records";
+        promise.setException(GrampsImportException(
+            i18n("The import failed. The records that were imported before it failed are still in the database.")
+        ));
     } else {
-        qWarning() << "Failed to import...";
-        // TODO
-        // promise.setException()
+        qWarning() << "Failed to import, the imported records were removed";
+        promise.setException(GrampsImportException(i18n("The import failed. Nothing was imported.")));
     }
 }
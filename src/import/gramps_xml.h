@@ -6,15 +6,14 @@
 
 #pragma once
 
-#include <libxml/tree.h>
-
+#include <QByteArray>
+#include <QException>
 #include <QPromise>
 #include <QString>
 
-using GrampsXmlRoot = std::unique_ptr<xmlDoc, decltype(&xmlFreeDoc)>;
-
 struct GrampsXmlAnalysis {
-    GrampsXmlRoot document = {nullptr, xmlFreeDoc};
+    // The file is read again when importing, so it does not have to be kept in memory.
+    QString filename;
     bool valid;
     QString error;
     int people, families, events, sources, places, media, repositories, notes, citations;
@@ -23,4 +22,39 @@ struct GrampsXmlAnalysis {
 
 void validateGrampsXml(QPromise<GrampsXmlAnalysis>& promise, const QString& filename);
 
+/**
+ * An import that failed, with a message for the user.
+ */
+class GrampsImportException : public QException {
+public:
+    explicit GrampsImportException(const QString& message) : m_message(message), m_byteArray(message.toUtf8()) {
+    }
+
+    void raise() const override {
+        throw *this;
+    }
+
+    GrampsImportException* clone() const override {
+        return new GrampsImportException(*this);
+    }
+
+    const char* what() const noexcept override {
+        return m_byteArray.constData();
+    }
+
+    QString message() const {
+        return m_message;
+    }
+
+private:
+    QString m_message;
+    QByteArray m_byteArray;
+};
+
+/**
+ * Import a Gramps XML file that was validated by validateGrampsXml().
+ *
+ * If the import fails or is canceled, the records it imported are removed again. A failed import
+ * has a GrampsImportException, which tells whether that worked.
+ */
 void importGrampsResult(QPromise<bool>& promise, const GrampsXmlAnalysis& result);
@@ -0,0 +1,713 @@
+/*
+ * SPDX-FileCopyrightText: Niko Strijbol <niko@strijbol.be>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+#include "gramps_xml_reader.h"
+
+#include "utils/resource_exception.h"
+
+#include <KLocalizedString>
+#include <QFile>
+
+using namespace Qt::StringLiterals;
+
+namespace {
+bool nodeNameIs(const xmlNode* node, const char* name) {
+    // ReSharper disable once CppCStyleCast
+    return xmlStrEqual(node->name, BAD_CAST name) != 0;
+}
+
+QString attrStr(const xmlNode* node, const char* name) {
+    // ReSharper disable once CppCStyleCast
+    xmlChar* val = xmlGetProp(node, BAD_CAST name);
+    if (!val) {
+        return {};
+    }
+
+    QString result = QString::fromUtf8(val);
+    xmlFree(val);
+    return result;
+}
+
+QString textContent(const xmlNode* node) {
+    xmlChar* val = xmlNodeGetContent(node);
+    if (!val) {
+        return {};
+    }
+    QString result = QString::fromUtf8(val);
+    xmlFree(val);
+    return result;
+}
+
+GrampsDate parseDate(const xmlNode* node) {
+    GrampsDate date;
+
+    if (nodeNameIs(node, "daterange")) {
+        date = {
+            .type = u"daterange"_s,
+            .start = attrStr(node, "start"),
+            .stop = attrStr(node, "stop"),
+            .quality = attrStr(node, "quality"),
+            .calendarFormat = attrStr(node, "cformat"),
+            .isDualDated = attrStr(node, "dualdated") == u"1"_s,
+            .newYear = attrStr(node, "newyear"),
+        };
+    } else if (nodeNameIs(node, "datespan")) {
+        date = {
+            .type = u"datespan"_s,
+            .start = attrStr(node, "start"),
+            .stop = attrStr(node, "stop"),
+            .quality = attrStr(node, "quality"),
+            .calendarFormat = attrStr(node, "cformat"),
+            .isDualDated = attrStr(node, "dualdated") == u"1"_s,
+            .newYear = attrStr(node, "newyear"),
+        };
+    } else if (nodeNameIs(node, "dateval")) {
+        date = {
+            .type = u"dateval"_s,
+            .value = attrStr(node, "val"),
+            .modifier = attrStr(node, "type"),
+            .quality = attrStr(node, "quality"),
+            .calendarFormat = attrStr(node, "cformat"),
+            .isDualDated = attrStr(node, "dualdated") == u"1"_s,
+            .newYear = attrStr(node, "newyear"),
+        };
+    } else if (nodeNameIs(node, "datestr")) {
+        date = {
+            .type = u"datestr"_s,
+            .value = attrStr(node, "val"),
+        };
+    } else {
+        qWarning() << "Unknown node type" << node->type;
+    }
+
+    return date;
+}
+
+bool isDateNode(const xmlNode* c) {
+    return nodeNameIs(c, "dateval") || nodeNameIs(c, "daterange") || nodeNameIs(c, "datespan") ||
+           nodeNameIs(c, "datestr");
+}
+
+GrampsSurname parseSurname(const xmlNode* node) {
+    return {
+        .surname = textContent(node),
+        .prefix = attrStr(node, "prefix"),
+        .derivation = attrStr(node, "derivation"),
+        .connector = attrStr(node, "connector"),
+        .isPrimary = attrStr(node, "prim") == u"1"_s,
+    };
+}
+
+GrampsName parseName(const xmlNode* node) {
+    GrampsName name {
+        .isAlternate = attrStr(node, "alt") == u"1"_s,
+        .type = attrStr(node, "type"),
+        .sortAs = attrStr(node, "sort"),
+        .displayAs = attrStr(node, "display"),
+    };
+
+    for (const xmlNode* c = node->children; c; c = c->next) {
+        if (nodeNameIs(c, "first")) {
+            name.givenNames = textContent(c);
+        } else if (nodeNameIs(c, "call")) {
+            name.callName = textContent(c);
+        } else if (nodeNameIs(c, "surname")) {
+            name.surnames.append(parseSurname(c));
+        } else if (nodeNameIs(c, "suffix")) {
+            name.suffix = textContent(c);
+        } else if (nodeNameIs(c, "title")) {
+            name.title = textContent(c);
+        } else if (nodeNameIs(c, "nick")) {
+            name.nickname = textContent(c);
+        } else if (nodeNameIs(c, "familynick")) {
+            name.familyNickname = textContent(c);
+        } else if (nodeNameIs(c, "group")) {
+            name.groupAs = textContent(c);
+        } else if (nodeNameIs(c, "noteref")) {
+            name.noteHandles.append(attrStr(c, "hlink"));
+        } else if (nodeNameIs(c, "citationref")) {
+            name.citationHandles.append(attrStr(c, "hlink"));
+        } else if (isDateNode(c)) {
+            name.date = parseDate(c);
+        }
+    }
+
+    return name;
+}
+
+GrampsEventRef parseEventRef(const xmlNode* node) {
+    GrampsEventRef ref {
+        .eventHandle = attrStr(node, "hlink"),
+        .role = attrStr(node, "role"),
+    };
+
+    for (const xmlNode* c = node->children; c; c = c->next) {
+        if (nodeNameIs(c, "noteref")) {
+            ref.noteHandles.append(attrStr(c, "hlink"));
+        } else if (nodeNameIs(c, "citationref")) {
+            ref.citationHandles.append(attrStr(c, "hlink"));
+        }
+    }
+
+    return ref;
+}
+
+GrampsMediaRef parseMediaRef(const xmlNode* node) {
+    GrampsMediaRef ref {
+        .mediaHandle = attrStr(node, "hlink"),
+    };
+
+    for (const xmlNode* c = node->children; c; c = c->next) {
+        if (nodeNameIs(c, "citationref")) {
+            ref.citationHandles.append(attrStr(c, "hlink"));
+        } else if (nodeNameIs(c, "noteref")) {
+            ref.noteHandles.append(attrStr(c, "hlink"));
+        }
+    }
+
+    return ref;
+}
+
+GrampsPersonRef parsePersonRef(const xmlNode* node) {
+    GrampsPersonRef ref {
+        .personHandle = attrStr(node, "hlink"),
+        .relation = attrStr(node, "rel"),
+    };
+
+    for (const xmlNode* c = node->children; c; c = c->next) {
+        if (nodeNameIs(c, "citationref")) {
+            ref.citationHandles.append(attrStr(c, "hlink"));
+        } else if (nodeNameIs(c, "noteref")) {
+            ref.noteHandles.append(attrStr(c, "hlink"));
+        }
+    }
+
+    return ref;
+}
+
+GrampsChildRef parseChildRef(const xmlNode* node) {
+    GrampsChildRef ref {
+        .personHandle = attrStr(node, "hlink"),
+        .motherRelationType = attrStr(node, "mrel"),
+        .fatherRelationType = attrStr(node, "frel"),
+    };
+
+    for (const xmlNode* c = node->children; c; c = c->next) {
+        if (nodeNameIs(c, "citationref")) {
+            ref.citationHandles.append(attrStr(c, "hlink"));
+        } else if (nodeNameIs(c, "noteref")) {
+            ref.noteHandles.append(attrStr(c, "hlink"));
+        }
+    }
+
+    return ref;
+}
+
+GrampsSrcAttribute parseSrcAttribute(const xmlNode* node) {
+    return {
+        .type = attrStr(node, "type"),
+        .value = attrStr(node, "value"),
+    };
+}
+
+GrampsRepositoryRef parseRepositoryRef(const xmlNode* node) {
+    GrampsRepositoryRef ref {
+        .repositoryHandle = attrStr(node, "hlink"),
+        .callNumber = attrStr(node, "callno"),
+        .medium = attrStr(node, "medium"),
+    };
+
+    for (const xmlNode* c = node->children; c; c = c->next) {
+        if (nodeNameIs(c, "noteref")) {
+            ref.noteHandles.append(attrStr(c, "hlink"));
+        }
+    }
+
+    return ref;
+}
+
+GrampsPerson parsePerson(const xmlNode* node) {
+    GrampsPerson person {
+        .handle = attrStr(node, "handle"),
+        .id = attrStr(node, "id"),
+    };
+
+    for (const xmlNode* c = node->children; c; c = c->next) {
+        if (nodeNameIs(c, "gender")) {
+            person.sex = textContent(c);
+        } else if (nodeNameIs(c, "name")) {
+            person.names.append(parseName(c));
+        } else if (nodeNameIs(c, "eventref")) {
+            person.eventRefs.append(parseEventRef(c));
+        } else if (nodeNameIs(c, "objref")) {
+            person.mediaRefs.append(parseMediaRef(c));
+        } else if (nodeNameIs(c, "personref")) {
+            person.personRefs.append(parsePersonRef(c));
+        } else if (nodeNameIs(c, "noteref")) {
+            person.noteHandles.append(attrStr(c, "hlink"));
+        } else if (nodeNameIs(c, "citationref")) {
+            person.citationHandles.append(attrStr(c, "hlink"));
+        }
+    }
+
+    return person;
+}
+
+GrampsFamily parseFamily(const xmlNode* node) {
+    GrampsFamily family {
+        .handle = attrStr(node, "handle"),
+        .id = attrStr(node, "id"),
+    };
+
+    for (const xmlNode* c = node->children; c; c = c->next) {
+        if (nodeNameIs(c, "rel")) {
+            family.relationshipType = attrStr(c, "type");
+        } else if (nodeNameIs(c, "father")) {
+            family.fatherHandle = attrStr(c, "hlink");
+        } else if (nodeNameIs(c, "mother")) {
+            family.motherHandle = attrStr(c, "hlink");
+        } else if (nodeNameIs(c, "eventref")) {
+            family.eventRefs.append(parseEventRef(c));
+        } else if (nodeNameIs(c, "childref")) {
+            family.childRefs.append(parseChildRef(c));
+        } else if (nodeNameIs(c, "objref")) {
+            family.mediaRefs.append(parseMediaRef(c));
+        } else if (nodeNameIs(c, "noteref")) {
+            family.noteHandles.append(attrStr(c, "hlink"));
+        } else if (nodeNameIs(c, "citationref")) {
+            family.citationHandles.append(attrStr(c, "hlink"));
+        } else if (isDateNode(c)) {
+            family.date = parseDate(c);
+        }
+    }
+
+    return family;
+}
+
+GrampsEvent parseEvent(const xmlNode* node) {
+    GrampsEvent event {
+        .handle = attrStr(node, "handle"),
+        .id = attrStr(node, "id"),
+    };
+
+    for (const xmlNode* c = node->children; c; c = c->next) {
+        if (nodeNameIs(c, "type")) {
+            event.type = textContent(c);
+        } else if (nodeNameIs(c, "place")) {
+            event.placeHandle = attrStr(c, "hlink");
+        } else if (nodeNameIs(c, "description")) {
+            event.description = textContent(c);
+        } else if (nodeNameIs(c, "objref")) {
+            event.mediaRefs.append(parseMediaRef(c));
+        } else if (nodeNameIs(c, "noteref")) {
+            event.noteHandles.append(attrStr(c, "hlink"));
+        } else if (nodeNameIs(c, "citationref")) {
+            event.citationHandles.append(attrStr(c, "hlink"));
+        } else if (isDateNode(c)) {
+            event.date = parseDate(c);
+        }
+    }
+
+    return event;
+}
+
+GrampsPlace parsePlace(const xmlNode* node) {
+    GrampsPlace place {
+        .handle = attrStr(node, "handle"),
+        .id = attrStr(node, "id"),
+        .type = attrStr(node, "type"),
+    };
+
+    for (const xmlNode* c = node->children; c; c = c->next) {
+        if (nodeNameIs(c, "ptitle")) {
+            place.title = textContent(c);
+        } else if (nodeNameIs(c, "code")) {
+            place.code = textContent(c);
+        } else if (nodeNameIs(c, "pname")) {
+            GrampsPlaceName name {
+                .value = attrStr(c, "value"),
+                .language = attrStr(c, "lang"),
+            };
+            for (const xmlNode* d = c->children; d; d = d->next) {
+                if (isDateNode(d)) {
+                    name.date = parseDate(d);
+                }
+            }
+            place.names.append(name);
+        } else if (nodeNameIs(c, "coord")) {
+            place.latitude = attrStr(c, "lat").toDouble();
+            place.longitude = attrStr(c, "long").toDouble();
+            place.hasCoordinates = true;
+        } else if (nodeNameIs(c, "placeref")) {
+            place.parentHandles.append(attrStr(c, "hlink"));
+        } else if (nodeNameIs(c, "location")) {
+            // TODO
+        } else if (nodeNameIs(c, "objref")) {
+            place.mediaRefs.append(parseMediaRef(c));
+        } else if (nodeNameIs(c, "noteref")) {
+            place.noteHandles.append(attrStr(c, "hlink"));
+        } else if (nodeNameIs(c, "citationref")) {
+            place.citationHandles.append(attrStr(c, "hlink"));
+        }
+    }
+
+    return place;
+}
+
+GrampsNote parseNote(const xmlNode* node) {
+    GrampsNote note {
+        .handle = attrStr(node, "handle"),
+        .id = attrStr(node, "id"),
+        .type = attrStr(node, "type"),
+    };
+
+    for (const xmlNode* c = node->children; c; c = c->next) {
+        if (nodeNameIs(c, "text")) {
+            note.text = textContent(c);
+        }
+    }
+
+    return note;
+}
+
+GrampsCitation parseCitation(const xmlNode* node) {
+    GrampsCitation citation {
+        .handle = attrStr(node, "handle"),
+        .id = attrStr(node, "id"),
+    };
+
+    for (const xmlNode* c = node->children; c; c = c->next) {
+        if (nodeNameIs(c, "page")) {
+            citation.page = textContent(c);
+        } else if (nodeNameIs(c, "confidence")) {
+            citation.confidence = textContent(c);
+        } else if (nodeNameIs(c, "sourceref")) {
+            citation.sourceHandle = attrStr(c, "hlink");
+        } else if (nodeNameIs(c, "objref")) {
+            citation.mediaRefs.append(parseMediaRef(c));
+        } else if (nodeNameIs(c, "srcattribute")) {
+            citation.sourceAttributes.append(parseSrcAttribute(c));
+        } else if (nodeNameIs(c, "noteref")) {
+            citation.noteHandles.append(attrStr(c, "hlink"));
+        } else if (isDateNode(c)) {
+            citation.date = parseDate(c);
+        }
+    }
+
+    return citation;
+}
+
+GrampsSource parseSource(const xmlNode* node) {
+    GrampsSource source {
+        .handle = attrStr(node, "handle"),
+        .id = attrStr(node, "id"),
+    };
+
+    for (const xmlNode* c = node->children; c; c = c->next) {
+        if (nodeNameIs(c, "stitle")) {
+            source.title = textContent(c);
+        } else if (nodeNameIs(c, "sauthor")) {
+            source.author = textContent(c);
+        } else if (nodeNameIs(c, "spubinfo")) {
+            source.publicationInfo = textContent(c);
+        } else if (nodeNameIs(c, "sabbrev")) {
+            source.abbreviation = textContent(c);
+        } else if (nodeNameIs(c, "noteref")) {
+            source.noteHandles.append(attrStr(c, "hlink"));
+        } else if (nodeNameIs(c, "objref")) {
+            source.mediaRefs.append(parseMediaRef(c));
+        } else if (nodeNameIs(c, "srcattribute")) {
+            source.sourceAttributes.append(parseSrcAttribute(c));
+        } else if (nodeNameIs(c, "reporef")) {
+            source.repositoryRefs.append(parseRepositoryRef(c));
+        }
+    }
+
+    return source;
+}
+
+// Called object-content in the XML
+GrampsMedia parseMedia(const xmlNode* node) {
+    GrampsMedia media {
+        .handle = attrStr(node, "handle"),
+        .id = attrStr(node, "id"),
+    };
+
+    for (const xmlNode* c = node->children; c; c = c->next) {
+        if (nodeNameIs(c, "file")) {
+            media.filePath = attrStr(c, "src");
+            media.mimeType = attrStr(c, "mime");
+            media.checksum = attrStr(c, "checksum");
+            media.description = attrStr(c, "description");
+        } else if (nodeNameIs(c, "noteref")) {
+            media.noteHandles.append(attrStr(c, "hlink"));
+        } else if (nodeNameIs(c, "citationref")) {
+            media.citationHandles.append(attrStr(c, "hlink"));
+        } else if (isDateNode(c)) {
+            media.date = parseDate(c);
+        }
+    }
+
+    return media;
+}
+
+GrampsRepository parseRepository(const xmlNode* node) {
+    GrampsRepository repository {
+        .handle = attrStr(node, "handle"),
+        .id = attrStr(node, "id"),
+    };
+
+    for (const xmlNode* c = node->children; c; c = c->next) {
+        if (nodeNameIs(c, "rname")) {
+            repository.name = textContent(c);
+        } else if (nodeNameIs(c, "type")) {
+            repository.type = textContent(c);
+        } else if (nodeNameIs(c, "noteref")) {
+            repository.noteHandles.append(attrStr(c, "hlink"));
+        }
+    }
+
+    return repository;
+}
+
+std::unique_ptr<xmlRelaxNG, decltype(&xmlRelaxNGFree)> loadSchema() {
+    QFile rngSchemaFile(u":/schema/grampsxml-1.7.2.rng"_s);
+    if (!rngSchemaFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qWarning() << "Could not open Gramps XML schema file.";
+        throw ResourceNotFoundException();
+    }
+    const QByteArray rngSchemaBytes = rngSchemaFile.readAll();
+
+    std::unique_ptr<xmlRelaxNGParserCtxt, decltype(&xmlRelaxNGFreeParserCtxt)> parserContext(
+        xmlRelaxNGNewMemParserCtxt(rngSchemaBytes.constData(), static_cast<int>(rngSchemaBytes.size())),
+        xmlRelaxNGFreeParserCtxt
+    );
+    if (!parserContext) {
+        qWarning() << "Failed to create RelaxNG parser context from memory.";
+        throw ResourceNotFoundException();
+    }
+
+    std::unique_ptr<xmlRelaxNG, decltype(&xmlRelaxNGFree)> schema(
+        xmlRelaxNGParse(parserContext.get()),
+        xmlRelaxNGFree
+    );
+    if (!schema) {
+        qWarning() << "Failed to create RelaxNG schema.";
+        throw ResourceNotFoundException();
+    }
+    return schema;
+}
+}
+
+int GrampsCounts::total() const {
+    return people + families + events + sources + places + media + repositories + notes + citations;
+}
+
+GrampsXmlReader::GrampsXmlReader(const QString& filename, bool validate) :
+    schema(validate ? loadSchema() : decltype(schema)(nullptr, xmlRelaxNGFree)),
+    reader(xmlReaderForFile(filename.toUtf8().constData(), nullptr, XML_PARSE_NONET), xmlFreeTextReader) {
+    if (!reader) {
+        qWarning() << "Failed to open XML file" << filename;
+        return;
+    }
+    // Before the schema, so validation errors are collected as well.
+    xmlTextReaderSetErrorHandler(reader.get(), collectError, this);
+    if (schema && xmlTextReaderRelaxNGSetSchema(reader.get(), schema.get()) != 0) {
+        qWarning() << "Failed to use the RelaxNG schema.";
+        throw ResourceNotFoundException();
+    }
+    move(xmlTextReaderRead(reader.get()));
+}
+
+template<typename Function>
+auto GrampsXmlReader::nextWith(Function take) -> std::optional<std::invoke_result_t<Function, const xmlNode*>> {
+    while (status == 1) {
+        if (!atRecord()) {
+            move(xmlTextReaderRead(reader.get()));
+            continue;
+        }
+
+        // Build the tree of this record only, and take it.
+        const xmlNode* node = xmlTextReaderExpand(reader.get());
+        if (node == nullptr) {
+            move(-1);
+            return std::nullopt;
+        }
+        auto record = take(node);
+
+        // Moving past the record validates it, and frees its tree.
+        move(xmlTextReaderNext(reader.get()));
+        if (status < 0) {
+            return std::nullopt;
+        }
+        count();
+        return record;
+    }
+    return std::nullopt;
+}
+
+std::optional<GrampsRecord> GrampsXmlReader::next() {
+    return nextWith([this](const xmlNode* node) { return parse(section, node); });
+}
+
+std::optional<GrampsXmlReader::RecordTree> GrampsXmlReader::nextTree() {
+    return nextWith([this](const xmlNode* node) {
+        RecordTree tree;
+        tree.section = section;
+        // The tree of the reader is freed when it moves on. A deep copy without a document can be
+        // used and freed on another thread.
+        tree.node = std::shared_ptr<xmlNode>(xmlCopyNode(const_cast<xmlNode*>(node), 1), xmlFreeNode);
+        return tree;
+    });
+}
+
+GrampsRecord GrampsXmlReader::RecordTree::parse() const {
+    return GrampsXmlReader::parse(section, node.get());
+}
+
+GrampsRecord GrampsXmlReader::parse(Section section, const xmlNode* node) {
+    switch (section) {
+        case Section::PEOPLE:
+            return parsePerson(node);
+        case Section::FAMILIES:
+            return parseFamily(node);
+        case Section::EVENTS:
+            return parseEvent(node);
+        case Section::PLACES:
+            return parsePlace(node);
+        case Section::NOTES:
+            return parseNote(node);
+        case Section::CITATIONS:
+            return parseCitation(node);
+        case Section::SOURCES:
+            return parseSource(node);
+        case Section::MEDIA:
+            return parseMedia(node);
+        case Section::REPOSITORIES:
+            return parseRepository(node);
+        case Section::NONE:
+            break;
+    }
+    // atRecord() is only true in a section with records.
+    Q_UNREACHABLE();
+}
+
+bool GrampsXmlReader::skipToEnd() {
+    while (status == 1) {
+        if (atRecord()) {
+            count();
+        }
+        move(xmlTextReaderRead(reader.get()));
+    }
+    return status == 0;
+}
+
+bool GrampsXmlReader::hasError() const {
+    return status < 0;
+}
+
+QString GrampsXmlReader::error() const {
+    if (errors.isEmpty()) {
+        return i18n("Could not parse XML file");
+    }
+    return errors.join(u"\n"_s);
+}
+
+const GrampsCounts& GrampsXmlReader::counts() const {
+    return counts_;
+}
+
+void GrampsXmlReader::collectError(
+    void* arg,
+    const char* message,
+    xmlParserSeverities severity,
+    xmlTextReaderLocatorPtr
+) {
+    if (severity == XML_PARSER_SEVERITY_WARNING || severity == XML_PARSER_SEVERITY_VALIDITY_WARNING) {
+        return;
+    }
+    static_cast<GrampsXmlReader*>(arg)->errors.append(QString::fromUtf8(message).trimmed());
+}
+
+void GrampsXmlReader::move(int result) {
+    if (!reader) {
+        status = -1;
+        return;
+    }
+    // The reader continues after a validation error, but there is no point in that.
+    if (result >= 0 && schema && xmlTextReaderIsValid(reader.get()) != 1) {
+        result = -1;
+    }
+    status = result;
+}
+
+bool GrampsXmlReader::atRecord() {
+    if (xmlTextReaderNodeType(reader.get()) != XML_READER_TYPE_ELEMENT) {
+        return false;
+    }
+    const auto depth = xmlTextReaderDepth(reader.get());
+    if (depth == 1) {
+        const auto* name = xmlTextReaderConstLocalName(reader.get());
+        // ReSharper disable CppCStyleCast
+        if (xmlStrEqual(name, BAD_CAST "people")) {
+            section = Section::PEOPLE;
+        } else if (xmlStrEqual(name, BAD_CAST "families")) {
+            section = Section::FAMILIES;
+        } else if (xmlStrEqual(name, BAD_CAST "events")) {
+            section = Section::EVENTS;
+        } else if (xmlStrEqual(name, BAD_CAST "places")) {
+            section = Section::PLACES;
+        } else if (xmlStrEqual(name, BAD_CAST "notes")) {
+            section = Section::NOTES;
+        } else if (xmlStrEqual(name, BAD_CAST "citations")) {
+            section = Section::CITATIONS;
+        } else if (xmlStrEqual(name, BAD_CAST "sources")) {
+            section = Section::SOURCES;
+        } else if (xmlStrEqual(name, BAD_CAST "objects")) {
+            section = Section::MEDIA;
+        } else if (xmlStrEqual(name, BAD_CAST "repositories")) {
+            section = Section::REPOSITORIES;
+        } else {
+            section = Section::NONE;
+        }
+        // ReSharper restore CppCStyleCast
+        return false;
+    }
+    return depth == 2 && section != Section::NONE;
+}
+
+void GrampsXmlReader::count() {
+    switch (section) {
+        case Section::PEOPLE:
+            ++counts_.people;
+            break;
+        case Section::FAMILIES:
+            ++counts_.families;
+            break;
+        case Section::EVENTS:
+            ++counts_.events;
+            break;
+        case Section::PLACES:
+            ++counts_.places;
+            break;
+        case Section::NOTES:
+            ++counts_.notes;
+            break;
+        case Section::CITATIONS:
+            ++counts_.citations;
+            break;
+        case Section::SOURCES:
+            ++counts_.sources;
+            break;
+        case Section::MEDIA:
+            ++counts_.media;
+            break;
+        case Section::REPOSITORIES:
+            ++counts_.repositories;
+            break;
+        case Section::NONE:
+            break;
+    }
+}
@@ -0,0 +1,341 @@
+/*
+ * SPDX-FileCopyrightText: Niko Strijbol <niko@strijbol.be>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <libxml/relaxng.h>
+#include <libxml/xmlreader.h>
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <variant>
+
+struct GrampsDate {
+    QString type;
+    // dateval.val or datestr.val
+    QString value;
+    // daterange/datespan.start
+    QString start;
+    // daterange/datespan.stop
+    QString stop;
+    // before/after/about (dateval only)
+    QString modifier;
+    // estimated/calculated
+    QString quality;
+    QString calendarFormat;
+    bool isDualDated = false;
+    QString newYear;
+};
+
+struct GrampsSurname {
+    QString surname;
+    QString prefix;
+    QString derivation;
+    QString connector;
+    bool isPrimary = false;
+};
+
+struct GrampsAddress {
+    GrampsDate date;
+    QString street;
+    QString locality;
+    QString city;
+    QString county;
+    QString state;
+    QString country;
+    QString postal;
+    QString phone;
+    QList<QString> noteHandles;
+    QList<QString> citationHandles;
+};
+
+struct GrampsName {
+    bool isAlternate = false;
+    QString type;
+    QString sortAs;
+    QString displayAs;
+    QString givenNames;
+    QString callName;
+    QList<GrampsSurname> surnames;
+    QString suffix;
+    QString title;
+    QString nickname;
+    QString familyNickname;
+    QString groupAs;
+    GrampsDate date;
+    QList<QString> noteHandles;
+    QList<QString> citationHandles;
+};
+
+struct GrampsEventRef {
+    QString eventHandle;
+    QString role;
+    QList<QString> noteHandles;
+    QList<QString> citationHandles;
+};
+
+struct GrampsMediaRef {
+    QString mediaHandle;
+    QList<QString> citationHandles;
+    QList<QString> noteHandles;
+};
+
+struct GrampsPersonRef {
+    QString personHandle;
+    QString relation;
+    QList<QString> citationHandles;
+    QList<QString> noteHandles;
+};
+
+struct GrampsChildRef {
+    QString personHandle;
+    QString motherRelationType;
+    QString fatherRelationType;
+    QList<QString> citationHandles;
+    QList<QString> noteHandles;
+};
+
+struct GrampsPerson {
+    QString handle, id, sex;
+    QList<GrampsName> names;
+    QList<GrampsEventRef> eventRefs;
+    QList<GrampsMediaRef> mediaRefs;
+    QList<GrampsAddress> addresses;
+    QList<GrampsPersonRef> personRefs;
+    QList<QString> noteHandles;
+    QList<QString> citationHandles;
+};
+
+struct GrampsFamily {
+    QString handle, id;
+    QString relationshipType;
+    QString fatherHandle;
+    QString motherHandle;
+    QList<GrampsEventRef> eventRefs;
+    QList<GrampsChildRef> childRefs;
+    QList<GrampsMediaRef> mediaRefs;
+    GrampsDate date;
+    QList<QString> noteHandles;
+    QList<QString> citationHandles;
+};
+
+struct GrampsEvent {
+    QString handle, id, type, description;
+    GrampsDate date;
+    QString placeHandle;
+    QList<GrampsMediaRef> mediaRefs;
+    QList<QString> noteHandles;
+    QList<QString> citationHandles;
+};
+
+struct GrampsPlaceName {
+    QString value;
+    QString language;
+    GrampsDate date;
+};
+
+struct GrampsPlace {
+    QString handle, id, type;
+    QString title;
+    QString code;
+    QList<GrampsPlaceName> names;
+    double latitude = 0.0, longitude = 0.0;
+    bool hasCoordinates = false;
+    QList<QString> parentHandles;
+    QList<GrampsMediaRef> mediaRefs;
+    QList<QString> noteHandles;
+    QList<QString> citationHandles;
+};
+
+struct GrampsNote {
+    QString handle, id, type;
+    QString text;
+};
+
+struct GrampsSrcAttribute {
+    QString type;
+    QString value;
+};
+
+struct GrampsRepositoryRef {
+    QString repositoryHandle;
+    QString callNumber;
+    QString medium;
+    QList<QString> noteHandles;
+};
+
+struct GrampsCitation {
+    QString handle, id;
+    GrampsDate date;
+    QString page;
+    QString confidence;
+    QString sourceHandle;
+    QList<GrampsSrcAttribute> sourceAttributes;
+    QList<GrampsMediaRef> mediaRefs;
+    QList<QString> noteHandles;
+};
+
+struct GrampsSource {
+    QString handle, id;
+    QString title;
+    QString author;
+    QString publicationInfo;
+    QString abbreviation;
+    QList<GrampsSrcAttribute> sourceAttributes;
+    QList<GrampsRepositoryRef> repositoryRefs;
+    QList<GrampsMediaRef> mediaRefs;
+    QList<QString> noteHandles;
+};
+
+struct GrampsMedia {
+    QString handle, id;
+    QString filePath;
+    QString mimeType;
+    QString checksum;
+    QString description;
+    GrampsDate date;
+    QList<QString> noteHandles;
+    QList<QString> citationHandles;
+};
+
+struct GrampsRepository {
+    QString handle, id;
+    QString name;
+    QString type;
+    QList<GrampsAddress> addresses;
+    QList<QString> noteHandles;
+};
+
+/**
+ * One top-level object of a Gramps XML file, e.g. a person or a place.
+ */
+using GrampsRecord = std::variant<
+    GrampsPerson,
+    GrampsFamily,
+    GrampsEvent,
+    GrampsPlace,
+    GrampsNote,
+    GrampsCitation,
+    GrampsSource,
+    GrampsMedia,
+    GrampsRepository>;
+
+/**
+ * The number of records in each section of a Gramps XML file.
+ */
+struct GrampsCounts {
+    int people = 0, families = 0, events = 0, sources = 0, places = 0, media = 0, repositories = 0, notes = 0,
+        citations = 0;
+
+    [[nodiscard]] int total() const;
+};
+
+/**
+ * Reads a Gramps XML file one record at a time, and validates it against the schema while reading.
+ *
+ * Only the record that is being read is kept in memory, not the whole document, so the memory does
+ * not depend on the size of the file. A record is only returned once it has been validated. When the
+ * file is not valid, reading stops at the first error.
+ */
+class GrampsXmlReader {
+    enum class Section { NONE, PEOPLE, FAMILIES, EVENTS, PLACES, NOTES, CITATIONS, SOURCES, MEDIA, REPOSITORIES };
+
+public:
+    /**
+     * @param validate False to skip the validation, for a file that was validated before.
+     *
+     * @throws ResourceNotFoundException If the schema cannot be loaded.
+     */
+    explicit GrampsXmlReader(const QString& filename, bool validate = true);
+
+    GrampsXmlReader(const GrampsXmlReader&) = delete;
+    GrampsXmlReader& operator=(const GrampsXmlReader&) = delete;
+
+    /**
+     * Read and validate the next record.
+     *
+     * @return The record, or nothing at the end of the file or on an error.
+     */
+    [[nodiscard]] std::optional<GrampsRecord> next();
+
+    /**
+     * The tree of one record, which can be converted on another thread than the one reading the file.
+     */
+    class RecordTree {
+    public:
+        /**
+         * Convert the tree into the record, like next() does.
+         */
+        [[nodiscard]] GrampsRecord parse() const;
+
+    private:
+        friend class GrampsXmlReader;
+
+        Section section = Section::NONE;
+        // A copy that does not belong to the document of the reader.
+        std::shared_ptr<xmlNode> node;
+    };
+
+    /**
+     * Read and validate the next record, without converting it.
+     *
+     * A record takes longer to convert than to read, so the records of a file can be converted on more
+     * threads than the one reading it.
+     *
+     * @return The tree of the record, or nothing at the end of the file or on an error.
+     */
+    [[nodiscard]] std::optional<RecordTree> nextTree();
+
+    /**
+     * Read and validate the rest of the file, only counting the records.
+     *
+     * @return If the file is valid.
+     */
+    bool skipToEnd();
+
+    /**
+     * @return If the file could not be read or is not valid.
+     */
+    [[nodiscard]] bool hasError() const;
+
+    /**
+     * @return Why the file could not be read or is not valid.
+     */
+    [[nodiscard]] QString error() const;
+
+    /**
+     * @return The number of records read so far.
+     */
+    [[nodiscard]] const GrampsCounts& counts() const;
+
+private:
+    // The reader must be freed before the schema it uses. There is no schema if the reader does not validate.
+    std::unique_ptr<xmlRelaxNG, decltype(&xmlRelaxNGFree)> schema;
+    std::unique_ptr<xmlTextReader, decltype(&xmlFreeTextReader)> reader;
+    // The result of the last move of the reader: 1 on a node, 0 at the end and -1 on an error.
+    int status = -1;
+    Section section = Section::NONE;
+    GrampsCounts counts_;
+    QStringList errors;
+
+    static void collectError(void* arg, const char* message, xmlParserSeverities severity, xmlTextReaderLocatorPtr);
+
+    static GrampsRecord parse(Section section, const xmlNode* node);
+
+    /**
+     * Move to the next record, and take it from its tree.
+     */
+    template<typename Function>
+    auto nextWith(Function take) -> std::optional<std::invoke_result_t<Function, const xmlNode*>>;
+
+    void move(int result);
+    [[nodiscard]] bool atRecord();
+    void count();
+};
@@ -0,0 +1,46 @@
+/*
+ * SPDX-FileCopyrightText: Niko Strijbol <niko@strijbol.be>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+#include "import_pipeline.h"
+
+#include <QSqlError>
+
+ChunkedTransaction::ChunkedTransaction(QSqlDatabase& db, int stepsPerTransaction) :
+    db(db),
+    stepsPerTransaction(stepsPerTransaction) {
+}
+
+ChunkedTransaction::~ChunkedTransaction() {
+    if (open && !db.rollback()) {
+        qWarning() << "Failed to rollback import transaction:" << db.lastError().text();
+    }
+}
+
+bool ChunkedTransaction::begin() {
+    if (!db.transaction()) {
+        qWarning() << "Failed to start import transaction:" << db.lastError().text();
+        return false;
+    }
+    open = true;
+    steps = 0;
+    return true;
+}
+
+bool ChunkedTransaction::step() {
+    if (++steps < stepsPerTransaction) {
+        return true;
+    }
+    return commit() && begin();
+}
+
+bool ChunkedTransaction::commit() {
+    if (!db.commit()) {
+        // The transaction is still open, so it is rolled back at the end.
+        qWarning() << "Failed to commit import transaction:" << db.lastError().text();
+        return false;
+    }
+    open = false;
+    return true;
+}
@@ -0,0 +1,454 @@
+/*
+ * SPDX-FileCopyrightText: Niko Strijbol <niko@strijbol.be>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QList>
+#include <QMutex>
+#include <QPromise>
+#include <QQueue>
+#include <QSqlDatabase>
+#include <QString>
+#include <QThread>
+#include <QThreadPool>
+#include <QWaitCondition>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <type_traits>
+
+/**
+ * Values passed from one stage of an import to the next one, which run on different threads.
+ *
+ * The queue holds a limited number of values, so a stage is never much further than the next
+ * one: adding a value waits while the queue is full.
+ */
+template<typename T>
+class BoundedQueue {
+public:
+    static constexpr qsizetype DEFAULT_CAPACITY = 1'000;
+
+    explicit BoundedQueue(qsizetype capacity = DEFAULT_CAPACITY) : capacity(capacity) {
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    /**
+     * Add a value, waiting while the queue is full.
+     *
+     * @return False if the next stage stopped, so this stage can stop as well.
+     */
+    bool push(T&& value) {
+        QMutexLocker locker(&mutex);
+        while (values.size() >= capacity && !closed) {
+            notFull.wait(&mutex);
+        }
+        if (closed) {
+            return false;
+        }
+        values.enqueue(std::move(value));
+        notEmpty.wakeOne();
+        return true;
+    }
+
+    /**
+     * Mark the end of the values.
+     */
+    void finish() {
+        QMutexLocker locker(&mutex);
+        finished = true;
+        notEmpty.wakeOne();
+    }
+
+    /**
+     * Mark the end of the values, because the stage adding them failed.
+     */
+    void fail(const QString& error) {
+        QMutexLocker locker(&mutex);
+        if (!finished) {
+            error_ = error;
+        }
+        finished = true;
+        notEmpty.wakeOne();
+    }
+
+    /**
+     * @return The next value, waiting until it is added, or nothing at the end or once closed.
+     */
+    std::optional<T> pop() {
+        QMutexLocker locker(&mutex);
+        while (values.isEmpty() && !finished && !closed) {
+            notEmpty.wait(&mutex);
+        }
+        if (values.isEmpty() || closed) {
+            return std::nullopt;
+        }
+        auto value = values.dequeue();
+        notFull.wakeOne();
+        return value;
+    }
+
+    /**
+     * Stop passing values, e.g. because the next stage failed. Wakes the stages waiting for the queue.
+     */
+    void close() {
+        QMutexLocker locker(&mutex);
+        closed = true;
+        values.clear();
+        notFull.wakeAll();
+        notEmpty.wakeAll();
+    }
+
+    /**
+     * @return Why the stage adding the values failed, or nothing if it did not.
+     */
+    [[nodiscard]] QString error() const {
+        QMutexLocker locker(&mutex);
+        return error_;
+    }
+
+private:
+    mutable QMutex mutex;
+    QWaitCondition notFull;
+    QWaitCondition notEmpty;
+    QQueue<T> values;
+    qsizetype capacity;
+    bool finished = false;
+    bool closed = false;
+    QString error_;
+};
+
+/**
+ * The output of a stage of an ImportPipeline: the values of one or more queues, one queue after the
+ * other, or one value of each queue in turn for the output of parallel converters.
+ */
+template<typename T>
+class ImportChannel {
+public:
+    /**
+     * @return The next value, waiting until it is available, or nothing at the end or on an error.
+     */
+    std::optional<T> next() {
+        if (interleaved) {
+            return nextInTurn();
+        }
+        while (current < queues.size()) {
+            if (auto value = queues[current]->pop()) {
+                return value;
+            }
+            if (error_ = queues[current]->error(); !error_.isEmpty()) {
+                return std::nullopt;
+            }
+            ++current;
+        }
+        return std::nullopt;
+    }
+
+    /**
+     * @return Why a stage failed, or nothing if none did.
+     */
+    [[nodiscard]] const QString& error() const {
+        return error_;
+    }
+
+private:
+    template<typename>
+    friend class ImportPipeline;
+
+    QList<std::shared_ptr<BoundedQueue<T>>> queues;
+    qsizetype current = 0;
+    // Value i is in queue i modulo the number of queues.
+    bool interleaved = false;
+    QString error_;
+
+    std::optional<T> nextInTurn() {
+        if (queues.isEmpty()) {
+            return std::nullopt;
+        }
+        // The queues get their values in turn, so the end of the next queue is the end of all of them.
+        auto value = queues[current]->pop();
+        if (value) {
+            current = (current + 1) % queues.size();
+        } else {
+            error_ = queues[current]->error();
+        }
+        return value;
+    }
+};
+
+/**
+ * A transaction that is committed and started again every so many steps, e.g. rows.
+ *
+ * A large import does not build up one huge transaction this way. If the import fails, only the
+ * current chunk is rolled back.
+ */
+class ChunkedTransaction {
+public:
+    static constexpr int DEFAULT_STEPS = 2'000;
+
+    explicit ChunkedTransaction(QSqlDatabase& db, int stepsPerTransaction = DEFAULT_STEPS);
+
+    ChunkedTransaction(const ChunkedTransaction&) = delete;
+    ChunkedTransaction& operator=(const ChunkedTransaction&) = delete;
+
+    ~ChunkedTransaction();
+
+    bool begin();
+
+    /**
+     * Commit and begin again if this transaction has enough steps.
+     */
+    bool step();
+
+    bool commit();
+
+    [[nodiscard]] bool isOpen() const {
+        return open;
+    }
+
+private:
+    QSqlDatabase& db;
+    int stepsPerTransaction;
+    bool open = false;
+    int steps = 0;
+};
+
+/**
+ * Runs the stages of an import at the same time, connected by bounded queues.
+ *
+ * An import reads records (read()), converts them (transform()) and writes them to the database
+ * (write()). The readers and converters run on the threads of the pipeline, the writer on the
+ * calling thread, which has the database connection. All stages keep the order of the values, so
+ * the writer gets the values of the first reader first.
+ *
+ * The promise of the import is used to cancel the stages and to report the number of written
+ * values as progress. Nothing runs until write() is called.
+ *
+ * Usage:
+ * @code
+ * ImportPipeline pipeline(promise);
+ * auto lines = pipeline.read<QString>({[&file](BoundedQueue<QString>& output) {
+ *     while (!file.atEnd()) {
+ *         if (!output.push(QString::fromUtf8(file.readLine()))) {
+ *             return;
+ *         }
+ *     }
+ * }});
+ * auto rows = pipeline.transform(std::move(lines), &parseCsvLine);
+ * const auto written = pipeline.write(rows, [&](CsvRow&& row) { return insert(row); });
+ * @endcode
+ */
+template<typename Result>
+class ImportPipeline {
+public:
+    // How often the progress is reported, in ms; reporting it for every value takes longer than writing some.
+    static constexpr qint64 PROGRESS_INTERVAL = 100;
+
+    template<typename T>
+    using Reader = std::function<void(BoundedQueue<T>& output)>;
+
+    explicit ImportPipeline(QPromise<Result>& promise) : promise(promise) {
+    }
+
+    ImportPipeline(const ImportPipeline&) = delete;
+    ImportPipeline& operator=(const ImportPipeline&) = delete;
+
+    ~ImportPipeline() {
+        stop();
+    }
+
+    /**
+     * Add readers, which run at the same time. A reader adds its values to its output, and calls
+     * fail() on it if it cannot read them.
+     *
+     * @return The values of all readers, in the order of the readers.
+     */
+    template<typename T>
+    ImportChannel<T> read(QList<Reader<T>> readers) {
+        ImportChannel<T> channel;
+        for (auto& reader: readers) {
+            auto output = std::make_shared<BoundedQueue<T>>();
+            channel.queues.append(output);
+            readerTasks.append([output, reader = std::move(reader)] {
+                reader(*output);
+                output->finish();
+            });
+            stops.append([output] { output->close(); });
+        }
+        return channel;
+    }
+
+    /**
+     * Add a stage converting each value of the input.
+     */
+    template<typename In, typename Function, typename Out = std::invoke_result_t<Function, In&&>>
+    ImportChannel<Out> transform(ImportChannel<In> input, Function function) {
+        auto output = std::make_shared<BoundedQueue<Out>>();
+        transformTasks.append([input = std::move(input), function = std::move(function), output]() mutable {
+            while (auto value = input.next()) {
+                if (!output->push(std::invoke(function, std::move(*value)))) {
+                    return;
+                }
+            }
+            if (input.error().isEmpty()) {
+                output->finish();
+            } else {
+                output->fail(input.error());
+            }
+        });
+        stops.append([output] { output->close(); });
+
+        ImportChannel<Out> channel;
+        channel.queues.append(output);
+        return channel;
+    }
+
+    /**
+     * Report the text with the next progress of write(), since the promise ignores a text without a
+     * higher progress value. Call it from the writer.
+     */
+    void setProgressText(const QString& text) {
+        progressText = text;
+    }
+
+    /**
+     * Add a stage converting each value of the input on several threads, for a conversion that takes
+     * longer than reading the values. The output keeps the order of the input.
+     *
+     * The values are handed to the converters in turn, and taken from them in the same turn.
+     */
+    template<typename In, typename Function, typename Out = std::invoke_result_t<Function, In&&>>
+    ImportChannel<Out> transform(ImportChannel<In> input, Function function, int converters) {
+        if (converters <= 1) {
+            return transform(std::move(input), std::move(function));
+        }
+
+        ImportChannel<Out> channel;
+        channel.interleaved = true;
+        QList<std::shared_ptr<BoundedQueue<In>>> inputs;
+        for (int i = 0; i < converters; ++i) {
+            auto converterInput = std::make_shared<BoundedQueue<In>>();
+            auto output = std::make_shared<BoundedQueue<Out>>();
+            inputs.append(converterInput);
+            channel.queues.append(output);
+            transformTasks.append([converterInput, output, function] {
+                while (auto value = converterInput->pop()) {
+                    if (!output->push(std::invoke(function, std::move(*value)))) {
+                        return;
+                    }
+                }
+                if (converterInput->error().isEmpty()) {
+                    output->finish();
+                } else {
+                    output->fail(converterInput->error());
+                }
+            });
+            stops.append([converterInput, output] {
+                converterInput->close();
+                output->close();
+            });
+        }
+
+        transformTasks.append([input = std::move(input), inputs]() mutable {
+            qsizetype turn = 0;
+            while (auto value = input.next()) {
+                if (!inputs[turn]->push(std::move(*value))) {
+                    return;
+                }
+                turn = (turn + 1) % inputs.size();
+            }
+            for (const auto& converterInput: inputs) {
+                if (input.error().isEmpty()) {
+                    converterInput->finish();
+                } else {
+                    converterInput->fail(input.error());
+                }
+            }
+        });
+        return channel;
+    }
+
+    /**
+     * Start the other stages, and write each value of the input on this thread.
+     *
+     * @param writer Writes a value, and returns false if that failed.
+     * @return If all values were written: false if a stage failed or the import was canceled.
+     */
+    template<typename T, typename Function>
+    bool write(ImportChannel<T>& input, Function writer) {
+        start();
+        auto progress = promise.future().progressValue();
+        QElapsedTimer sinceProgress;
+        sinceProgress.start();
+
+        bool written = true;
+        while (auto value = input.next()) {
+            if (promise.isCanceled() || !std::invoke(writer, std::move(*value))) {
+                written = false;
+                break;
+            }
+            ++progress;
+            if (sinceProgress.hasExpired(PROGRESS_INTERVAL)) {
+                reportProgress(progress);
+                sinceProgress.restart();
+            }
+        }
+        if (!input.error().isEmpty()) {
+            qWarning() << "Import stage failed:" << input.error();
+            written = false;
+        }
+
+        stop();
+        reportProgress(progress);
+        return written;
+    }
+
+private:
+    QPromise<Result>& promise;
+    // The text for the next progress, if it changed.
+    std::optional<QString> progressText;
+    QThreadPool pool;
+    QList<std::function<void()>> readerTasks;
+    QList<std::function<void()>> transformTasks;
+    // Closes the queues, which stops the stages.
+    QList<std::function<void()>> stops;
+
+    void start() {
+        // Every converter needs its own thread, or it could wait for a reader that waits for it.
+        const auto transforms = static_cast<int>(transformTasks.size());
+        pool.setMaxThreadCount(std::max(QThread::idealThreadCount(), transforms + 1));
+        // The readers are started in order, so the reader of the values that are needed first always runs.
+        for (auto& task: transformTasks) {
+            pool.start(std::move(task));
+        }
+        for (auto& task: readerTasks) {
+            pool.start(std::move(task));
+        }
+        transformTasks.clear();
+        readerTasks.clear();
+    }
+
+    void reportProgress(int progress) {
+        if (progressText.has_value()) {
+            promise.setProgressValueAndText(progress, *progressText);
+            progressText.reset();
+        } else {
+            promise.setProgressValue(progress);
+        }
+    }
+
+    void stop() {
+        pool.clear();
+        for (const auto& stop: stops) {
+            stop();
+        }
+        pool.waitForDone();
+    }
+};
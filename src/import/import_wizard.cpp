@@ -11,7 +11,6 @@
 #include <KLocalizedString>
 #include <QLabel>
 #include <QProgressBar>
-#include <QSqlDatabase>
 #include <QStringLiteral>
 #include <QVBoxLayout>
 #include <QtConcurrent>
@@ -201,7 +200,6 @@ void GrampsImportPage::initializePage() {
     auto previousPage = static_cast<GrampsCheckPage*>(wizard()->page(ImportWizard::Page_GrampsCheck));
 
     auto analysis = previousPage->takeAnalysis();
-    auto databaseName = QSqlDatabase::database().connectionName();
 
     watcher_ = new QFutureWatcher<bool>(this);
     connect(watcher_, &QFutureWatcher<bool>::finished, this, &GrampsImportPage::onFinished);
@@ -216,7 +214,7 @@ void GrampsImportPage::initializePage() {
         progressBar->setRange(minimum, maximum);
     });
 
-    watcher_->setFuture(QtConcurrent::run(importGrampsResult, std::move(analysis), databaseName));
+    watcher_->setFuture(QtConcurrent::run(importGrampsResult, std::move(analysis)));
 }
 
 void GrampsImportPage::cleanupPage() {
@@ -237,6 +235,11 @@ bool GrampsImportPage::isComplete() const {
 
 void GrampsImportPage::onFinished() {
     if (watcher_) {
+        try {
+            watcher_->waitForFinished();
+        } catch (const GrampsImportException& exception) {
+            progressLabel->setText(exception.message());
+        }
         Q_EMIT completeChanged();
         watcher_->cancel();
         watcher_->disconnect(this);
@@ -5,10 +5,10 @@
  */
 #include "name_origins_management_window.h"
 
-#include "../core/data_event_broker.h"
 #include "../domain/name/name_origin_translation_repository.h"
 #include "../domain/name/name_repository.h"
 #include "../domain/name/names.h"
+#include "database/change_capture.h"
 #include "database/schema.h"
 #include "editors/type_translations_dialog.h"
 #include "utils/model_utils.h"
@@ -92,7 +92,7 @@ QVariant NameOriginsManagementWindow::doAddItem() const {
         return {};
     }
     auto newId = query.lastInsertId();
-    DataEventBroker::instance().notifyChanged<Schema::NameOrigins>(newId.toLongLong());
+    ChangeCapture::deliverCommitted();
     return newId;
 }
 
@@ -105,7 +105,7 @@ bool NameOriginsManagementWindow::doRemoveItem(const QVariant& id) const {
         qWarning() << "Could not delete name origin:" << query.lastError().text();
         return false;
     }
-    DataEventBroker::instance().notifyChanged<Schema::NameOrigins>(id.toLongLong());
+    ChangeCapture::deliverCommitted();
     return true;
 }
 
@@ -134,7 +134,7 @@ void NameOriginsManagementWindow::repairItems() {
             q.exec();
         }
     }
-    DataEventBroker::instance().notifyChanged<Schema::NameOrigins>(-1);
+    ChangeCapture::deliverCommitted();
     progress.setValue(1);
 
     // Reload after trim.
@@ -176,7 +176,7 @@ void NameOriginsManagementWindow::repairItems() {
         }
     }
 
-    DataEventBroker::instance().notifyChanged<Schema::NameOrigins>(-1);
+    ChangeCapture::deliverCommitted();
     progress.setValue(5);
 }
 
@@ -230,7 +230,7 @@ void NameOriginsManagementWindow::removeMarkedReferences(
         }
     }
 
-    DataEventBroker::instance().notifyChanged<Schema::Names>(-1);
+    ChangeCapture::deliverCommitted();
 }
 
 bool NameOriginsManagementWindow::isUsed(const QVariant& id) {
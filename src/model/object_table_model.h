@@ -5,15 +5,37 @@
  */
 #pragma once
 
+#include "core/data_event_broker.h"
+#include "utils/async.h"
+#include "utils/locale_change_notifier.h"
+
+#include <qcoro/qcorotask.h>
+
 #include <QAbstractTableModel>
+#include <QDebug>
+#include <QFuture>
+#include <QHash>
 #include <QVariant>
+#include <QtConcurrent>
+#include <concepts>
 #include <functional>
+#include <optional>
+#include <utility>
 
 template<typename T>
 class ObjectTableModel : public QAbstractTableModel {
 public:
     using Extractor = std::function<QVariant(const T&)>;
     using Setter = std::function<bool(T&, const QVariant&)>;
+    using RowId = std::function<IntegerPrimaryKey(const T&)>;
+    using RowFetcher = std::function<std::optional<T>(IntegerPrimaryKey)>;
+
+    // How the values of a projected column are computed, see projectColumn().
+    enum class Projection {
+        SEQUENTIAL,
+        // On the global thread pool, so the extractor must be thread-safe.
+        PARALLEL,
+    };
 
     explicit ObjectTableModel(QObject* parent = nullptr) : QAbstractTableModel(parent) {
     }
@@ -58,10 +80,166 @@ public:
             {header, [field](const T& item) { return QVariant::fromValue(item.*field); }, std::move(setter)};
     }
 
+    /**
+     * Compute the values of a column once per row, when the rows are set, instead of each time a
+     * view asks for them.
+     *
+     * Use this for columns that are expensive to get, e.g. localized dates or names built from
+     * parts. The values are kept in a flat cache, and computed again for rows that change, and
+     * for all rows when the locale or language of the application changes.
+     *
+     * Call this after the column is set.
+     */
+    void projectColumn(int index, Projection projection = Projection::SEQUENTIAL) {
+        Q_ASSERT(index < columns.size());
+        if (columns[index].slot >= 0) {
+            return;
+        }
+        if (projectedColumns.isEmpty()) {
+            connect(&LocaleChangeNotifier::instance(), &LocaleChangeNotifier::changed, this, [this] {
+                projectAllRows();
+            });
+        }
+        columns[index].slot = projectedColumns.size();
+        projectedColumns.append({index, projection});
+        projectAllRows();
+    }
+
+    /**
+     * Set how to get the id of a row.
+     *
+     * This is needed to update single rows, and lets setItems() change only the rows that differ
+     * instead of resetting the model.
+     */
+    void setRowId(RowId rowIdParam) {
+        rowId = std::move(rowIdParam);
+        indexRows();
+    }
+
+    void setRowId(IntegerPrimaryKey T::* field) {
+        setRowId([field](const T& item) { return item.*field; });
+    }
+
+    /**
+     * Keep the rows up to date with changes to a table, one row at a time.
+     *
+     * The ids of the table must be the ids of the rows (see setRowId). When a single row of the
+     * table changes, only that row is fetched again, and it is updated, inserted or removed. Views
+     * keep their selection and scroll position. A table-wide change reloads all rows.
+     *
+     * @param fetchRow Fetch the row with the given id, or std::nullopt if it is not (or no longer)
+     *                 part of this model.
+     * @param reloadAll Reload all rows.
+     */
+    template<typename Table>
+    void updateRowsOn(RowFetcher fetchRow, std::function<void()> reloadAll) {
+        Q_ASSERT(rowId);
+        DataEventBroker::instance().subscribe<Table>(
+            this,
+            std::nullopt,
+            [this, fetchRow = std::move(fetchRow), reloadAll = std::move(reloadAll)](
+                std::optional<IntegerPrimaryKey> id
+            ) {
+                // A reload that is still running might not include the change, so it must run again.
+                if (!id.has_value() || hasPendingReload()) {
+                    reloadAll();
+                    return;
+                }
+                updateRow(*id, fetchRow(*id));
+            }
+        );
+    }
+
+    /**
+     * Update, insert or remove the row with the given id.
+     *
+     * A new row is added at the end; sort with a proxy model if the order matters.
+     *
+     * @param row The new value of the row, or std::nullopt to remove it.
+     */
+    void updateRow(IntegerPrimaryKey id, const std::optional<T>& row) {
+        Q_ASSERT(rowId);
+        const auto existing = rowById.value(id, -1);
+        if (row.has_value() && existing >= 0) {
+            items[existing] = *row;
+            projectRow(existing);
+            Q_EMIT dataChanged(index(existing, 0), index(existing, columns.size() - 1));
+        } else if (row.has_value()) {
+            const auto position = items.size();
+            beginInsertRows({}, position, position);
+            items.append(*row);
+            projected.resize(items.size() * projectedColumns.size());
+            projectRow(position);
+            rowById.insert(id, position);
+            endInsertRows();
+        } else if (existing >= 0) {
+            beginRemoveRows({}, existing, existing);
+            items.removeAt(existing);
+            projected.remove(existing * projectedColumns.size(), projectedColumns.size());
+            rowById.remove(id);
+            indexRows(existing);
+            endRemoveRows();
+        }
+    }
+
+    /**
+     * Replace the items.
+     *
+     * If there is a row id (see setRowId), the rows are matched by id with the current rows, and
+     * only the differences are applied: rows are removed, inserted, moved or changed. Proxies and
+     * views then only handle the rows that were touched, and keep their selection. Otherwise, the
+     * model is reset.
+     */
     void setItems(const QList<T>& itemsParam) {
-        beginResetModel();
-        items = itemsParam;
-        endResetModel();
+        // This is newer than any reload that is still running.
+        appliedGeneration = ++reloadGeneration;
+        replaceItems(itemsParam);
+    }
+
+    /**
+     * Replace the items with the result of the task, once it is finished.
+     *
+     * Until then, the model keeps showing the current items. If another reload is started (or
+     * the items are set directly) before the task finishes, its result is outdated and dropped.
+     *
+     * If the task is already finished (e.g. because the query ran synchronously), the items
+     * are replaced before this returns.
+     */
+    void setItemsAsync(QCoro::Task<QList<T>> task) {
+        const auto generation = ++reloadGeneration;
+        auto apply = [this, generation](const QList<T>& fresh) {
+            if (generation != reloadGeneration) {
+                return;
+            }
+            appliedGeneration = generation;
+            replaceItems(fresh);
+        };
+        auto fail = [this, generation] {
+            qWarning() << "Could not reload items of model" << this;
+            if (generation == reloadGeneration) {
+                appliedGeneration = generation;
+            }
+        };
+
+        auto future = spawn(std::move(task));
+        if (future.isFinished()) {
+            if (future.resultCount() > 0) {
+                apply(future.result());
+            } else {
+                fail();
+            }
+            return;
+        }
+
+        // The continuation runs on the thread of this model, and not at all if it is gone.
+        future.then(this, apply).onFailed(this, fail);
+    }
+
+    /**
+     * @return True if the last reload started with setItemsAsync() has not finished yet.
+     */
+    [[nodiscard]] bool hasPendingReload() const {
+        return appliedGeneration != reloadGeneration;
     }
 
     [[nodiscard]] const QList<T>& getItems() const {
@@ -88,8 +266,12 @@ public:
         }
 
         if (role == Qt::DisplayRole || role == Qt::EditRole) {
+            const auto& column = columns[index.column()];
+            if (column.slot >= 0 && projectionIsCurrent) {
+                return projected[index.row() * projectedColumns.size() + column.slot];
+            }
             const T& item = items[index.row()];
-            return columns[index.column()].extractor(item);
+            return column.extractor(item);
         }
 
         return {};
@@ -104,6 +286,7 @@ public:
             if (setter) {
                 T& item = items[index.row()];
                 if (setter(item, value)) {
+                    projectRow(index.row());
                     Q_EMIT dataChanged(index, index, {Qt::DisplayRole, Qt::EditRole});
                     return true;
                 }
@@ -134,8 +317,260 @@ private:
         QString header;
         Extractor extractor;
         Setter setter;
+        // The position of the column in a row of the projected values, or -1 if it is not projected.
+        qsizetype slot = -1;
     };
 
+    struct ProjectedColumn {
+        int column;
+        Projection projection;
+    };
+
+    // With fewer rows, the thread pool costs more than it saves.
+    static constexpr qsizetype MIN_PARALLEL_ROWS = 1'000;
+
     QList<T> items;
     QList<ColumnDef> columns;
+    QList<ProjectedColumn> projectedColumns;
+    // The values of the projected columns, row after row.
+    QList<QVariant> projected;
+    // False while the rows are being replaced one change at a time; data() then uses the extractors.
+    bool projectionIsCurrent = true;
+    quint64 reloadGeneration = 0;
+    quint64 appliedGeneration = 0;
+    RowId rowId;
+    // The position of each row, by id. Only kept if there is a row id.
+    QHash<IntegerPrimaryKey, qsizetype> rowById;
+
+    void resetItems(const QList<T>& itemsParam, QList<QVariant> projection) {
+        beginResetModel();
+        items = itemsParam;
+        projected = std::move(projection);
+        projectionIsCurrent = true;
+        indexRows();
+        endResetModel();
+    }
+
+    // The values of the projected columns for the rows.
+    [[nodiscard]] QList<QVariant> project(const QList<T>& rows) const {
+        const auto width = projectedColumns.size();
+        QList<QVariant> result(rows.size() * width);
+        if (width == 0) {
+            return result;
+        }
+        bool anyParallel = false;
+        for (qsizetype slot = 0; slot < width; ++slot) {
+            const auto& [column, projection] = projectedColumns[slot];
+            if (projection == Projection::PARALLEL && rows.size() >= MIN_PARALLEL_ROWS) {
+                anyParallel = true;
+                continue;
+            }
+            const auto& extractor = columns[column].extractor;
+            for (qsizetype row = 0; row < rows.size(); ++row) {
+                result[row * width + slot] = extractor(rows[row]);
+            }
+        }
+        if (anyParallel) {
+            const auto* first = result.data();
+            QtConcurrent::blockingMap(result, [this, &rows, width, first](QVariant& value) {
+                const auto offset = &value - first;
+                const auto& [column, projection] = projectedColumns[offset % width];
+                if (projection == Projection::PARALLEL) {
+                    value = columns[column].extractor(rows[offset / width]);
+                }
+            });
+        }
+        return result;
+    }
+
+    void projectRow(qsizetype row) {
+        const auto width = projectedColumns.size();
+        for (qsizetype slot = 0; slot < width; ++slot) {
+            projected[row * width + slot] = columns[projectedColumns[slot].column].extractor(items[row]);
+        }
+    }
+
+    void projectAllRows() {
+        projected = project(items);
+        projectionIsCurrent = true;
+        if (!items.isEmpty()) {
+            for (const auto& projectedColumn: std::as_const(projectedColumns)) {
+                Q_EMIT dataChanged(index(0, projectedColumn.column), index(items.size() - 1, projectedColumn.column));
+            }
+        }
+    }
+
+    // With more runs of removed or inserted rows than this, a reset is cheaper for views and proxies.
+    static constexpr qsizetype MAX_STRUCTURAL_CHANGES = 100;
+
+    void replaceItems(const QList<T>& fresh) {
+        auto freshProjection = project(fresh);
+        // Without ids (or with duplicate ids), rows cannot be matched.
+        if (!rowId || items.isEmpty() || rowById.size() != items.size()) {
+            resetItems(fresh, std::move(freshProjection));
+            return;
+        }
+        QHash<IntegerPrimaryKey, qsizetype> freshById;
+        freshById.reserve(fresh.size());
+        for (qsizetype position = 0; position < fresh.size(); ++position) {
+            freshById.insert(rowId(fresh[position]), position);
+        }
+        if (freshById.size() != fresh.size()) {
+            resetItems(fresh, std::move(freshProjection));
+            return;
+        }
+
+        // Count the structural changes first, to decide whether to reset instead.
+        qsizetype runs = 0;
+        bool reordered = false;
+        bool inRun = false;
+        qsizetype lastKept = -1;
+        for (const auto& item: std::as_const(items)) {
+            const auto target = freshById.value(rowId(item), -1);
+            if (target < 0) {
+                runs += inRun ? 0 : 1;
+                inRun = true;
+                continue;
+            }
+            inRun = false;
+            reordered = reordered || target < lastKept;
+            lastKept = target;
+        }
+        inRun = false;
+        for (const auto& item: fresh) {
+            const bool added = !rowById.contains(rowId(item));
+            runs += added && !inRun ? 1 : 0;
+            inRun = added;
+        }
+        if (runs > MAX_STRUCTURAL_CHANGES) {
+            resetItems(fresh, std::move(freshProjection));
+            return;
+        }
+
+        // The projected values are replaced at the end; until then, the rows are out of step with them.
+        projectionIsCurrent = false;
+        removeRowsNotIn(freshById);
+        if (reordered) {
+            moveRowsInOrderOf(freshById, fresh.size());
+        }
+        insertRowsNotIn(fresh);
+        // The rows now have the same ids as the fresh items, but maybe other values.
+        changeRows(fresh, std::move(freshProjection));
+    }
+
+    // Remove the rows that are not in the fresh items, from the back so the positions stay valid.
+    void removeRowsNotIn(const QHash<IntegerPrimaryKey, qsizetype>& freshById) {
+        auto last = items.size() - 1;
+        while (last >= 0) {
+            if (freshById.contains(rowId(items[last]))) {
+                --last;
+                continue;
+            }
+            auto first = last;
+            while (first > 0 && !freshById.contains(rowId(items[first - 1]))) {
+                --first;
+            }
+            beginRemoveRows({}, first, last);
+            items.remove(first, last - first + 1);
+            endRemoveRows();
+            last = first - 1;
+        }
+    }
+
+    // Put the rows in the order of the fresh items; all rows must be in the fresh items.
+    void moveRowsInOrderOf(const QHash<IntegerPrimaryKey, qsizetype>& freshById, qsizetype freshSize) {
+        Q_EMIT layoutAboutToBeChanged({}, QAbstractItemModel::VerticalSortHint);
+
+        QList<qsizetype> oldRowAt(freshSize, -1);
+        for (qsizetype row = 0; row < items.size(); ++row) {
+            oldRowAt[freshById.value(rowId(items[row]))] = row;
+        }
+        QList<T> moved;
+        moved.reserve(items.size());
+        QList<qsizetype> newRowOf(items.size());
+        for (const auto oldRow: std::as_const(oldRowAt)) {
+            if (oldRow >= 0) {
+                newRowOf[oldRow] = moved.size();
+                moved.append(std::move(items[oldRow]));
+            }
+        }
+        items = std::move(moved);
+
+        const auto from = persistentIndexList();
+        QModelIndexList to;
+        to.reserve(from.size());
+        for (const auto& persistent: from) {
+            to.append(index(newRowOf[persistent.row()], persistent.column()));
+        }
+        changePersistentIndexList(from, to);
+
+        Q_EMIT layoutChanged({}, QAbstractItemModel::VerticalSortHint);
+    }
+
+    // Insert the fresh items that were not rows before; the other rows must be in the fresh order.
+    void insertRowsNotIn(const QList<T>& fresh) {
+        qsizetype first = 0;
+        while (first < fresh.size()) {
+            if (rowById.contains(rowId(fresh[first]))) {
+                ++first;
+                continue;
+            }
+            auto last = first;
+            while (last + 1 < fresh.size() && !rowById.contains(rowId(fresh[last + 1]))) {
+                ++last;
+            }
+            beginInsertRows({}, first, last);
+            auto inserted = items.first(first);
+            inserted.reserve(items.size() + last - first + 1);
+            inserted.append(fresh.sliced(first, last - first + 1));
+            inserted.append(items.sliced(first));
+            items = std::move(inserted);
+            endInsertRows();
+            first = last + 1;
+        }
+    }
+
+    // Replace the rows by the fresh items, which have the same ids, and report the ones that differ.
+    void changeRows(const QList<T>& fresh, QList<QVariant> freshProjection) {
+        QList<std::pair<qsizetype, qsizetype>> changed;
+        if constexpr (std::equality_comparable<T>) {
+            for (qsizetype row = 0; row < items.size(); ++row) {
+                if (items[row] == fresh[row]) {
+                    continue;
+                }
+                if (!changed.isEmpty() && changed.last().second == row - 1) {
+                    changed.last().second = row;
+                } else {
+                    changed.append({row, row});
+                }
+            }
+        } else if (!items.isEmpty()) {
+            changed.append({0, items.size() - 1});
+        }
+
+        items = fresh;
+        projected = std::move(freshProjection);
+        projectionIsCurrent = true;
+        indexRows();
+
+        if (changed.size() > MAX_STRUCTURAL_CHANGES) {
+            changed = {{changed.first().first, changed.last().second}};
+        }
+        for (const auto& [first, last]: std::as_const(changed)) {
+            Q_EMIT dataChanged(index(first, 0), index(last, columns.size() - 1));
+        }
+    }
+
+    void indexRows(qsizetype from = 0) {
+        if (!rowId) {
+            return;
+        }
+        if (from == 0) {
+            rowById.clear();
+            rowById.reserve(items.size());
+        }
+        for (auto position = from; position < items.size(); ++position) {
+            rowById.insert(rowId(items[position]), position);
+        }
+    }
 };
@@ -6,7 +6,6 @@
 #include "person_detail_view.h"
 
 #include "../domain/event/event_types.h"
-#include "../domain/name/names.h"
 #include "../domain/person/person_sex.h"
 #include "core/data_event_broker.h"
 #include "database/schema.h"
@@ -53,9 +52,7 @@ DeathInformation constructDeathText(const QAbstractItemModel* birthModel, const
     if (deathModel->rowCount() != 0) {
         qDebug() << "There is a death event";
         auto index = deathModel->index(0, PersonDeathEventsModel::DATE);
-        deathDate = GenealogicalDate::fromDatabaseRepresentation(
-            deathModel->index(0, PersonDeathEventsModel::DATE_RAW).data().toString()
-        );
+        deathDate = deathModel->index(0, PersonDeathEventsModel::DATE_RAW).data().value<GenealogicalDate>();
         if (!deathDate.isValid()) {
             return {.symbol = QStringLiteral("✝︎"), .date = i18n("unknown date")};
         }
@@ -85,9 +82,7 @@ DeathInformation constructDeathText(const QAbstractItemModel* birthModel, const
 
     QString ageText;
     if (birthModel->rowCount() != 0) {
-        auto birthDate = GenealogicalDate::fromDatabaseRepresentation(
-            birthModel->index(0, PersonBirthEventsModel::DATE_RAW).data().toString()
-        );
+        auto birthDate = birthModel->index(0, PersonBirthEventsModel::DATE_RAW).data().value<GenealogicalDate>();
         auto birthProleptic = birthDate.prolepticRepresentation();
         auto deathProleptic = deathDate.prolepticRepresentation();
         auto ageInDays = birthProleptic.daysTo(deathProleptic);
@@ -220,8 +215,7 @@ bool PersonDetailView::hasId(IntegerPrimaryKey id) const {
 QString PersonDetailView::getDisplayName() const {
     QString name;
     if (personData.has_value()) {
-        name =
-            construct_display_name(personData->titles, personData->givenNames, personData->prefix, personData->surname);
+        name = personData->displayName;
     }
     auto personId = format_id(FormattedIdentifierDelegate::PERSON, id);
     return QStringLiteral("%1 [%2]").arg(name, personId);
@@ -9,6 +9,7 @@
 #include "domain/family/ancestor_model.h"
 #include "utils/formatted_identifier_delegate.h"
 
+#include <QTimer>
 #include <QtNodes/StyleCollection>
 
 namespace {
@@ -20,19 +21,228 @@ ConnectionId create(NodeId out, NodeId in) {
         .inPortIndex = 0,
     };
 }
+
+void appendUnique(QList<NodeId>& nodes, NodeId node) {
+    // A node has few parents or children, so this is cheaper than a set.
+    if (!nodes.contains(node)) {
+        nodes.append(node);
+    }
+}
 }
 
-PersonTreeGraphModel::PersonTreeGraphModel(IntegerPrimaryKey person) {
-    this->sourceModel_ = new AncestorModel(person, this);
+PersonTreeGraphModel::PersonTreeGraphModel(IntegerPrimaryKey person, int generations) :
+    root_(static_cast<NodeId>(person)) {
+    this->sourceModel_ = new AncestorModel(person, generations, this);
+    layout_.setSpacing({.siblings = 300, .subtrees = 360, .levels = 150});
 
-    connect(sourceModel_, &QAbstractItemModel::modelReset, this, [this] {
-        Q_EMIT this->modelReset();
-        calculateNodePositions();
-    });
+    connect(sourceModel_, &QAbstractItemModel::modelReset, this, &PersonTreeGraphModel::scheduleRefresh);
+    connect(sourceModel_, &QAbstractItemModel::rowsInserted, this, &PersonTreeGraphModel::scheduleRefresh);
+    connect(sourceModel_, &QAbstractItemModel::rowsRemoved, this, &PersonTreeGraphModel::scheduleRefresh);
+    connect(sourceModel_, &QAbstractItemModel::layoutChanged, this, &PersonTreeGraphModel::scheduleRefresh);
+    connect(sourceModel_, &QAbstractItemModel::dataChanged, this, &PersonTreeGraphModel::scheduleRefresh);
 
+    rebuildIndex();
+    rebuildLayout();
     calculateNodePositions();
 }
 
+void PersonTreeGraphModel::scheduleRefresh() {
+    // A reload of the source model often comes as a reset followed by inserted rows and changed data.
+    if (refreshPending) {
+        return;
+    }
+    refreshPending = true;
+    QTimer::singleShot(0, this, [this] {
+        if (refreshPending) {
+            refresh();
+        }
+    });
+}
+
+void PersonTreeGraphModel::refresh() {
+    refreshPending = false;
+    const auto nodesBefore = visibleNodes();
+    const auto connectionsBefore = visibleConnections();
+    const auto captionsBefore = captions_;
+
+    rebuildIndex();
+    rebuildLayout();
+    const auto laidOut = calculateNodePositions();
+    emitChanges(nodesBefore, connectionsBefore, laidOut);
+
+    for (const auto nodeId: nodesBefore) {
+        const auto caption = captions_.constFind(nodeId);
+        if (caption != captions_.cend() && *caption != captionsBefore.value(nodeId) && layout_.isVisible(nodeId)) {
+            Q_EMIT nodeUpdated(nodeId);
+        }
+    }
+}
+
+void PersonTreeGraphModel::rebuildIndex() {
+    rowOfNode_.clear();
+    parentsOf_.clear();
+    childrenOf_.clear();
+    captions_.clear();
+
+    const auto rows = sourceModel_->rowCount();
+    rowOfNode_.reserve(rows);
+    for (int row = 0; row < rows; ++row) {
+        const auto childId = sourceModel_->index(row, AncestorModel::CHILD_ID).data().toUInt();
+        if (!rowOfNode_.contains(childId)) {
+            rowOfNode_.insert(childId, row);
+            const auto name = sourceModel_->index(row, AncestorModel::DISPLAY_NAME).data().toString();
+            const auto id = format_id(FormattedIdentifierDelegate::PERSON, childId);
+            if (sourceModel_->index(row, AncestorModel::UNLOADED_PARENTS).data().toBool()) {
+                captions_.insert(childId, QStringLiteral("%1 (%2) …").arg(name, id));
+            } else {
+                captions_.insert(childId, QStringLiteral("%1 (%2)").arg(name, id));
+            }
+        }
+
+        for (const auto parentColumn: {AncestorModel::FATHER_ID, AncestorModel::MOTHER_ID}) {
+            const auto parentData = sourceModel_->index(row, parentColumn).data();
+            if (parentData.isNull()) {
+                continue;
+            }
+            const auto parentId = parentData.toUInt();
+            appendUnique(parentsOf_[childId], parentId);
+            appendUnique(childrenOf_[parentId], childId);
+        }
+    }
+}
+
+void PersonTreeGraphModel::rebuildLayout() {
+    if (!rowOfNode_.contains(root_)) {
+        layout_.clear();
+        return;
+    }
+
+    // The parents of a person are its children in the layout. Parents that are already in the
+    // tree are skipped, so everyone is placed once.
+    QList<NodeId> order{root_};
+    QHash<NodeId, QList<NodeId>> childrenInLayout;
+    QSet<NodeId> placed{root_};
+    for (qsizetype next = 0; next < order.size(); ++next) {
+        auto& children = childrenInLayout[order[next]];
+        for (const auto parentId: parentsOf_.value(order[next])) {
+            if (rowOfNode_.contains(parentId) && !placed.contains(parentId)) {
+                placed.insert(parentId);
+                children.append(parentId);
+                order.append(parentId);
+            }
+        }
+    }
+
+    // Update the current layout, so only the changed subtrees are laid out again. This is not
+    // possible if someone moved to another child in the layout.
+    bool inPlace = layout_.contains(root_);
+    for (qsizetype next = 0; next < order.size() && inPlace; ++next) {
+        const auto current = layout_.children(order[next]);
+        for (const auto childId: childrenInLayout.value(order[next])) {
+            if (layout_.contains(childId) && !current.contains(childId)) {
+                inPlace = false;
+            }
+        }
+    }
+    if (!inPlace) {
+        layout_.setRoot(root_);
+    }
+    for (const auto nodeId: std::as_const(order)) {
+        layout_.setChildren(nodeId, childrenInLayout.value(nodeId));
+        layout_.setCollapsed(nodeId, collapsed_.contains(nodeId));
+    }
+}
+
+QList<NodeId> PersonTreeGraphModel::calculateNodePositions() {
+    const auto laidOut = layout_.layout();
+    for (const auto nodeId: laidOut) {
+        const auto position = layout_.position(nodeId);
+        // The ancestors are above the person.
+        _nodeGeometryData[nodeId].pos = {position.x(), -position.y()};
+    }
+    return laidOut;
+}
+
+void PersonTreeGraphModel::setCollapsed(NodeId nodeId, bool collapsed) {
+    if (!layout_.contains(nodeId) || layout_.isCollapsed(nodeId) == collapsed) {
+        return;
+    }
+    if (collapsed) {
+        collapsed_.insert(nodeId);
+    } else {
+        collapsed_.remove(nodeId);
+    }
+
+    const auto nodesBefore = visibleNodes();
+    const auto connectionsBefore = visibleConnections();
+    layout_.setCollapsed(nodeId, collapsed);
+    emitChanges(nodesBefore, connectionsBefore, calculateNodePositions());
+}
+
+bool PersonTreeGraphModel::isCollapsed(NodeId nodeId) const {
+    return layout_.isCollapsed(nodeId);
+}
+
+bool PersonTreeGraphModel::hasUnloadedAncestors(NodeId nodeId) const {
+    const auto row = rowOfNode_.constFind(nodeId);
+    return row != rowOfNode_.cend() && sourceModel_->index(*row, AncestorModel::UNLOADED_PARENTS).data().toBool();
+}
+
+void PersonTreeGraphModel::loadAncestors(NodeId nodeId) {
+    // The new ancestors are shown once they are loaded.
+    setCollapsed(nodeId, false);
+    sourceModel_->loadMoreGenerations(nodeId);
+}
+
+QSet<NodeId> PersonTreeGraphModel::visibleNodes() const {
+    const auto nodes = layout_.visibleNodes();
+    return QSet<NodeId>(nodes.cbegin(), nodes.cend());
+}
+
+std::unordered_set<ConnectionId> PersonTreeGraphModel::visibleConnections() const {
+    std::unordered_set<ConnectionId> result;
+    for (const auto nodeId: layout_.visibleNodes()) {
+        for (const auto parentId: parentsOf_.value(nodeId)) {
+            if (layout_.isVisible(parentId)) {
+                result.insert(create(parentId, nodeId));
+            }
+        }
+    }
+    return result;
+}
+
+void PersonTreeGraphModel::emitChanges(
+    const QSet<NodeId>& nodesBefore,
+    const std::unordered_set<ConnectionId>& connectionsBefore,
+    const QList<NodeId>& laidOut
+) {
+    const auto nodesAfter = visibleNodes();
+    const auto connectionsAfter = visibleConnections();
+
+    // Connections are removed before their nodes, and added after them.
+    for (const auto& connectionId: connectionsBefore) {
+        if (!connectionsAfter.contains(connectionId)) {
+            Q_EMIT connectionDeleted(connectionId);
+        }
+    }
+    for (const auto nodeId: nodesBefore - nodesAfter) {
+        Q_EMIT nodeDeleted(nodeId);
+    }
+    for (const auto nodeId: nodesAfter - nodesBefore) {
+        Q_EMIT nodeCreated(nodeId);
+    }
+    for (const auto& connectionId: connectionsAfter) {
+        if (!connectionsBefore.contains(connectionId)) {
+            Q_EMIT connectionCreated(connectionId);
+        }
+    }
+    for (const auto nodeId: laidOut) {
+        if (nodesBefore.contains(nodeId)) {
+            Q_EMIT nodePositionUpdated(nodeId);
+        }
+    }
+}
+
 QtNodes::NodeFlags PersonTreeGraphModel::nodeFlags(NodeId nodeId) const {
     Q_UNUSED(nodeId);
     return QtNodes::NoFlags;
@@ -40,8 +250,11 @@ QtNodes::NodeFlags PersonTreeGraphModel::nodeFlags(NodeId nodeId) const {
 
 std::unordered_set<NodeId> PersonTreeGraphModel::allNodeIds() const {
     std::unordered_set<NodeId> result;
-    for (int row = 0; row < sourceModel_->rowCount(); ++row) {
-        result.insert(sourceModel_->index(row, AncestorModel::CHILD_ID).data().toUInt());
+    result.reserve(rowOfNode_.size());
+    for (auto it = rowOfNode_.cbegin(); it != rowOfNode_.cend(); ++it) {
+        if (layout_.isVisible(it.key())) {
+            result.insert(it.key());
+        }
     }
     return result;
 }
@@ -60,31 +273,20 @@ std::unordered_set<ConnectionId>
 PersonTreeGraphModel::connections(NodeId nodeId, PortType portType, PortIndex index) const {
     std::unordered_set<ConnectionId> result;
     Q_UNUSED(index);
+    if (!layout_.isVisible(nodeId)) {
+        return result;
+    }
     if (portType == PortType::In) {
-        auto matches =
-            sourceModel_->match(sourceModel_->index(0, AncestorModel::CHILD_ID), Qt::DisplayRole, nodeId, -1);
-        for (auto matchedIndex: std::as_const(matches)) {
-            auto fatherData = sourceModel_->index(matchedIndex.row(), AncestorModel::FATHER_ID).data();
-            if (!fatherData.isNull()) {
-                result.insert(create(fatherData.toUInt(), nodeId));
-            }
-            auto motherData = sourceModel_->index(matchedIndex.row(), AncestorModel::MOTHER_ID).data();
-            if (!motherData.isNull()) {
-                result.insert(create(motherData.toUInt(), nodeId));
+        for (const auto parentId: parentsOf_.value(nodeId)) {
+            if (layout_.isVisible(parentId)) {
+                result.insert(create(parentId, nodeId));
             }
         }
     } else if (portType == PortType::Out) {
-        auto fatherMatches =
-            sourceModel_->match(sourceModel_->index(0, AncestorModel::FATHER_ID), Qt::DisplayRole, nodeId, -1);
-        for (auto matchedIndex: std::as_const(fatherMatches)) {
-            auto childData = sourceModel_->index(matchedIndex.row(), AncestorModel::CHILD_ID).data();
-            result.insert(create(nodeId, childData.toUInt()));
-        }
-        auto motherMatches =
-            sourceModel_->match(sourceModel_->index(0, AncestorModel::MOTHER_ID), Qt::DisplayRole, nodeId, -1);
-        for (auto matchedIndex: std::as_const(motherMatches)) {
-            auto childData = sourceModel_->index(matchedIndex.row(), AncestorModel::CHILD_ID).data();
-            result.insert(create(nodeId, childData.toUInt()));
+        for (const auto childId: childrenOf_.value(nodeId)) {
+            if (layout_.isVisible(childId)) {
+                result.insert(create(nodeId, childId));
+            }
         }
     }
 
@@ -92,22 +294,13 @@ PersonTreeGraphModel::connections(NodeId nodeId, PortType portType, PortIndex in
 }
 
 bool PersonTreeGraphModel::connectionExists(const ConnectionId connectionId) const {
-    auto matches = sourceModel_->match(
-        sourceModel_->index(0, AncestorModel::CHILD_ID),
-        Qt::DisplayRole,
-        connectionId.inNodeId,
-        -1
-    );
-
-    return std::ranges::any_of(matches, [&](const QModelIndex& matchedIndex) {
-        auto fatherData = sourceModel_->index(matchedIndex.row(), AncestorModel::FATHER_ID).data();
-        auto motherData = sourceModel_->index(matchedIndex.row(), AncestorModel::MOTHER_ID).data();
-        return (!fatherData.isNull() && fatherData.toUInt() == connectionId.outNodeId) ||
-               (!motherData.isNull() && motherData.toUInt() == connectionId.outNodeId);
-    });
+    if (!layout_.isVisible(connectionId.inNodeId) || !layout_.isVisible(connectionId.outNodeId)) {
+        return false;
+    }
+    const auto parents = parentsOf_.constFind(connectionId.inNodeId);
+    return parents != parentsOf_.cend() && parents->contains(connectionId.outNodeId);
 }
 
-
 bool PersonTreeGraphModel::connectionPossible(const ConnectionId connectionId) const {
     Q_UNUSED(connectionId);
     return false;
@@ -119,8 +312,7 @@ bool PersonTreeGraphModel::detachPossible(const ConnectionId connectionId) const
 }
 
 bool PersonTreeGraphModel::nodeExists(const NodeId nodeId) const {
-    auto matches = findByChildId(nodeId);
-    return !matches.isEmpty();
+    return layout_.isVisible(nodeId);
 }
 
 QVariant PersonTreeGraphModel::nodeData(NodeId nodeId, NodeRole role) const {
@@ -133,13 +325,9 @@ QVariant PersonTreeGraphModel::nodeData(NodeId nodeId, NodeRole role) const {
             return _nodeGeometryData[nodeId].size;
         case NodeRole::CaptionVisible:
             return true;
-        case NodeRole::Caption: {
+        case NodeRole::Caption:
             // TODO: show more data here.
-            auto index = findByChildId(nodeId);
-            auto name = sourceModel_->index(index.first().row(), AncestorModel::DISPLAY_NAME).data().toString();
-            auto id = format_id(FormattedIdentifierDelegate::PERSON, nodeId);
-            return QStringLiteral("%1 (%2)").arg(name, id);
-        }
+            return captions_.value(nodeId);
         case NodeRole::Style:
             return QtNodes::StyleCollection::nodeStyle().toJson().toVariantMap();
         case NodeRole::InPortCount:
@@ -237,35 +425,11 @@ bool PersonTreeGraphModel::deleteNode(const NodeId nodeId) {
     return false;
 }
 
-void PersonTreeGraphModel::calculateNodePositions() const {
-    // TODO: use a proper algorithm for this.
-    // TODO: do not do a double pass.
-    QMap<int, QList<NodeId>> levelToNodes;
-    for (int row = 0; row < sourceModel_->rowCount(); ++row) {
-        auto nodeId = sourceModel_->index(row, AncestorModel::CHILD_ID).data().toUInt();
-        auto level = sourceModel_->index(row, AncestorModel::LEVEL).data().toInt();
-        auto yValue = (level - 1) * 150;
-        _nodeGeometryData[nodeId].pos.setY(-yValue);
-        levelToNodes[level].append(nodeId);
-    }
-
-    for (int level = 1; level <= levelToNodes.count(); ++level) {
-        auto nodes = levelToNodes[level];
-        std::ranges::sort(nodes);
-        for (int nodeIndex = 0; nodeIndex < nodes.count(); ++nodeIndex) {
-            NodeId nodeId = nodes[nodeIndex];
-            double dIndex = nodeIndex;
-            int max = static_cast<int>(nodes.count()) - 1;
-            // NOLINTNEXTLINE(bugprone-integer-division)
-            double centeredIndex = dIndex - (max / 2) + (nodes.count() % 2 ? 0 : -0.5);
-            double xValue = 300 * centeredIndex;
-            _nodeGeometryData[nodeId].pos.setX(xValue);
-        }
-    }
-}
-
 QModelIndexList PersonTreeGraphModel::findByChildId(NodeId childId) const {
     // TODO: should we support multiple parents somehow?
-    auto start = sourceModel_->index(0, AncestorModel::CHILD_ID);
-    return sourceModel_->match(start, Qt::DisplayRole, childId);
+    const auto row = rowOfNode_.constFind(childId);
+    if (row == rowOfNode_.cend()) {
+        return {};
+    }
+    return {sourceModel_->index(*row, AncestorModel::CHILD_ID)};
 }
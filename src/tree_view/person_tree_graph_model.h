@@ -7,9 +7,14 @@
 #pragma once
 
 #include "database/schema.h"
+#include "domain/family/ancestor_model.h"
+#include "tidy_tree_layout.h"
 
 #include <QAbstractItemModel>
+#include <QHash>
+#include <QList>
 #include <QPointF>
+#include <QSet>
 #include <QSizeF>
 #include <QtNodes/AbstractGraphModel>
 
@@ -29,12 +34,23 @@ struct NodeGeometryData {
 
 /**
  * Maps a normal Qt model from the database to one that graph can use.
+ *
+ * QtNodes queries the graph for every node and port while painting, so the nodes and edges of
+ * the source model are indexed once when it changes, and all queries are answered from the index.
+ * The scene is told which nodes and connections were added, removed or moved, so it is not reset.
+ *
+ * The ancestors are laid out as a tidy tree with the person at the bottom. A person that is an
+ * ancestor along several lines is placed once, above the first descendant it was found for. The
+ * ancestors of a person can be hidden by collapsing it.
+ *
+ * Only some generations are loaded at first; the ancestors of the last generation are loaded when
+ * asked for (see loadAncestors).
  */
 class PersonTreeGraphModel : public QtNodes::AbstractGraphModel {
     Q_OBJECT
 
 public:
-    explicit PersonTreeGraphModel(IntegerPrimaryKey person);
+    explicit PersonTreeGraphModel(IntegerPrimaryKey person, int generations = AncestorModel::DEFAULT_GENERATIONS);
 
     [[nodiscard]] QtNodes::NodeFlags nodeFlags(NodeId nodeId) const override;
 
@@ -62,9 +78,59 @@ public:
 
     QModelIndexList findByChildId(NodeId childId) const;
 
+    /**
+     * Hide or show the ancestors of a person.
+     */
+    void setCollapsed(NodeId nodeId, bool collapsed);
+    [[nodiscard]] bool isCollapsed(NodeId nodeId) const;
+
+    /**
+     * @return If the person has parents that are not loaded yet.
+     */
+    [[nodiscard]] bool hasUnloadedAncestors(NodeId nodeId) const;
+
+    /**
+     * Load more generations of the ancestors of a person, and show them.
+     */
+    void loadAncestors(NodeId nodeId);
+
 private:
-    QAbstractItemModel* sourceModel_;
+    AncestorModel* sourceModel_;
+    NodeId root_;
     mutable std::unordered_map<NodeId, NodeGeometryData> _nodeGeometryData;
 
-    void calculateNodePositions() const;
+    // The first row of each node in the source model.
+    QHash<NodeId, int> rowOfNode_;
+    QHash<NodeId, QList<NodeId>> parentsOf_;
+    QHash<NodeId, QList<NodeId>> childrenOf_;
+    QHash<NodeId, QString> captions_;
+
+    TidyTreeLayout layout_;
+    // Kept when the source model is reset.
+    QSet<NodeId> collapsed_;
+    bool refreshPending = false;
+
+    /**
+     * Refresh once the event loop runs again, for all changes of the source model until then.
+     */
+    void scheduleRefresh();
+    /**
+     * Update the index and layout to the source model, and tell the scene what changed.
+     */
+    void refresh();
+    void rebuildIndex();
+    void rebuildLayout();
+    /**
+     * Lay out what changed since the last layout.
+     *
+     * @return The nodes that were laid out again.
+     */
+    QList<NodeId> calculateNodePositions();
+    [[nodiscard]] QSet<NodeId> visibleNodes() const;
+    [[nodiscard]] std::unordered_set<ConnectionId> visibleConnections() const;
+    void emitChanges(
+        const QSet<NodeId>& nodesBefore,
+        const std::unordered_set<ConnectionId>& connectionsBefore,
+        const QList<NodeId>& laidOut
+    );
 };
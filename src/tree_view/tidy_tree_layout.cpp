@@ -0,0 +1,462 @@
+/*
+ * SPDX-FileCopyrightText: Niko Strijbol <niko@strijbol.be>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "tidy_tree_layout.h"
+
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+const std::vector<int> NO_CHILDREN;
+
+bool sameOutline(const std::vector<std::pair<double, double>>& a, const std::vector<std::pair<double, double>>& b) {
+    constexpr double EPSILON = 1e-9;
+    return std::ranges::equal(a, b, [](const auto& left, const auto& right) {
+        return std::abs(left.first - right.first) < EPSILON && std::abs(left.second - right.second) < EPSILON;
+    });
+}
+
+void extend(std::vector<std::pair<double, double>>& outline, int depth, double x) {
+    if (std::cmp_less_equal(outline.size(), depth)) {
+        outline.emplace_back(x, x);
+        return;
+    }
+    auto& [left, right] = outline[depth];
+    left = std::min(left, x);
+    right = std::max(right, x);
+}
+}
+
+void TidyTreeLayout::setSpacing(const Spacing& spacingParam) {
+    spacing = spacingParam;
+    layoutAll = true;
+}
+
+void TidyTreeLayout::setRoot(Key rootKey) {
+    clear();
+    root = allocate(rootKey, -1);
+}
+
+void TidyTreeLayout::clear() {
+    nodes.clear();
+    freeSlots.clear();
+    indexOf.clear();
+    dirtyNodes.clear();
+    withRemoved.clear();
+    root = -1;
+    placedCount = 0;
+    layoutAll = true;
+}
+
+void TidyTreeLayout::setChildren(Key key, const QList<Key>& childKeys) {
+    const auto found = indexOf.constFind(key);
+    if (found == indexOf.cend()) {
+        qWarning() << "Cannot set children of node" << key << "that is not in the tree";
+        return;
+    }
+    const int node = *found;
+
+    std::vector<int> newChildren;
+    newChildren.reserve(childKeys.size());
+    for (const auto childKey: childKeys) {
+        const auto existing = indexOf.constFind(childKey);
+        if (existing == indexOf.cend()) {
+            // This might reallocate the nodes.
+            newChildren.push_back(allocate(childKey, node));
+        } else if (nodes[*existing].parent == node && std::ranges::find(newChildren, *existing) == newChildren.end()) {
+            newChildren.push_back(*existing);
+        }
+    }
+
+    if (newChildren == nodes[node].children) {
+        return;
+    }
+
+    for (const auto oldChild: nodes[node].children) {
+        if (std::ranges::find(newChildren, oldChild) == newChildren.end()) {
+            detach(oldChild);
+            if (nodes[node].removed.empty()) {
+                withRemoved.push_back(node);
+            }
+            nodes[node].removed.push_back(oldChild);
+        }
+    }
+    for (std::size_t number = 0; number < newChildren.size(); ++number) {
+        nodes[newChildren[number]].number = static_cast<int>(number);
+    }
+    nodes[node].children = std::move(newChildren);
+    markDirty(node);
+}
+
+void TidyTreeLayout::setCollapsed(Key key, bool collapsed) {
+    const auto found = indexOf.constFind(key);
+    if (found == indexOf.cend() || nodes[*found].collapsed == collapsed) {
+        return;
+    }
+    nodes[*found].collapsed = collapsed;
+    markDirty(*found);
+}
+
+bool TidyTreeLayout::isCollapsed(Key key) const {
+    const auto found = indexOf.constFind(key);
+    return found != indexOf.cend() && nodes[*found].collapsed;
+}
+
+bool TidyTreeLayout::contains(Key key) const {
+    return indexOf.contains(key);
+}
+
+QList<TidyTreeLayout::Key> TidyTreeLayout::children(Key key) const {
+    QList<Key> result;
+    const auto found = indexOf.constFind(key);
+    if (found != indexOf.cend()) {
+        for (const auto child: nodes[*found].children) {
+            result.append(nodes[child].key);
+        }
+    }
+    return result;
+}
+
+bool TidyTreeLayout::isVisible(Key key) const {
+    const auto found = indexOf.constFind(key);
+    return found != indexOf.cend() && nodes[*found].placed;
+}
+
+QPointF TidyTreeLayout::position(Key key) const {
+    const auto found = indexOf.constFind(key);
+    if (found == indexOf.cend()) {
+        return {};
+    }
+    const auto& node = nodes[*found];
+    return {node.x, node.depth * spacing.levels};
+}
+
+QList<TidyTreeLayout::Key> TidyTreeLayout::visibleNodes() const {
+    QList<Key> result;
+    for (auto it = indexOf.cbegin(); it != indexOf.cend(); ++it) {
+        if (nodes[it.value()].placed) {
+            result.append(it.key());
+        }
+    }
+    return result;
+}
+
+QList<TidyTreeLayout::Key> TidyTreeLayout::layout() {
+    QList<Key> laidOut;
+    if (root < 0) {
+        return laidOut;
+    }
+
+    std::vector<int> tops;
+    if (layoutAll) {
+        tops.push_back(root);
+    } else {
+        for (const auto node: dirtyNodes) {
+            if (!nodes[node].detached && isShown(node)) {
+                tops.push_back(findSubtreeToLayout(node));
+            }
+        }
+    }
+    for (const auto node: dirtyNodes) {
+        nodes[node].dirty = false;
+    }
+    dirtyNodes.clear();
+
+    // Subtrees in another subtree that is laid out are laid out with it.
+    std::ranges::sort(tops);
+    tops.erase(std::ranges::unique(tops).begin(), tops.end());
+    for (const auto top: tops) {
+        bool nested = false;
+        for (auto ancestor = nodes[top].parent; ancestor >= 0 && !nested; ancestor = nodes[ancestor].parent) {
+            nested = std::ranges::binary_search(tops, ancestor);
+        }
+        if (!nested) {
+            place(top, laidOut);
+        }
+    }
+
+    // The removed nodes are no longer needed for the old outline.
+    std::vector<int> toFree;
+    for (const auto node: withRemoved) {
+        toFree.insert(toFree.end(), nodes[node].removed.begin(), nodes[node].removed.end());
+        nodes[node].removed.clear();
+    }
+    withRemoved.clear();
+    while (!toFree.empty()) {
+        const auto node = toFree.back();
+        toFree.pop_back();
+        toFree.insert(toFree.end(), nodes[node].children.begin(), nodes[node].children.end());
+        toFree.insert(toFree.end(), nodes[node].removed.begin(), nodes[node].removed.end());
+        nodes[node] = {};
+        freeSlots.push_back(node);
+    }
+
+    layoutAll = false;
+    return laidOut;
+}
+
+int TidyTreeLayout::allocate(Key key, int parent) {
+    int node;
+    if (freeSlots.empty()) {
+        node = static_cast<int>(nodes.size());
+        nodes.emplace_back();
+    } else {
+        node = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    nodes[node].key = key;
+    nodes[node].parent = parent;
+    indexOf.insert(key, node);
+    return node;
+}
+
+void TidyTreeLayout::detach(int node) {
+    std::vector<int> stack{node};
+    while (!stack.empty()) {
+        const auto current = stack.back();
+        stack.pop_back();
+        nodes[current].detached = true;
+        indexOf.remove(nodes[current].key);
+        stack.insert(stack.end(), nodes[current].children.begin(), nodes[current].children.end());
+    }
+}
+
+void TidyTreeLayout::markDirty(int node) {
+    if (!nodes[node].dirty) {
+        nodes[node].dirty = true;
+        dirtyNodes.push_back(node);
+    }
+}
+
+bool TidyTreeLayout::isShown(int node) const {
+    for (auto ancestor = nodes[node].parent; ancestor >= 0; ancestor = nodes[ancestor].parent) {
+        if (nodes[ancestor].collapsed) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int TidyTreeLayout::findSubtreeToLayout(int node) {
+    // A subtree with the same outline fits in the same place, so the rest of the tree stays.
+    walkedCount = 0;
+    auto top = node;
+    while (top != root && (!nodes[top].placed || !sameOutline(walk(top), placedOutline(top)))) {
+        // The walks of the larger subtrees add up, so stop trying well before that costs more than
+        // laying out the whole tree.
+        if (2 * walkedCount > placedCount) {
+            return root;
+        }
+        top = nodes[top].parent;
+    }
+    return top;
+}
+
+void TidyTreeLayout::place(int top, QList<Key>& laidOut) {
+    const auto baseX = top == root ? 0.0 : nodes[top].x;
+    const auto baseDepth = top == root ? 0 : nodes[top].depth;
+
+    // Forget the previous layout, since nodes might be hidden now.
+    std::vector<int> stack{top};
+    while (!stack.empty()) {
+        const auto current = stack.back();
+        stack.pop_back();
+        if (nodes[current].placed) {
+            nodes[current].placed = false;
+            --placedCount;
+            stack.insert(stack.end(), nodes[current].children.begin(), nodes[current].children.end());
+            stack.insert(stack.end(), nodes[current].removed.begin(), nodes[current].removed.end());
+        }
+    }
+
+    walk(top);
+    stack.push_back(top);
+    while (!stack.empty()) {
+        const auto current = stack.back();
+        stack.pop_back();
+        auto& node = nodes[current];
+        node.placed = true;
+        ++placedCount;
+        node.x = baseX + node.relativeX;
+        node.depth = baseDepth + node.relativeDepth;
+        laidOut.append(node.key);
+        const auto& children = visibleChildren(current);
+        stack.insert(stack.end(), children.begin(), children.end());
+    }
+}
+
+TidyTreeLayout::Outline TidyTreeLayout::placedOutline(int top) const {
+    Outline outline;
+    const auto baseX = nodes[top].x;
+    const auto baseDepth = nodes[top].depth;
+    std::vector<int> stack{top};
+    while (!stack.empty()) {
+        const auto current = stack.back();
+        stack.pop_back();
+        const auto& node = nodes[current];
+        if (!node.placed) {
+            continue;
+        }
+        extend(outline, node.depth - baseDepth, node.x - baseX);
+        stack.insert(stack.end(), node.children.begin(), node.children.end());
+        stack.insert(stack.end(), node.removed.begin(), node.removed.end());
+    }
+    return outline;
+}
+
+TidyTreeLayout::Outline TidyTreeLayout::walk(int top) {
+    walkRoot = top;
+    firstWalk(top);
+    Outline outline;
+    secondWalk(top, -nodes[top].prelim, 0, outline);
+    return outline;
+}
+
+const std::vector<int>& TidyTreeLayout::visibleChildren(int node) const {
+    return nodes[node].collapsed ? NO_CHILDREN : nodes[node].children;
+}
+
+int TidyTreeLayout::leftSibling(int node) const {
+    const auto& current = nodes[node];
+    if (node == walkRoot || current.number == 0) {
+        return -1;
+    }
+    return nodes[current.parent].children[current.number - 1];
+}
+
+int TidyTreeLayout::nextLeft(int node) const {
+    const auto& children = visibleChildren(node);
+    return children.empty() ? nodes[node].thread : children.front();
+}
+
+int TidyTreeLayout::nextRight(int node) const {
+    const auto& children = visibleChildren(node);
+    return children.empty() ? nodes[node].thread : children.back();
+}
+
+double TidyTreeLayout::separation(int left, int right) const {
+    return nodes[left].parent == nodes[right].parent ? spacing.siblings : spacing.subtrees;
+}
+
+void TidyTreeLayout::firstWalk(int node) {
+    // Nothing outside this subtree refers to it yet, so the state of a previous walk can go.
+    auto& current = nodes[node];
+    current.prelim = 0;
+    current.mod = 0;
+    current.shift = 0;
+    current.change = 0;
+    current.thread = -1;
+    current.ancestor = node;
+
+    const auto& children = visibleChildren(node);
+    const auto sibling = leftSibling(node);
+    if (children.empty()) {
+        if (sibling >= 0) {
+            nodes[node].prelim = nodes[sibling].prelim + separation(sibling, node);
+        }
+        return;
+    }
+
+    auto defaultAncestor = children.front();
+    for (const auto child: children) {
+        firstWalk(child);
+        defaultAncestor = apportion(child, defaultAncestor);
+    }
+    executeShifts(node);
+
+    const auto midpoint = (nodes[children.front()].prelim + nodes[children.back()].prelim) / 2;
+    if (sibling >= 0) {
+        nodes[node].prelim = nodes[sibling].prelim + separation(sibling, node);
+        nodes[node].mod = nodes[node].prelim - midpoint;
+    } else {
+        nodes[node].prelim = midpoint;
+    }
+}
+
+int TidyTreeLayout::apportion(int node, int defaultAncestor) {
+    const auto sibling = leftSibling(node);
+    if (sibling < 0) {
+        return defaultAncestor;
+    }
+
+    // The inner and outer contours on the right (p) of the node and left (m) of its siblings.
+    auto insideRight = node;
+    auto outsideRight = node;
+    auto insideLeft = sibling;
+    auto outsideLeft = nodes[nodes[node].parent].children.front();
+    auto sumInsideRight = nodes[insideRight].mod;
+    auto sumOutsideRight = nodes[outsideRight].mod;
+    auto sumInsideLeft = nodes[insideLeft].mod;
+    auto sumOutsideLeft = nodes[outsideLeft].mod;
+
+    while (nextRight(insideLeft) >= 0 && nextLeft(insideRight) >= 0) {
+        insideLeft = nextRight(insideLeft);
+        insideRight = nextLeft(insideRight);
+        outsideLeft = nextLeft(outsideLeft);
+        outsideRight = nextRight(outsideRight);
+        nodes[outsideRight].ancestor = node;
+
+        const auto shift = (nodes[insideLeft].prelim + sumInsideLeft) - (nodes[insideRight].prelim + sumInsideRight) +
+                           separation(insideLeft, insideRight);
+        if (shift > 0) {
+            const auto leftAncestor = nodes[insideLeft].ancestor;
+            const bool isSibling = nodes[leftAncestor].parent == nodes[node].parent && leftAncestor != node;
+            moveSubtree(isSibling ? leftAncestor : defaultAncestor, node, shift);
+            sumInsideRight += shift;
+            sumOutsideRight += shift;
+        }
+        sumInsideLeft += nodes[insideLeft].mod;
+        sumInsideRight += nodes[insideRight].mod;
+        sumOutsideLeft += nodes[outsideLeft].mod;
+        sumOutsideRight += nodes[outsideRight].mod;
+    }
+
+    if (nextRight(insideLeft) >= 0 && nextRight(outsideRight) < 0) {
+        nodes[outsideRight].thread = nextRight(insideLeft);
+        nodes[outsideRight].mod += sumInsideLeft - sumOutsideRight;
+    }
+    if (nextLeft(insideRight) >= 0 && nextLeft(outsideLeft) < 0) {
+        nodes[outsideLeft].thread = nextLeft(insideRight);
+        nodes[outsideLeft].mod += sumInsideRight - sumOutsideLeft;
+        defaultAncestor = node;
+    }
+    return defaultAncestor;
+}
+
+void TidyTreeLayout::moveSubtree(int left, int right, double shift) {
+    const auto subtrees = nodes[right].number - nodes[left].number;
+    nodes[right].change -= shift / subtrees;
+    nodes[right].shift += shift;
+    nodes[left].change += shift / subtrees;
+    nodes[right].prelim += shift;
+    nodes[right].mod += shift;
+}
+
+void TidyTreeLayout::executeShifts(int node) {
+    double shift = 0;
+    double change = 0;
+    const auto& children = visibleChildren(node);
+    for (auto it = children.rbegin(); it != children.rend(); ++it) {
+        auto& child = nodes[*it];
+        child.prelim += shift;
+        child.mod += shift;
+        change += child.change;
+        shift += child.shift + change;
+    }
+}
+
+void TidyTreeLayout::secondWalk(int node, double modSum, int depth, Outline& outline) {
+    auto& current = nodes[node];
+    current.relativeX = current.prelim + modSum;
+    current.relativeDepth = depth;
+    extend(outline, depth, current.relativeX);
+    ++walkedCount;
+    const auto childModSum = modSum + current.mod;
+    for (const auto child: visibleChildren(node)) {
+        secondWalk(child, childModSum, depth + 1, outline);
+    }
+}
@@ -0,0 +1,157 @@
+/*
+ * SPDX-FileCopyrightText: Niko Strijbol <niko@strijbol.be>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QPointF>
+#include <utility>
+#include <vector>
+
+/**
+ * Lays out a tree so it is tidy: nodes on a level do not overlap, parents are centered above
+ * their children, and a subtree is drawn the same wherever it is in the tree.
+ *
+ * This is the algorithm of Walker, with the improvements of Buchheim, Jünger and Leipert to run
+ * in linear time.
+ *
+ * The tree can change after it is laid out: nodes can get other children, and the children of
+ * a node can be hidden by collapsing it. The next layout then only lays out the smallest subtree
+ * that contains the changes, and whose outline stays the same. The nodes outside that subtree
+ * keep their position.
+ *
+ * The root is at (0, 0); every level is one level separation further along the y-axis.
+ */
+class TidyTreeLayout {
+public:
+    using Key = quint32;
+
+    struct Spacing {
+        // Between the centers of neighbouring nodes with the same parent.
+        double siblings = 1.0;
+        // Between the centers of neighbouring nodes with another parent.
+        double subtrees = 1.0;
+        // Between the centers of two levels.
+        double levels = 1.0;
+    };
+
+    void setSpacing(const Spacing& spacing);
+
+    /**
+     * Replace the tree by a tree with only a root.
+     */
+    void setRoot(Key root);
+
+    void clear();
+
+    /**
+     * Set the children of a node that is in the tree, from left to right.
+     *
+     * Children that are already elsewhere in the tree keep their place and are skipped. Children
+     * that the node no longer has are removed from the tree, with their descendants.
+     */
+    void setChildren(Key node, const QList<Key>& children);
+
+    /**
+     * Hide or show the descendants of a node.
+     */
+    void setCollapsed(Key node, bool collapsed);
+
+    [[nodiscard]] bool isCollapsed(Key node) const;
+
+    [[nodiscard]] bool contains(Key node) const;
+
+    [[nodiscard]] QList<Key> children(Key node) const;
+
+    /**
+     * Lay out the parts of the tree that changed since the last layout.
+     *
+     * @return The visible nodes that were laid out again; the other nodes did not move.
+     */
+    QList<Key> layout();
+
+    /**
+     * @return If the node was visible in the last layout.
+     */
+    [[nodiscard]] bool isVisible(Key node) const;
+
+    /**
+     * @return The position of the node in the last layout.
+     */
+    [[nodiscard]] QPointF position(Key node) const;
+
+    [[nodiscard]] QList<Key> visibleNodes() const;
+
+private:
+    // The leftmost and rightmost x on each level of a subtree.
+    using Outline = std::vector<std::pair<double, double>>;
+
+    struct Node {
+        Key key = 0;
+        int parent = -1;
+        std::vector<int> children;
+        // Children that were removed since the last layout, which still define the old outline.
+        std::vector<int> removed;
+        // The position in the children of the parent.
+        int number = 0;
+        bool collapsed = false;
+        bool dirty = false;
+        bool detached = false;
+
+        // The result of the last layout.
+        bool placed = false;
+        double x = 0;
+        int depth = 0;
+
+        // The state of the walks, see the paper of Buchheim et al.
+        double prelim = 0;
+        double mod = 0;
+        double shift = 0;
+        double change = 0;
+        int thread = -1;
+        int ancestor = -1;
+        // The result of the walks, relative to the root of the walk.
+        double relativeX = 0;
+        int relativeDepth = 0;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<int> freeSlots;
+    QHash<Key, int> indexOf;
+    int root = -1;
+    Spacing spacing;
+    bool layoutAll = true;
+    std::vector<int> dirtyNodes;
+    std::vector<int> withRemoved;
+    // The number of nodes in the last layout.
+    qsizetype placedCount = 0;
+    // The root of the subtree that is being walked, and the number of nodes walked.
+    int walkRoot = -1;
+    qsizetype walkedCount = 0;
+
+    int allocate(Key key, int parent);
+    void detach(int node);
+    void markDirty(int node);
+    [[nodiscard]] bool isShown(int node) const;
+    [[nodiscard]] int findSubtreeToLayout(int node);
+    void place(int top, QList<Key>& laidOut);
+
+    // The walks over the subtree rooted at walkRoot.
+    Outline walk(int top);
+    [[nodiscard]] const std::vector<int>& visibleChildren(int node) const;
+    [[nodiscard]] int leftSibling(int node) const;
+    [[nodiscard]] int nextLeft(int node) const;
+    [[nodiscard]] int nextRight(int node) const;
+    [[nodiscard]] double separation(int left, int right) const;
+    void firstWalk(int node);
+    int apportion(int node, int defaultAncestor);
+    void moveSubtree(int left, int right, double shift);
+    void executeShifts(int node);
+    void secondWalk(int node, double modSum, int depth, Outline& outline);
+
+    [[nodiscard]] Outline placedOutline(int top) const;
+};
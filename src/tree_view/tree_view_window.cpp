@@ -8,6 +8,7 @@
 
 #include "domain/family/ancestor_model.h"
 #include "main/main_window.h"
+#include "opaSettings.h"
 #include "person_tree_graph_model.h"
 #include "utils/formatted_identifier_delegate.h"
 
@@ -20,7 +21,7 @@
 #include <QtNodes/StyleCollection>
 
 TreeViewWindow::TreeViewWindow(IntegerPrimaryKey person, QWidget* parent) : QMainWindow(parent) {
-    auto* graphModel = new PersonTreeGraphModel(person);
+    auto* graphModel = new PersonTreeGraphModel(person, opaSettings::pedigreeGenerations());
     auto rootIndex = graphModel->findByChildId(person).constFirst();
     auto* model = rootIndex.model();
     auto name = model->index(rootIndex.row(), AncestorModel::DISPLAY_NAME).data().toString();
@@ -55,6 +56,20 @@ TreeViewWindow::TreeViewWindow(IntegerPrimaryKey person, QWidget* parent) : QMai
     toolbar->addAction(center);
     connect(center, &QAction::triggered, graphicsView, &QtNodes::GraphicsView::centerScene);
 
+    auto* collapse = new QAction(toolbar);
+    collapse->setText(i18n("Show or hide ancestors"));
+    collapse->setIcon(QIcon::fromTheme(QStringLiteral("view-list-tree")));
+    toolbar->addAction(collapse);
+    connect(collapse, &QAction::triggered, this, [this, graphModel] {
+        for (const auto nodeId: scene->selectedNodes()) {
+            if (graphModel->hasUnloadedAncestors(nodeId)) {
+                graphModel->loadAncestors(nodeId);
+            } else {
+                graphModel->setCollapsed(nodeId, !graphModel->isCollapsed(nodeId));
+            }
+        }
+    });
+
     setCentralWidget(graphicsView);
     toolbar->setMovable(false);
 
@@ -5,7 +5,6 @@
  */
 #include "./name_editor_dialog.h"
 
-#include "../../domain/name/name_origin_translation_repository.h"
 #include "../../domain/name/name_origins_model.h"
 #include "../../domain/name/name_repository.h"
 #include "../../domain/name/names.h"
@@ -13,6 +12,7 @@
 #include "ui_name_editor_dialog.h"
 #include "utils/formatted_identifier_delegate.h"
 #include "utils/translating_proxy_model.h"
+#include "utils/type_translation_cache.h"
 
 #include <KLocalizedString>
 #include <QCompleter>
@@ -40,7 +40,7 @@ NamesEditorDialog::NamesEditorDialog(IntegerPrimaryKey nameId, bool newRow, QWid
     auto* originsProxy = new TranslatingProxyModel(
         TypeTranslationResolver(
             [](IntegerPrimaryKey originId, const QString& locale) {
-                return NameOriginTranslationRepository().findByTypeIdAndLocale(originId, locale);
+                return TypeTranslationCache::forTable<Schema::NameOriginTranslations>().find(originId, locale);
             },
             NameOrigins::toDisplayString
         ),
@@ -9,7 +9,6 @@
 #include "domain/media/media_repository.h"
 #include "domain/source/source.h"
 #include "domain/source/source_repository.h"
-#include "domain/source/source_type_translation_repository.h"
 #include "domain/source/source_types.h"
 #include "domain/source/source_types_list_model.h"
 #include "editors/note_editor_dialog.h"
@@ -20,6 +19,7 @@
 #include "utils/formatted_identifier_delegate.h"
 #include "utils/model_utils.h"
 #include "utils/translating_proxy_model.h"
+#include "utils/type_translation_cache.h"
 
 #include <KCollapsibleGroupBox>
 #include <KLocalizedString>
@@ -53,7 +53,7 @@ SourceEditorDialog::SourceEditorDialog(std::optional<IntegerPrimaryKey> sourceId
     auto* typesProxy = new TranslatingProxyModel(
         TypeTranslationResolver(
             [](IntegerPrimaryKey typeId, const QString& locale) {
-                return SourceTypeTranslationRepository().findByTypeIdAndLocale(typeId, locale);
+                return TypeTranslationCache::forTable<Schema::SourceTypeTranslations>().find(typeId, locale);
             },
             SourceTypes::toDisplayString
         ),
@@ -0,0 +1,28 @@
+/*
+ * SPDX-FileCopyrightText: Niko Strijbol <niko@strijbol.be>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+#include "locale_change_notifier.h"
+
+#include <QCoreApplication>
+#include <QEvent>
+
+LocaleChangeNotifier& LocaleChangeNotifier::instance() {
+    static LocaleChangeNotifier notifier;
+    return notifier;
+}
+
+LocaleChangeNotifier::LocaleChangeNotifier() {
+    if (auto* application = QCoreApplication::instance()) {
+        application->installEventFilter(this);
+    }
+}
+
+bool LocaleChangeNotifier::eventFilter(QObject* watched, QEvent* event) {
+    if (watched == QCoreApplication::instance() &&
+        (event->type() == QEvent::LocaleChange || event->type() == QEvent::LanguageChange)) {
+        Q_EMIT changed();
+    }
+    return QObject::eventFilter(watched, event);
+}
@@ -0,0 +1,30 @@
+/*
+ * SPDX-FileCopyrightText: Niko Strijbol <niko@strijbol.be>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+#pragma once
+
+#include <QObject>
+
+/**
+ * Tells when the locale or the language of the application changes.
+ *
+ * Models that cache localized text connect to changed() to compute it again. Only widgets get
+ * these events, so the notifier watches the application object instead. There is one notifier
+ * for the whole application, so there is one event filter, however many models listen.
+ */
+class LocaleChangeNotifier : public QObject {
+    Q_OBJECT
+
+public:
+    static LocaleChangeNotifier& instance();
+
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
+Q_SIGNALS:
+    void changed();
+
+private:
+    LocaleChangeNotifier();
+};
@@ -5,11 +5,28 @@
  */
 #include "translating_proxy_model.h"
 
+#include "locale_change_notifier.h"
+
 #include <QLocale>
 
 TranslatingProxyModel::TranslatingProxyModel(TypeTranslationResolver resolver, QObject* parent) :
     QIdentityProxyModel(parent),
-    resolver(std::move(resolver)) {
+    resolver(std::move(resolver)),
+    locale(QLocale::system().name()) {
+    connect(
+        &LocaleChangeNotifier::instance(),
+        &LocaleChangeNotifier::changed,
+        this,
+        &TranslatingProxyModel::onLocaleChanged
+    );
+}
+
+void TranslatingProxyModel::onLocaleChanged() {
+    locale = QLocale::system().name();
+    const auto rows = rowCount();
+    if (rows > 0) {
+        Q_EMIT dataChanged(index(0, TYPE_COLUMN), index(rows - 1, TYPE_COLUMN), {Qt::DisplayRole});
+    }
 }
 
 QVariant TranslatingProxyModel::data(const QModelIndex& index, int role) const {
@@ -23,6 +40,5 @@ QVariant TranslatingProxyModel::data(const QModelIndex& index, int role) const {
     const auto idIdx = QIdentityProxyModel::index(index.row(), ID_COLUMN, index.parent());
     const auto typeId = QIdentityProxyModel::data(idIdx, Qt::DisplayRole).toLongLong();
 
-    const auto locale = QLocale::system().name();
     return resolver.resolve(typeString, builtin, typeId, locale);
 }
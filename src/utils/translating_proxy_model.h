@@ -14,6 +14,8 @@
  *
  * Wraps a source model with columns ID, TYPE, BUILTIN (indices 0, 1, 2).
  * For the TYPE column, Qt::DisplayRole is intercepted and resolved via TypeTranslationResolver.
+ * This happens each time a view paints the column, so the resolver should not query the database;
+ * see TypeTranslationCache.
  */
 class TranslatingProxyModel : public QIdentityProxyModel {
     Q_OBJECT
@@ -29,4 +31,8 @@ public:
 
 private:
     TypeTranslationResolver resolver;
+    // The name of the system locale, which is not cheap to get.
+    QString locale;
+
+    void onLocaleChanged();
 };
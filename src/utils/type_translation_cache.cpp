@@ -0,0 +1,72 @@
+/*
+ * SPDX-FileCopyrightText: Niko Strijbol <niko@strijbol.be>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+#include "type_translation_cache.h"
+
+#include "core/query_helper.h"
+
+#include <QList>
+#include <QSqlQuery>
+
+using namespace Qt::StringLiterals;
+
+namespace {
+QList<TypeTranslationCache*>& allCaches() {
+    static QList<TypeTranslationCache*> caches;
+    return caches;
+}
+}
+
+TypeTranslationCache::TypeTranslationCache(QLatin1StringView table, QLatin1StringView typeIdColumn) :
+    table(table),
+    typeIdColumn(typeIdColumn) {
+    allCaches().append(this);
+}
+
+TypeTranslationCache::~TypeTranslationCache() {
+    allCaches().removeOne(this);
+}
+
+void TypeTranslationCache::clearAll() {
+    for (auto* cache: std::as_const(allCaches())) {
+        cache->clear();
+    }
+}
+
+std::optional<QString> TypeTranslationCache::find(IntegerPrimaryKey typeId, const QString& locale) {
+    ++stats_.lookups;
+    auto translations = byLocale.constFind(locale);
+    if (translations == byLocale.cend()) {
+        ++stats_.loads;
+        translations = byLocale.insert(locale, load(locale));
+    }
+    if (const auto name = translations->constFind(typeId); name != translations->cend()) {
+        return *name;
+    }
+    return std::nullopt;
+}
+
+void TypeTranslationCache::clear() {
+    byLocale.clear();
+}
+
+TypeTranslationCache::Stats TypeTranslationCache::stats() const {
+    return stats_;
+}
+
+QHash<IntegerPrimaryKey, QString> TypeTranslationCache::load(const QString& locale) const {
+    QHash<IntegerPrimaryKey, QString> result;
+    auto [query, ok] = QueryHelper::executeCached(
+        u"SELECT %1, name FROM %2 WHERE locale = :locale"_s.arg(typeIdColumn, table),
+        {{u":locale"_s, locale}}
+    );
+    if (!ok) {
+        return result;
+    }
+    while (query->next()) {
+        result.insert(query->value(0).toLongLong(), query->value(1).toString());
+    }
+    return result;
+}
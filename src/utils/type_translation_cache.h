@@ -0,0 +1,89 @@
+/*
+ * SPDX-FileCopyrightText: Niko Strijbol <niko@strijbol.be>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+#pragma once
+
+#include "core/data_event_broker.h"
+#include "database/schema.h"
+
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <concepts>
+#include <optional>
+#include <type_traits>
+
+/**
+ * The translations of user-defined types (event types, location types, etc.), by locale.
+ *
+ * The first lookup for a locale loads all translations of the table for that locale, so the
+ * lookups after it, e.g. when a combo box paints its rows, are a hash lookup instead of a query.
+ * The cache is emptied when its table changes, and when another database is opened.
+ *
+ * There is one cache per table, see forTable(). Use it from the GUI thread.
+ */
+class TypeTranslationCache : public QObject {
+    Q_OBJECT
+
+public:
+    struct Stats {
+        qint64 lookups = 0;
+        // Lookups that had to load the translations of their locale.
+        qint64 loads = 0;
+    };
+
+    /**
+     * @tparam Table One of the *_type_translations tables, e.g. Schema::EventTypeTranslations.
+     */
+    template<typename Table>
+    static TypeTranslationCache& forTable() {
+        static_assert(Schema::is_table_tag<Table>, "forTable must be called with a type from the Schema namespace.");
+        static TypeTranslationCache cache(std::type_identity<Table>{});
+        return cache;
+    }
+
+    /**
+     * Empty the caches of all tables.
+     */
+    static void clearAll();
+
+    /**
+     * @return The translation of the type for exactly this locale, without falling back to the
+     * language (see TypeTranslationResolver for that).
+     */
+    [[nodiscard]] std::optional<QString> find(IntegerPrimaryKey typeId, const QString& locale);
+
+    void clear();
+
+    [[nodiscard]] Stats stats() const;
+
+    ~TypeTranslationCache() override;
+
+private:
+    QLatin1StringView table;
+    QLatin1StringView typeIdColumn;
+    QHash<QString, QHash<IntegerPrimaryKey, QString>> byLocale;
+    Stats stats_;
+
+    TypeTranslationCache(QLatin1StringView table, QLatin1StringView typeIdColumn);
+
+    template<typename Table>
+    explicit TypeTranslationCache(std::type_identity<Table>) : TypeTranslationCache(Table::table, keyColumn<Table>()) {
+        connectToTable<Table>(this, [this] { clear(); });
+    }
+
+    template<typename Table>
+    static constexpr QLatin1StringView keyColumn() {
+        if constexpr (std::same_as<Table, Schema::EventRoleTranslations>) {
+            return QLatin1StringView("role_id");
+        } else if constexpr (std::same_as<Table, Schema::NameOriginTranslations>) {
+            return QLatin1StringView("origin_id");
+        } else {
+            return QLatin1StringView("type_id");
+        }
+    }
+
+    QHash<IntegerPrimaryKey, QString> load(const QString& locale) const;
+};